@@ -42,6 +42,9 @@
 
 #define FN_CELLULAR_INDEX_MAX 3
 
+// Points processed at once by the batch functions: the coordinates of a block stay in the cache across the octaves
+#define FN_BATCH_SIZE 128
+
 #ifdef FN_USE_DOUBLES
 typedef double FN_DECIMAL;
 #else
@@ -219,6 +222,31 @@ public:
 	FN_DECIMAL GetWhiteNoise(FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
 	FN_DECIMAL GetWhiteNoiseInt(int x, int y, int z, int w) const;
 
+	//Batch
+	// Evaluate count points: out[i] is the same as calling the function on (x[i], y[i], z[i])
+	// The interpolation and fractal types are switched on once per block of FN_BATCH_SIZE points instead of once per point and octave
+	void GetValue(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetValueFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetPerlin(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetPerlinFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetSimplex(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetSimplexFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetCellular(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetWhiteNoise(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetCubic(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+	void GetCubicFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const;
+
+	void GetValue(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetValueFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetPerlin(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetPerlinFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetSimplex(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetSimplexFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetCellular(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetWhiteNoise(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetCubic(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void GetCubicFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+
 private:
 	unsigned char m_perm[512];
 	unsigned char m_perm12[512];
@@ -301,6 +329,23 @@ private:
 	//4D
 	FN_DECIMAL SingleSimplex(unsigned char offset, FN_DECIMAL x, FN_DECIMAL y, FN_DECIMAL z, FN_DECIMAL w) const;
 
+	//Batch
+	// Single noise on at most FN_BATCH_SIZE points. z is ignored by the 2D ones
+	typedef void (FastNoise::*SingleBatchFunction)(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+
+	void NoiseBatch(SingleBatchFunction single, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void FractalBatch(SingleBatchFunction single, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+
+	void SingleValueBatch2D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void SinglePerlinBatch2D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void SingleSimplexBatch2D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void SingleCubicBatch2D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+
+	void SingleValueBatch3D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void SinglePerlinBatch3D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void SingleSimplexBatch3D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+	void SingleCubicBatch3D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const;
+
 	inline unsigned char Index2D_12(unsigned char offset, int x, int y) const;
 	inline unsigned char Index3D_12(unsigned char offset, int x, int y, int z) const;
 	inline unsigned char Index4D_32(unsigned char offset, int x, int y, int z, int w) const;
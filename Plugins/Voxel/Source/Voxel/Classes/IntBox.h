@@ -107,6 +107,16 @@ struct VOXEL_API FIntBox
 			   Max.X > Other.Max.X && Max.Y > Other.Max.Y && Max.Z > Other.Max.Z;
 	}
 
+	/**
+	 * Get the smallest box containing both boxes
+	 */
+	FIntBox Union(const FIntBox& Other) const
+	{
+		return FIntBox(
+			FIntVector(FMath::Min(Min.X, Other.Min.X), FMath::Min(Min.Y, Other.Min.Y), FMath::Min(Min.Z, Other.Min.Z)),
+			FIntVector(FMath::Max(Max.X, Other.Max.X), FMath::Max(Max.Y, Other.Max.Y), FMath::Max(Max.Z, Other.Max.Z)));
+	}
+
 	/**
 	 * Returns the overlap FVoxelBox of two box
 	 *
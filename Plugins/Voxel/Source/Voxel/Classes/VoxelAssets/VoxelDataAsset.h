@@ -6,6 +6,18 @@
 #include "VoxelAsset.h"
 #include "VoxelDataAsset.generated.h"
 
+/**
+ * Decompressed content of a UVoxelDataAsset. Shared by the asset and its instances, never modified once shared
+ */
+struct FVoxelDataAssetData
+{
+	FIntVector Size = FIntVector::ZeroValue;
+
+	TArray<float> Values;
+	TArray<FVoxelMaterial> Materials;
+	TArray<uint8> VoxelTypes;
+};
+
 /**
  * A Data Asset stores the values of every voxel inside it
  */
@@ -79,11 +91,13 @@ private:
 	UPROPERTY()
 	TArray<uint8> CompressedData;
 
-	FIntVector Size;
+	// Decompressed once by LoadInternal, then shared with the instances
+	TSharedRef<FVoxelDataAssetData> Data;
 
-	TArray<float> Values;
-	TArray<FVoxelMaterial> Materials;
-	TArray<uint8> VoxelTypes;
+	/**
+	 * Get the data to modify it. Copied first if shared with instances, so that they aren't affected
+	 */
+	FVoxelDataAssetData& GetMutableData();
 
 	static const ECompressionFlags CompressionFlags = (ECompressionFlags)(COMPRESS_ZLIB | COMPRESS_BiasSpeed);
 };
@@ -91,7 +105,7 @@ private:
 class FVoxelDataAssetInstance : public FVoxelAssetInstance
 {
 public:
-	FVoxelDataAssetInstance(const FIntVector& Size, const TArray<float>& Values, const TArray<FVoxelMaterial>& Materials, const TArray<uint8>& VoxelTypes, const FIntVector& Position);
+	FVoxelDataAssetInstance(const TSharedRef<const FVoxelDataAssetData>& Data, const FIntVector& Position);
 
 	//~ Begin FVoxelAssetInstance Interface
 	void GetValuesAndMaterialsAndVoxelTypes(float Values[], FVoxelMaterial Materials[], FVoxelType VoxelTypes[], const FIntVector& Start, const FIntVector& StartIndex, int Step, const FIntVector& Size, const FIntVector& ArraySize) const override;
@@ -99,8 +113,5 @@ public:
 	//~ End FVoxelAssetInstance Interface
 
 private:
-	const FIntVector Size;
-	const TArray<float> Values;
-	const TArray<FVoxelMaterial> Materials;
-	const TArray<uint8> VoxelTypes;
+	const TSharedRef<const FVoxelDataAssetData> Data;
 };
@@ -8,6 +8,19 @@
 #include "VoxelAsset.h"
 #include "VoxelLandscapeAsset.generated.h"
 
+/**
+ * Decompressed content of a UVoxelLandscapeAsset. Shared by the asset and its instances, never modified once shared
+ */
+struct FVoxelLandscapeAssetData
+{
+	TArray<float> Heights;
+	TArray<FVoxelMaterial> Materials;
+	int Width = 0;
+	int Height = 0;
+	float MaxHeight = -1e10;
+	float MinHeight = 1e10;
+};
+
 /**
  * Asset that holds 2D information
  */
@@ -82,12 +95,13 @@ private:
 	UPROPERTY()
 	TArray<uint8> CompressedData;
 
-	TArray<float> Heights;
-	TArray<FVoxelMaterial> Materials;
-	int Width;
-	int Height;
-	float MaxHeight;
-	float MinHeight;
+	// Decompressed once by LoadInternal, then shared with the instances
+	TSharedRef<FVoxelLandscapeAssetData> Data;
+
+	/**
+	 * Get the data to modify it. Copied first if shared with instances, so that they aren't affected
+	 */
+	FVoxelLandscapeAssetData& GetMutableData();
 
 	static const ECompressionFlags CompressionFlags = (ECompressionFlags)(COMPRESS_ZLIB | COMPRESS_BiasSpeed);
 };
@@ -97,12 +111,7 @@ class VOXEL_API FVoxelLandscapeAssetInstance : public FVoxelAssetInstance
 {
 public:
 	FVoxelLandscapeAssetInstance(
-		const TArray<float>& Heights,
-		const TArray<FVoxelMaterial>& Materials,
-		int Width,
-		int Height,
-		float MaxHeight,
-		float MinHeight,
+		const TSharedRef<const FVoxelLandscapeAssetData>& Data,
 		int Precision,
 		float HeightMultiplier,
 		float HeightOffset,
@@ -123,12 +132,7 @@ public:
 	FORCEINLINE FVoxelMaterial GetMaterial(int X, int Y) const;
 
 private:
-	const TArray<float> Heights;
-	const TArray<FVoxelMaterial> Materials;
-	const int Width;
-	const int Height;
-	const float MaxHeight;
-	const float MinHeight;
+	const TSharedRef<const FVoxelLandscapeAssetData> Data;
 
 	const int Precision;
 	const float HeightMultiplier;
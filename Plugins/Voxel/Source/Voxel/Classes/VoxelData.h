@@ -11,8 +11,10 @@
 #include "VoxelAsset.h"
 #include "VoxelSave.h"
 #include "VoxelDirection.h"
+#include "VoxelRaycast.h"
 
 class FValueOctree;
+struct FValueOctreeContext;
 class FVoxelWorldGeneratorInstance;
 
 /**
@@ -26,8 +28,9 @@ public:
 	 * @param	LOD				LOD of this world; Size = DATA_CHUNK_SIZE * 2^LOD
 	 * @param	WorldGenerator	Generator for this world
 	 * @param	bMultiplayer	Is this for a multiplayer world
+	 * @param	GeneratorCacheSize	Max memory used to cache the world generator values, in bytes
 	 */
-	FVoxelData(int LOD, TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, bool bMultiplayer);
+	FVoxelData(int LOD, TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, bool bMultiplayer, uint32 GeneratorCacheSize = 0);
 	~FVoxelData();
 
 	// LOD of the octree
@@ -42,19 +45,22 @@ public:
 
 	
 	/**
-	 * Lock Box in read/write
+	 * Lock Box in read/write. There is only one writer at a time
+	 * Other threads don't see the edits until EndSet
+	 * Loads the streamed chunks in Box first, see StreamFromSave
 	 * @param	Box		Box to lock
 	 * @return	Locked octrees
 	 */
 	TArray<uint64> BeginSet(const FIntBox& Box);
 	/**
-	 * End the lock on LockedOctrees
+	 * End the lock on LockedOctrees and publish the edits
 	 * @param	LockedOctrees		Returned by BeginSet
 	 */
 	 void EndSet(TArray<uint64>& LockedOctrees);
 	 
 	/**
 	 * Lock Box in read only
+	 * Reads don't block writers: each chunk is read as it was at the end of an EndSet
 	 * @param	Box		Box to lock
 	 * @return	Locked octrees
 	 */
@@ -97,6 +103,18 @@ public:
 	FVector GetGradient(int X, int Y, int Z);
 	FVector GetGradient(const FIntVector& P);
 
+	/**
+	 * Find the first surface crossed by Ray. The values are trilinearly interpolated between the voxels. Doesn't require BeginGet, thread safe
+	 * The regions without surface are skipped using the octree summaries and the world generator IsEmpty
+	 * @return	Was a surface hit?
+	 */
+	bool Raycast(const FVoxelRay& Ray, FVoxelRaycastHit& OutHit) const;
+	/**
+	 * Raycast many rays, eg from a worker thread. Close rays share the skipped regions
+	 * @param	OutHits		Same order as Rays
+	 */
+	void RaycastBatch(const TArray<FVoxelRay>& Rays, TArray<FVoxelRaycastHit>& OutHits) const;
+
 	/**
 	 * Set value at position. Requires BeginSet
 	 * @param	X,Y,Z	Position in voxel space
@@ -158,9 +176,14 @@ public:
 	FORCEINLINE void ClampToWorld(int& X, int& Y, int& Z) const;
 
 	/**
-	 * Get a save of this world
+	 * Get a save of this world. Loads all the streamed chunks first
 	 */
 	void GetSave(FVoxelWorldSave& OutSave);
+	/**
+	 * Append the chunks edited since the last GetSave/AppendToSave to Save. Does GetSave if Save can't be appended to, or if edited chunks were reset since
+	 * @param	Save	The last save of this world
+	 */
+	void AppendToSave(FVoxelWorldSave& Save);
 
 	/**
 	 * Load this world from save
@@ -169,7 +192,30 @@ public:
 	 * @return	OutModifiedPositions		The modified positions
 	 */
 	void LoadFromSaveAndGetModifiedPositions(const FVoxelWorldSave& Save, TArray<FIntVector>& OutModifiedPositions, bool bReset);
+	/**
+	 * Load this world from save lazily: the chunks are loaded by LoadStreamedChunksAndGetModifiedPositions, or before being edited
+	 * Until then, reading them returns the world generator values
+	 * @param	Save						Save to load from. Requires Save.HasChunkIndex. Copied
+	 * @param	bReset						Reset all chunks? Set to false if the world is unmodified
+	 */
+	void StreamFromSave(const FVoxelWorldSave& Save, bool bReset);
+	/**
+	 * Load the streamed chunks intersecting Boxes
+	 * @return	OutModifiedPositions		The modified positions, including the ones of the chunks loaded by BeginSet
+	 * @return	Are there streamed chunks not loaded yet?
+	 */
+	bool LoadStreamedChunksAndGetModifiedPositions(const TArray<FIntBox>& Boxes, TArray<FIntVector>& OutModifiedPositions);
 	
+	/**
+	 * Get the edited chunks intersecting Boxes but none of ExcludedBoxes, eg the ones entering a region. Loads the streamed chunks in Boxes first
+	 * @param	OutChunks	Sorted by increasing Id
+	 */
+	void GetChunksInBoxes(const TArray<FIntBox>& Boxes, const TArray<FIntBox>& ExcludedBoxes, TArray<FVoxelChunkSave>& OutChunks);
+	/**
+	 * Get the bounds of the data chunk with this Id, eg of a diff
+	 */
+	FIntBox GetChunkBounds(uint64 Id) const;
+
 	/**
 	 * Get diff arrays to allow network transmission
 	 * @param	OutValueDiffQueue		Values diff array; sorted by increasing Id
@@ -203,6 +249,38 @@ public:
 	}
 	void DiscardValuesByPredicateF(const std::function<int(const FIntBox&)>& P);
 
+	/**
+	 * Compress the edited chunks that weren't used for a while, and page the compressed ones out to disk
+	 * @param	MinIdleTime			Time in seconds since the last use of a chunk before compressing it
+	 * @param	MinPagingIdleTime	Time in seconds since the last use of a compressed chunk before paging it out. 0 to disable
+	 * @param	MaxChunks			Max number of chunks to compress or page out
+	 */
+	void CompressColdChunks(float MinIdleTime, float MinPagingIdleTime, int MaxChunks);
+
 private:
+	FCriticalSection WriteSection;
+	FValueOctreeContext* const OctreeContext;
 	FValueOctree* const MainOctree;
+
+	// Save of StreamFromSave. Requires the write lock
+	FVoxelWorldSave StreamedSave;
+	// Chunks of StreamedSave not loaded yet. Sorted by increasing Id
+	TArray<FVoxelChunkSaveIndex> StreamedChunks;
+	// Positions modified by the streamed chunks loaded by BeginSet
+	TArray<FIntVector> StreamedModifiedPositions;
+
+	/**
+	 * BeginSet that doesn't load the streamed chunks, for the operations not depending on the chunks values
+	 */
+	TArray<uint64> BeginSetInternal(const FIntBox& Box, bool bLoadStreamedChunks);
+	/**
+	 * Requires the write lock
+	 */
+	void LoadStreamedChunks(const TArray<FIntBox>& Boxes);
+	/**
+	 * @param	KnownBox				Last box returned by FValueOctree::GetBoxWithoutSurface. Kept between the rays of a batch
+	 * @param	bKnownBoxWithoutSurface	Its result
+	 */
+	bool RaycastInternal(const FVoxelRay& Ray, FVoxelRaycastHit& OutHit, FIntBox& KnownBox, bool& bKnownBoxWithoutSurface) const;
+	void ResetDirtyChunks();
 };
\ No newline at end of file
@@ -36,6 +36,35 @@ public:\
 	void GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const; \
 };
 
+// Same as GENERATED_COMPUTENODE, with batch and range implementations
+#define GENERATED_COMPUTENODE_BATCH(CppName)\
+class FVoxelComputeNode_##CppName : public FVoxelComputeNode\
+{\
+public:\
+	FVoxelComputeNode_##CppName(const UVoxelNode_##CppName* Node) : FVoxelComputeNode(Node) {}\
+\
+	void Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outputs[], const FVoxelContext& Context) const override; \
+	void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const override; \
+	void ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const override; \
+	void GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const; \
+	void GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const override; \
+};
+
+// Same as GENERATED_COMPUTENODE_BATCH, for the nodes reading the Coordinate of the context
+#define GENERATED_COMPUTENODE_COORDINATE(CppName, Coordinate)\
+class FVoxelComputeNode_##CppName : public FVoxelComputeNode\
+{\
+public:\
+	FVoxelComputeNode_##CppName(const UVoxelNode_##CppName* Node) : FVoxelComputeNode(Node) {}\
+\
+	void Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outputs[], const FVoxelContext& Context) const override; \
+	void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const override; \
+	void ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const override; \
+	uint8 GetContextDependencies() const override { return EVoxelContextDependency::Coordinate; } \
+	void GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const; \
+	void GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const override; \
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -58,7 +87,21 @@ public:
 	FVoxelComputeNode_If(const UVoxelNode_If* Node) : FVoxelComputeNode(Node) {}
 
 	virtual int32 GetBranchResult(FVoxelNodeType Inputs[]) const override { return Inputs[0].B ? 0 : 1; }
+	virtual void GetBranchResultBatch(FVoxelNodeType* Inputs[], const FVoxelBatchLanes& Lanes, int32 OutBranchIds[]) const override
+	{
+		for (int Index = 0; Index < Lanes.Num; Index++)
+		{
+			const int32 Lane = Lanes.Get(Index);
+			OutBranchIds[Lane] = Inputs[0][Lane].B ? 0 : 1;
+		}
+	}
 	virtual FString GetBranchResultCpp(const TArray<FString>& Inputs) const override { return Inputs[0] + TEXT(" ? 0 : 1"); }
+	virtual void GetBranchResultRange(const FVoxelRange Inputs[], bool OutPossibleBranches[]) const override
+	{
+		OutPossibleBranches[0] = Inputs[0].CanBeTrue();
+		OutPossibleBranches[1] = Inputs[0].CanBeFalse();
+	}
+	virtual FString GetBranchResultRangeCpp(const TArray<FString>& Inputs, int32 BranchIndex) const override { return Inputs[0] + (BranchIndex == 0 ? TEXT(".CanBeTrue()") : TEXT(".CanBeFalse()")); }
 };
 
 //////////////////////////////////////////////////////////////////////////////////////
@@ -293,7 +336,7 @@ public:
 	FLinearColor GetColor()	const override { return FLinearColor::Green; }
 };
 
-GENERATED_COMPUTENODE(XF)
+GENERATED_COMPUTENODE_COORDINATE(XF, X)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -310,7 +353,7 @@ public:
 	FLinearColor GetColor()	const override { return FLinearColor::Green; }
 };
 
-GENERATED_COMPUTENODE(YF)
+GENERATED_COMPUTENODE_COORDINATE(YF, Y)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -327,7 +370,7 @@ public:
 	FLinearColor GetColor()	const override { return FLinearColor::Green; }
 };
 
-GENERATED_COMPUTENODE(ZF)
+GENERATED_COMPUTENODE_COORDINATE(ZF, Z)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -345,7 +388,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("X", "X"); }
 };
 
-GENERATED_COMPUTENODE(XI)
+GENERATED_COMPUTENODE_COORDINATE(XI, X)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -363,7 +406,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("Y", "Y"); }
 };
 
-GENERATED_COMPUTENODE(YI)
+GENERATED_COMPUTENODE_COORDINATE(YI, Y)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -381,7 +424,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("Z", "Z"); }
 };
 
-GENERATED_COMPUTENODE(ZI)
+GENERATED_COMPUTENODE_COORDINATE(ZI, Z)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -395,7 +438,7 @@ public:
 	GENERATED_NODE_BODY(2, MAX_PINS - 1, 1)
 };
 
-GENERATED_COMPUTENODE(Max)
+GENERATED_COMPUTENODE_BATCH(Max)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -409,7 +452,7 @@ public:
 	GENERATED_NODE_BODY(2, MAX_PINS - 1, 1)
 };
 
-GENERATED_COMPUTENODE(Min)
+GENERATED_COMPUTENODE_BATCH(Min)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -427,7 +470,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("<", "<"); }
 };
 
-GENERATED_COMPUTENODE(Less)
+GENERATED_COMPUTENODE_BATCH(Less)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -445,7 +488,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("<=", "<="); }
 };
 
-GENERATED_COMPUTENODE(LessEqual)
+GENERATED_COMPUTENODE_BATCH(LessEqual)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -463,7 +506,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT(">", ">"); }
 };
 
-GENERATED_COMPUTENODE(Greater)
+GENERATED_COMPUTENODE_BATCH(Greater)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -481,7 +524,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT(">=", ">="); }
 };
 
-GENERATED_COMPUTENODE(GreaterEqual)
+GENERATED_COMPUTENODE_BATCH(GreaterEqual)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -519,8 +562,11 @@ public:
 	}
 
 	void Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outputs[], const FVoxelContext& Context) const override;
+	void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const override;
+	void ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const override;
 	void GetExposedVariables(TArray<FVoxelExposedVariable>& Variables) const override;
 	void GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const;
+	void GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const override;
 
 private:
 	const float Value;
@@ -565,8 +611,11 @@ public:
 	}
 
 	void Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outputs[], const FVoxelContext& Context) const override;
+	void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const override;
+	void ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const override;
 	void GetExposedVariables(TArray<FVoxelExposedVariable>& Variables) const override;
 	void GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const;
+	void GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const override;
 
 private:
 	const int32 Value;
@@ -591,7 +640,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("float", "float"); }
 };
 
-GENERATED_COMPUTENODE(FloatOfInt)
+GENERATED_COMPUTENODE_BATCH(FloatOfInt)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -611,7 +660,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("Round", "Round"); }
 };
 
-GENERATED_COMPUTENODE(Round)
+GENERATED_COMPUTENODE_BATCH(Round)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -644,7 +693,7 @@ public:
 	}
 };
 
-GENERATED_COMPUTENODE(Lerp)
+GENERATED_COMPUTENODE_BATCH(Lerp)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -677,7 +726,7 @@ public:
 	}
 };
 
-GENERATED_COMPUTENODE(Clamp)
+GENERATED_COMPUTENODE_BATCH(Clamp)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -694,7 +743,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("+", "+"); }
 };
 
-GENERATED_COMPUTENODE(FAdd)
+GENERATED_COMPUTENODE_BATCH(FAdd)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -711,7 +760,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("-", "-"); }
 };
 
-GENERATED_COMPUTENODE(FSubstract)
+GENERATED_COMPUTENODE_BATCH(FSubstract)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -728,7 +777,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("*", "*"); }
 };
 
-GENERATED_COMPUTENODE(FMultiply)
+GENERATED_COMPUTENODE_BATCH(FMultiply)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -745,7 +794,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("/", "/"); }
 };
 
-GENERATED_COMPUTENODE(FDivide)
+GENERATED_COMPUTENODE_BATCH(FDivide)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -764,7 +813,7 @@ public:
 	FString GetOutputPinCategory(int32 PinIndex) const override { return FVoxelPinCategory::PC_Int; }
 };
 
-GENERATED_COMPUTENODE(IAdd)
+GENERATED_COMPUTENODE_BATCH(IAdd)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -783,7 +832,7 @@ public:
 	FString GetOutputPinCategory(int32 PinIndex) const override { return FVoxelPinCategory::PC_Int; }
 };
 
-GENERATED_COMPUTENODE(ISubstract)
+GENERATED_COMPUTENODE_BATCH(ISubstract)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -802,7 +851,7 @@ public:
 	FString GetOutputPinCategory(int32 PinIndex) const override { return FVoxelPinCategory::PC_Int; }
 };
 
-GENERATED_COMPUTENODE(IMultiply)
+GENERATED_COMPUTENODE_BATCH(IMultiply)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -838,7 +887,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("1 - X", "1 - X"); }
 };
 
-GENERATED_COMPUTENODE(1MinusX)
+GENERATED_COMPUTENODE_BATCH(1MinusX)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -855,7 +904,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("SQRT", "SQRT"); }
 };
 
-GENERATED_COMPUTENODE(Sqrt)
+GENERATED_COMPUTENODE_BATCH(Sqrt)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -908,7 +957,7 @@ public:
 	FText GetTitle() const override { return LOCTEXT("ABS", "ABS"); }
 };
 
-GENERATED_COMPUTENODE(FAbs)
+GENERATED_COMPUTENODE_BATCH(FAbs)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -927,7 +976,7 @@ public:
 	FString GetOutputPinCategory(int32 PinIndex) const override { return FVoxelPinCategory::PC_Int; }
 };
 
-GENERATED_COMPUTENODE(IAbs)
+GENERATED_COMPUTENODE_BATCH(IAbs)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -1063,7 +1112,7 @@ public:
 	FString GetOutputPinCategory(int32 PinIndex) const override { return FVoxelPinCategory::PC_Boolean; }
 };
 
-GENERATED_COMPUTENODE(BAnd)
+GENERATED_COMPUTENODE_BATCH(BAnd)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -1082,7 +1131,7 @@ public:
 	FString GetOutputPinCategory(int32 PinIndex) const override { return FVoxelPinCategory::PC_Boolean; }
 };
 
-GENERATED_COMPUTENODE(BOr)
+GENERATED_COMPUTENODE_BATCH(BOr)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -1101,7 +1150,7 @@ public:
 	FString GetOutputPinCategory(int32 PinIndex) const override { return FVoxelPinCategory::PC_Boolean; }
 };
 
-GENERATED_COMPUTENODE(BNot)
+GENERATED_COMPUTENODE_BATCH(BNot)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
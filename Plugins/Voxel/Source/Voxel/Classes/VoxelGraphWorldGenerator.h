@@ -58,19 +58,66 @@ struct FVoxelComputeNodeTree
 	// Runtime
 	void Init(const AVoxelWorld* VoxelWorld) const;
 	void Compute(FVoxelNodeType Variables[], const FVoxelContext& Context, float& Value, FVoxelMaterial& Material, FVoxelType& VoxelType) const;
+	/**
+	 * Compute a batch of voxels. Each node is called once for all the active lanes
+	 * @param	Registers	VOXEL_BATCH_SIZE lanes per variable: the lanes of variable Id start at Registers + Id * VOXEL_BATCH_SIZE
+	 * @param	Values		Per lane values
+	 * @param	Materials	Per lane materials
+	 * @param	VoxelTypes	Per lane voxel types
+	 * @param	bSkipColumnNodes	Don't compute the nodes computed by ComputeColumnsBatch
+	 */
+	void ComputeBatch(FVoxelNodeType Registers[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes, float Values[], FVoxelMaterial Materials[], FVoxelType VoxelTypes[], bool bSkipColumnNodes = false) const;
+	/**
+	 * Compute the first nodes of the root that don't depend on Z, until a set or a branch node
+	 * Their registers are valid for all the voxels of the lanes columns: then call ComputeBatch with bSkipColumnNodes for each Z
+	 */
+	void ComputeColumnsBatch(FVoxelNodeType Registers[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const;
+	/**
+	 * Compute conservative bounds of the value for all the voxels in Bounds
+	 * @param	Variables	Ranges of the variables
+	 * @param	Value		In: range of the value before this tree. Out: range of the value after this tree
+	 */
+	void ComputeRange(FVoxelRange Variables[], const FIntBox& Bounds, FVoxelRange& Value) const;
 
 	// Compilation
 	void GetAdditionalHeaders(TArray<FString>& OutAdditionalHeaders) const;
 	void GetExposedVariables(TArray<FVoxelExposedVariable>& Variables) const;
 	void GetVariables(TArray<FVoxelVariable>& Variables) const;
 	void GetSetVoxelWorld(const FString& VoxelWorld, FString& OutCpp) const;
-	void GetMain(const TArray<FString>& Variables, const FString& Context, const FString& Value, const FString& Material, const FString& VoxelType, FString& OutCpp);
+	/**
+	 * @param	StartNodeIndex	Nodes of the root already written by GetMainBatch
+	 */
+	void GetMain(const TArray<FString>& Variables, const FString& Context, const FString& Value, const FString& Material, const FString& VoxelType, FString& OutCpp, int32 StartNodeIndex = 0);
+	/**
+	 * Write the first nodes of the root whose outputs only depend on Dependencies, until a set or a branch node. Called from the outermost loop to the innermost one
+	 * @param	Dependencies			EVoxelContextDependency flags: coordinates fixed by the enclosing loops
+	 * @param	Context				Name of the context. Name of the array of contexts if Lane isn't empty
+	 * @param	Lane				If empty, the outputs are scalars. Else they are arrays of VOXEL_BATCH_SIZE elements, and Lane is the name of the lane index
+	 * @param	Count				Name of the number of lanes
+	 * @param	InOutLaneVariables	Variables to use in GetMain inside a loop on Lane. Must be initialized to Variables
+	 * @param	InOutWrittenNodes	Nodes of the root already written. Must be initialized to empty
+	 * @return	Number of nodes at the start of the root that are written by GetMainBatch
+	 */
+	int32 GetMainBatch(const TArray<FString>& Variables, uint8 Dependencies, const FString& Context, const FString& Lane, const FString& Count, TArray<FString>& InOutLaneVariables, TArray<bool>& InOutWrittenNodes, FString& OutCpp);
+	void GetRangeMain(const TArray<FString>& Variables, const FString& Bounds, const FString& Value, FString& OutCpp, int32& UniqueId);
 
 private:
 	TSharedPtr<FVoxelComputeNode>* Nodes;
 	int32 NodesCount;
 	FVoxelComputeNodeTree* Childs[MAX_PINS];
 	int32 ChildsCount;
+
+	// Registers filled with the default values of the unconnected inputs, used in batch mode
+	TArray<FVoxelNodeType> DefaultRegisters;
+	// For each node and input, offset of the default register in DefaultRegisters. -1 if the input is connected
+	TArray<int32> DefaultRegistersOffsets;
+
+	// For each node, EVoxelContextDependency flags of its outputs. Inputs from the parents are assumed to depend on everything
+	TArray<uint8> NodesDependencies;
+
+	void GetBatchInputs(int32 NodeIndex, FVoxelNodeType Registers[], FVoxelNodeType* OutInputs[]) const;
+	// Number of nodes at the start of the root before the first set or branch node
+	int32 GetBatchNodesCount() const;
 };
 
 //////////////////////////////////////////////////////////////////////////////////////
@@ -5,10 +5,14 @@
 #include "CoreMinimal.h"
 #include "VoxelAsset.h"
 #include "VoxelMaterial.h"
+#include "VoxelRange.h"
+#include "IntBox.h"
 #include "EdGraph/EdGraphNode.h"
 #include "VoxelNode.generated.h"
 
 #define MAX_PINS 64
+// Number of voxels processed at once by the compute nodes in batch mode
+#define VOXEL_BATCH_SIZE 128
 
 class UVoxelNode;
 class FVoxelComputeNode;
@@ -20,6 +24,49 @@ struct FVoxelContext
 	int32 Z;
 };
 
+/**
+ * Coordinates of the FVoxelContext a value depends on. Used as flags
+ */
+namespace EVoxelContextDependency
+{
+	enum Type : uint8
+	{
+		None = 0,
+		X = 1 << 0,
+		Y = 1 << 1,
+		Z = 1 << 2,
+		All = X | Y | Z
+	};
+}
+
+/**
+ * Positions of the voxels of a batch, in structure of arrays layout
+ */
+struct FVoxelBatchContext
+{
+	int32 X[VOXEL_BATCH_SIZE];
+	int32 Y[VOXEL_BATCH_SIZE];
+	int32 Z[VOXEL_BATCH_SIZE];
+};
+
+/**
+ * Active lanes of a batch. Lanes are discarded by branch nodes
+ */
+struct FVoxelBatchLanes
+{
+	// Sorted indices of the active lanes. Unused if bDense
+	const int32* Indices;
+	// Number of active lanes
+	int32 Num;
+	// If true, the active lanes are 0 .. Num - 1
+	bool bDense;
+
+	explicit FVoxelBatchLanes(int32 Num) : Indices(nullptr), Num(Num), bDense(true) {}
+	FVoxelBatchLanes(const int32* Indices, int32 Num) : Indices(Indices), Num(Num), bDense(false) {}
+
+	FORCEINLINE int32 Get(int32 Index) const { return bDense ? Index : Indices[Index]; }
+};
+
 // Can be used with union
 struct FVoxelMaterial_internal
 {
@@ -70,6 +117,9 @@ union FVoxelNodeType
 	FVoxelType_internal VT;
 };
 
+// Batch registers are reinterpreted as float arrays for SIMD
+static_assert(sizeof(FVoxelNodeType) == sizeof(float), "FVoxelNodeType must be the size of a float");
+
 UENUM()
 enum class EVoxelPinCategory : uint8
 {
@@ -278,12 +328,42 @@ public:
 	virtual void Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outputs[], const FVoxelContext& Context) const { check(false); }
 	virtual int32 GetBranchResult(FVoxelNodeType Inputs[]) const { check(false); return -1; }
 
+	/**
+	 * Batch version of Compute: Inputs[i] and Outputs[i] are registers of VOXEL_BATCH_SIZE lanes. Only the active lanes must be read/written
+	 * Default implementation calls Compute on each active lane
+	 */
+	virtual void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const;
+	/**
+	 * Batch version of GetBranchResult: set OutBranchIds[Lane] for each active lane
+	 * Default implementation calls GetBranchResult on each active lane
+	 */
+	virtual void GetBranchResultBatch(FVoxelNodeType* Inputs[], const FVoxelBatchLanes& Lanes, int32 OutBranchIds[]) const;
+
+	/**
+	 * Compute conservative bounds of the outputs for all the voxels in Bounds, given conservative bounds of the inputs
+	 * Default implementation returns infinite bounds
+	 */
+	virtual void ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const;
+	/**
+	 * Range version of GetBranchResult: set OutPossibleBranches[i] to true if branch i can be taken
+	 * Default implementation allows every branch
+	 */
+	virtual void GetBranchResultRange(const FVoxelRange Inputs[], bool OutPossibleBranches[]) const;
+
+	/**
+	 * Coordinates of the context read by Compute, as EVoxelContextDependency flags. The outputs depend on them and on the inputs dependencies
+	 * Used to compute the nodes that don't depend on Z once per column
+	 */
+	virtual uint8 GetContextDependencies() const { return EVoxelContextDependency::None; }
+
 	virtual bool IsSetValueNode() const { return false; }
 	virtual bool IsSetMaterialNode() const { return false; }
 	virtual bool IsSetVoxelTypeNode() const { return false; }
 
 	FORCEINLINE FVoxelNodeType GetDefaultValue(int32 Index) { return DefaultValues[Index]; }
 	FORCEINLINE FString GetDefaultValueString(int32 Index) { return DefaultValueStrings[Index]; }
+	FORCEINLINE FVoxelRange GetDefaultRange(int32 Index) { return DefaultRanges[Index]; }
+	FORCEINLINE FString GetDefaultRangeString(int32 Index) { return DefaultRangeStrings[Index]; }
 	FORCEINLINE int32 GetInputId(int32 Index) { return InputIds[Index]; }
 	FORCEINLINE int32 GetOutputId(int32 Index) { return OutputIds[Index]; }
 	FORCEINLINE FString GetOutputType(int32 Index) { return OutputType[Index]; }
@@ -294,11 +374,21 @@ public:
 	virtual void GetExposedVariables(TArray<FVoxelExposedVariable>& Variables) const {}
 	virtual void GetSetVoxelWorld(const FString& VoxelWorld, FString& OutCpp) const {}
 	virtual void GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const { check(false); }
+	/**
+	 * Batch version of GetMain: Inputs and Outputs are arrays of VOXEL_BATCH_SIZE elements, Count is the name of the number of elements used
+	 * Only called if all the inputs are connected. Return false without writing anything to be called with GetMain on each element instead
+	 */
+	virtual bool GetMainBatch(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Count, FString& OutCpp) const { return false; }
 	virtual FString GetBranchResultCpp(const TArray<FString>& Inputs) const { check(false); return FString(); }
+	// Range versions of GetMain/GetBranchResultCpp. Inputs, Outputs and the return value are FVoxelRange
+	virtual void GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const;
+	virtual FString GetBranchResultRangeCpp(const TArray<FString>& Inputs, int32 BranchIndex) const { return TEXT("true"); }
 
 private:
 	FVoxelNodeType DefaultValues[MAX_PINS];
 	FString DefaultValueStrings[MAX_PINS];
+	FVoxelRange DefaultRanges[MAX_PINS];
+	FString DefaultRangeStrings[MAX_PINS];
 	FString OutputType[MAX_PINS];
 	int32 InputIds[MAX_PINS];
 	int32 OutputIds[MAX_PINS];
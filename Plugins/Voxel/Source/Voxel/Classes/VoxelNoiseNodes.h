@@ -80,6 +80,12 @@ public:
 	void GetVariables(TArray<FVoxelVariable>& Variables) const override;
 	void GetSetVoxelWorld(const FString& VoxelWorld, FString& OutCpp) const override;
 
+	/**
+	 * Get a bound of the absolute value of the noise
+	 * @param	SingleBound		Bound of a single octave of the noise function
+	 */
+	virtual float GetNoiseBound(float SingleBound) const { return SingleBound; }
+
 protected:
 	const float Scale;
 	FString const NoiseName;
@@ -120,6 +126,8 @@ public:
 	void Init(const AVoxelWorld* VoxelWorld) override;
 	void GetSetVoxelWorld(const FString& VoxelWorld, FString& OutCpp) const override;
 
+	float GetNoiseBound(float SingleBound) const override;
+
 private:
 	int FractalOctaves;
 	float FractalLacunarity;
@@ -181,7 +189,7 @@ private:
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
 
-#define GENERATE_2D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Fractal)\
+#define GENERATE_2D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Bound, Fractal)\
 class FVoxelComputeNode_##CppName : public FVoxelComputeNode_NoiseNode##Fractal\
 {\
 public:\
@@ -191,6 +199,28 @@ public:\
 	{\
 		Outputs[0].F = Noise.FunctionName(Inputs[0].F / Scale, Inputs[1].F / Scale);\
 	}\
+	void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const override\
+	{\
+		float X[VOXEL_BATCH_SIZE];\
+		float Y[VOXEL_BATCH_SIZE];\
+		float Result[VOXEL_BATCH_SIZE];\
+		for (int Index = 0; Index < Lanes.Num; Index++)\
+		{\
+			const int32 Lane = Lanes.Get(Index);\
+			X[Index] = Inputs[0][Lane].F / Scale;\
+			Y[Index] = Inputs[1][Lane].F / Scale;\
+		}\
+		Noise.FunctionName(X, Y, Result, Lanes.Num);\
+		for (int Index = 0; Index < Lanes.Num; Index++)\
+		{\
+			Outputs[0][Lanes.Get(Index)].F = Result[Index];\
+		}\
+	}\
+	void ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const override\
+	{\
+		const float NoiseBound = GetNoiseBound(Bound);\
+		Outputs[0] = FVoxelRange(-NoiseBound, NoiseBound);\
+	}\
 \
 	void GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const override\
 	{\
@@ -201,14 +231,36 @@ public:\
 		OutCpp.Append(Inputs[0] + TEXT(" / ") + ScaleName + TEXT(", ")\
 				    + Inputs[1] + TEXT(" / ") + ScaleName + TEXT(");"));\
 	}\
+	bool GetMainBatch(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Count, FString& OutCpp) const override\
+	{\
+		FString ScaleName = FString::SanitizeFloat(Scale);\
+		FString BatchSize = FString::FromInt(VOXEL_BATCH_SIZE);\
+\
+		OutCpp.Append(TEXT("{\n"));\
+		OutCpp.Append(TEXT("float ___X___[") + BatchSize + TEXT("];\n"));\
+		OutCpp.Append(TEXT("float ___Y___[") + BatchSize + TEXT("];\n"));\
+		OutCpp.Append(TEXT("for (int ___Index___ = 0; ___Index___ < ") + Count + TEXT("; ___Index___++)\n"));\
+		OutCpp.Append(TEXT("{\n"));\
+		OutCpp.Append(TEXT("___X___[___Index___] = ") + Inputs[0] + TEXT("[___Index___] / ") + ScaleName + TEXT(";\n"));\
+		OutCpp.Append(TEXT("___Y___[___Index___] = ") + Inputs[1] + TEXT("[___Index___] / ") + ScaleName + TEXT(";\n"));\
+		OutCpp.Append(TEXT("}\n"));\
+		OutCpp.Append(NoiseName + TEXT(".") + #FunctionName + TEXT("(___X___, ___Y___, ") + Outputs[0] + TEXT(", ") + Count + TEXT(");\n"));\
+		OutCpp.Append(TEXT("}"));\
+		return true;\
+	}\
+	void GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const override\
+	{\
+		const FString NoiseBound = FString::SanitizeFloat(GetNoiseBound(Bound));\
+		OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(-") + NoiseBound + TEXT(", ") + NoiseBound + TEXT(");"));\
+	}\
 };
 
-#define GENERATE_2D_NOISE_COMPUTENODE(FunctionName, CppName) GENERATE_2D_NOISE_COMPUTENODE_AUX(FunctionName, CppName,)
-#define GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(FunctionName, CppName) GENERATE_2D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Fractal)
+#define GENERATE_2D_NOISE_COMPUTENODE(FunctionName, CppName, Bound) GENERATE_2D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Bound,)
+#define GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(FunctionName, CppName, Bound) GENERATE_2D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Bound, Fractal)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
-#define GENERATE_3D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Fractal)\
+#define GENERATE_3D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Bound, Fractal)\
 class FVoxelComputeNode_##CppName : public FVoxelComputeNode_NoiseNode##Fractal\
 {\
 public:\
@@ -218,6 +270,30 @@ public:\
 	{\
 		Outputs[0].F = Noise.FunctionName(Inputs[0].F / Scale, Inputs[1].F / Scale, Inputs[2].F / Scale);\
 	}\
+	void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const override\
+	{\
+		float X[VOXEL_BATCH_SIZE];\
+		float Y[VOXEL_BATCH_SIZE];\
+		float Z[VOXEL_BATCH_SIZE];\
+		float Result[VOXEL_BATCH_SIZE];\
+		for (int Index = 0; Index < Lanes.Num; Index++)\
+		{\
+			const int32 Lane = Lanes.Get(Index);\
+			X[Index] = Inputs[0][Lane].F / Scale;\
+			Y[Index] = Inputs[1][Lane].F / Scale;\
+			Z[Index] = Inputs[2][Lane].F / Scale;\
+		}\
+		Noise.FunctionName(X, Y, Z, Result, Lanes.Num);\
+		for (int Index = 0; Index < Lanes.Num; Index++)\
+		{\
+			Outputs[0][Lanes.Get(Index)].F = Result[Index];\
+		}\
+	}\
+	void ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const override\
+	{\
+		const float NoiseBound = GetNoiseBound(Bound);\
+		Outputs[0] = FVoxelRange(-NoiseBound, NoiseBound);\
+	}\
 	void GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const override\
 	{\
 		FString ScaleName = FString::SanitizeFloat(Scale);\
@@ -228,10 +304,34 @@ public:\
 				    + Inputs[1] + TEXT(" / ") + ScaleName + TEXT(", ")\
 					+ Inputs[2] + TEXT(" / ") + ScaleName + TEXT(");"));\
 	}\
+	bool GetMainBatch(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Count, FString& OutCpp) const override\
+	{\
+		FString ScaleName = FString::SanitizeFloat(Scale);\
+		FString BatchSize = FString::FromInt(VOXEL_BATCH_SIZE);\
+\
+		OutCpp.Append(TEXT("{\n"));\
+		OutCpp.Append(TEXT("float ___X___[") + BatchSize + TEXT("];\n"));\
+		OutCpp.Append(TEXT("float ___Y___[") + BatchSize + TEXT("];\n"));\
+		OutCpp.Append(TEXT("float ___Z___[") + BatchSize + TEXT("];\n"));\
+		OutCpp.Append(TEXT("for (int ___Index___ = 0; ___Index___ < ") + Count + TEXT("; ___Index___++)\n"));\
+		OutCpp.Append(TEXT("{\n"));\
+		OutCpp.Append(TEXT("___X___[___Index___] = ") + Inputs[0] + TEXT("[___Index___] / ") + ScaleName + TEXT(";\n"));\
+		OutCpp.Append(TEXT("___Y___[___Index___] = ") + Inputs[1] + TEXT("[___Index___] / ") + ScaleName + TEXT(";\n"));\
+		OutCpp.Append(TEXT("___Z___[___Index___] = ") + Inputs[2] + TEXT("[___Index___] / ") + ScaleName + TEXT(";\n"));\
+		OutCpp.Append(TEXT("}\n"));\
+		OutCpp.Append(NoiseName + TEXT(".") + #FunctionName + TEXT("(___X___, ___Y___, ___Z___, ") + Outputs[0] + TEXT(", ") + Count + TEXT(");\n"));\
+		OutCpp.Append(TEXT("}"));\
+		return true;\
+	}\
+	void GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const override\
+	{\
+		const FString NoiseBound = FString::SanitizeFloat(GetNoiseBound(Bound));\
+		OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(-") + NoiseBound + TEXT(", ") + NoiseBound + TEXT(");"));\
+	}\
 };
 
-#define GENERATE_3D_NOISE_COMPUTENODE(FunctionName, CppName) GENERATE_3D_NOISE_COMPUTENODE_AUX(FunctionName, CppName,)
-#define GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(FunctionName, CppName) GENERATE_3D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Fractal)
+#define GENERATE_3D_NOISE_COMPUTENODE(FunctionName, CppName, Bound) GENERATE_3D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Bound,)
+#define GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(FunctionName, CppName, Bound) GENERATE_3D_NOISE_COMPUTENODE_AUX(FunctionName, CppName, Bound, Fractal)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -245,7 +345,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE(GetValue, 2DValueNoise)
+GENERATE_2D_NOISE_COMPUTENODE(GetValue, 2DValueNoise, 1)
 
 UCLASS(meta = (DisplayName = "2D Value Noise Fractal"))
 class VOXEL_API UVoxelNode_2DValueNoiseFractal : public UVoxelNode_NoiseNodeFractal
@@ -255,7 +355,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(GetValueFractal, 2DValueNoiseFractal)
+GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(GetValueFractal, 2DValueNoiseFractal, 1)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -267,7 +367,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE(GetPerlin, 2DPerlinNoise)
+GENERATE_2D_NOISE_COMPUTENODE(GetPerlin, 2DPerlinNoise, 2)
 
 UCLASS(meta = (DisplayName = "2D Perlin Noise Fractal"))
 class VOXEL_API UVoxelNode_2DPerlinNoiseFractal : public UVoxelNode_NoiseNodeFractal
@@ -277,7 +377,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(GetPerlinFractal, 2DPerlinNoiseFractal)
+GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(GetPerlinFractal, 2DPerlinNoiseFractal, 2)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -289,7 +389,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE(GetSimplex, 2DSimplexNoise)
+GENERATE_2D_NOISE_COMPUTENODE(GetSimplex, 2DSimplexNoise, 2)
 
 UCLASS(meta = (DisplayName = "2D Simplex Noise Fractal"))
 class VOXEL_API UVoxelNode_2DSimplexNoiseFractal : public UVoxelNode_NoiseNodeFractal
@@ -299,7 +399,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(GetSimplexFractal, 2DSimplexNoiseFractal)
+GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(GetSimplexFractal, 2DSimplexNoiseFractal, 2)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -311,7 +411,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE(GetCubic, 2DCubicNoise)
+GENERATE_2D_NOISE_COMPUTENODE(GetCubic, 2DCubicNoise, 2)
 
 UCLASS(meta = (DisplayName = "2D Cubic Noise Fractal"))
 class VOXEL_API UVoxelNode_2DCubicNoiseFractal : public UVoxelNode_NoiseNodeFractal
@@ -321,7 +421,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(GetCubicFractal, 2DCubicNoiseFractal)
+GENERATE_2D_NOISE_COMPUTENODE_FRACTAL(GetCubicFractal, 2DCubicNoiseFractal, 2)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -333,7 +433,7 @@ public:
 	GENERATED_NODE_BODY(2, 2, 1)
 };
 
-GENERATE_2D_NOISE_COMPUTENODE(GetWhiteNoise, 2DWhiteNoise)
+GENERATE_2D_NOISE_COMPUTENODE(GetWhiteNoise, 2DWhiteNoise, 1)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -347,7 +447,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE(GetValue, 3DValueNoise)
+GENERATE_3D_NOISE_COMPUTENODE(GetValue, 3DValueNoise, 1)
 
 UCLASS(meta = (DisplayName = "3D Value Noise Fractal"))
 class VOXEL_API UVoxelNode_3DValueNoiseFractal : public UVoxelNode_NoiseNodeFractal
@@ -357,7 +457,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(GetValueFractal, 3DValueNoiseFractal)
+GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(GetValueFractal, 3DValueNoiseFractal, 1)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -369,7 +469,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE(GetPerlin, 3DPerlinNoise)
+GENERATE_3D_NOISE_COMPUTENODE(GetPerlin, 3DPerlinNoise, 2)
 
 UCLASS(meta = (DisplayName = "3D Perlin Noise Fractal"))
 class VOXEL_API UVoxelNode_3DPerlinNoiseFractal : public UVoxelNode_NoiseNodeFractal
@@ -379,7 +479,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(GetPerlinFractal, 3DPerlinNoiseFractal)
+GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(GetPerlinFractal, 3DPerlinNoiseFractal, 2)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -391,7 +491,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE(GetSimplex, 3DSimplexNoise)
+GENERATE_3D_NOISE_COMPUTENODE(GetSimplex, 3DSimplexNoise, 2)
 
 UCLASS(meta = (DisplayName = "3D Simplex Noise Fractal"))
 class VOXEL_API UVoxelNode_3DSimplexNoiseFractal : public UVoxelNode_NoiseNodeFractal
@@ -401,7 +501,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(GetSimplexFractal, 3DSimplexNoiseFractal)
+GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(GetSimplexFractal, 3DSimplexNoiseFractal, 2)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -413,7 +513,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE(GetCubic, 3DCubicNoise)
+GENERATE_3D_NOISE_COMPUTENODE(GetCubic, 3DCubicNoise, 2)
 
 UCLASS(meta = (DisplayName = "3D Cubic Noise Fractal"))
 class VOXEL_API UVoxelNode_3DCubicNoiseFractal : public UVoxelNode_NoiseNodeFractal
@@ -423,7 +523,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(GetCubicFractal, 3DCubicNoiseFractal)
+GENERATE_3D_NOISE_COMPUTENODE_FRACTAL(GetCubicFractal, 3DCubicNoiseFractal, 2)
 
 //////////////////////////////////////////////////////////////////////////////////////
 
@@ -435,7 +535,7 @@ public:
 	GENERATED_NODE_BODY(3, 3, 1)
 };
 
-GENERATE_3D_NOISE_COMPUTENODE(GetWhiteNoise, 3DWhiteNoise)
+GENERATE_3D_NOISE_COMPUTENODE(GetWhiteNoise, 3DWhiteNoise, 1)
 
 //////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
@@ -481,6 +581,14 @@ public:
 	{
 		Outputs[0].F = Noise.GetCellular(Inputs[0].F / Scale, Inputs[1].F / Scale);
 	}
+	void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const override
+	{
+		for (int Index = 0; Index < Lanes.Num; Index++)
+		{
+			const int32 Lane = Lanes.Get(Index);
+			Outputs[0][Lane].F = Noise.GetCellular(Inputs[0][Lane].F / Scale, Inputs[1][Lane].F / Scale);
+		}
+	}
 	void GetSetVoxelWorld(const FString& VoxelWorld, FString& OutCpp) const override
 	{
 		FVoxelComputeNode_NoiseNode::GetSetVoxelWorld(VoxelWorld, OutCpp);
@@ -547,6 +655,14 @@ public:
 	{
 		Outputs[0].F = Noise.GetCellular(Inputs[0].F / Scale, Inputs[1].F / Scale, Inputs[2].F);
 	}
+	void ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const override
+	{
+		for (int Index = 0; Index < Lanes.Num; Index++)
+		{
+			const int32 Lane = Lanes.Get(Index);
+			Outputs[0][Lane].F = Noise.GetCellular(Inputs[0][Lane].F / Scale, Inputs[1][Lane].F / Scale, Inputs[2][Lane].F);
+		}
+	}
 	void GetSetVoxelWorld(const FString& VoxelWorld, FString& OutCpp) const override
 	{
 		FVoxelComputeNode_NoiseNode::GetSetVoxelWorld(VoxelWorld, OutCpp);
@@ -91,10 +91,14 @@ struct FVoxelProcMeshSection
 	/** Should we display this section */
 	bool bSectionVisible;
 
+	/** Should the vertices be translated for the component transitions. See UVoxelProceduralMeshComponent::SetTransitions */
+	bool bEnableTransitions;
+
 	FVoxelProcMeshSection()
 		: SectionLocalBox(ForceInit)
 		, bEnableCollision(false)
 		, bSectionVisible(true)
+		, bEnableTransitions(false)
 	{
 	}
 
@@ -106,6 +110,7 @@ struct FVoxelProcMeshSection
 		SectionLocalBox.Init();
 		bEnableCollision = false;
 		bSectionVisible = true;
+		bEnableTransitions = false;
 	}
 };
 
@@ -128,6 +133,9 @@ public:
 	/** Whether this section is currently visible */
 	bool bSectionVisible;
 
+	/** Whether the transitions are applied to this section */
+	bool bEnableTransitions;
+
 	/** Buffer for tessellation */
 	FVoxelProcMeshIndexBuffer AdjacencyIndexBuffer;
 
@@ -137,6 +145,7 @@ public:
 	FVoxelProcMeshProxySection()
 		: Material(NULL)
 		, bSectionVisible(true)
+		, bEnableTransitions(false)
 		, bRequiresAdjacencyInformation(false)
 	{
 	}
@@ -144,6 +153,7 @@ public:
 	FVoxelProcMeshProxySection(ERHIFeatureLevel::Type InFeatureLevel)
 		: Material(NULL)
 		, bSectionVisible(true)
+		, bEnableTransitions(false)
 		, bRequiresAdjacencyInformation(false)
 		, VertexFactory(InFeatureLevel)
 	{
@@ -152,6 +162,19 @@ public:
 };
 
 
+/** Data sent to the render thread to update a single section of an existing proxy */
+struct FVoxelProcMeshSectionUpdateData
+{
+	int32 TargetSection;
+	TArray<FVoxelDynamicMeshVertex> NewVertexBuffer;
+	float NewPositionScale;
+	TArray<int32> NewIndexBuffer;
+	/** Used if the section was empty */
+	UMaterialInterface* Material;
+	bool bSectionVisible;
+	bool bEnableTransitions;
+};
+
 /** Procedural mesh scene proxy */
 class FVoxelProceduralMeshSceneProxy : public FPrimitiveSceneProxy
 {
@@ -171,6 +194,12 @@ public:
 
 	uint32 GetAllocatedSize(void) const;
 
+	/** Replace the buffers of a section, without recreating the other sections. Deletes SectionData */
+	void UpdateSection_RenderThread(FVoxelProcMeshSectionUpdateData* SectionData);
+
+	/** Set the transitions of the sections with bEnableTransitions */
+	void SetTransitions_RenderThread(uint8 NewTransitionsMask, uint8 NewTransitionsLOD);
+
 #if ENGINE_MINOR_VERSION >= 19	
 	SIZE_T GetTypeHash() const override
 	{
@@ -186,6 +215,13 @@ private:
 	UBodySetup* BodySetup;
 
 	FMaterialRelevance MaterialRelevance;
+
+	uint8 TransitionsMask;
+	uint8 TransitionsLOD;
+
+	/** Build the adjacency buffer if the section material needs it, and init its resources */
+	void InitSectionResources(FVoxelProcMeshProxySection& Section, bool bRenderThread);
+	void ReleaseSectionResources(FVoxelProcMeshProxySection& Section);
 };
 
 
@@ -236,6 +272,17 @@ public:
 	/** Replace a section with new section geometry */
 	void SetProcMeshSection(int32 SectionIndex, const FVoxelProcMeshSection& Section);
 
+	/**
+	 * Set the Transvoxel transitions of the sections with bEnableTransitions. The vertices are translated in the vertex shader:
+	 * changing the transitions doesn't rebuild the sections. The collisions use the untranslated vertices
+	 * @param	NewTransitionsMask	EVoxelDirection flags of the sides with a higher LOD neighbor
+	 * @param	NewTransitionsLOD	The LOD of the sections
+	 */
+	void SetTransitions(uint8 NewTransitionsMask, uint8 NewTransitionsLOD);
+
+	/** Is an async physics cook in progress? The previous collisions are used until it's done */
+	bool IsCollisionCookPending() const;
+
 	//~ Begin UPrimitiveComponent Interface.
 	FPrimitiveSceneProxy* CreateSceneProxy() override;
 	class UBodySetup* GetBodySetup() override;
@@ -256,6 +303,8 @@ private:
 	//~ End USceneComponent Interface.
 
 
+	/** Send the new section to the scene proxy, or recreate the proxy if needed */
+	void UpdateSectionRenderState(int32 SectionIndex, bool bSectionCountChanged);
 	/** Mark collision data as dirty, and re-create on instance if necessary */
 	void UpdateCollision();
 	/** Update LocalBounds member from the local box of each section */
@@ -277,6 +326,9 @@ private:
 	/** Local space bounds of mesh */
 	FBoxSphereBounds LocalBounds;
 
+	uint8 TransitionsMask;
+	uint8 TransitionsLOD;
+
 	/** Queue for async body setups that are being cooked */
 	UPROPERTY()
 	TArray<UBodySetup*> AsyncBodySetupQueue;
@@ -0,0 +1,152 @@
+// Copyright 2018 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Conservative bounds of a value over a region: every value in the region is in [Min, Max]
+ * Ints are stored as floats, bools as 0 (false) or 1 (true)
+ * Used by graph world generators to compute IsEmpty without sampling every voxel
+ */
+struct FVoxelRange
+{
+	float Min;
+	float Max;
+
+	FVoxelRange() = default;
+	FVoxelRange(float Value) : Min(Value), Max(Value) {}
+	FVoxelRange(float Min, float Max) : Min(Min), Max(Max) {}
+
+	FORCEINLINE static FVoxelRange Infinite() { return FVoxelRange(-MAX_flt, MAX_flt); }
+	FORCEINLINE static FVoxelRange TrueOrFalse() { return FVoxelRange(0, 1); }
+
+	FORCEINLINE bool CanBeTrue() const { return Max > 0; }
+	FORCEINLINE bool CanBeFalse() const { return Min <= 0; }
+
+	FORCEINLINE static FVoxelRange Union(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return FVoxelRange(FMath::Min(A.Min, B.Min), FMath::Max(A.Max, B.Max));
+	}
+
+	FORCEINLINE static FVoxelRange Add(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return Sanitize(FVoxelRange(A.Min + B.Min, A.Max + B.Max));
+	}
+	FORCEINLINE static FVoxelRange Sub(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return Sanitize(FVoxelRange(A.Min - B.Max, A.Max - B.Min));
+	}
+	FORCEINLINE static FVoxelRange Mul(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		const float X = A.Min * B.Min;
+		const float Y = A.Min * B.Max;
+		const float Z = A.Max * B.Min;
+		const float W = A.Max * B.Max;
+		return Sanitize(FVoxelRange(FMath::Min(FMath::Min(X, Y), FMath::Min(Z, W)), FMath::Max(FMath::Max(X, Y), FMath::Max(Z, W))));
+	}
+	FORCEINLINE static FVoxelRange Div(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		if (B.Min <= 0 && 0 <= B.Max)
+		{
+			return Infinite();
+		}
+		return Mul(A, FVoxelRange(1 / B.Max, 1 / B.Min));
+	}
+
+	FORCEINLINE static FVoxelRange Minimum(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return FVoxelRange(FMath::Min(A.Min, B.Min), FMath::Min(A.Max, B.Max));
+	}
+	FORCEINLINE static FVoxelRange Maximum(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return FVoxelRange(FMath::Max(A.Min, B.Min), FMath::Max(A.Max, B.Max));
+	}
+	FORCEINLINE static FVoxelRange Clamp(const FVoxelRange& X, const FVoxelRange& InMin, const FVoxelRange& InMax)
+	{
+		if (InMin.Max <= InMax.Min)
+		{
+			// Clamp is increasing in all its arguments when Min <= Max
+			return FVoxelRange(FMath::Clamp(X.Min, InMin.Min, InMax.Min), FMath::Clamp(X.Max, InMin.Max, InMax.Max));
+		}
+		else
+		{
+			// The result is always one of the arguments
+			return Union(Union(X, InMin), InMax);
+		}
+	}
+	FORCEINLINE static FVoxelRange Lerp(const FVoxelRange& A, const FVoxelRange& B, const FVoxelRange& Alpha)
+	{
+		return Add(A, Mul(Alpha, Sub(B, A)));
+	}
+
+	FORCEINLINE static FVoxelRange OneMinus(const FVoxelRange& X)
+	{
+		return FVoxelRange(1 - X.Max, 1 - X.Min);
+	}
+	FORCEINLINE static FVoxelRange Abs(const FVoxelRange& X)
+	{
+		if (X.Min >= 0)
+		{
+			return X;
+		}
+		else if (X.Max <= 0)
+		{
+			return FVoxelRange(-X.Max, -X.Min);
+		}
+		else
+		{
+			return FVoxelRange(0, FMath::Max(-X.Min, X.Max));
+		}
+	}
+	FORCEINLINE static FVoxelRange Sqrt(const FVoxelRange& X)
+	{
+		if (X.Min < 0)
+		{
+			// NaN
+			return Infinite();
+		}
+		return FVoxelRange(FMath::Sqrt(X.Min), FMath::Sqrt(X.Max));
+	}
+	FORCEINLINE static FVoxelRange Round(const FVoxelRange& X)
+	{
+		return FVoxelRange(FMath::RoundToFloat(X.Min), FMath::RoundToFloat(X.Max));
+	}
+
+	FORCEINLINE static FVoxelRange Less(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return A.Max < B.Min ? FVoxelRange(1) : A.Min >= B.Max ? FVoxelRange(0) : TrueOrFalse();
+	}
+	FORCEINLINE static FVoxelRange LessEqual(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return A.Max <= B.Min ? FVoxelRange(1) : A.Min > B.Max ? FVoxelRange(0) : TrueOrFalse();
+	}
+	FORCEINLINE static FVoxelRange Greater(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return Less(B, A);
+	}
+	FORCEINLINE static FVoxelRange GreaterEqual(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return LessEqual(B, A);
+	}
+
+	FORCEINLINE static FVoxelRange And(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return Minimum(A, B);
+	}
+	FORCEINLINE static FVoxelRange Or(const FVoxelRange& A, const FVoxelRange& B)
+	{
+		return Maximum(A, B);
+	}
+	FORCEINLINE static FVoxelRange Not(const FVoxelRange& A)
+	{
+		return OneMinus(A);
+	}
+
+private:
+	// Infinities can create NaNs (Inf - Inf, 0 * Inf)
+	FORCEINLINE static FVoxelRange Sanitize(const FVoxelRange& X)
+	{
+		return FMath::IsNaN(X.Min) || FMath::IsNaN(X.Max) ? Infinite() : X;
+	}
+};
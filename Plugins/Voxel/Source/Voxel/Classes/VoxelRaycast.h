@@ -0,0 +1,53 @@
+// Copyright 2018 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Ray in voxel space
+ */
+struct FVoxelRay
+{
+	FVector Start;
+	// Normalized
+	FVector Direction;
+	// In voxels
+	float MaxDistance;
+
+	FVoxelRay()
+		: Start(FVector::ZeroVector)
+		, Direction(FVector::ForwardVector)
+		, MaxDistance(0)
+	{
+	}
+	// From Start to End
+	FVoxelRay(const FVector& Start, const FVector& End)
+		: Start(Start)
+		, Direction((End - Start).GetSafeNormal())
+		, MaxDistance((End - Start).Size())
+	{
+	}
+};
+
+/**
+ * First surface crossed by a FVoxelRay
+ */
+struct FVoxelRaycastHit
+{
+	bool bHit;
+	// From the ray start, in voxels
+	float Distance;
+	// In voxel space
+	FVector Position;
+	// Points toward the empty side of the surface
+	FVector Normal;
+
+	FVoxelRaycastHit()
+		: bHit(false)
+		, Distance(0)
+		, Position(FVector::ZeroVector)
+		, Normal(FVector::ZeroVector)
+	{
+	}
+};
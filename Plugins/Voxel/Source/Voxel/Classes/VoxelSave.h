@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "VoxelMaterial.h"
 #include "VoxelGlobals.h"
+#include "IntBox.h"
 #include "VoxelSave.generated.h"
 
 /**
@@ -13,6 +14,8 @@
 struct FVoxelChunkSave
 {
 	uint64 Id;
+	// Min corner of the chunk
+	FIntVector Position;
 	TArray<float, TFixedAllocator<DATA_CHUNK_TOTAL_SIZE>> Values;
 	TArray<FVoxelMaterial, TFixedAllocator<DATA_CHUNK_TOTAL_SIZE>> Materials;
 
@@ -20,6 +23,7 @@ struct FVoxelChunkSave
 	FVoxelChunkSave(uint64 Id, FIntVector Position, float Values[DATA_CHUNK_TOTAL_SIZE], FVoxelMaterial Materials[DATA_CHUNK_TOTAL_SIZE]);
 };
 
+// Legacy format: doesn't have the position
 FORCEINLINE FArchive& operator<<(FArchive &Ar, FVoxelChunkSave& Save)
 {
 	Ar << Save.Id;
@@ -29,16 +33,53 @@ FORCEINLINE FArchive& operator<<(FArchive &Ar, FVoxelChunkSave& Save)
 	return Ar;
 }
 
+/**
+ *	Location of a chunk in a save, to load it without decompressing the others
+ */
+struct FVoxelChunkSaveIndex
+{
+	uint64 Id;
+	// Min corner of the chunk
+	FIntVector Position;
+	// Compressed chunk in FVoxelWorldSave::Data
+	int32 Offset;
+	int32 Size;
+
+	FORCEINLINE FIntBox GetBounds() const
+	{
+		return FIntBox(Position, Position + FIntVector(DATA_CHUNK_SIZE, DATA_CHUNK_SIZE, DATA_CHUNK_SIZE));
+	}
+};
+
+namespace EVoxelSaveVersion
+{
+	enum Type
+	{
+		// Single compressed blob
+		BeforeChunkIndex = 0,
+		// Chunks compressed independently, see FVoxelWorldSave
+		ChunkIndex = 1,
+
+		LatestVersion = ChunkIndex
+	};
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
  *	Compressed save of the world
+ *	Data is a list of chunk records: Id, Position, compressed size and the chunk values and materials compressed independently
+ *	Records can be appended: the last record of a chunk replaces the previous ones
  */
 USTRUCT(BlueprintType, Category = Voxel)
 struct VOXEL_API FVoxelWorldSave
 {
 	GENERATED_BODY()
 
+	// Saves without it are EVoxelSaveVersion::BeforeChunkIndex
+	UPROPERTY()
+	int Version;
+
 	UPROPERTY(VisibleAnywhere)
 	int LOD;
 
@@ -47,6 +88,45 @@ struct VOXEL_API FVoxelWorldSave
 
 	FVoxelWorldSave();
 
+	/**
+	 * Replace the save content. The chunks are compressed in parallel
+	 */
 	void Init(int NewLOD, const TArray<FVoxelChunkSave>& ChunksList);
+	/**
+	 * Add chunks to the save, eg the ones edited since the last save. They replace the chunks with the same Id
+	 * Must be on the latest version
+	 */
+	void Append(const TArray<FVoxelChunkSave>& ChunksList);
+
+	/**
+	 * Can chunks be loaded without decompressing the entire save?
+	 */
+	FORCEINLINE bool HasChunkIndex() const
+	{
+		return Version >= EVoxelSaveVersion::ChunkIndex;
+	}
+
+	/**
+	 * Get all the chunks
+	 * @param	SaveQueue	Sorted by increasing Id
+	 */
 	void GetChunksQueue(TArray<FVoxelChunkSave>& SaveQueue) const;
+	/**
+	 * Get the index of the chunks without decompressing them. Requires HasChunkIndex
+	 * @param	OutIndex	Sorted by increasing Id
+	 */
+	void GetChunksIndex(TArray<FVoxelChunkSaveIndex>& OutIndex) const;
+	/**
+	 * Decompress some chunks, in parallel. Requires HasChunkIndex
+	 * @param	Index		Chunks to decompress, from GetChunksIndex
+	 * @param	OutChunks	Same order as Index. The corrupted chunks are skipped
+	 */
+	void GetChunks(const TArray<FVoxelChunkSaveIndex>& Index, TArray<FVoxelChunkSave>& OutChunks) const;
+
+	/**
+	 * Split the records in several saves, eg to send them in bounded messages. Requires HasChunkIndex
+	 * @param	MaxDataSize		Max size of the Data of each save. A larger record gets its own save
+	 * @param	OutSaves		In the records order
+	 */
+	void SplitRecords(int32 MaxDataSize, TArray<FVoxelWorldSave>& OutSaves) const;
 };
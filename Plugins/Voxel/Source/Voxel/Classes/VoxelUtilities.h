@@ -16,6 +16,15 @@ public:
 		return (A > 0 && B > 0) || (A <= 0 && B <= 0);
 	}
 
+	/**
+	 * Quantize a value in [-1, 1] to int16. Keeps the sign, as it defines the surface
+	 */
+	FORCEINLINE static int16 QuantizeValue(float Value)
+	{
+		const int32 Quantized = FMath::RoundToInt(Value * MAX_int16);
+		return (int16)(Value > 0 ? FMath::Max(Quantized, 1) : Value < 0 ? FMath::Min(Quantized, -1) : 0);
+	}
+
 	/**
 	 * If Value ~= 1 ignore, if Value > 0 use if same sign, else use
 	 */
@@ -9,27 +9,34 @@
 #include "Components.h"
 #include "PackedNormal.h"
 #include "RenderUtils.h"
+#include "ShaderParameters.h"
+#include "Math/Vector2DHalf.h"
 #include "Runtime/Launch/Resources/Version.h"
 
 
-/** The vertex type used for dynamic meshes. */
+/**
+ * The vertex type used for dynamic meshes, packed in 16 bytes:
+ * - the position is in 16 bits fixed point, in units of the vertex buffer PositionScale
+ * - the normal is octahedral encoded in 2x8 bits, and stored as the 4th position component
+ * - the tangents are derived from the normal in the shader
+ */
 struct FVoxelDynamicMeshVertex
 {
 	FVoxelDynamicMeshVertex() {}
-	FVoxelDynamicMeshVertex( const FVector& InPosition );
+	FVoxelDynamicMeshVertex(const FVector& InPosition, const FVector& InNormal, const FVector2D& InTexCoord, const FColor& InColor, float PositionScale);
 
-	FVoxelDynamicMeshVertex(const FVector& InPosition,const FVector& InTangentX,const FVector& InTangentZ,const FVector2D& InTexCoord1,const FVector2D& InTexCoord2,const FVector2D& InTexCoord3, const FColor& InColor);
+	void SetPosition(const FVector& InPosition, float PositionScale);
+	FVector GetPosition(float PositionScale) const;
 
-	void SetTangents( const FVector& InTangentX, const FVector& InTangentY, const FVector& InTangentZ );
+	void SetNormal(const FVector& InNormal);
+	FVector GetNormal() const;
 
-	FVector GetTangentY();;
-
-	FVector Position;
-	FVector2D TextureCoordinate;
-	FPackedNormal TangentX;
-	FPackedNormal TangentZ;
+	int16 Position[3];
+	uint16 PackedNormal;
 	FColor Color;
+	FVector2DHalf TextureCoordinate;
 };
+static_assert(sizeof(FVoxelDynamicMeshVertex) == 16, "FVoxelDynamicMeshVertex should be 16 bytes");
 
 /** Resource array to pass  */
 class FVoxelProcMeshVertexResourceArray : public FResourceArrayInterface
@@ -55,9 +62,26 @@ class FVoxelProcMeshVertexBuffer : public FVertexBuffer
 {
 public:
 	TArray<FVoxelDynamicMeshVertex> Vertices;
+	// Size of a position unit of the vertices
+	float PositionScale = 1;
+
+	/**
+	 * Smallest power of 2 position scale for which all the coordinates fit in 16 bits
+	 * Powers of 2 keep the integer coordinates exact, so that the chunks borders still match
+	 * @param	MaxAbsCoordinate	Max absolute value of the vertices coordinates
+	 */
+	static float GetPositionScale(float MaxAbsCoordinate);
+
+	/**
+	 * Upload the vertices, reusing the RHI buffer if it's big enough. Render thread only
+	 */
+	void UpdateBuffer();
 
 	void InitRHI() override;
 
+private:
+	// Size of the RHI buffer, in bytes
+	uint32 AllocatedSize = 0;
 };
 
 /** Index Buffer */
@@ -66,7 +90,16 @@ class FVoxelProcMeshIndexBuffer : public FIndexBuffer
 public:
 	TArray<int32> Indices;
 
+	/**
+	 * Upload the indices, reusing the RHI buffer if it's big enough. Render thread only
+	 */
+	void UpdateBuffer();
+
 	void InitRHI() override;
+
+private:
+	// Size of the RHI buffer, in bytes
+	uint32 AllocatedSize = 0;
 };
 
 
@@ -75,9 +108,15 @@ class FVoxelVertexFactoryShaderParameters : public FVertexFactoryShaderParameter
 public:
 	FVoxelVertexFactoryShaderParameters() {}
 
-	void Bind(const FShaderParameterMap& ParameterMap) override {}
-	void Serialize(FArchive& Ar) override {}
+	void Bind(const FShaderParameterMap& ParameterMap) override;
+	void Serialize(FArchive& Ar) override;
 	void SetMesh(FRHICommandList& RHICmdList, FShader* Shader, const FVertexFactory* VertexFactory, const FSceneView& View, const FMeshBatchElement& BatchElement, uint32 DataFlags) const override;
+
+private:
+	FShaderParameter PositionScaleParameter;
+	FShaderParameter TransitionsMinParameter;
+	FShaderParameter TransitionsMaxParameter;
+	FShaderParameter TransitionsStepParameter;
 };
 
 /** Vertex Factory */
@@ -88,12 +127,9 @@ public:
 
 	struct FDataType
 	{
-		/** The stream to read the vertex position from. */
+		/** The stream to read the vertex position and normal from. */
 		FVertexStreamComponent PositionComponent;
 
-		/** The streams to read the tangent basis from. */
-		FVertexStreamComponent TangentBasisComponents[2];
-
 		/** The streams to read the texture coordinates from. */
 		TArray<FVertexStreamComponent, TFixedAllocator<MAX_STATIC_TEXCOORDS / 2> > TextureCoordinates;
 
@@ -137,9 +173,35 @@ public:
 
 	FORCEINLINE_DEBUGGABLE void SetColorOverrideStream(FRHICommandList& RHICmdList, const FVertexBuffer* ColorVertexBuffer) const;
 
+	FORCEINLINE float GetPositionScale() const
+	{
+		return PositionScale;
+	}
+
+	/**
+	 * Set the transitions applied to the vertices in the vertex shader, see FVoxelIntermediateChunk::GetTranslated
+	 * Must be called on the render thread once initialized
+	 */
+	FORCEINLINE void SetTransitions(uint8 InTransitionsMask, uint8 InTransitionsLOD)
+	{
+		TransitionsMask = InTransitionsMask;
+		TransitionsLOD = InTransitionsLOD;
+	}
+	FORCEINLINE uint8 GetTransitionsMask() const
+	{
+		return TransitionsMask;
+	}
+	FORCEINLINE uint8 GetTransitionsLOD() const
+	{
+		return TransitionsLOD;
+	}
+
 protected:
 	FDataType Data;
 	int32 ColorStreamIndex;
+	float PositionScale;
+	uint8 TransitionsMask;
+	uint8 TransitionsLOD;
 
 	const FDataType& GetData() const { return Data; }
 };
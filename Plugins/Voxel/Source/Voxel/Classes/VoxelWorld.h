@@ -88,6 +88,7 @@ public:
 	FORCEINLINE float GetChunksFadeDuration() const;
 	FORCEINLINE int GetCollisionsThreadCount() const;
 	FORCEINLINE int GetMeshThreadCount() const;
+	FORCEINLINE float GetMeshUpdateBudget() const;
 	FORCEINLINE FQueuedThreadPool* GetAsyncTasksThreadPool() const;
 	FORCEINLINE bool GetCreateAdditionalVerticesForMaterialsTransitions() const;
 	UMaterialInstanceDynamic* GetVoxelMaterialDynamicInstance();
@@ -187,14 +188,14 @@ public:
 	TArray<FIntVector> GetNeighboringPositions(const FVector& GlobalPosition) const;
 
 	/**
-	 * Add chunks at position to update queue
+	 * Add chunks at position to update queue. Updates are merged and sent to the render on next tick
 	 * @param	Position	Position in voxel space
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	void UpdateChunksAtPosition(const FIntVector& Position);
 
 	/**
-	 * Add chunks overlapping box to update queue
+	 * Add chunks overlapping box to update queue. Updates are merged and sent to the render on next tick
 	 * @param	Box			Box
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
@@ -206,6 +207,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	void UpdateAll();
 
+	/**
+	 * Send the queued chunks updates to the render now instead of on next tick
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	void FlushChunksUpdates();
+
 	/**
 	 * Is position in this world?
 	 * @param	Position	Position in voxel space
@@ -214,9 +221,9 @@ public:
 	bool IsInWorld(const FIntVector& Position) const;
 
 	/**
-	 * Get the intersection using voxel data. Doesn't depend on LOD. Useful for short distances, but costful for big ones
-	 * @param	Start				The start of the raycast. The start and the end must have only one coordinate not in common
-	 * @param	End					The end of the raycast. The start and the end must have only one coordinate not in common
+	 * Get the intersection using voxel data. Doesn't depend on LOD. The regions without surface are skipped
+	 * @param	Start				The start of the raycast, in voxel space
+	 * @param	End					The end of the raycast, in voxel space
 	 * @return	GlobalPosition		The world position of the intersection if found
 	 * @return	VoxelPosition		The voxel position of the intersection if found
 	 * @return	Has intersected?
@@ -225,6 +232,19 @@ public:
 	bool GetIntersectionBP(const FIntVector& Start, const FIntVector& End, FVector& GlobalPosition, FIntVector& VoxelPosition); // BP Function can't be const for performance (pure are called for each output)
 	bool GetIntersection(const FIntVector& Start, const FIntVector& End, FVector& GlobalPosition, FIntVector& VoxelPosition) const;
 
+	/**
+	 * Raycast against the voxel data, eg for line of sight checks. Doesn't depend on LOD nor on the collisions
+	 * Use GetData()->RaycastBatch to cast many rays from a worker thread
+	 * @param	Start				The start of the raycast, in world space
+	 * @param	End					The end of the raycast, in world space
+	 * @return	HitPosition			The world position of the hit if found
+	 * @return	HitNormal			The world normal of the surface at the hit
+	 * @return	Has hit?
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel", meta = (DisplayName = "Raycast"))
+	bool RaycastBP(const FVector& Start, const FVector& End, FVector& HitPosition, FVector& HitNormal); // BP Function can't be const for performance (pure are called for each output)
+	bool Raycast(const FVector& Start, const FVector& End, FVector& HitPosition, FVector& HitNormal) const;
+
 	/**
 	 * Get the normal at the voxel position Position using gradient. May differ from the mesh normal
 	 * @param	Position	Position in voxel space
@@ -281,6 +301,12 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Voxel")
 	void GetSave(FVoxelWorldSave& OutSave) const;
+	/**
+	 * Add the chunks edited since the last GetSave/AppendToSave to Save, without recompressing the others
+	 * @param	Save	The last save of this world. Replaced by a full save if it can't be appended to
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel")
+	void AppendToSave(UPARAM(ref) FVoxelWorldSave& Save) const;
 	/**
 	 * Load world from save
 	 * @param	Save	Save to load from
@@ -288,6 +314,15 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Voxel", meta = (AdvancedDisplay = "1"))
 	void LoadFromSave(const FVoxelWorldSave& Save, bool bReset = true);
+	/**
+	 * Load world from save lazily: only the chunks close to the invokers are loaded, the others once they get close or are edited
+	 * Saves from older versions are loaded entirely
+	 * @param	Save		Save to load from
+	 * @param	Distance	In world space. Chunks closer than this to an invoker are loaded
+	 * @param	bReset		Reset existing world? Set to false only if current world is unmodified
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Voxel", meta = (AdvancedDisplay = "2"))
+	void StreamFromSave(const FVoxelWorldSave& Save, float Distance = 10000, bool bReset = true);
 	
 	/**
 	 * Use this world as a multiplayer server
@@ -391,10 +426,26 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Voxel|Performance", meta = (ClampMin = "1", UIMin = "1"), AdvancedDisplay)
 	int MeshThreadCount;
 
+	// Max time spent each frame applying the computed meshes, grass and actors, in milliseconds. At least one mesh is applied per frame. 0 to disable the limit
+	UPROPERTY(EditAnywhere, Category = "Voxel|Performance", meta = (ClampMin = "0", UIMin = "0"), AdvancedDisplay)
+	float MeshUpdateBudget;
+
 	// Number of threads allocated for the collisions meshes processing. Setting it too low may impact performance
 	UPROPERTY(EditAnywhere, Category = "Voxel|Performance", meta = (ClampMin = "1", UIMin = "1"), AdvancedDisplay)
 	int CollisionsThreadCount;
 
+	// Edited chunks not used for this many seconds are compressed to save memory. 0 to disable
+	UPROPERTY(EditAnywhere, Category = "Voxel|Performance", meta = (ClampMin = "0", UIMin = "0"), AdvancedDisplay)
+	float ColdChunksCompressionDelay;
+
+	// Compressed chunks not used for this many seconds are written to a temporary file in Saved/VoxelPages, and read back on their next use. 0 to disable
+	UPROPERTY(EditAnywhere, Category = "Voxel|Performance", meta = (ClampMin = "0", UIMin = "0"), AdvancedDisplay)
+	float ColdChunksPagingDelay;
+
+	// Memory used to cache the world generator values of the chunks, in MB. 0 to disable
+	UPROPERTY(EditAnywhere, Category = "Voxel|Performance", meta = (ClampMin = "0", UIMin = "0", ClampMax = "4095"), AdvancedDisplay)
+	int GeneratorCacheSize;
+
 
 	// Is this world multiplayer?
 	UPROPERTY(EditAnywhere, Category = "Voxel|Multiplayer")
@@ -404,6 +455,10 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Voxel|Multiplayer", meta = (EditCondition = "bMultiplayer"))
 	float MultiplayerSyncRate;
 
+	// Clients only receive the edits closer than this to their invokers. In world space
+	UPROPERTY(EditAnywhere, Category = "Voxel|Multiplayer", meta = (EditCondition = "bMultiplayer"))
+	float MultiplayerInterestDistance;
+
 	// Debug multiplayer syncs?
 	UPROPERTY(EditAnywhere, Category = "Voxel|Multiplayer", meta = (EditCondition = "bMultiplayer"))
 	bool bDebugMultiplayer;
@@ -441,6 +496,17 @@ private:
 
 	float TimeSinceActorOctreeUpdate;
 
+	float TimeSinceColdChunksCompression;
+
+	// Is a save streamed? See StreamFromSave
+	bool bIsStreamingSave;
+	float SaveStreamingDistance;
+
+	// Queued updates smaller than a data chunk, merged by data chunk
+	TMap<FIntVector, FIntBox> QueuedChunksUpdates;
+	// Bigger queued updates
+	TArray<FIntBox> QueuedBoxesUpdates;
+
 	TSet<FIntVector> ChunksWithCreatedActors;
 	TSharedPtr<FVoxelActorOctree> ActorOctree;
 
@@ -451,10 +517,15 @@ private:
 	// Destroy the world
 	void DestroyWorldInternal();
 
+	// Load the streamed chunks close to the invokers
+	void LoadStreamedChunks();
+
 	// Receive data from server
 	void ReceiveData();
 	// Send data to clients
 	void SendData();
+	// Send the region around the invokers to the server
+	void SendInterest();
 
 	void TriggerOnClientConnection();
 };
@@ -2261,4 +2261,355 @@ void FastNoise::SingleGradientPerturb(unsigned char offset, FN_DECIMAL warpAmp,
 
 	x += Lerp(lx0x, lx1x, ys) * warpAmp;
 	y += Lerp(ly0x, ly1x, ys) * warpAmp;
-}
\ No newline at end of file
+}
+// Batch
+static void ScaleBatch(const FN_DECIMAL* v, FN_DECIMAL scale, FN_DECIMAL* out, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = v[i] * scale;
+	}
+}
+
+static void FloorBatch(const FN_DECIMAL* v, int* v0, FN_DECIMAL* vd0, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		v0[i] = FastFloor(v[i]);
+		vd0[i] = v[i] - (FN_DECIMAL)v0[i];
+	}
+}
+
+static void InterpBatch(FastNoise::Interp interp, const FN_DECIMAL* vd0, FN_DECIMAL* vs, int count)
+{
+	switch (interp)
+	{
+	case FastNoise::Linear:
+		for (int i = 0; i < count; i++)
+		{
+			vs[i] = vd0[i];
+		}
+		break;
+	case FastNoise::Hermite:
+		for (int i = 0; i < count; i++)
+		{
+			vs[i] = InterpHermiteFunc(vd0[i]);
+		}
+		break;
+	case FastNoise::Quintic:
+		for (int i = 0; i < count; i++)
+		{
+			vs[i] = InterpQuinticFunc(vd0[i]);
+		}
+		break;
+	}
+}
+
+void FastNoise::NoiseBatch(SingleBatchFunction single, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	FN_DECIMAL xf[FN_BATCH_SIZE];
+	FN_DECIMAL yf[FN_BATCH_SIZE];
+	FN_DECIMAL zf[FN_BATCH_SIZE];
+
+	for (int start = 0; start < count; start += FN_BATCH_SIZE)
+	{
+		const int n = std::min(count - start, FN_BATCH_SIZE);
+
+		ScaleBatch(x + start, m_frequency, xf, n);
+		ScaleBatch(y + start, m_frequency, yf, n);
+		if (z)
+		{
+			ScaleBatch(z + start, m_frequency, zf, n);
+		}
+
+		(this->*single)(0, xf, yf, zf, out + start, n);
+	}
+}
+
+void FastNoise::FractalBatch(SingleBatchFunction single, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	FN_DECIMAL xf[FN_BATCH_SIZE];
+	FN_DECIMAL yf[FN_BATCH_SIZE];
+	FN_DECIMAL zf[FN_BATCH_SIZE];
+	FN_DECIMAL noise[FN_BATCH_SIZE];
+
+	for (int start = 0; start < count; start += FN_BATCH_SIZE)
+	{
+		const int n = std::min(count - start, FN_BATCH_SIZE);
+		FN_DECIMAL* sum = out + start;
+
+		ScaleBatch(x + start, m_frequency, xf, n);
+		ScaleBatch(y + start, m_frequency, yf, n);
+		if (z)
+		{
+			ScaleBatch(z + start, m_frequency, zf, n);
+		}
+
+		(this->*single)(m_perm[0], xf, yf, zf, noise, n);
+
+		switch (m_fractalType)
+		{
+		case FBM:
+			for (int i = 0; i < n; i++)
+			{
+				sum[i] = noise[i];
+			}
+			break;
+		case Billow:
+			for (int i = 0; i < n; i++)
+			{
+				sum[i] = FastAbs(noise[i]) * 2 - 1;
+			}
+			break;
+		case RigidMulti:
+			for (int i = 0; i < n; i++)
+			{
+				sum[i] = 1 - FastAbs(noise[i]);
+			}
+			break;
+		default:
+			for (int i = 0; i < n; i++)
+			{
+				sum[i] = 0;
+			}
+			continue;
+		}
+
+		FN_DECIMAL amp = 1;
+		for (int octave = 1; octave < m_octaves; octave++)
+		{
+			ScaleBatch(xf, m_lacunarity, xf, n);
+			ScaleBatch(yf, m_lacunarity, yf, n);
+			if (z)
+			{
+				ScaleBatch(zf, m_lacunarity, zf, n);
+			}
+
+			amp *= m_gain;
+			(this->*single)(m_perm[octave], xf, yf, zf, noise, n);
+
+			switch (m_fractalType)
+			{
+			case FBM:
+				for (int i = 0; i < n; i++)
+				{
+					sum[i] += noise[i] * amp;
+				}
+				break;
+			case Billow:
+				for (int i = 0; i < n; i++)
+				{
+					sum[i] += (FastAbs(noise[i]) * 2 - 1) * amp;
+				}
+				break;
+			case RigidMulti:
+				for (int i = 0; i < n; i++)
+				{
+					sum[i] -= (1 - FastAbs(noise[i])) * amp;
+				}
+				break;
+			}
+		}
+
+		if (m_fractalType != RigidMulti)
+		{
+			ScaleBatch(sum, m_fractalBounding, sum, n);
+		}
+	}
+}
+
+void FastNoise::SingleValueBatch2D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	int x0[FN_BATCH_SIZE], y0[FN_BATCH_SIZE];
+	FN_DECIMAL xd0[FN_BATCH_SIZE], yd0[FN_BATCH_SIZE];
+	FN_DECIMAL xs[FN_BATCH_SIZE], ys[FN_BATCH_SIZE];
+
+	FloorBatch(x, x0, xd0, count);
+	FloorBatch(y, y0, yd0, count);
+	InterpBatch(m_interp, xd0, xs, count);
+	InterpBatch(m_interp, yd0, ys, count);
+
+	for (int i = 0; i < count; i++)
+	{
+		int x1 = x0[i] + 1;
+		int y1 = y0[i] + 1;
+
+		FN_DECIMAL xf0 = Lerp(ValCoord2DFast(offset, x0[i], y0[i]), ValCoord2DFast(offset, x1, y0[i]), xs[i]);
+		FN_DECIMAL xf1 = Lerp(ValCoord2DFast(offset, x0[i], y1), ValCoord2DFast(offset, x1, y1), xs[i]);
+
+		out[i] = Lerp(xf0, xf1, ys[i]);
+	}
+}
+
+void FastNoise::SinglePerlinBatch2D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	int x0[FN_BATCH_SIZE], y0[FN_BATCH_SIZE];
+	FN_DECIMAL xd0[FN_BATCH_SIZE], yd0[FN_BATCH_SIZE];
+	FN_DECIMAL xs[FN_BATCH_SIZE], ys[FN_BATCH_SIZE];
+
+	FloorBatch(x, x0, xd0, count);
+	FloorBatch(y, y0, yd0, count);
+	InterpBatch(m_interp, xd0, xs, count);
+	InterpBatch(m_interp, yd0, ys, count);
+
+	for (int i = 0; i < count; i++)
+	{
+		int x1 = x0[i] + 1;
+		int y1 = y0[i] + 1;
+		FN_DECIMAL xd1 = xd0[i] - 1;
+		FN_DECIMAL yd1 = yd0[i] - 1;
+
+		FN_DECIMAL xf0 = Lerp(GradCoord2D(offset, x0[i], y0[i], xd0[i], yd0[i]), GradCoord2D(offset, x1, y0[i], xd1, yd0[i]), xs[i]);
+		FN_DECIMAL xf1 = Lerp(GradCoord2D(offset, x0[i], y1, xd0[i], yd1), GradCoord2D(offset, x1, y1, xd1, yd1), xs[i]);
+
+		out[i] = Lerp(xf0, xf1, ys[i]);
+	}
+}
+
+void FastNoise::SingleSimplexBatch2D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = SingleSimplex(offset, x[i], y[i]);
+	}
+}
+
+void FastNoise::SingleCubicBatch2D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = SingleCubic(offset, x[i], y[i]);
+	}
+}
+
+void FastNoise::SingleValueBatch3D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	int x0[FN_BATCH_SIZE], y0[FN_BATCH_SIZE], z0[FN_BATCH_SIZE];
+	FN_DECIMAL xd0[FN_BATCH_SIZE], yd0[FN_BATCH_SIZE], zd0[FN_BATCH_SIZE];
+	FN_DECIMAL xs[FN_BATCH_SIZE], ys[FN_BATCH_SIZE], zs[FN_BATCH_SIZE];
+
+	FloorBatch(x, x0, xd0, count);
+	FloorBatch(y, y0, yd0, count);
+	FloorBatch(z, z0, zd0, count);
+	InterpBatch(m_interp, xd0, xs, count);
+	InterpBatch(m_interp, yd0, ys, count);
+	InterpBatch(m_interp, zd0, zs, count);
+
+	for (int i = 0; i < count; i++)
+	{
+		int x1 = x0[i] + 1;
+		int y1 = y0[i] + 1;
+		int z1 = z0[i] + 1;
+
+		FN_DECIMAL xf00 = Lerp(ValCoord3DFast(offset, x0[i], y0[i], z0[i]), ValCoord3DFast(offset, x1, y0[i], z0[i]), xs[i]);
+		FN_DECIMAL xf10 = Lerp(ValCoord3DFast(offset, x0[i], y1, z0[i]), ValCoord3DFast(offset, x1, y1, z0[i]), xs[i]);
+		FN_DECIMAL xf01 = Lerp(ValCoord3DFast(offset, x0[i], y0[i], z1), ValCoord3DFast(offset, x1, y0[i], z1), xs[i]);
+		FN_DECIMAL xf11 = Lerp(ValCoord3DFast(offset, x0[i], y1, z1), ValCoord3DFast(offset, x1, y1, z1), xs[i]);
+
+		FN_DECIMAL yf0 = Lerp(xf00, xf10, ys[i]);
+		FN_DECIMAL yf1 = Lerp(xf01, xf11, ys[i]);
+
+		out[i] = Lerp(yf0, yf1, zs[i]);
+	}
+}
+
+void FastNoise::SinglePerlinBatch3D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	int x0[FN_BATCH_SIZE], y0[FN_BATCH_SIZE], z0[FN_BATCH_SIZE];
+	FN_DECIMAL xd0[FN_BATCH_SIZE], yd0[FN_BATCH_SIZE], zd0[FN_BATCH_SIZE];
+	FN_DECIMAL xs[FN_BATCH_SIZE], ys[FN_BATCH_SIZE], zs[FN_BATCH_SIZE];
+
+	FloorBatch(x, x0, xd0, count);
+	FloorBatch(y, y0, yd0, count);
+	FloorBatch(z, z0, zd0, count);
+	InterpBatch(m_interp, xd0, xs, count);
+	InterpBatch(m_interp, yd0, ys, count);
+	InterpBatch(m_interp, zd0, zs, count);
+
+	for (int i = 0; i < count; i++)
+	{
+		int x1 = x0[i] + 1;
+		int y1 = y0[i] + 1;
+		int z1 = z0[i] + 1;
+		FN_DECIMAL xd1 = xd0[i] - 1;
+		FN_DECIMAL yd1 = yd0[i] - 1;
+		FN_DECIMAL zd1 = zd0[i] - 1;
+
+		FN_DECIMAL xf00 = Lerp(GradCoord3D(offset, x0[i], y0[i], z0[i], xd0[i], yd0[i], zd0[i]), GradCoord3D(offset, x1, y0[i], z0[i], xd1, yd0[i], zd0[i]), xs[i]);
+		FN_DECIMAL xf10 = Lerp(GradCoord3D(offset, x0[i], y1, z0[i], xd0[i], yd1, zd0[i]), GradCoord3D(offset, x1, y1, z0[i], xd1, yd1, zd0[i]), xs[i]);
+		FN_DECIMAL xf01 = Lerp(GradCoord3D(offset, x0[i], y0[i], z1, xd0[i], yd0[i], zd1), GradCoord3D(offset, x1, y0[i], z1, xd1, yd0[i], zd1), xs[i]);
+		FN_DECIMAL xf11 = Lerp(GradCoord3D(offset, x0[i], y1, z1, xd0[i], yd1, zd1), GradCoord3D(offset, x1, y1, z1, xd1, yd1, zd1), xs[i]);
+
+		FN_DECIMAL yf0 = Lerp(xf00, xf10, ys[i]);
+		FN_DECIMAL yf1 = Lerp(xf01, xf11, ys[i]);
+
+		out[i] = Lerp(yf0, yf1, zs[i]);
+	}
+}
+
+void FastNoise::SingleSimplexBatch3D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = SingleSimplex(offset, x[i], y[i], z[i]);
+	}
+}
+
+void FastNoise::SingleCubicBatch3D(unsigned char offset, const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = SingleCubic(offset, x[i], y[i], z[i]);
+	}
+}
+
+void FastNoise::GetValue(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const { NoiseBatch(&FastNoise::SingleValueBatch2D, x, y, nullptr, out, count); }
+void FastNoise::GetValueFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const { FractalBatch(&FastNoise::SingleValueBatch2D, x, y, nullptr, out, count); }
+void FastNoise::GetPerlin(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const { NoiseBatch(&FastNoise::SinglePerlinBatch2D, x, y, nullptr, out, count); }
+void FastNoise::GetPerlinFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const { FractalBatch(&FastNoise::SinglePerlinBatch2D, x, y, nullptr, out, count); }
+void FastNoise::GetSimplex(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const { NoiseBatch(&FastNoise::SingleSimplexBatch2D, x, y, nullptr, out, count); }
+void FastNoise::GetSimplexFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const { FractalBatch(&FastNoise::SingleSimplexBatch2D, x, y, nullptr, out, count); }
+void FastNoise::GetCubic(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const { NoiseBatch(&FastNoise::SingleCubicBatch2D, x, y, nullptr, out, count); }
+void FastNoise::GetCubicFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const { FractalBatch(&FastNoise::SingleCubicBatch2D, x, y, nullptr, out, count); }
+
+void FastNoise::GetValue(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const { NoiseBatch(&FastNoise::SingleValueBatch3D, x, y, z, out, count); }
+void FastNoise::GetValueFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const { FractalBatch(&FastNoise::SingleValueBatch3D, x, y, z, out, count); }
+void FastNoise::GetPerlin(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const { NoiseBatch(&FastNoise::SinglePerlinBatch3D, x, y, z, out, count); }
+void FastNoise::GetPerlinFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const { FractalBatch(&FastNoise::SinglePerlinBatch3D, x, y, z, out, count); }
+void FastNoise::GetSimplex(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const { NoiseBatch(&FastNoise::SingleSimplexBatch3D, x, y, z, out, count); }
+void FastNoise::GetSimplexFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const { FractalBatch(&FastNoise::SingleSimplexBatch3D, x, y, z, out, count); }
+void FastNoise::GetCubic(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const { NoiseBatch(&FastNoise::SingleCubicBatch3D, x, y, z, out, count); }
+void FastNoise::GetCubicFractal(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const { FractalBatch(&FastNoise::SingleCubicBatch3D, x, y, z, out, count); }
+
+// No shared work between the points
+void FastNoise::GetCellular(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = GetCellular(x[i], y[i]);
+	}
+}
+
+void FastNoise::GetWhiteNoise(const FN_DECIMAL* x, const FN_DECIMAL* y, FN_DECIMAL* out, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = GetWhiteNoise(x[i], y[i]);
+	}
+}
+
+void FastNoise::GetCellular(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = GetCellular(x[i], y[i], z[i]);
+	}
+}
+
+void FastNoise::GetWhiteNoise(const FN_DECIMAL* x, const FN_DECIMAL* y, const FN_DECIMAL* z, FN_DECIMAL* out, int count) const
+{
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = GetWhiteNoise(x[i], y[i], z[i]);
+	}
+}
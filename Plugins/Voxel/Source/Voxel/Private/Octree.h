@@ -282,6 +282,8 @@ protected:
 		Childs.Add(new ElementType(static_cast<ElementType*>(this), 6));
 		Childs.Add(new ElementType(static_cast<ElementType*>(this), 7));
 
+		// Childs must be fully constructed before other threads can see them
+		FPlatformMisc::MemoryBarrier();
 		bIsLeaf = false;
 	}
 
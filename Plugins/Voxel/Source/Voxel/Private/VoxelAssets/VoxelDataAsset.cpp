@@ -8,16 +8,36 @@
 
 UVoxelDataAsset::UVoxelDataAsset(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
+	, Data(MakeShared<FVoxelDataAssetData>())
 {
 };
 
 TSharedRef<FVoxelAssetInstance> UVoxelDataAsset::GetAssetInternal(const FIntVector& Position) const
 {
-	return MakeShareable(new FVoxelDataAssetInstance(Size, Values, Materials, VoxelTypes, Position));
+	return MakeShareable(new FVoxelDataAssetInstance(Data, Position));
+}
+
+FVoxelDataAssetData& UVoxelDataAsset::GetMutableData()
+{
+	if (!Data.IsUnique())
+	{
+		Data = MakeShared<FVoxelDataAssetData>(*Data);
+	}
+	return *Data;
 }
 
 void UVoxelDataAsset::SetSize(const FIntVector& NewSize, bool bInitialize)
 {
+	// Don't copy the arrays that are going to be reset
+	if (!Data.IsUnique())
+	{
+		Data = MakeShared<FVoxelDataAssetData>();
+	}
+	FIntVector& Size = Data->Size;
+	TArray<float>& Values = Data->Values;
+	TArray<FVoxelMaterial>& Materials = Data->Materials;
+	TArray<uint8>& VoxelTypes = Data->VoxelTypes;
+
 	Size.X = FMath::Max(0, NewSize.X);
 	Size.Y = FMath::Max(0, NewSize.Y);
 	Size.Z = FMath::Max(0, NewSize.Z);
@@ -41,55 +61,64 @@ void UVoxelDataAsset::SetSize(const FIntVector& NewSize, bool bInitialize)
 
 FIntVector UVoxelDataAsset::GetSize() const
 {
-	return Size;
+	return Data->Size;
 }
 
 void UVoxelDataAsset::SetValue(int X, int Y, int Z, float NewValue)
 {
+	FVoxelDataAssetData& MutableData = GetMutableData();
+	const FIntVector& Size = MutableData.Size;
 	check(0 <= X && X < Size.X);
 	check(0 <= Y && Y < Size.Y);
 	check(0 <= Z && Z < Size.Z);
-	Values[X + Size.X * Y + Size.X * Size.Y * Z] = NewValue;
+	MutableData.Values[X + Size.X * Y + Size.X * Size.Y * Z] = NewValue;
 }
 
 void UVoxelDataAsset::SetMaterial(int X, int Y, int Z, FVoxelMaterial NewMaterial)
 {
+	FVoxelDataAssetData& MutableData = GetMutableData();
+	const FIntVector& Size = MutableData.Size;
 	check(0 <= X && X < Size.X);
 	check(0 <= Y && Y < Size.Y);
 	check(0 <= Z && Z < Size.Z);
-	Materials[X + Size.X * Y + Size.X * Size.Y * Z] = NewMaterial;
+	MutableData.Materials[X + Size.X * Y + Size.X * Size.Y * Z] = NewMaterial;
 }
 
 void UVoxelDataAsset::SetVoxelType(int X, int Y, int Z, FVoxelType VoxelType)
 {
+	FVoxelDataAssetData& MutableData = GetMutableData();
+	const FIntVector& Size = MutableData.Size;
 	check(0 <= X && X < Size.X);
 	check(0 <= Y && Y < Size.Y);
 	check(0 <= Z && Z < Size.Z);
-	VoxelTypes[X + Size.X * Y + Size.X * Size.Y * Z] = VoxelType.Value;
+	MutableData.VoxelTypes[X + Size.X * Y + Size.X * Size.Y * Z] = VoxelType.Value;
 }
 
 float UVoxelDataAsset::GetValue(int X, int Y, int Z) const
 {
+	const FIntVector& Size = Data->Size;
 	check(0 <= X && X < Size.X);
 	check(0 <= Y && Y < Size.Y);
 	check(0 <= Z && Z < Size.Z);
-	return Values[X + Size.X * Y + Size.X * Size.Y * Z];
+	return Data->Values[X + Size.X * Y + Size.X * Size.Y * Z];
 }
 
 FVoxelMaterial UVoxelDataAsset::GetMaterial(int X, int Y, int Z) const
 {
+	const FIntVector& Size = Data->Size;
 	check(0 <= X && X < Size.X);
 	check(0 <= Y && Y < Size.Y);
 	check(0 <= Z && Z < Size.Z);
-	return Materials[X + Size.X * Y + Size.X * Size.Y * Z];
+	return Data->Materials[X + Size.X * Y + Size.X * Size.Y * Z];
 }
 
 FVoxelType UVoxelDataAsset::GetVoxelType(int X, int Y, int Z) const
 {
+	const FIntVector& Size = Data->Size;
 	check(0 <= X && X < Size.X);
 	check(0 <= Y && Y < Size.Y);
 	check(0 <= Z && Z < Size.Z);
-	return FVoxelType(VoxelTypes[X + Size.X * Y + Size.X * Size.Y * Z]);
+	return FVoxelType(Data->VoxelTypes[X + Size.X * Y + Size.X * Size.Y * Z]);
 }
 
 void UVoxelDataAsset::SetPrecomputedArrays(FIntVector InSize, TArray<float>& InValues, TArray<FVoxelMaterial>& InMaterials, TArray<uint8>& InVoxelTypes)
@@ -99,28 +128,30 @@ void UVoxelDataAsset::SetPrecomputedArrays(FIntVector InSize, TArray<float>& InV
 	check(InMaterials.Num() == Count);
 	check(InVoxelTypes.Num() == Count);
 
-	Size = InSize;
-	Values = InValues;
-	Materials = InMaterials;
-	VoxelTypes = InVoxelTypes;
+	TSharedRef<FVoxelDataAssetData> NewData = MakeShared<FVoxelDataAssetData>();
+	NewData->Size = InSize;
+	NewData->Values = InValues;
+	NewData->Materials = InMaterials;
+	NewData->VoxelTypes = InVoxelTypes;
+	Data = NewData;
 }
 
 void UVoxelDataAsset::Save()
 {
 	FBufferArchive Archive;
 
-	Archive << Size;
+	Archive << Data->Size;
 
 	TArray<uint8> RLEValues;
-	FVoxelUtilities::CompressRLE(Values, RLEValues);
+	FVoxelUtilities::CompressRLE(Data->Values, RLEValues);
 	Archive << RLEValues;
 
 	TArray<uint8> RLEMaterials;
-	FVoxelUtilities::CompressRLE(Materials, RLEMaterials);
+	FVoxelUtilities::CompressRLE(Data->Materials, RLEMaterials);
 	Archive << RLEMaterials;
 
 	TArray<uint8> RLETypes;
-	FVoxelUtilities::CompressRLE(VoxelTypes, RLETypes);
+	FVoxelUtilities::CompressRLE(Data->VoxelTypes, RLETypes);
 	Archive << RLETypes;
 
 	int32 UncompressedSize = Archive.Num();
@@ -135,38 +166,40 @@ void UVoxelDataAsset::Save()
 
 void UVoxelDataAsset::LoadInternal()
 {
-	TArray<uint8> Data;
+	TArray<uint8> Uncompressed;
 
 	int32 UncompressedSize;
 	FMemory::Memcpy(&UncompressedSize, &CompressedData[0], sizeof(UncompressedSize));
-	Data.SetNum(UncompressedSize);
-	verify(FCompression::UncompressMemory(CompressionFlags, Data.GetData(), UncompressedSize, CompressedData.GetData() + sizeof(UncompressedSize), CompressedData.Num() - sizeof(UncompressedSize)));
+	Uncompressed.SetNum(UncompressedSize);
+	verify(FCompression::UncompressMemory(CompressionFlags, Uncompressed.GetData(), UncompressedSize, CompressedData.GetData() + sizeof(UncompressedSize), CompressedData.Num() - sizeof(UncompressedSize)));
+
+	FMemoryReader Reader(Uncompressed);
 
-	FMemoryReader Reader(Data);
+	// New data, as the previous one might be used by instances
+	TSharedRef<FVoxelDataAssetData> NewData = MakeShared<FVoxelDataAssetData>();
 
-	Reader << Size;
+	Reader << NewData->Size;
 
 	TArray<uint8> RLEValues;
 	Reader << RLEValues;
-	FVoxelUtilities::DecompressRLE(RLEValues, Values);
+	FVoxelUtilities::DecompressRLE(RLEValues, NewData->Values);
 
 	TArray<uint8> RLEMaterials;
 	Reader << RLEMaterials;
-	FVoxelUtilities::DecompressRLE(RLEMaterials, Materials);
+	FVoxelUtilities::DecompressRLE(RLEMaterials, NewData->Materials);
 
 	TArray<uint8> RLETypes;
 	Reader << RLETypes;
-	FVoxelUtilities::DecompressRLE(RLETypes, VoxelTypes);
+	FVoxelUtilities::DecompressRLE(RLETypes, NewData->VoxelTypes);
+
+	Data = NewData;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
-FVoxelDataAssetInstance::FVoxelDataAssetInstance(const FIntVector& Size, const TArray<float>& Values, const TArray<FVoxelMaterial>& Materials, const TArray<uint8>& VoxelTypes, const FIntVector& Position)
-	: Size(Size)
-	, Values(Values)
-	, Materials(Materials)
-	, VoxelTypes(VoxelTypes)
+FVoxelDataAssetInstance::FVoxelDataAssetInstance(const TSharedRef<const FVoxelDataAssetData>& Data, const FIntVector& Position)
+	: Data(Data)
 	, FVoxelAssetInstance(Position)
 {
 
@@ -174,6 +207,11 @@ FVoxelDataAssetInstance::FVoxelDataAssetInstance(const FIntVector& Size, const T
 
 void FVoxelDataAssetInstance::GetValuesAndMaterialsAndVoxelTypes(float InValues[], FVoxelMaterial InMaterials[], FVoxelType InVoxelTypes[], const FIntVector& Start, const FIntVector& StartIndex, const int Step, const FIntVector& InSize, const FIntVector& ArraySize) const
 {
+	const FIntVector& Size = Data->Size;
+	const TArray<float>& Values = Data->Values;
+	const TArray<FVoxelMaterial>& Materials = Data->Materials;
+	const TArray<uint8>& VoxelTypes = Data->VoxelTypes;
+
 	for (int K = 0; K < InSize.Z; K++)
 	{
 		const int Z = Start.Z + K * Step - Position.Z;
@@ -211,7 +249,7 @@ void FVoxelDataAssetInstance::GetValuesAndMaterialsAndVoxelTypes(float InValues[
 
 FIntBox FVoxelDataAssetInstance::GetLocalBounds() const
 {
-	const FIntVector Bounds;
+	const FIntVector& Size = Data->Size;
 
 	FIntBox Box;
 	Box.Min = FIntVector(0, 0, 0);
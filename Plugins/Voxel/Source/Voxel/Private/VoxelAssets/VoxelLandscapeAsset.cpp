@@ -15,21 +15,15 @@ UVoxelLandscapeAsset::UVoxelLandscapeAsset(const FObjectInitializer& ObjectIniti
 	, HeightOffset(0)
 	, ScaleMultiplier(1)
 	, bShrink(false)
-	, MaxHeight(-1e10)
-	, MinHeight(1e10)
 	, AdditionalThickness(1000000)
+	, Data(MakeShared<FVoxelLandscapeAssetData>())
 {
 };
 
 TSharedRef<FVoxelAssetInstance> UVoxelLandscapeAsset::GetAssetInternal(const FIntVector& Position) const
 {
 	return MakeShareable(new FVoxelLandscapeAssetInstance(
-		Heights,
-		Materials,
-		Width,
-		Height,
-		MaxHeight,
-		MinHeight,
+		Data,
 		Precision,
 		HeightMultiplier,
 		HeightOffset,
@@ -39,73 +33,97 @@ TSharedRef<FVoxelAssetInstance> UVoxelLandscapeAsset::GetAssetInternal(const FIn
 		Position));
 }
 
+FVoxelLandscapeAssetData& UVoxelLandscapeAsset::GetMutableData()
+{
+	if (!Data.IsUnique())
+	{
+		Data = MakeShared<FVoxelLandscapeAssetData>(*Data);
+	}
+	return *Data;
+}
+
 void UVoxelLandscapeAsset::SetSize(int InWidth, int InHeight, bool bInitialize)
 {
-	Width = InWidth;
-	Height = InHeight;
+	// Don't copy the arrays that are going to be reset
+	if (!Data.IsUnique())
+	{
+		TSharedRef<FVoxelLandscapeAssetData> NewData = MakeShared<FVoxelLandscapeAssetData>();
+		NewData->MaxHeight = Data->MaxHeight;
+		NewData->MinHeight = Data->MinHeight;
+		Data = NewData;
+	}
+
+	Data->Width = InWidth;
+	Data->Height = InHeight;
 
 	if (bInitialize)
 	{
-		Heights.SetNum(Width * Height);
-		Materials.SetNum(Width * Height);
+		Data->Heights.SetNum(InWidth * InHeight);
+		Data->Materials.SetNum(InWidth * InHeight);
 	}
 	else
 	{
-		Heights.SetNumUninitialized(Width * Height);
-		Materials.SetNumUninitialized(Width * Height);
+		Data->Heights.SetNumUninitialized(InWidth * InHeight);
+		Data->Materials.SetNumUninitialized(InWidth * InHeight);
 	}
 }
 
 int UVoxelLandscapeAsset::GetTerrainWidth()
 {
-	return Width;
+	return Data->Width;
 }
 
 int UVoxelLandscapeAsset::GetTerrainHeight()
 {
-	return Height;
+	return Data->Height;
 }
 
 void UVoxelLandscapeAsset::SetHeight(int X, int Y, float NewHeight)
 {
-	check(0 <= X && X < Width);
-	check(0 <= Y && Y < Height);
-	MaxHeight = FMath::Max(MaxHeight, NewHeight);
-	MinHeight = FMath::Min(MinHeight, NewHeight);
-	Heights[X + Width * Y] = NewHeight;
+	FVoxelLandscapeAssetData& MutableData = GetMutableData();
+	check(0 <= X && X < MutableData.Width);
+	check(0 <= Y && Y < MutableData.Height);
+	MutableData.MaxHeight = FMath::Max(MutableData.MaxHeight, NewHeight);
+	MutableData.MinHeight = FMath::Min(MutableData.MinHeight, NewHeight);
+	MutableData.Heights[X + MutableData.Width * Y] = NewHeight;
 }
 
 void UVoxelLandscapeAsset::SetMaterial(int X, int Y, FVoxelMaterial Material)
 {
-	check(0 <= X && X < Width);
-	check(0 <= Y && Y < Height);
-	Materials[X + Width * Y] = Material;
+	FVoxelLandscapeAssetData& MutableData = GetMutableData();
+	check(0 <= X && X < MutableData.Width);
+	check(0 <= Y && Y < MutableData.Height);
+	MutableData.Materials[X + MutableData.Width * Y] = Material;
 }
 
 float UVoxelLandscapeAsset::GetHeight(int X, int Y) const
 {
-	check(0 <= X && X < Width);
-	check(0 <= Y && Y < Height);
-	return Heights[X + Width * Y];
+	check(0 <= X && X < Data->Width);
+	check(0 <= Y && Y < Data->Height);
+	return Data->Heights[X + Data->Width * Y];
 }
 
 FVoxelMaterial UVoxelLandscapeAsset::GetMaterial(int X, int Y) const
 {
-	check(0 <= X && X < Width);
-	check(0 <= Y && Y < Height);
-	return Materials[X + Width * Y];
+	check(0 <= X && X < Data->Width);
+	check(0 <= Y && Y < Data->Height);
+	return Data->Materials[X + Data->Width * Y];
 }
 
 void UVoxelLandscapeAsset::SetPrecomputedValues(const TArray<float>& InHeights, const TArray<FVoxelMaterial>& InMaterials, int InWidth, int InHeight, float InMaxHeight, float InMinHeight)
 {
-	Heights = InHeights;
-	Materials = InMaterials;
+	TSharedRef<FVoxelLandscapeAssetData> NewData = MakeShared<FVoxelLandscapeAssetData>();
 
-	Width = InWidth;
-	Height = InHeight;
+	NewData->Heights = InHeights;
+	NewData->Materials = InMaterials;
 
-	MaxHeight = InMaxHeight;
-	MinHeight = InMinHeight;
+	NewData->Width = InWidth;
+	NewData->Height = InHeight;
+
+	NewData->MaxHeight = InMaxHeight;
+	NewData->MinHeight = InMinHeight;
+
+	Data = NewData;
 }
 
 void UVoxelLandscapeAsset::Save()
@@ -113,14 +131,14 @@ void UVoxelLandscapeAsset::Save()
 	FBufferArchive Archive;
 
 	// Heights are too random to benefit from RLE
-	Archive << Heights;
+	Archive << Data->Heights;
 	TArray<uint8> TmpData;
-	FVoxelUtilities::CompressRLE(Materials, TmpData);
+	FVoxelUtilities::CompressRLE(Data->Materials, TmpData);
 	Archive << TmpData;
-	Archive << Width;
-	Archive << Height;
-	Archive << MaxHeight;
-	Archive << MinHeight;
+	Archive << Data->Width;
+	Archive << Data->Height;
+	Archive << Data->MaxHeight;
+	Archive << Data->MinHeight;
 
 	int32 UncompressedSize = Archive.Num();
 	int32 CompressedSize = FCompression::CompressMemoryBound(CompressionFlags, UncompressedSize);
@@ -134,34 +152,34 @@ void UVoxelLandscapeAsset::Save()
 
 void UVoxelLandscapeAsset::LoadInternal()
 {
-	TArray<uint8> Data;
+	TArray<uint8> Uncompressed;
 
 	int32 UncompressedSize;
 	FMemory::Memcpy(&UncompressedSize, &CompressedData[0], sizeof(UncompressedSize));
-	Data.SetNum(UncompressedSize);
-	verify(FCompression::UncompressMemory(CompressionFlags, Data.GetData(), UncompressedSize, CompressedData.GetData() + sizeof(UncompressedSize), CompressedData.Num() - sizeof(UncompressedSize)));
-	
-	FMemoryReader Reader(Data);
-	Reader << Heights;
+	Uncompressed.SetNum(UncompressedSize);
+	verify(FCompression::UncompressMemory(CompressionFlags, Uncompressed.GetData(), UncompressedSize, CompressedData.GetData() + sizeof(UncompressedSize), CompressedData.Num() - sizeof(UncompressedSize)));
+
+	// New data, as the previous one might be used by instances
+	TSharedRef<FVoxelLandscapeAssetData> NewData = MakeShared<FVoxelLandscapeAssetData>();
+
+	FMemoryReader Reader(Uncompressed);
+	Reader << NewData->Heights;
 	TArray<uint8> TmpData;
 	Reader << TmpData;
-	FVoxelUtilities::DecompressRLE(TmpData, Materials);
-	Reader << Width;
-	Reader << Height;
-	Reader << MaxHeight;
-	Reader << MinHeight;
+	FVoxelUtilities::DecompressRLE(TmpData, NewData->Materials);
+	Reader << NewData->Width;
+	Reader << NewData->Height;
+	Reader << NewData->MaxHeight;
+	Reader << NewData->MinHeight;
+
+	Data = NewData;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
 FVoxelLandscapeAssetInstance::FVoxelLandscapeAssetInstance(
-	const TArray<float>& Heights,
-	const TArray<FVoxelMaterial>& Materials,
-	int Width,
-	int Height,
-	float MaxHeight,
-	float MinHeight,
+	const TSharedRef<const FVoxelLandscapeAssetData>& Data,
 	int Precision,
 	float HeightMultiplier,
 	float HeightOffset,
@@ -169,12 +187,7 @@ FVoxelLandscapeAssetInstance::FVoxelLandscapeAssetInstance(
 	int ScaleMultiplier,
 	bool bShrink,
 	const FIntVector& Position)
-	: Heights(Heights)
-	, Materials(Materials)
-	, Width(Width)
-	, Height(Height)
-	, MaxHeight(MaxHeight)
-	, MinHeight(MinHeight)
+	: Data(Data)
 	, Precision(Precision)
 	, HeightMultiplier(HeightMultiplier)
 	, HeightOffset(HeightOffset)
@@ -200,7 +213,7 @@ void FVoxelLandscapeAssetInstance::GetValuesAndMaterialsAndVoxelTypes(float InVa
 			const int IndexX = bShrink ? (X * ScaleMultiplier) : (X / ScaleMultiplier);
 			const int IndexY = bShrink ? (Y * ScaleMultiplier) : (Y / ScaleMultiplier);
 
-			if (0 <= IndexX && IndexX < Width && 0 <= IndexY && IndexY < Height)
+			if (0 <= IndexX && IndexX < Data->Width && 0 <= IndexY && IndexY < Data->Height)
 			{
 				const float CurrentHeight = GetHeight(IndexX, IndexY) * HeightMultiplier + HeightOffset;
 
@@ -292,6 +305,9 @@ void FVoxelLandscapeAssetInstance::GetValuesAndMaterialsAndVoxelTypes(float InVa
 
 bool FVoxelLandscapeAssetInstance::IsAssetEmpty(const FIntVector& Start, const int Step, const FIntVector& Size) const
 {
+	const float MaxHeight = Data->MaxHeight;
+	const float MinHeight = Data->MinHeight;
+
 	FIntBox Box = FIntBox(Start - Position , Start - Position + Size * Step);
 	FIntBox InfiniteZBox = GetLocalBounds();
 	InfiniteZBox.Min.Z = MIN_int32;
@@ -334,6 +350,11 @@ void FVoxelLandscapeAssetInstance::SetVoxelWorld(const AVoxelWorld* VoxelWorld)
 
 FIntBox FVoxelLandscapeAssetInstance::GetLocalBounds() const
 {
+	const int Width = Data->Width;
+	const int Height = Data->Height;
+	const float MaxHeight = Data->MaxHeight;
+	const float MinHeight = Data->MinHeight;
+
 	const int FinalWidth = bShrink ? FMath::FloorToInt((double)Width / (double)ScaleMultiplier) : (Width * ScaleMultiplier);
 	const int FinalHeight = bShrink ? FMath::FloorToInt((double)Height / (double)ScaleMultiplier) : (Height * ScaleMultiplier);
 
@@ -346,14 +367,14 @@ FIntBox FVoxelLandscapeAssetInstance::GetLocalBounds() const
 
 float FVoxelLandscapeAssetInstance::GetHeight(int X, int Y) const
 {
-	check(0 <= X && X < Width);
-	check(0 <= Y && Y < Height);
-	return Heights[X + Width * Y];
+	check(0 <= X && X < Data->Width);
+	check(0 <= Y && Y < Data->Height);
+	return Data->Heights[X + Data->Width * Y];
 }
 
 FVoxelMaterial FVoxelLandscapeAssetInstance::GetMaterial(int X, int Y) const
 {
-	check(0 <= X && X < Width);
-	check(0 <= Y && Y < Height);
-	return Materials[X + Width * Y];
+	check(0 <= X && X < Data->Width);
+	check(0 <= Y && Y < Data->Height);
+	return Data->Materials[X + Data->Width * Y];
 }
@@ -1,79 +1,236 @@
 // Copyright 2018 Phyronnaz
 
 #include "ValueOctree.h"
+#include "VoxelPrivate.h"
 #include "VoxelAsset.h"
 #include "VoxelWorldGenerator.h"
 #include "VoxelUtilities.h"
 #include "ScopeLock.h"
 
-FValueOctree::FValueOctree(TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, uint8 LOD, bool bMultiplayer)
+DECLARE_CYCLE_STAT(TEXT("FValueOctree::UpdateSummaries"), STAT_FValueOctree_UpdateSummaries, STATGROUP_Voxel);
+
+/**
+ * Signs of the values in a region. There's a surface if there are both positive and negative values
+ */
+namespace ERegionSigns
+{
+	enum Type : uint8
+	{
+		Positive = 0x01,
+		Negative = 0x02,
+		// Homogeneous world generator values, of unknown sign
+		Generator = 0x04,
+		// Might have a surface
+		Mixed = 0x08
+	};
+}
+
+FORCEINLINE uint8 GetSummarySigns(const FValueOctreeSummary& Summary)
+{
+	return Summary.MayHaveSurface() ? ERegionSigns::Mixed : Summary.Max <= 0 ? ERegionSigns::Negative : ERegionSigns::Positive;
+}
+
+FORCEINLINE bool HasSurface(uint8 Signs)
+{
+	return (Signs & ERegionSigns::Mixed) || ((Signs & ERegionSigns::Positive) && (Signs & ERegionSigns::Negative));
+}
+
+FValueOctree::FValueOctree(TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, uint8 LOD, bool bMultiplayer, FValueOctreeContext& Context)
 	: TVoxelOctree(LOD)
-	, WorldGenerator(WorldGenerator)
-	, bIsDirty(false)
-	, bIsNetworkDirty(false)
 	, bMultiplayer(bMultiplayer)
-	, Values(nullptr)
-	, Materials(nullptr)
+	, Context(Context)
+	, State(new FValueOctreeState(WorldGenerator, 0))
+	, PendingState(nullptr)
+	, PendingStateThreadId(0)
+	, bIsNetworkDirty(false)
+	, bIsSaveDirty(false)
 {
 
 }
 
 FValueOctree::FValueOctree(FValueOctree* Parent, uint8 ChildIndex)
 	: TVoxelOctree(Parent, ChildIndex)
-	, WorldGenerator(Parent->WorldGenerator)
-	, bIsDirty(false)
-	, bIsNetworkDirty(false)
 	, bMultiplayer(Parent->bMultiplayer)
-	, Values(nullptr)
-	, Materials(nullptr)
+	, Context(Parent->Context)
+	, State(new FValueOctreeState(Parent->GetLastState().WorldGenerator, Parent->GetLastState().WorldGeneratorGeneration))
+	, PendingState(nullptr)
+	, PendingStateThreadId(0)
+	, bIsNetworkDirty(false)
+	, bIsSaveDirty(false)
 {
-
+	// Take our assets before being visible to the readers
+	for (auto& Asset : Parent->GetLastState().Assets)
+	{
+		if (GetBounds().Intersect(Asset->GetWorldBounds()))
+		{
+			State->Assets.Add(Asset);
+		}
+	}
 }
 
 FValueOctree::~FValueOctree()
 {
-	if (Values)
+	delete State;
+	if (PendingState)
 	{
-		delete[] Values;
+		delete PendingState;
 	}
-	if (Materials)
+}
+
+FValueOctree::FStateReader::FStateReader(const FValueOctree& Octree)
+{
+	if (Octree.PendingStateThreadId == FPlatformTLS::GetCurrentThreadId())
+	{
+		// The writer reads its own edits
+		ReadState = Octree.PendingState;
+		ReadState->NumReaders.Increment();
+	}
+	else
 	{
-		delete[] Materials;
+		// Must be done under the lock, else the state could be deleted in between
+		FScopeLock Lock(&Octree.StateSection);
+		ReadState = Octree.State;
+		ReadState->NumReaders.Increment();
 	}
 }
 
+FValueOctree::FStateReader::~FStateReader()
+{
+	ReadState->NumReaders.Decrement();
+}
+
 bool FValueOctree::IsDirty() const
 {
 	check(LOD == 0);
-	return bIsDirty;
+	return GetLastState().DirtyData.IsValid();
 }
 
 bool FValueOctree::IsEmpty(const FIntVector& Start, const int Step, const FIntVector& Size) const
 {
-	FIntBox InBounds(Start, Start + Size * Step);
-	
-	for (const auto& Asset : Assets)
+	const FIntBox InBounds(Start, Start + Size * Step);
+
+	const uint8 Signs = GetRegionSigns(InBounds, Start, Step, Size);
+	if (HasSurface(Signs))
+	{
+		return false;
+	}
+
+	if ((Signs & ERegionSigns::Generator) && (Signs & (ERegionSigns::Positive | ERegionSigns::Negative)))
+	{
+		// The generator values are homogeneous: one is enough to know their sign
+		FStateReader NodeState(*this);
+		float Value;
+		FVoxelMaterial Material;
+		NodeState->WorldGenerator->GetValueAndMaterial(Start.X, Start.Y, Start.Z, Value, Material);
+		return !HasSurface(Signs | (Value <= 0 ? ERegionSigns::Negative : ERegionSigns::Positive));
+	}
+
+	return true;
+}
+
+FValueOctreeSummary FValueOctree::GetSummary() const
+{
+	FStateReader NodeState(*this);
+	return GetSummary(*NodeState);
+}
+
+bool FValueOctree::GetBoxWithoutSurface(const FIntVector& P, FIntBox& OutBox) const
+{
+	check(IsInOctree(P.X, P.Y, P.Z));
+
+	FStateReader NodeState(*this);
+
+	if (!IsLeaf())
+	{
+		const FValueOctreeSummary Summary = GetSummary(*NodeState);
+		if (Summary.bIsFullyEdited && !Summary.MayHaveSurface())
+		{
+			OutBox = GetBounds();
+			return true;
+		}
+		return GetChild(P)->GetBoxWithoutSurface(P, OutBox);
+	}
+
+	if (NodeState->DirtyData.IsValid())
+	{
+		OutBox = GetBounds();
+		return !GetSummary(*NodeState).MayHaveSurface();
+	}
+
+	// Big leaves usually have a surface somewhere: try smaller boxes around P, down to the data chunks
+	const FIntVector LeafMin = GetMinimalCornerPosition();
+	for (int BoxSize = Size(); ; BoxSize /= 2)
 	{
-		if (Asset->GetWorldBounds().Intersect(InBounds) && !Asset->IsEmpty(Start, Step, Size))
+		const FIntVector Min = LeafMin + ((P - LeafMin) / BoxSize) * BoxSize;
+		const FIntVector BoxSize3(BoxSize, BoxSize, BoxSize);
+		OutBox = FIntBox(Min, Min + BoxSize3);
+
+		// The assets values might not have the same sign as the generator ones
+		bool bHasAsset = false;
+		for (const auto& Asset : NodeState->Assets)
+		{
+			if (Asset->GetWorldBounds().Intersect(OutBox))
+			{
+				bHasAsset = true;
+				break;
+			}
+		}
+
+		if (!bHasAsset && NodeState->WorldGenerator->IsEmpty(Min, 1, BoxSize3))
+		{
+			return true;
+		}
+		if (BoxSize <= DATA_CHUNK_SIZE)
 		{
 			return false;
 		}
 	}
+}
+
+uint8 FValueOctree::GetRegionSigns(const FIntBox& InBounds, const FIntVector& Start, const int Step, const FIntVector& Size) const
+{
+	FStateReader NodeState(*this);
 
 	if (IsLeaf())
 	{
-		return (LOD != 0 || !IsDirty()) && WorldGenerator->IsEmpty(Start, Step, Size);
+		if (NodeState->DirtyData.IsValid())
+		{
+			// The chunk bounds are conservative for the region
+			return GetSummarySigns(GetSummary(*NodeState));
+		}
+
+		for (const auto& Asset : NodeState->Assets)
+		{
+			if (Asset->GetWorldBounds().Intersect(InBounds) && !Asset->IsEmpty(Start, Step, Size))
+			{
+				return ERegionSigns::Mixed;
+			}
+		}
+
+		return NodeState->WorldGenerator->IsEmpty(Start, Step, Size) ? ERegionSigns::Generator : ERegionSigns::Mixed;
 	}
 	else
 	{
+		const FValueOctreeSummary Summary = GetSummary(*NodeState);
+		if (Summary.bIsFullyEdited)
+		{
+			// No need to go down to the leaves
+			return GetSummarySigns(Summary);
+		}
+
+		uint8 Signs = 0;
 		for (auto Child : GetChilds())
 		{
-			if (Child->GetBounds().Intersect(InBounds) && !Child->IsEmpty(Start, Step, Size))
+			if (Child->GetBounds().Intersect(InBounds))
 			{
-				return false;
+				Signs |= Child->GetRegionSigns(InBounds, Start, Step, Size);
+				if (HasSurface(Signs))
+				{
+					break;
+				}
 			}
 		}
-		return true;
+		return Signs;
 	}
 }
 
@@ -89,7 +246,13 @@ void FValueOctree::GetValuesAndMaterials(float InValues[], FVoxelMaterial InMate
 
 	if (IsLeaf())
 	{
-		if (LOD == 0 && IsDirty())
+		FStateReader LeafState(*this);
+		const FVoxelCompactChunk* const DirtyData = LeafState->DirtyData.Get();
+		const TArray<TSharedRef<FVoxelAssetInstance>>& Assets = LeafState->Assets;
+		FVoxelWorldGeneratorInstance& WorldGenerator = LeafState->WorldGenerator.Get();
+
+		// If the chunk can't be read, use the world generator until it can
+		if (DirtyData && DirtyData->EnsureDecompressed())
 		{
 			for (int I = 0; I < Size.X; I++)
 			{
@@ -109,11 +272,11 @@ void FValueOctree::GetValuesAndMaterials(float InValues[], FVoxelMaterial InMate
 
 						if (InValues)
 						{
-							InValues[Index] = Values[LocalIndex];
+							InValues[Index] = DirtyData->GetValue(LocalIndex);
 						}
 						if (InMaterials)
 						{
-							InMaterials[Index] = Materials[LocalIndex];
+							InMaterials[Index] = DirtyData->GetMaterial(LocalIndex);
 						}
 					}
 				}
@@ -168,7 +331,7 @@ void FValueOctree::GetValuesAndMaterials(float InValues[], FVoxelMaterial InMate
 								}
 								if (MaterialType != EVoxelMaterialType::UseMaterial)
 								{
-									Material = WorldGenerator->GetMaterial(X, Y, Z);
+									Material = WorldGenerator.GetMaterial(X, Y, Z);
 								}
 							}
 							InMaterials[GlobalIndex] = Material;
@@ -218,7 +381,7 @@ void FValueOctree::GetValuesAndMaterials(float InValues[], FVoxelMaterial InMate
 								}
 								if (ValueType != EVoxelValueType::UseValue)
 								{
-									Stack.Add(FTmpValueTypeValue(EVoxelValueType::UseValue, WorldGenerator->GetValue(X, Y, Z)));
+									Stack.Add(FTmpValueTypeValue(EVoxelValueType::UseValue, WorldGenerator.GetValue(X, Y, Z)));
 								}
 
 								float LastValue = Stack.Last().Value;
@@ -255,7 +418,7 @@ void FValueOctree::GetValuesAndMaterials(float InValues[], FVoxelMaterial InMate
 		}
 		else
 		{
-			WorldGenerator->GetValuesAndMaterialsAndVoxelTypes(InValues, InMaterials, nullptr, Start, StartIndex, Step, Size, ArraySize);
+			Context.GeneratorCache.GetValuesAndMaterials(WorldGenerator, LeafState->WorldGeneratorGeneration, InValues, InMaterials, Start, StartIndex, Step, Size, ArraySize);
 		}
 	}
 	else if (Size.X == 1 && Size.Y == 1 && Size.Z == 1 && false)
@@ -554,6 +717,7 @@ void FValueOctree::SetValueAndMaterial(int X, int Y, int Z, float Value, FVoxelM
 	check(IsInOctree(X, Y, Z));
 
 	bIsNetworkDirty = true;
+	bIsSaveDirty = true;
 
 	if (LOD != 0)
 	{
@@ -570,23 +734,33 @@ void FValueOctree::SetValueAndMaterial(int X, int Y, int Z, float Value, FVoxelM
 		int LocalX, LocalY, LocalZ;
 		GlobalToLocal(X, Y, Z, LocalX, LocalY, LocalZ);
 
+		FVoxelCompactChunk& DirtyData = GetPendingDirtyData();
+
 		uint32 Index = IndexFromCoordinates(LocalX, LocalY, LocalZ);
 		if (bSetValue)
 		{
-			Values[Index] = Value;
+			DirtyData.SetValue(Index, Value);
 
 			if (bMultiplayer)
 			{
-				DirtyValues.Add(Index);
+				if (DirtyValues.Num() == 0)
+				{
+					DirtyValues.Init(false, DATA_CHUNK_TOTAL_SIZE);
+				}
+				DirtyValues[Index] = true;
 			}
 		}
 		if (bSetMaterial)
 		{
-			Materials[Index] = Material;
+			DirtyData.SetMaterial(Index, Material);
 
 			if (bMultiplayer)
 			{
-				DirtyMaterials.Add(Index);
+				if (DirtyMaterials.Num() == 0)
+				{
+					DirtyMaterials.Init(false, DATA_CHUNK_TOTAL_SIZE);
+				}
+				DirtyMaterials[Index] = true;
 			}
 		}
 	}
@@ -596,16 +770,11 @@ void FValueOctree::SetAsNotDirty()
 {
 	check(LOD == 0);
 
-	bIsDirty = false;
-	if (Values)
-	{
-		delete Values;
-		Values = nullptr;
-	}
-	if (Materials)
+	if (IsDirty())
 	{
-		delete Materials;
-		Materials = nullptr;
+		GetPendingState().DirtyData.Reset();
+		Context.bHasResetSavedChunks = true;
+		bIsSaveDirty = false;
 	}
 }
 
@@ -617,10 +786,16 @@ void FValueOctree::AddAsset(TSharedRef<FVoxelAssetInstance> Asset)
 		{
 			if (LOD != 0 || !IsDirty())
 			{
-				Assets.EmplaceAt(0, Asset);
+				GetPendingState().Assets.EmplaceAt(0, Asset);
 			}
 			else
 			{
+				bIsSaveDirty = true;
+
+				FVoxelCompactChunk& DirtyData = GetPendingDirtyData();
+				float* Values = DirtyData.GetRawValues();
+				FVoxelMaterial* Materials = DirtyData.GetRawMaterials();
+
 				for (int X = 0; X < DATA_CHUNK_SIZE; X++)
 				{
 					for (int Y = 0; Y < DATA_CHUNK_SIZE; Y++)
@@ -669,28 +844,76 @@ void FValueOctree::AddAsset(TSharedRef<FVoxelAssetInstance> Asset)
 
 void FValueOctree::RemoveAssets()
 {
-	Assets.Empty();
+	if (GetLastState().Assets.Num() > 0)
+	{
+		GetPendingState().Assets.Empty();
+	}
 }
 
 
-void FValueOctree::AddDirtyChunksToSaveQueue(TArray<FVoxelChunkSave>& SaveQueue)
+void FValueOctree::AddDirtyChunksToSaveQueue(TArray<FVoxelChunkSave>& SaveQueue, bool bOnlyEditedSinceLastSave)
 {
 	if (IsLeaf())
 	{
-		if (LOD == 0 && IsDirty())
+		if (LOD == 0 && IsDirty() && (bIsSaveDirty || !bOnlyEditedSinceLastSave))
 		{
-			SaveQueue.Add(FVoxelChunkSave(Id, Position, Values, Materials));
+			if (AddToSaveQueue(SaveQueue))
+			{
+				bIsSaveDirty = false;
+			}
 		}
 	}
 	else
 	{
 		for (auto Child : GetChilds())
 		{
-			Child->AddDirtyChunksToSaveQueue(SaveQueue);
+			Child->AddDirtyChunksToSaveQueue(SaveQueue, bOnlyEditedSinceLastSave);
 		}
 	}
 }
 
+void FValueOctree::AddDirtyChunksInBoxesToSaveQueue(const TArray<FIntBox>& Boxes, const TArray<FIntBox>& ExcludedBoxes, TArray<FVoxelChunkSave>& SaveQueue)
+{
+	if (!Boxes.ContainsByPredicate([&](const FIntBox& Box) { return Box.Intersect(GetBounds()); }))
+	{
+		return;
+	}
+
+	if (IsLeaf())
+	{
+		if (LOD == 0 && IsDirty() && !ExcludedBoxes.ContainsByPredicate([&](const FIntBox& Box) { return Box.Intersect(GetBounds()); }))
+		{
+			AddToSaveQueue(SaveQueue);
+		}
+	}
+	else
+	{
+		for (auto Child : GetChilds())
+		{
+			Child->AddDirtyChunksInBoxesToSaveQueue(Boxes, ExcludedBoxes, SaveQueue);
+		}
+	}
+}
+
+bool FValueOctree::AddToSaveQueue(TArray<FVoxelChunkSave>& SaveQueue) const
+{
+	const FVoxelCompactChunk& DirtyData = *GetLastState().DirtyData;
+	if (!DirtyData.EnsureDecompressed())
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Voxel chunk at %s not saved: it couldn't be read"), *GetMinimalCornerPosition().ToString());
+		return false;
+	}
+
+	// Large: filled in place
+	FVoxelChunkSave& Save = SaveQueue[SaveQueue.AddDefaulted()];
+	Save.Id = Id;
+	Save.Position = GetMinimalCornerPosition();
+	Save.Values.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+	Save.Materials.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+	DirtyData.GetValuesAndMaterials(Save.Values.GetData(), Save.Materials.GetData());
+	return true;
+}
+
 void FValueOctree::LoadFromSaveQueueAndGetModifiedPositions(TArray<FVoxelChunkSave>& SaveQueue, TArray<FIntVector>& OutModifiedPositions)
 {
 	if (SaveQueue.Num() == 0)
@@ -702,29 +925,14 @@ void FValueOctree::LoadFromSaveQueueAndGetModifiedPositions(TArray<FVoxelChunkSa
 	{
 		if (SaveQueue.Last().Id == Id)
 		{
-			bIsDirty = true;
-			if (!Values)
-			{
-				Values = new float[DATA_CHUNK_TOTAL_SIZE];
-			}
-			if (!Materials)
-			{
-				Materials = new FVoxelMaterial[DATA_CHUNK_TOTAL_SIZE];
-			}
+			TSharedRef<FVoxelCompactChunk> DirtyData = MakeShared<FVoxelCompactChunk>();
 
-			auto Last = SaveQueue.Pop(false);
-			for (int X = 0; X < DATA_CHUNK_SIZE; X++)
-			{
-				for (int Y = 0; Y < DATA_CHUNK_SIZE; Y++)
-				{
-					for (int Z = 0; Z < DATA_CHUNK_SIZE; Z++)
-					{
-						const uint32 Index = IndexFromCoordinates(X, Y, Z);
-						Values[Index] = Last.Values[Index];
-						Materials[Index] = Last.Materials[Index];
-					}
-				}
-			}
+			const FVoxelChunkSave& Last = SaveQueue.Last();
+			FMemory::Memcpy(DirtyData->GetRawValues(), Last.Values.GetData(), DATA_CHUNK_TOTAL_SIZE * sizeof(float));
+			FMemory::Memcpy(DirtyData->GetRawMaterials(), Last.Materials.GetData(), DATA_CHUNK_TOTAL_SIZE * sizeof(FVoxelMaterial));
+			SaveQueue.Pop(false);
+
+			GetPendingState().DirtyData = DirtyData;
 
 			// Update neighbors
 			const int S = Size();
@@ -767,22 +975,26 @@ void FValueOctree::AddChunksToDiffQueues(TArray<FVoxelValueDiff>& OutValueDiffQu
 {
 	if (IsLeaf())
 	{
-		if (bIsNetworkDirty)
+		const TSharedPtr<FVoxelCompactChunk>& DirtyData = GetLastState().DirtyData;
+		// Else sent on the next sync
+		if (bIsNetworkDirty && (!DirtyData.IsValid() || DirtyData->EnsureDecompressed()))
 		{
 			bIsNetworkDirty = false;
 
-			for (int Index : DirtyValues)
+			for (TConstSetBitIterator<> It(DirtyValues); It; ++It)
 			{
+				const int Index = It.GetIndex();
 				check(0 <= Index && Index < DATA_CHUNK_TOTAL_SIZE);
-				OutValueDiffQueue.Add(FVoxelValueDiff(Id, Index, Values[Index]));
+				OutValueDiffQueue.Add(FVoxelValueDiff(Id, Index, DirtyData->GetValue(Index)));
 			}
-			for (int Index : DirtyMaterials)
+			for (TConstSetBitIterator<> It(DirtyMaterials); It; ++It)
 			{
+				const int Index = It.GetIndex();
 				check(0 <= Index && Index < DATA_CHUNK_TOTAL_SIZE);
-				OutColorDiffQueue.Add(FVoxelMaterialDiff(Id, Index, Materials[Index]));
+				OutColorDiffQueue.Add(FVoxelMaterialDiff(Id, Index, DirtyData->GetMaterial(Index)));
 			}
-			DirtyValues.Empty(DATA_CHUNK_TOTAL_SIZE);
-			DirtyMaterials.Empty(DATA_CHUNK_TOTAL_SIZE);
+			DirtyValues.Empty();
+			DirtyMaterials.Empty();
 		}
 	}
 	else
@@ -804,9 +1016,10 @@ void FValueOctree::LoadValueDiff(FVoxelValueDiff& Diff, TArray<FIntVector>& OutM
 		{
 			SetAsDirtyAndSetDefaultValues();
 		}
+		bIsSaveDirty = true;
 
 		check(0 <= Diff.Index && Diff.Index < DATA_CHUNK_TOTAL_SIZE);
-		Values[Diff.Index] = Diff.Value;
+		GetPendingDirtyData().SetValue(Diff.Index, Diff.Value);
 
 		int X, Y, Z;
 		CoordinatesFromIndex(Diff.Index, X, Y, Z);
@@ -840,9 +1053,10 @@ void FValueOctree::LoadMaterialDiff(FVoxelMaterialDiff& Diff, TArray<FIntVector>
 		{
 			SetAsDirtyAndSetDefaultValues();
 		}
+		bIsSaveDirty = true;
 
 		check(0 <= Diff.Index && Diff.Index < DATA_CHUNK_TOTAL_SIZE);
-		Materials[Diff.Index] = Diff.Material;
+		GetPendingDirtyData().SetMaterial(Diff.Index, Diff.Material);
 
 		int X, Y, Z;
 		CoordinatesFromIndex(Diff.Index, X, Y, Z);
@@ -869,36 +1083,34 @@ void FValueOctree::LoadMaterialDiff(FVoxelMaterialDiff& Diff, TArray<FIntVector>
 
 void FValueOctree::CreateChilds()
 {
+	// The childs copy our assets
 	TVoxelOctree::CreateChilds();
-	
-	for (auto Child : GetChilds())
+
+	// We aren't read anymore
+	const TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator = GetLastState().WorldGenerator;
+	const uint32 WorldGeneratorGeneration = GetLastState().WorldGeneratorGeneration;
+	if (PendingState)
 	{
-		for (auto& Asset : Assets)
-		{
-			if (Child->GetBounds().Intersect(Asset->GetWorldBounds()))
-			{
-				Child->Assets.Add(Asset);
-			}
-		}
+		delete PendingState;
+		PendingState = nullptr;
+		PendingStateThreadId = 0;
 	}
-	Assets.Reset();
+	SetState(new FValueOctreeState(WorldGenerator, WorldGeneratorGeneration));
 }
 
 void FValueOctree::SetAsDirtyAndSetDefaultValues()
 {
 	check(!IsDirty());
 	check(LOD == 0);
-	check(!Values);
-	check(!Materials);
 
-	Values = new float[DATA_CHUNK_TOTAL_SIZE];
-	Materials = new FVoxelMaterial[DATA_CHUNK_TOTAL_SIZE];
+	TSharedRef<FVoxelCompactChunk> DirtyData = MakeShared<FVoxelCompactChunk>();
 
 	FIntVector Min = GetMinimalCornerPosition();
-	GetValuesAndMaterials(Values, Materials, FIntVector(Min.X, Min.Y, Min.Z), FIntVector::ZeroValue, 1, FIntVector(DATA_CHUNK_SIZE, DATA_CHUNK_SIZE, DATA_CHUNK_SIZE), FIntVector(DATA_CHUNK_SIZE, DATA_CHUNK_SIZE, DATA_CHUNK_SIZE));
-	Assets.Reset();
+	GetValuesAndMaterials(DirtyData->GetRawValues(), DirtyData->GetRawMaterials(), FIntVector(Min.X, Min.Y, Min.Z), FIntVector::ZeroValue, 1, FIntVector(DATA_CHUNK_SIZE, DATA_CHUNK_SIZE, DATA_CHUNK_SIZE), FIntVector(DATA_CHUNK_SIZE, DATA_CHUNK_SIZE, DATA_CHUNK_SIZE));
 
-	bIsDirty = true;
+	FValueOctreeState& NewState = GetPendingState();
+	NewState.DirtyData = DirtyData;
+	NewState.Assets.Reset();
 }
 
 uint32 FValueOctree::IndexFromCoordinates(int X, int Y, int Z) const
@@ -942,15 +1154,17 @@ void FValueOctree::GetPositionsToUpdate(TArray<FIntVector>& OutPositions)
 	}
 }
 
-void FValueOctree::SetWorldGenerator(TSharedRef<FVoxelWorldGeneratorInstance> NewGenerator)
+void FValueOctree::SetWorldGenerator(TSharedRef<FVoxelWorldGeneratorInstance> NewGenerator, uint32 NewGeneration)
 {
-	WorldGenerator = NewGenerator;
+	FValueOctreeState& NewState = GetPendingState();
+	NewState.WorldGenerator = NewGenerator;
+	NewState.WorldGeneratorGeneration = NewGeneration;
 
 	if (!IsLeaf())
 	{
 		for (auto& Child : GetChilds())
 		{
-			Child->SetWorldGenerator(NewGenerator);
+			Child->SetWorldGenerator(NewGenerator, NewGeneration);
 		}
 	}
 }
@@ -984,8 +1198,12 @@ void FValueOctree::DiscardValuesByPredicate(const std::function<int(const FIntBo
 					bNewChunk = true;
 					SetAsDirtyAndSetDefaultValues();
 				}
-				check(Values);
-				check(Materials);
+				bIsSaveDirty = true;
+
+				FVoxelCompactChunk& DirtyData = GetPendingDirtyData();
+				float* Values = DirtyData.GetRawValues();
+				FVoxelMaterial* Materials = DirtyData.GetRawMaterials();
+				FVoxelWorldGeneratorInstance& WorldGenerator = GetLastState().WorldGenerator.Get();
 
 				for (int X = 0; X < DATA_CHUNK_SIZE; X++)
 				{
@@ -1003,7 +1221,7 @@ void FValueOctree::DiscardValuesByPredicate(const std::function<int(const FIntBo
 								if (!bNewChunk)
 								{
 									const int Index = IndexFromCoordinates(X, Y, Z);
-									WorldGenerator->GetValueAndMaterial(GlobalPos.X, GlobalPos.Y, GlobalPos.Z, Values[Index], Materials[Index]);
+									WorldGenerator.GetValueAndMaterial(GlobalPos.X, GlobalPos.Y, GlobalPos.Z, Values[Index], Materials[Index]);
 								}
 							}
 							else if (LocalResult == 1)
@@ -1048,147 +1266,185 @@ void FValueOctree::SetEntireChunkAsNotDirty()
 	}
 }
 
-void FValueOctree::BeginSet(const FIntBox& Box, TArray<uint64>& Ids)
+void FValueOctree::CompressColdChunks(double Time, double MinIdleTime, double MinPagingIdleTime, int& MaxChunks)
 {
-	if (GetBounds().Intersect(Box))
+	if (MaxChunks <= 0)
 	{
-		MainLock.lock();
-		MainLock.unlock();
-
-		check(GetCounter.GetValue() == 0);
-		check(SetCounter.GetValue() == 0);
-		
-		if (IsLeaf())
-		{
-			// Lock
-			MainLock.lock();
-			SetCounter.Increment();
-			Ids.Add(Id);
+		return;
+	}
 
-			// Unlock transactions
-			TransactionLock.unlock();
-		}
-		else
+	if (IsLeaf())
+	{
+		if (LOD == 0 && IsDirty() && GetLastState().DirtyData->IsCold(Time, MinIdleTime))
 		{
-			// First lock childs
-			for (auto Child : GetChilds())
+			// Compress a copy, as the readers might use the current chunk
+			TSharedRef<FVoxelCompactChunk> DirtyData = MakeShared<FVoxelCompactChunk>(*GetLastState().DirtyData);
+			if (DirtyData->CompressIfCold(Time, MinIdleTime))
 			{
-				Child->LockTransactions();
+				MaxChunks--;
 			}
-			// Then unlock this
-			TransactionLock.unlock();
-			
-			// Finally propagate to childs
-			for (auto Child : GetChilds())
+			// Even if it failed, so that we don't try again next time
+			GetPendingState().DirtyData = DirtyData;
+		}
+		else if (LOD == 0 && IsDirty() && MinPagingIdleTime > 0 && GetLastState().DirtyData->CanPageOut(Time, MinPagingIdleTime))
+		{
+			// Same as above: the readers might use the current chunk
+			TSharedPtr<FVoxelCompactChunk> DirtyData = GetLastState().DirtyData->CreatePagedCopy(Context.GetPageStore());
+			if (DirtyData.IsValid())
 			{
-				Child->BeginSet(Box, Ids);
+				GetPendingState().DirtyData = DirtyData;
+				MaxChunks--;
 			}
 		}
 	}
 	else
-	{		
-		TransactionLock.unlock();
-	}
-}
-
-void FValueOctree::EndSet(TArray<uint64>& Ids)
-{
-	if (Ids.Num() > 0)
 	{
-		if (Ids.Last() == Id)
+		for (auto Child : GetChilds())
 		{
-			Ids.Pop(false);
-			SetCounter.Decrement();
-
-			check(GetCounter.GetValue() == 0);
-			check(SetCounter.GetValue() == 0);
-
-			MainLock.unlock();
-		}
-
-		if (Ids.Num() > 0)
-		{
-			if (IsIdChild(Ids.Last()))
-			{
-				for (auto Child : GetChilds())
-				{
-					Child->EndSet(Ids);
-				}
-			}
+			Child->CompressColdChunks(Time, MinIdleTime, MinPagingIdleTime, MaxChunks);
 		}
 	}
 }
 
-void FValueOctree::BeginGet(const FIntBox& Box, TArray<uint64>& Ids)
+FValueOctreeState& FValueOctree::GetPendingState()
 {
-	if (GetBounds().Intersect(Box))
+	if (!PendingState)
 	{
-		MainLock.lock_shared();
-		MainLock.unlock_shared();
+		PendingState = new FValueOctreeState(*State);
+		PendingStateThreadId = FPlatformTLS::GetCurrentThreadId();
+		Context.EditedOctrees.Add(this);
+	}
+	return *PendingState;
+}
 
-		check(SetCounter.GetValue() == 0);
+FVoxelCompactChunk& FValueOctree::GetPendingDirtyData()
+{
+	FValueOctreeState& NewState = GetPendingState();
+	check(NewState.DirtyData.IsValid());
 
-		if (IsLeaf())
+	if (NewState.DirtyData == State->DirtyData)
+	{
+		if (State->DirtyData->EnsureDecompressed())
 		{
-			// Lock
-			MainLock.lock_shared();
-			GetCounter.Increment();
-			Ids.Add(Id);
-
-			// Unlock transactions
-			TransactionLock.unlock();
+			NewState.DirtyData = MakeShared<FVoxelCompactChunk>(*State->DirtyData);
 		}
 		else
 		{
-			// First lock childs
-			for (auto Child : GetChilds())
-			{
-				Child->LockTransactions();
-			}
-			// Then unlock this
-			TransactionLock.unlock();
+			UE_LOG(LogVoxel, Error, TEXT("Voxel chunk at %s lost: it couldn't be read. Using the world generator values"), *GetMinimalCornerPosition().ToString());
 
-			// Finally propagate to childs
-			for (auto Child : GetChilds())
-			{
-				Child->BeginGet(Box, Ids);
-			}
+			// The readers fall back to the world generator too
+			TSharedRef<FVoxelCompactChunk> DirtyData = MakeShared<FVoxelCompactChunk>();
+			GetValuesAndMaterials(DirtyData->GetRawValues(), DirtyData->GetRawMaterials(), GetMinimalCornerPosition(), FIntVector::ZeroValue, 1, FIntVector(DATA_CHUNK_SIZE, DATA_CHUNK_SIZE, DATA_CHUNK_SIZE), FIntVector(DATA_CHUNK_SIZE, DATA_CHUNK_SIZE, DATA_CHUNK_SIZE));
+			NewState.DirtyData = DirtyData;
 		}
 	}
-	else
+	return *NewState.DirtyData;
+}
+
+void FValueOctree::SetState(FValueOctreeState* NewState)
+{
+	FValueOctreeState* OldState;
 	{
-		TransactionLock.unlock();
+		FScopeLock Lock(&StateSection);
+		OldState = State;
+		State = NewState;
 	}
+	Context.RetiredStates.Add(OldState);
 }
 
-void FValueOctree::EndGet(TArray<uint64>& Ids)
+void FValueOctree::PublishPendingState()
 {
-	if (Ids.Num() > 0)
+	if (PendingState)
 	{
-		if (Ids.Last() == Id)
+		// Edits are done
+		if (PendingState->DirtyData.IsValid())
 		{
-			Ids.Pop(false);
-			GetCounter.Decrement();
+			PendingState->DirtyData->Pack();
+		}
 
-			check(SetCounter.GetValue() == 0);
+		SetState(PendingState);
+		PendingState = nullptr;
+		PendingStateThreadId = 0;
+	}
+}
 
-			MainLock.unlock_shared();
-		}
+FValueOctreeSummary FValueOctree::GetSummary(const FValueOctreeState& NodeState) const
+{
+	if (!IsLeaf())
+	{
+		return NodeState.Summary;
+	}
+	else if (NodeState.DirtyData.IsValid())
+	{
+		const FVoxelCompactChunk& DirtyData = *NodeState.DirtyData;
+		// Not packed: being edited by this thread
+		return DirtyData.IsPacked() ? FValueOctreeSummary(DirtyData.GetMinValue(), DirtyData.GetMaxValue(), true) : FValueOctreeSummary(-MAX_flt, MAX_flt, true);
+	}
+	else
+	{
+		return FValueOctreeSummary();
+	}
+}
+
+void FValueOctree::UpdateSummaries(const TArray<FIntBox>& EditedBounds)
+{
+	check(!IsLeaf());
 
-		if (Ids.Num() > 0)
+	FValueOctreeSummary NewSummary(MAX_flt, -MAX_flt, true);
+	TArray<FIntBox> ChildEditedBounds;
+	for (auto Child : GetChilds())
+	{
+		if (!Child->IsLeaf())
 		{
-			if (IsIdChild(Ids.Last()))
+			ChildEditedBounds.Reset();
+			for (auto& Box : EditedBounds)
 			{
-				for (auto Child : GetChilds())
+				if (Box.Intersect(Child->GetBounds()))
 				{
-					Child->EndGet(Ids);
+					ChildEditedBounds.Add(Box);
 				}
 			}
+			if (ChildEditedBounds.Num() > 0)
+			{
+				Child->UpdateSummaries(ChildEditedBounds);
+			}
 		}
+		NewSummary.Add(Child->GetSummary(Child->GetLastState()));
+	}
+
+	if (!(NewSummary == State->Summary))
+	{
+		// Published states are never modified
+		FValueOctreeState* NewState = new FValueOctreeState(*State);
+		NewState->Summary = NewSummary;
+		SetState(NewState);
 	}
 }
 
-void FValueOctree::LockTransactions()
+void FValueOctree::PublishPendingStates()
 {
-	TransactionLock.lock();
+	TArray<FIntBox> EditedBounds;
+	for (auto Octree : Context.EditedOctrees)
+	{
+		EditedBounds.Add(Octree->GetBounds());
+		Octree->PublishPendingState();
+	}
+	Context.EditedOctrees.Reset();
+
+	if (EditedBounds.Num() > 0 && !IsLeaf())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FValueOctree_UpdateSummaries);
+		UpdateSummaries(EditedBounds);
+	}
+
+	// New readers can't get the retired states: they can be deleted once their last reader is done
+	Context.RetiredStates.RemoveAllSwap([](FValueOctreeState* RetiredState)
+	{
+		if (RetiredState->NumReaders.GetValue() == 0)
+		{
+			delete RetiredState;
+			return true;
+		}
+		return false;
+	});
 }
@@ -2,41 +2,172 @@
 
 #pragma once
 
-#include <shared_mutex>
-
 #include "CoreMinimal.h"
 #include "Octree.h"
 #include "VoxelSave.h"
 #include "VoxelDiff.h"
-#include "ThreadSafeBool.h"
+#include "ThreadSafeCounter.h"
 #include "VoxelGlobals.h"
+#include "VoxelCompactChunk.h"
+#include "VoxelGeneratorCache.h"
+#include "VoxelPageStore.h"
 
 class FVoxelWorldGeneratorInstance;
 class FVoxelAssetInstance;
+class FValueOctree;
+
+/**
+ * Conservative bounds of the values of a FValueOctree node, to skip homogeneous regions without going down to the leaves
+ */
+struct FValueOctreeSummary
+{
+	// Bounds of the edited values. Min > Max if none
+	float Min;
+	float Max;
+	// Are all the leaves edited? Else the world generator and the assets values must be checked too
+	bool bIsFullyEdited;
+
+	FValueOctreeSummary()
+		: Min(MAX_flt)
+		, Max(-MAX_flt)
+		, bIsFullyEdited(false)
+	{
+	}
+	FValueOctreeSummary(float Min, float Max, bool bIsFullyEdited)
+		: Min(Min)
+		, Max(Max)
+		, bIsFullyEdited(bIsFullyEdited)
+	{
+	}
+
+	/**
+	 * Are there values on both sides of the surface? Values > 0 are empty
+	 */
+	FORCEINLINE bool MayHaveSurface() const
+	{
+		return Min <= 0 && 0 < Max;
+	}
+
+	FORCEINLINE void Add(const FValueOctreeSummary& Other)
+	{
+		Min = FMath::Min(Min, Other.Min);
+		Max = FMath::Max(Max, Other.Max);
+		bIsFullyEdited &= Other.bIsFullyEdited;
+	}
+
+	FORCEINLINE bool operator==(const FValueOctreeSummary& Other) const
+	{
+		return Min == Other.Min && Max == Other.Max && bIsFullyEdited == Other.bIsFullyEdited;
+	}
+};
+
+/**
+ * Data of a FValueOctree leaf read by the meshing threads
+ * A published state is never modified: writers edit a copy, which is published by EndSet
+ */
+struct FValueOctreeState
+{
+	// Generator for this world
+	TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator;
+	// Generation of WorldGenerator in the generator cache
+	uint32 WorldGeneratorGeneration;
+	// Values & materials if dirty. Shared with the previous state until edited
+	TSharedPtr<FVoxelCompactChunk> DirtyData;
+	// Voxel assets
+	TArray<TSharedRef<FVoxelAssetInstance>> Assets;
+	// Summary of the childs if not a leaf. Leaves use their DirtyData
+	FValueOctreeSummary Summary;
+
+	// Readers of this state. Retired states are deleted once it's 0
+	FThreadSafeCounter NumReaders;
+
+	FValueOctreeState(TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, uint32 WorldGeneratorGeneration)
+		: WorldGenerator(WorldGenerator)
+		, WorldGeneratorGeneration(WorldGeneratorGeneration)
+	{
+	}
+	FValueOctreeState(const FValueOctreeState& Other)
+		: WorldGenerator(Other.WorldGenerator)
+		, WorldGeneratorGeneration(Other.WorldGeneratorGeneration)
+		, DirtyData(Other.DirtyData)
+		, Assets(Other.Assets)
+		, Summary(Other.Summary)
+	{
+	}
+};
+
+/**
+ * Data shared by all the nodes of a FValueOctree
+ */
+struct FValueOctreeContext
+{
+	// Used by the readers
+	FVoxelGeneratorCache GeneratorCache;
+
+	// Only used by the writer: nodes with a pending state
+	TArray<FValueOctree*> EditedOctrees;
+	// Only used by the writer: replaced states, that might still be read
+	TArray<FValueOctreeState*> RetiredStates;
+	// Only used by the writer: a saved chunk was reset since the last save. Save records can't remove it
+	bool bHasResetSavedChunks;
+
+	FValueOctreeContext(uint32 GeneratorCacheSize)
+		: GeneratorCache(GeneratorCacheSize)
+		, bHasResetSavedChunks(false)
+	{
+	}
+
+	// Only used by the writer. Created on the first page out
+	TSharedRef<FVoxelPageStore, ESPMode::ThreadSafe> GetPageStore()
+	{
+		if (!PageStore.IsValid())
+		{
+			PageStore = MakeShared<FVoxelPageStore, ESPMode::ThreadSafe>();
+		}
+		return PageStore.ToSharedRef();
+	}
+
+private:
+	// Shared with the paged chunks, that can outlive the context
+	TSharedPtr<FVoxelPageStore, ESPMode::ThreadSafe> PageStore;
+};
 
 /**
  * Octree that holds modified values & materials
+ * Readers never wait for the writer: they use the published state of the leaves. There can only be one writer at a time
  */
 class FValueOctree : public TVoxelOctree<FValueOctree, DATA_CHUNK_SIZE>
 {
 public:
-	FValueOctree(TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, uint8 LOD, bool bMultiplayer);
+	FValueOctree(TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, uint8 LOD, bool bMultiplayer, FValueOctreeContext& Context);
 	FValueOctree(FValueOctree* Parent, uint8 ChildIndex);
 	~FValueOctree();
 
 	// Is the game multiplayer?
 	const bool bMultiplayer;
 
-	// Generator for this world
-	TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator;
-
 	/**
-	 * Does this chunk have been modified?
+	 * Does this chunk have been modified? Requires BeginSet
 	 */
 	bool IsDirty() const;
 	
+	/**
+	 * Is there no surface in this region? Uses the summaries of the edited values, the world generator and the assets
+	 */
 	bool IsEmpty(const FIntVector& Start, const int Step, const FIntVector& Size) const;
 
+	/**
+	 * Get the bounds of the edited values of this node. Thread safe
+	 */
+	FValueOctreeSummary GetSummary() const;
+
+	/**
+	 * Get a box around P whose values all have the same sign, to skip it when raycasting. Thread safe
+	 * @param	OutBox	The box without surface if found, else a box around P in which there's no need to look for one again
+	 * @return	Is OutBox without surface?
+	 */
+	bool GetBoxWithoutSurface(const FIntVector& P, FIntBox& OutBox) const;
+
 	/**
 	 * Get values and materials
 	 * @see FVoxelWorldGeneratorInstance
@@ -72,9 +203,15 @@ public:
 
 	/**
 	 * Add dirty chunks to SaveList
-	 * @param	SaveList		List to save chunks into. Sorted by increasing Id
+	 * @param	SaveList					List to save chunks into. Sorted by increasing Id
+	 * @param	bOnlyEditedSinceLastSave	Only add the chunks edited since they were last added to a save
 	 */
-	void AddDirtyChunksToSaveQueue(TArray<FVoxelChunkSave>& SaveQueue);
+	void AddDirtyChunksToSaveQueue(TArray<FVoxelChunkSave>& SaveQueue, bool bOnlyEditedSinceLastSave);
+	/**
+	 * Add the dirty chunks intersecting Boxes but none of ExcludedBoxes to SaveList. Doesn't change the save dirty flags
+	 * @param	SaveList	List to save chunks into. Sorted by increasing Id
+	 */
+	void AddDirtyChunksInBoxesToSaveQueue(const TArray<FIntBox>& Boxes, const TArray<FIntBox>& ExcludedBoxes, TArray<FVoxelChunkSave>& SaveQueue);
 	/**
 	 * Load chunks from Save list
 	 * @param	SaveQueue				Queue to load chunks from. Sorted by decreasing Id (top is lowest Id)
@@ -93,14 +230,14 @@ public:
 	void LoadMaterialDiff(FVoxelMaterialDiff& Diff, TArray<FIntVector>& OutModifiedPositions);
 	
 	/**
-	 * Get the positions to update for this chunk. Must be called only if LOD == 0
+	 * Get the positions to update for this chunk. Must be called only if LOD == 0. Requires BeginSet
 	 */
 	void GetPositionsToUpdate(TArray<FIntVector>& OutPositions);
 
 	/**
 	 * Set the new world generator
 	 */
-	void SetWorldGenerator(TSharedRef<FVoxelWorldGeneratorInstance> NewGenerator);
+	void SetWorldGenerator(TSharedRef<FVoxelWorldGeneratorInstance> NewGenerator, uint32 NewGeneration);
 
 	/**
 	 * P(bounds) = -1: discard
@@ -114,44 +251,93 @@ public:
 	 */
 	void SetEntireChunkAsNotDirty();
 	
-	// sorted by increasing Id
-	void BeginSet(const FIntBox& Box, TArray<uint64>& OutIds);
-	// sorted by decreasing Id
-	void EndSet(TArray<uint64>& Ids);
-	
-	// sorted by increasing Id
-	void BeginGet(const FIntBox& Box, TArray<uint64>& OutIds);
-	// sorted by decreasing Id
-	void EndGet(TArray<uint64>& Ids);
+	/**
+	 * Publish the edits of the writer, update the summaries of their parents and delete the retired states no longer read. Requires BeginSet
+	 */
+	void PublishPendingStates();
 
-	void LockTransactions();
+	/**
+	 * Compress the dirty chunks that weren't used since MinIdleTime seconds, and page out the compressed ones not used since MinPagingIdleTime. Requires BeginSet
+	 * @param	MinPagingIdleTime	0 to disable paging
+	 * @param	MaxChunks			Max number of chunks to compress or page out. Decremented
+	 */
+	void CompressColdChunks(double Time, double MinIdleTime, double MinPagingIdleTime, int& MaxChunks);
 
 private:
-	// Values if dirty
-	float* Values;
-	// Materials if dirty
-	FVoxelMaterial* Materials;
-	
-	// Voxel assets
-	TArray<TSharedRef<FVoxelAssetInstance>> Assets;
+	FValueOctreeContext& Context;
+
+	// State read by the other threads. Only replaced under StateSection
+	FValueOctreeState* State;
+	// Copy of State edited by the writer. Null if not edited
+	FValueOctreeState* PendingState;
+	// Thread editing PendingState, so that it reads its own edits. 0 if none
+	uint32 PendingStateThreadId;
 
-	// Is the chunk dirty? Undefined behaviour if LOD != 0
-	bool bIsDirty;
+	mutable FCriticalSection StateSection;
 
-	// For multiplayer
-	TSet<uint32> DirtyValues;
-	TSet<uint32> DirtyMaterials;
+	// For multiplayer. Empty if nothing changed since last sync
+	TBitArray<> DirtyValues;
+	TBitArray<> DirtyMaterials;
 
 	// Has the chunk changed since last sync?
 	bool bIsNetworkDirty;
+	// Has the chunk changed since it was last saved?
+	bool bIsSaveDirty;
+
+	/**
+	 * Keep the state read by this thread alive
+	 */
+	class FStateReader
+	{
+	public:
+		FStateReader(const FValueOctree& Octree);
+		~FStateReader();
+
+		FORCEINLINE const FValueOctreeState* operator->() const
+		{
+			return ReadState;
+		}
+		FORCEINLINE const FValueOctreeState& operator*() const
+		{
+			return *ReadState;
+		}
+
+	private:
+		FValueOctreeState* ReadState;
+	};
 
-	std::shared_mutex MainLock;
-	std::mutex TransactionLock;
+	/**
+	 * State with the pending edits. Only for the writer
+	 */
+	FORCEINLINE const FValueOctreeState& GetLastState() const
+	{
+		return PendingState ? *PendingState : *State;
+	}
+	/**
+	 * Copy the state if needed to edit it
+	 */
+	FValueOctreeState& GetPendingState();
+	/**
+	 * Copy the dirty data if it's still shared with the readers
+	 */
+	FVoxelCompactChunk& GetPendingDirtyData();
 
-	FThreadSafeCounter GetCounter;
-	FThreadSafeCounter SetCounter;
+	/**
+	 * Replace the published state. The old one is retired
+	 */
+	void SetState(FValueOctreeState* NewState);
+	void PublishPendingState();
 
-	FThreadSafeBool bIsLocked;
+	FValueOctreeSummary GetSummary(const FValueOctreeState& NodeState) const;
+	/**
+	 * Recompute the summaries of the nodes intersecting EditedBounds. The leaves must be published
+	 * @param	EditedBounds	Bounds of the edited nodes intersecting this one
+	 */
+	void UpdateSummaries(const TArray<FIntBox>& EditedBounds);
+	/**
+	 * Signs of the values in a region, see ERegionSigns
+	 */
+	uint8 GetRegionSigns(const FIntBox& InBounds, const FIntVector& Start, const int Step, const FIntVector& Size) const;
 
 
 	/**
@@ -173,4 +359,10 @@ private:
 	 * Get the (X, Y, Z) coordinates corresponding to the array index
 	 */
 	FORCEINLINE void CoordinatesFromIndex(uint32 Index, int& OutX, int& OutY, int& OutZ) const;
+
+	/**
+	 * Add the values and materials of this dirty chunk to SaveQueue
+	 * @return	False if the chunk couldn't be read
+	 */
+	bool AddToSaveQueue(TArray<FVoxelChunkSave>& SaveQueue) const;
 };
\ No newline at end of file
@@ -0,0 +1,505 @@
+// Copyright 2018 Phyronnaz
+
+#include "VoxelCompactChunk.h"
+#include "VoxelPrivate.h"
+#include "VoxelPageStore.h"
+#include "VoxelUtilities.h"
+#include "MemoryWriter.h"
+#include "MemoryReader.h"
+#include "Compression.h"
+#include "ScopeLock.h"
+#include "Crc.h"
+
+DECLARE_CYCLE_STAT(TEXT("FVoxelCompactChunk::Pack"), STAT_VoxelCompactChunk_Pack, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelCompactChunk::Compress"), STAT_VoxelCompactChunk_Compress, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelCompactChunk::Decompress"), STAT_VoxelCompactChunk_Decompress, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelCompactChunk::PageOut"), STAT_VoxelCompactChunk_PageOut, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelCompactChunk::PageIn"), STAT_VoxelCompactChunk_PageIn, STATGROUP_Voxel);
+
+DECLARE_MEMORY_STAT(TEXT("Voxel Edited Chunks Memory"), STAT_VoxelEditedChunksMemory, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Edited Chunks"), STAT_VoxelEditedChunks, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Compressed Chunks"), STAT_VoxelCompressedChunks, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Paged Chunks"), STAT_VoxelPagedChunks, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Page Ins"), STAT_VoxelPageIns, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Page Outs"), STAT_VoxelPageOuts, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Chunk Read Failures"), STAT_VoxelChunkReadFailures, STATGROUP_Voxel);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Voxel Edited Chunks Bytes Per Chunk"), STAT_VoxelEditedChunksBytesPerChunk, STATGROUP_Voxel);
+
+// Used to compute the bytes per chunk stat
+static FThreadSafeCounter64 TotalAllocatedSize;
+static FThreadSafeCounter NumChunks;
+
+// Decompressions are rare: no need for a lock per chunk. Also protects the pages
+static FCriticalSection DecompressSection;
+
+FVoxelCompactChunk::FVoxelCompactChunk()
+	: ValuesFormat(EValuesFormat::Float)
+	, MaterialsFormat(EMaterialsFormat::Raw)
+	, bIsPacked(false)
+	, bIsCompressed(false)
+	, UniformValue(0)
+	, MinValue(0)
+	, MaxValue(0)
+	, UncompressedSize(0)
+	, PageOffset(0)
+	, PageSize(0)
+	, PageCrc(0)
+	, LastUseTime(0)
+	, AllocatedSize(0)
+{
+	RawValues.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+	Materials.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+
+	NumChunks.Increment();
+	INC_DWORD_STAT(STAT_VoxelEditedChunks);
+	UpdateAllocatedSize();
+}
+
+FVoxelCompactChunk::FVoxelCompactChunk(const FVoxelCompactChunk& Other)
+	: bIsCompressed(false)
+	, UncompressedSize(0)
+	, PageOffset(0)
+	, PageSize(0)
+	, PageCrc(0)
+	, AllocatedSize(0)
+{
+	// The callers check that Other can be read
+	verify(Other.EnsureDecompressed());
+
+	ValuesFormat = Other.ValuesFormat;
+	MaterialsFormat = Other.MaterialsFormat;
+	bIsPacked = Other.bIsPacked;
+	UniformValue = Other.UniformValue;
+	MinValue = Other.MinValue;
+	MaxValue = Other.MaxValue;
+	QuantizedValues = Other.QuantizedValues;
+	RawValues = Other.RawValues;
+	Materials = Other.Materials;
+	MaterialIndices = Other.MaterialIndices;
+	LastUseTime = Other.LastUseTime;
+
+	NumChunks.Increment();
+	INC_DWORD_STAT(STAT_VoxelEditedChunks);
+	UpdateAllocatedSize();
+}
+
+FVoxelCompactChunk::~FVoxelCompactChunk()
+{
+	if (bIsCompressed)
+	{
+		DEC_DWORD_STAT(STAT_VoxelCompressedChunks);
+	}
+	if (PageStore.IsValid())
+	{
+		PageStore->Free(PageOffset, PageSize);
+		DEC_DWORD_STAT(STAT_VoxelPagedChunks);
+	}
+
+	NumChunks.Decrement();
+	DEC_DWORD_STAT(STAT_VoxelEditedChunks);
+	DEC_MEMORY_STAT_BY(STAT_VoxelEditedChunksMemory, AllocatedSize);
+	TotalAllocatedSize.Subtract(AllocatedSize);
+}
+
+void FVoxelCompactChunk::GetValuesAndMaterials(float OutValues[], FVoxelMaterial OutMaterials[]) const
+{
+	if (UNLIKELY(!EnsureDecompressed()))
+	{
+		for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+		{
+			if (OutValues)
+			{
+				OutValues[Index] = 1;
+			}
+			if (OutMaterials)
+			{
+				OutMaterials[Index] = FVoxelMaterial();
+			}
+		}
+		return;
+	}
+
+	if (OutValues)
+	{
+		switch (ValuesFormat)
+		{
+		case EValuesFormat::Uniform:
+			for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+			{
+				OutValues[Index] = UniformValue;
+			}
+			break;
+		case EValuesFormat::Int16:
+			for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+			{
+				OutValues[Index] = QuantizedValues[Index] / (float)MAX_int16;
+			}
+			break;
+		default:
+			FMemory::Memcpy(OutValues, RawValues.GetData(), DATA_CHUNK_TOTAL_SIZE * sizeof(float));
+		}
+	}
+	if (OutMaterials)
+	{
+		if (MaterialsFormat == EMaterialsFormat::Raw)
+		{
+			FMemory::Memcpy(OutMaterials, Materials.GetData(), DATA_CHUNK_TOTAL_SIZE * sizeof(FVoxelMaterial));
+		}
+		else
+		{
+			for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+			{
+				OutMaterials[Index] = GetMaterial(Index);
+			}
+		}
+	}
+}
+
+void FVoxelCompactChunk::SetValue(int Index, float Value)
+{
+	check(0 <= Index && Index < DATA_CHUNK_TOTAL_SIZE);
+	GetRawValues()[Index] = Value;
+}
+
+void FVoxelCompactChunk::SetMaterial(int Index, const FVoxelMaterial& Material)
+{
+	check(0 <= Index && Index < DATA_CHUNK_TOTAL_SIZE);
+	GetRawMaterials()[Index] = Material;
+}
+
+float* FVoxelCompactChunk::GetRawValues()
+{
+	// Edits are made on copies, that are decompressed
+	verify(EnsureDecompressed());
+	if (ValuesFormat != EValuesFormat::Float)
+	{
+		UnpackValues();
+	}
+	bIsPacked = false;
+	return RawValues.GetData();
+}
+
+FVoxelMaterial* FVoxelCompactChunk::GetRawMaterials()
+{
+	verify(EnsureDecompressed());
+	if (MaterialsFormat != EMaterialsFormat::Raw)
+	{
+		UnpackMaterials();
+	}
+	bIsPacked = false;
+	return Materials.GetData();
+}
+
+void FVoxelCompactChunk::Pack()
+{
+	if (bIsPacked)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_VoxelCompactChunk_Pack);
+
+	check(!bIsCompressed);
+
+	if (ValuesFormat == EValuesFormat::Float)
+	{
+		bool bIsUniform = true;
+		float Min = RawValues[0];
+		float Max = RawValues[0];
+		for (int Index = 1; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+		{
+			const float Value = RawValues[Index];
+			bIsUniform &= Value == RawValues[0];
+			Min = FMath::Min(Min, Value);
+			Max = FMath::Max(Max, Value);
+		}
+		// Quantization keeps the sign: still conservative for the surface
+		MinValue = Min;
+		MaxValue = Max;
+
+		if (bIsUniform)
+		{
+			ValuesFormat = EValuesFormat::Uniform;
+			UniformValue = RawValues[0];
+			RawValues.Empty();
+		}
+		else if (-1 <= Min && Max <= 1)
+		{
+			ValuesFormat = EValuesFormat::Int16;
+			QuantizedValues.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+			for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+			{
+				QuantizedValues[Index] = FVoxelUtilities::QuantizeValue(RawValues[Index]);
+			}
+			RawValues.Empty();
+		}
+	}
+
+	if (MaterialsFormat == EMaterialsFormat::Raw)
+	{
+		TArray<FVoxelMaterial> Palette;
+		TArray<uint8> Indices;
+		Indices.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+
+		bool bFitsInPalette = true;
+		int LastPaletteIndex = -1;
+		for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+		{
+			const FVoxelMaterial& Material = Materials[Index];
+			// Materials are usually the same as the previous one
+			if (LastPaletteIndex < 0 || !(Palette[LastPaletteIndex] == Material))
+			{
+				LastPaletteIndex = Palette.IndexOfByKey(Material);
+				if (LastPaletteIndex == INDEX_NONE)
+				{
+					if (Palette.Num() == 256)
+					{
+						bFitsInPalette = false;
+						break;
+					}
+					LastPaletteIndex = Palette.Add(Material);
+				}
+			}
+			Indices[Index] = LastPaletteIndex;
+		}
+
+		if (bFitsInPalette)
+		{
+			if (Palette.Num() == 1)
+			{
+				MaterialsFormat = EMaterialsFormat::Uniform;
+				MaterialIndices.Empty();
+			}
+			else if (Palette.Num() <= 16)
+			{
+				MaterialsFormat = EMaterialsFormat::Palette4;
+				MaterialIndices.SetNumZeroed(DATA_CHUNK_TOTAL_SIZE / 2);
+				for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+				{
+					MaterialIndices[Index / 2] |= Indices[Index] << (4 * (Index & 1));
+				}
+			}
+			else
+			{
+				MaterialsFormat = EMaterialsFormat::Palette8;
+				MaterialIndices = MoveTemp(Indices);
+			}
+			Palette.Shrink();
+			Materials = MoveTemp(Palette);
+		}
+	}
+
+	bIsPacked = true;
+	LastUseTime = FPlatformTime::Seconds();
+	UpdateAllocatedSize();
+}
+
+bool FVoxelCompactChunk::IsCold(double Time, double MinIdleTime) const
+{
+	if (bIsCompressed || !bIsPacked || Time - LastUseTime < MinIdleTime)
+	{
+		return false;
+	}
+	// Nothing to gain if uniform
+	return ValuesFormat != EValuesFormat::Uniform || MaterialsFormat != EMaterialsFormat::Uniform;
+}
+
+bool FVoxelCompactChunk::CompressIfCold(double Time, double MinIdleTime)
+{
+	if (!IsCold(Time, MinIdleTime))
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_VoxelCompactChunk_Compress);
+
+	TArray<uint8> Uncompressed;
+	FMemoryWriter Writer(Uncompressed);
+	Writer << QuantizedValues;
+	Writer << RawValues;
+	Writer << Materials;
+	Writer << MaterialIndices;
+
+	const ECompressionFlags Flags = (ECompressionFlags)(COMPRESS_ZLIB | COMPRESS_BiasSpeed);
+	int32 CompressedSize = FCompression::CompressMemoryBound(Flags, Uncompressed.Num());
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(Flags, Compressed.GetData(), CompressedSize, Uncompressed.GetData(), Uncompressed.Num()) || CompressedSize >= Uncompressed.Num())
+	{
+		// Don't try again next time
+		LastUseTime = Time;
+		return false;
+	}
+	Compressed.SetNum(CompressedSize);
+	Compressed.Shrink();
+
+	CompressedData = MoveTemp(Compressed);
+	UncompressedSize = Uncompressed.Num();
+
+	QuantizedValues.Empty();
+	RawValues.Empty();
+	Materials.Empty();
+	MaterialIndices.Empty();
+
+	bIsCompressed.AtomicSet(true);
+	INC_DWORD_STAT(STAT_VoxelCompressedChunks);
+	UpdateAllocatedSize();
+
+	return true;
+}
+
+bool FVoxelCompactChunk::CanPageOut(double Time, double MinIdleTime) const
+{
+	return bIsCompressed && !PageStore.IsValid() && Time - LastUseTime >= MinIdleTime;
+}
+
+TSharedPtr<FVoxelCompactChunk> FVoxelCompactChunk::CreatePagedCopy(const TSharedRef<FVoxelPageStore, ESPMode::ThreadSafe>& Store) const
+{
+	FScopeLock Lock(&DecompressSection);
+
+	if (!bIsCompressed || PageStore.IsValid())
+	{
+		// Decompressed by a reader
+		return nullptr;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_VoxelCompactChunk_PageOut);
+
+	const int64 Offset = Store->Write(CompressedData);
+	if (Offset < 0)
+	{
+		return nullptr;
+	}
+
+	TSharedRef<FVoxelCompactChunk> Copy = MakeShared<FVoxelCompactChunk>();
+	Copy->RawValues.Empty();
+	Copy->Materials.Empty();
+
+	Copy->ValuesFormat = ValuesFormat;
+	Copy->MaterialsFormat = MaterialsFormat;
+	Copy->bIsPacked = bIsPacked;
+	Copy->UniformValue = UniformValue;
+	Copy->MinValue = MinValue;
+	Copy->MaxValue = MaxValue;
+	Copy->UncompressedSize = UncompressedSize;
+	Copy->LastUseTime = LastUseTime;
+
+	Copy->PageStore = Store;
+	Copy->PageOffset = Offset;
+	Copy->PageSize = CompressedData.Num();
+	Copy->PageCrc = FCrc::MemCrc32(CompressedData.GetData(), CompressedData.Num());
+
+	Copy->bIsCompressed.AtomicSet(true);
+	INC_DWORD_STAT(STAT_VoxelCompressedChunks);
+	INC_DWORD_STAT(STAT_VoxelPagedChunks);
+	INC_DWORD_STAT(STAT_VoxelPageOuts);
+	Copy->UpdateAllocatedSize();
+
+	return Copy;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool FVoxelCompactChunk::Decompress() const
+{
+	FScopeLock Lock(&DecompressSection);
+
+	if (!bIsCompressed)
+	{
+		// Decompressed by another reader
+		return true;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_VoxelCompactChunk_Decompress);
+
+	FVoxelCompactChunk* This = const_cast<FVoxelCompactChunk*>(this);
+
+	// Nothing is changed until the data is known to be valid, so that the next access can try again
+	TArray<uint8> PagedData;
+	const TArray<uint8>& Compressed = PageStore.IsValid() ? PagedData : CompressedData;
+	if (PageStore.IsValid())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_VoxelCompactChunk_PageIn);
+
+		if (!PageStore->Read(PageOffset, PageSize, PagedData) || FCrc::MemCrc32(PagedData.GetData(), PagedData.Num()) != PageCrc)
+		{
+			UE_LOG(LogVoxel, Error, TEXT("Failed to read a voxel page at byte %lld"), PageOffset);
+			INC_DWORD_STAT(STAT_VoxelChunkReadFailures);
+			return false;
+		}
+	}
+
+	TArray<uint8> Uncompressed;
+	Uncompressed.SetNumUninitialized(UncompressedSize);
+	if (!FCompression::UncompressMemory(COMPRESS_ZLIB, Uncompressed.GetData(), UncompressedSize, Compressed.GetData(), Compressed.Num()))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to decompress a voxel chunk"));
+		INC_DWORD_STAT(STAT_VoxelChunkReadFailures);
+		return false;
+	}
+
+	if (PageStore.IsValid())
+	{
+		PageStore->Free(PageOffset, PageSize);
+		This->PageStore.Reset();
+
+		DEC_DWORD_STAT(STAT_VoxelPagedChunks);
+		INC_DWORD_STAT(STAT_VoxelPageIns);
+	}
+
+	FMemoryReader Reader(Uncompressed);
+	Reader << This->QuantizedValues;
+	Reader << This->RawValues;
+	Reader << This->Materials;
+	Reader << This->MaterialIndices;
+
+	This->CompressedData.Empty();
+	This->LastUseTime = FPlatformTime::Seconds();
+	This->UpdateAllocatedSize();
+
+	DEC_DWORD_STAT(STAT_VoxelCompressedChunks);
+	// Must be last: other readers can use the data as soon as this is false
+	bIsCompressed.AtomicSet(false);
+	return true;
+}
+
+void FVoxelCompactChunk::UnpackValues()
+{
+	TArray<float> NewValues;
+	NewValues.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+	GetValuesAndMaterials(NewValues.GetData(), nullptr);
+
+	ValuesFormat = EValuesFormat::Float;
+	RawValues = MoveTemp(NewValues);
+	QuantizedValues.Empty();
+}
+
+void FVoxelCompactChunk::UnpackMaterials()
+{
+	TArray<FVoxelMaterial> NewMaterials;
+	NewMaterials.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+	GetValuesAndMaterials(nullptr, NewMaterials.GetData());
+
+	MaterialsFormat = EMaterialsFormat::Raw;
+	Materials = MoveTemp(NewMaterials);
+	MaterialIndices.Empty();
+}
+
+void FVoxelCompactChunk::UpdateAllocatedSize()
+{
+	const uint32 NewAllocatedSize = sizeof(FVoxelCompactChunk)
+		+ QuantizedValues.GetAllocatedSize()
+		+ RawValues.GetAllocatedSize()
+		+ Materials.GetAllocatedSize()
+		+ MaterialIndices.GetAllocatedSize()
+		+ CompressedData.GetAllocatedSize();
+
+	DEC_MEMORY_STAT_BY(STAT_VoxelEditedChunksMemory, AllocatedSize);
+	INC_MEMORY_STAT_BY(STAT_VoxelEditedChunksMemory, NewAllocatedSize);
+
+	const int64 Delta = (int64)NewAllocatedSize - (int64)AllocatedSize;
+	const int64 Total = TotalAllocatedSize.Add(Delta) + Delta;
+	SET_FLOAT_STAT(STAT_VoxelEditedChunksBytesPerChunk, (float)Total / FMath::Max(1, NumChunks.GetValue()));
+
+	AllocatedSize = NewAllocatedSize;
+}
@@ -0,0 +1,195 @@
+// Copyright 2018 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ThreadSafeBool.h"
+#include "VoxelMaterial.h"
+#include "VoxelGlobals.h"
+
+class FVoxelPageStore;
+
+/**
+ * Values and materials of an edited LOD 0 chunk, stored compactly:
+ * - values are stored once if uniform, else quantized to int16 if they are all in [-1, 1], else as floats
+ * - materials are stored once if uniform, else as 4 or 8 bits indices in a palette, else raw
+ * Edits unpack the chunk to floats and raw materials: Pack must be called once they are done
+ * Chunks not used for a while can be compressed, and then paged out to a FVoxelPageStore. They are decompressed on their next access
+ */
+class FVoxelCompactChunk
+{
+public:
+	// Values and materials are left uninitialized: fill them with GetRawValues and GetRawMaterials
+	FVoxelCompactChunk();
+	// The copy is decompressed
+	FVoxelCompactChunk(const FVoxelCompactChunk& Other);
+	~FVoxelCompactChunk();
+
+	FVoxelCompactChunk& operator=(const FVoxelCompactChunk&) = delete;
+
+	/**
+	 * Decompress the chunk if needed. Thread safe between readers
+	 * @return	False if the data couldn't be read, eg a page read failed. The chunk stays compressed, and the next call tries again
+	 */
+	FORCEINLINE bool EnsureDecompressed() const
+	{
+		return LIKELY(!bIsCompressed) || Decompress();
+	}
+
+	/**
+	 * Thread safe between readers. Empty values and default materials if EnsureDecompressed fails
+	 */
+	FORCEINLINE float GetValue(int Index) const;
+	FORCEINLINE FVoxelMaterial GetMaterial(int Index) const;
+	void GetValuesAndMaterials(float OutValues[], FVoxelMaterial OutMaterials[]) const;
+
+	void SetValue(int Index, float Value);
+	void SetMaterial(int Index, const FVoxelMaterial& Material);
+
+	/**
+	 * Unpack the values/materials and get them, eg to fill them
+	 * @return	Arrays of size DATA_CHUNK_TOTAL_SIZE
+	 */
+	float* GetRawValues();
+	FVoxelMaterial* GetRawMaterials();
+
+	/**
+	 * Use the most compact formats for the current data. Does nothing if already packed
+	 */
+	void Pack();
+	/**
+	 * Is the chunk packed, not compressed, and not used since MinIdleTime seconds?
+	 */
+	bool IsCold(double Time, double MinIdleTime) const;
+	/**
+	 * Compress the chunk if it's cold
+	 * @return	Whether the chunk was compressed
+	 */
+	bool CompressIfCold(double Time, double MinIdleTime);
+	/**
+	 * Is the chunk compressed, still in memory, and not used since MinIdleTime seconds?
+	 */
+	bool CanPageOut(double Time, double MinIdleTime) const;
+	/**
+	 * Write the compressed data to the store and create a copy without it. Thread safe
+	 * @return	The copy, or null if the chunk isn't compressed or the write failed
+	 */
+	TSharedPtr<FVoxelCompactChunk> CreatePagedCopy(const TSharedRef<FVoxelPageStore, ESPMode::ThreadSafe>& Store) const;
+
+	/**
+	 * Bounds of the values, computed by Pack
+	 */
+	FORCEINLINE bool IsPacked() const
+	{
+		return bIsPacked;
+	}
+	FORCEINLINE float GetMinValue() const
+	{
+		return MinValue;
+	}
+	FORCEINLINE float GetMaxValue() const
+	{
+		return MaxValue;
+	}
+
+	/**
+	 * Memory used by this chunk, in bytes
+	 */
+	FORCEINLINE uint32 GetAllocatedSize() const
+	{
+		return AllocatedSize;
+	}
+
+private:
+	enum class EValuesFormat : uint8
+	{
+		Uniform,
+		Int16,
+		Float
+	};
+	enum class EMaterialsFormat : uint8
+	{
+		Uniform,
+		Palette4,
+		Palette8,
+		Raw
+	};
+
+	EValuesFormat ValuesFormat;
+	EMaterialsFormat MaterialsFormat;
+
+	bool bIsPacked;
+	// Readers can decompress the chunk
+	mutable FThreadSafeBool bIsCompressed;
+
+	float UniformValue;
+	// Not compressed, so that the readers can use them without decompressing the chunk
+	float MinValue;
+	float MaxValue;
+	TArray<int16> QuantizedValues;
+	TArray<float> RawValues;
+
+	// Palette if Uniform/Palette4/Palette8, all the materials if Raw
+	TArray<FVoxelMaterial> Materials;
+	TArray<uint8> MaterialIndices;
+
+	TArray<uint8> CompressedData;
+	int32 UncompressedSize;
+
+	// If valid, CompressedData is in this store instead of in memory. Thread safe, as the readers reset it on page in while the writer shares the store
+	TSharedPtr<FVoxelPageStore, ESPMode::ThreadSafe> PageStore;
+	int64 PageOffset;
+	int32 PageSize;
+	// To detect corrupted pages
+	uint32 PageCrc;
+
+	// Last time this chunk was packed or decompressed
+	double LastUseTime;
+
+	uint32 AllocatedSize;
+
+	bool Decompress() const;
+
+	void UnpackValues();
+	void UnpackMaterials();
+
+	void UpdateAllocatedSize();
+};
+
+float FVoxelCompactChunk::GetValue(int Index) const
+{
+	if (UNLIKELY(!EnsureDecompressed()))
+	{
+		return 1;
+	}
+
+	switch (ValuesFormat)
+	{
+	case EValuesFormat::Uniform:
+		return UniformValue;
+	case EValuesFormat::Int16:
+		return QuantizedValues[Index] / (float)MAX_int16;
+	default:
+		return RawValues[Index];
+	}
+}
+
+FVoxelMaterial FVoxelCompactChunk::GetMaterial(int Index) const
+{
+	if (UNLIKELY(!EnsureDecompressed()))
+	{
+		return FVoxelMaterial();
+	}
+
+	switch (MaterialsFormat)
+	{
+	case EMaterialsFormat::Uniform:
+		return Materials[0];
+	case EMaterialsFormat::Palette4:
+		return Materials[(MaterialIndices[Index / 2] >> (4 * (Index & 1))) & 0xF];
+	case EMaterialsFormat::Palette8:
+		return Materials[MaterialIndices[Index]];
+	default:
+		return Materials[Index];
+	}
+}
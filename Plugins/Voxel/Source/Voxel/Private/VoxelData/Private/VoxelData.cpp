@@ -6,20 +6,37 @@
 #include "VoxelSave.h"
 #include "VoxelDiff.h"
 #include "VoxelWorldGenerator.h"
+#include "VoxelUtilities.h"
 #include "Algo/Reverse.h"
 #include "ScopeLock.h"
 
-FVoxelData::FVoxelData(int LOD, TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, bool bMultiplayer)
+DECLARE_CYCLE_STAT(TEXT("FVoxelData::Raycast"), STAT_FVoxelData_Raycast, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelData::RaycastBatch"), STAT_FVoxelData_RaycastBatch, STATGROUP_Voxel);
+
+// Samples per cell to find a sign change. The interpolated values are cubic along the ray
+#define RAYCAST_CELL_SAMPLES 4
+// Bisection steps to refine a sign change
+#define RAYCAST_REFINE_STEPS 8
+
+FVoxelData::FVoxelData(int LOD, TSharedRef<FVoxelWorldGeneratorInstance> WorldGenerator, bool bMultiplayer, uint32 GeneratorCacheSize)
 	: LOD(LOD)
 	, WorldGenerator(WorldGenerator)
 	, bMultiplayer(bMultiplayer)
-	, MainOctree(new FValueOctree(WorldGenerator, LOD, bMultiplayer))
+	, OctreeContext(new FValueOctreeContext(GeneratorCacheSize))
+	, MainOctree(new FValueOctree(WorldGenerator, LOD, bMultiplayer, *OctreeContext))
 {
 }
 
 FVoxelData::~FVoxelData()
 {
 	delete MainOctree;
+
+	for (auto RetiredState : OctreeContext->RetiredStates)
+	{
+		check(RetiredState->NumReaders.GetValue() == 0);
+		delete RetiredState;
+	}
+	delete OctreeContext;
 }
 
 int32 FVoxelData::Size() const
@@ -34,36 +51,36 @@ FIntBox FVoxelData::GetBounds() const
 
 TArray<uint64> FVoxelData::BeginSet(const FIntBox& Box)
 {
-	TArray<uint64> LockedOctrees;
+	return BeginSetInternal(Box, true);
+}
 
-	MainOctree->LockTransactions();
-	MainOctree->BeginSet(Box, LockedOctrees);
+TArray<uint64> FVoxelData::BeginSetInternal(const FIntBox& Box, bool bLoadStreamedChunks)
+{
+	// Edits are made on copies of the chunks: they don't need to wait for the readers
+	WriteSection.Lock();
 
-	Algo::Reverse(LockedOctrees);
-	return LockedOctrees;
+	// Else the streamed chunks would override the edits once loaded
+	if (bLoadStreamedChunks && StreamedChunks.Num() > 0)
+	{
+		LoadStreamedChunks({ Box });
+	}
+	return TArray<uint64>();
 }
 
 void FVoxelData::EndSet(TArray<uint64>& LockedOctrees)
 {
-	MainOctree->EndSet(LockedOctrees);
-	check(LockedOctrees.Num() == 0);
+	MainOctree->PublishPendingStates();
+	WriteSection.Unlock();
 }
 
 TArray<uint64> FVoxelData::BeginGet(const FIntBox& Box)
 {
-	TArray<uint64> LockedOctrees;
-
-	MainOctree->LockTransactions();
-	MainOctree->BeginGet(Box, LockedOctrees);
-
-	Algo::Reverse(LockedOctrees);
-	return LockedOctrees;
+	// Readers use the published chunks and never lock
+	return TArray<uint64>();
 }
 
 void FVoxelData::EndGet(TArray<uint64>& LockedOctrees)
 {
-	MainOctree->EndGet(LockedOctrees);
-	check(LockedOctrees.Num() == 0);
 }
 
 bool FVoxelData::IsEmpty(const FIntVector& Start, const int Step, const FIntVector& Size) const
@@ -167,6 +184,215 @@ FVector FVoxelData::GetGradient(const FIntVector& P)
 	return GetGradient(P.X, P.Y, P.Z);
 }
 
+/**
+ * Value at P, relative to the cell min corner, interpolated from the cell corners (index = X + 2 * Y + 4 * Z)
+ */
+FORCEINLINE float TrilinearInterpolation(const float Corners[8], const FVector& P)
+{
+	const float Y0 = FMath::Lerp(FMath::Lerp(Corners[0], Corners[1], P.X), FMath::Lerp(Corners[2], Corners[3], P.X), P.Y);
+	const float Y1 = FMath::Lerp(FMath::Lerp(Corners[4], Corners[5], P.X), FMath::Lerp(Corners[6], Corners[7], P.X), P.Y);
+	return FMath::Lerp(Y0, Y1, P.Z);
+}
+
+FORCEINLINE FVector TrilinearGradient(const float Corners[8], const FVector& P)
+{
+	return FVector(
+		FMath::Lerp(FMath::Lerp(Corners[1] - Corners[0], Corners[3] - Corners[2], P.Y), FMath::Lerp(Corners[5] - Corners[4], Corners[7] - Corners[6], P.Y), P.Z),
+		FMath::Lerp(FMath::Lerp(Corners[2] - Corners[0], Corners[3] - Corners[1], P.X), FMath::Lerp(Corners[6] - Corners[4], Corners[7] - Corners[5], P.X), P.Z),
+		FMath::Lerp(FMath::Lerp(Corners[4] - Corners[0], Corners[5] - Corners[1], P.X), FMath::Lerp(Corners[6] - Corners[2], Corners[7] - Corners[3], P.X), P.Y));
+}
+
+/**
+ * Clip [InOutTMin, InOutTMax] to the part of the ray inside [Min, Max]
+ * @return	Does the ray intersect the box?
+ */
+inline bool ClipRay(const FVector& Start, const FVector& Direction, const FVector& Min, const FVector& Max, float& InOutTMin, float& InOutTMax)
+{
+	for (int Axis = 0; Axis < 3; Axis++)
+	{
+		if (Direction[Axis] == 0)
+		{
+			if (Start[Axis] < Min[Axis] || Max[Axis] < Start[Axis])
+			{
+				return false;
+			}
+		}
+		else
+		{
+			float T0 = (Min[Axis] - Start[Axis]) / Direction[Axis];
+			float T1 = (Max[Axis] - Start[Axis]) / Direction[Axis];
+			if (T0 > T1)
+			{
+				Swap(T0, T1);
+			}
+			InOutTMin = FMath::Max(InOutTMin, T0);
+			InOutTMax = FMath::Min(InOutTMax, T1);
+		}
+	}
+	return InOutTMin <= InOutTMax;
+}
+
+bool FVoxelData::Raycast(const FVoxelRay& Ray, FVoxelRaycastHit& OutHit) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelData_Raycast);
+
+	FIntBox KnownBox;
+	bool bKnownBoxWithoutSurface = false;
+	return RaycastInternal(Ray, OutHit, KnownBox, bKnownBoxWithoutSurface);
+}
+
+void FVoxelData::RaycastBatch(const TArray<FVoxelRay>& Rays, TArray<FVoxelRaycastHit>& OutHits) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelData_RaycastBatch);
+
+	OutHits.SetNum(Rays.Num());
+
+	FIntBox KnownBox;
+	bool bKnownBoxWithoutSurface = false;
+	for (int Index = 0; Index < Rays.Num(); Index++)
+	{
+		RaycastInternal(Rays[Index], OutHits[Index], KnownBox, bKnownBoxWithoutSurface);
+	}
+}
+
+bool FVoxelData::RaycastInternal(const FVoxelRay& Ray, FVoxelRaycastHit& OutHit, FIntBox& KnownBox, bool& bKnownBoxWithoutSurface) const
+{
+	OutHit = FVoxelRaycastHit();
+
+	const FVector& Start = Ray.Start;
+	const FVector& Direction = Ray.Direction;
+	if (Direction.IsNearlyZero() || Ray.MaxDistance <= 0)
+	{
+		return false;
+	}
+
+	// The cells need their 8 corners in the world. IsInWorld excludes the min border
+	const FIntVector CellsMin = GetBounds().Min + FIntVector(1, 1, 1);
+	const FIntVector CellsMax = GetBounds().Max - FIntVector(1, 1, 1);
+
+	float T = 0;
+	float TEnd = Ray.MaxDistance;
+	if (!ClipRay(Start, Direction, FVector(CellsMin), FVector(CellsMax), T, TEnd))
+	{
+		return false;
+	}
+
+	// 3D DDA: Cell is the min corner of the current cell, TNext the distances at which the ray enters the next cell on each axis
+	FIntVector Cell;
+	FIntVector Step;
+	FVector TNext;
+	FVector TDelta;
+	auto InitCell = [&]()
+	{
+		const FVector P = Start + Direction * T;
+		for (int Axis = 0; Axis < 3; Axis++)
+		{
+			const int Floor = FMath::FloorToInt(P[Axis]);
+			// On a face, take the cell the ray goes into
+			Cell[Axis] = FMath::Clamp(Direction[Axis] < 0 && Floor == P[Axis] ? Floor - 1 : Floor, CellsMin[Axis], CellsMax[Axis] - 1);
+			Step[Axis] = Direction[Axis] > 0 ? 1 : Direction[Axis] < 0 ? -1 : 0;
+			TDelta[Axis] = Direction[Axis] != 0 ? 1 / FMath::Abs(Direction[Axis]) : MAX_flt;
+			TNext[Axis] = Direction[Axis] > 0 ? T + (Cell[Axis] + 1 - P[Axis]) / Direction[Axis] : Direction[Axis] < 0 ? T + (Cell[Axis] - P[Axis]) / Direction[Axis] : MAX_flt;
+		}
+	};
+	InitCell();
+
+	float Corners[8];
+	while (T < TEnd)
+	{
+		if (!KnownBox.IsInside(Cell))
+		{
+			bKnownBoxWithoutSurface = MainOctree->GetBoxWithoutSurface(Cell, KnownBox);
+		}
+
+		if (bKnownBoxWithoutSurface && KnownBox.IsInside(Cell + FIntVector(1, 1, 1)))
+		{
+			// Skip all the cells having their 8 corners in the box
+			float TBoxMin = T;
+			float TBoxExit = TEnd;
+			ClipRay(Start, Direction, FVector(KnownBox.Min), FVector(KnownBox.Max - FIntVector(1, 1, 1)), TBoxMin, TBoxExit);
+			if (TBoxExit > T)
+			{
+				T = TBoxExit;
+				InitCell();
+				continue;
+			}
+		}
+
+		const float TCellEnd = FMath::Min(TEnd, TNext.GetMin());
+
+		GetValuesAndMaterials(Corners, nullptr, Cell, FIntVector::ZeroValue, 1, FIntVector(2, 2, 2), FIntVector(2, 2, 2));
+
+		float MinCorner = Corners[0];
+		float MaxCorner = Corners[0];
+		for (int Index = 1; Index < 8; Index++)
+		{
+			MinCorner = FMath::Min(MinCorner, Corners[Index]);
+			MaxCorner = FMath::Max(MaxCorner, Corners[Index]);
+		}
+
+		// The interpolated values are between the corners ones
+		if (!FVoxelUtilities::HaveSameSign(MinCorner, MaxCorner))
+		{
+			const FVector CellPosition(Cell);
+			auto GetInterpolatedValue = [&](float TSample) { return TrilinearInterpolation(Corners, Start + Direction * TSample - CellPosition); };
+
+			float TA = T;
+			float ValueA = GetInterpolatedValue(TA);
+			for (int Sample = 1; Sample <= RAYCAST_CELL_SAMPLES; Sample++)
+			{
+				float TB = FMath::Lerp(T, TCellEnd, Sample / (float)RAYCAST_CELL_SAMPLES);
+				float ValueB = GetInterpolatedValue(TB);
+
+				if (!FVoxelUtilities::HaveSameSign(ValueA, ValueB))
+				{
+					for (int Refine = 0; Refine < RAYCAST_REFINE_STEPS; Refine++)
+					{
+						const float TMiddle = (TA + TB) / 2;
+						const float ValueMiddle = GetInterpolatedValue(TMiddle);
+						if (FVoxelUtilities::HaveSameSign(ValueA, ValueMiddle))
+						{
+							TA = TMiddle;
+							ValueA = ValueMiddle;
+						}
+						else
+						{
+							TB = TMiddle;
+							ValueB = ValueMiddle;
+						}
+					}
+
+					OutHit.bHit = true;
+					// Linear interpolation between the last samples
+					OutHit.Distance = TA + (TB - TA) * ValueA / (ValueA - ValueB);
+					OutHit.Position = Start + Direction * OutHit.Distance;
+					OutHit.Normal = TrilinearGradient(Corners, OutHit.Position - CellPosition).GetSafeNormal();
+					if (OutHit.Normal.IsZero())
+					{
+						OutHit.Normal = -Direction;
+					}
+					return true;
+				}
+
+				TA = TB;
+				ValueA = ValueB;
+			}
+		}
+
+		// Next cell
+		const int Axis = TNext.X < TNext.Y ? (TNext.X < TNext.Z ? 0 : 2) : (TNext.Y < TNext.Z ? 1 : 2);
+		T = TNext[Axis];
+		Cell[Axis] += Step[Axis];
+		TNext[Axis] += TDelta[Axis];
+		if (Cell[Axis] < CellsMin[Axis] || CellsMax[Axis] <= Cell[Axis])
+		{
+			break;
+		}
+	}
+
+	return false;
+}
+
 void FVoxelData::SetValue(int X, int Y, int Z, float Value)
 {
 	check(IsInWorld(X, Y, Z));
@@ -231,7 +457,8 @@ void FVoxelData::SetValueAndMaterial(const FIntVector& P, float Value, FVoxelMat
 
 void FVoxelData::AddAsset(TSharedRef<FVoxelAssetInstance> Asset)
 {
-	auto Octrees = BeginSet(FIntBox::Infinite());
+	// Load the streamed chunks first: once dirty, they would hide the asset
+	auto Octrees = BeginSet(Asset->GetWorldBounds());
 	MainOctree->AddAsset(Asset);
 	EndSet(Octrees);
 }
@@ -258,49 +485,185 @@ FORCEINLINE void FVoxelData::ClampToWorld(int& X, int& Y, int& Z) const
 
 void FVoxelData::GetSave(FVoxelWorldSave& OutSave)
 {
-	auto Octrees = BeginGet(FIntBox::Infinite());
+	// Dirty chunks are read with the write lock, to get the latest edits
+	auto Octrees = BeginSet(FIntBox::Infinite());
 
 	TArray<FVoxelChunkSave> SaveQueue;
-	MainOctree->AddDirtyChunksToSaveQueue(SaveQueue);
+	MainOctree->AddDirtyChunksToSaveQueue(SaveQueue, false);
 	OutSave.Init(LOD, SaveQueue);
+	OctreeContext->bHasResetSavedChunks = false;
 
-	EndGet(Octrees);
+	EndSet(Octrees);
+}
+
+void FVoxelData::AppendToSave(FVoxelWorldSave& Save)
+{
+	if (Save.Version != EVoxelSaveVersion::LatestVersion || Save.LOD != LOD)
+	{
+		GetSave(Save);
+		return;
+	}
+
+	// The streamed chunks are already in the save they come from
+	auto Octrees = BeginSetInternal(FIntBox::Infinite(), false);
+
+	if (OctreeContext->bHasResetSavedChunks)
+	{
+		// Their records would be loaded back
+		EndSet(Octrees);
+		GetSave(Save);
+		return;
+	}
+
+	TArray<FVoxelChunkSave> SaveQueue;
+	MainOctree->AddDirtyChunksToSaveQueue(SaveQueue, true);
+	Save.Append(SaveQueue);
+
+	EndSet(Octrees);
 }
 
 void FVoxelData::LoadFromSaveAndGetModifiedPositions(const FVoxelWorldSave& Save, TArray<FIntVector>& OutModifiedPositions, bool bReset)
 {
-	auto Octrees = BeginSet(FIntBox::Infinite());
+	// Decompress without the lock
+	TArray<FVoxelChunkSave> SaveQueue;
+	Save.GetChunksQueue(SaveQueue);
+	Algo::Reverse(SaveQueue);
+
+	auto Octrees = BeginSetInternal(FIntBox::Infinite(), false);
+
+	StreamedSave = FVoxelWorldSave();
+	StreamedChunks.Empty();
+
+	if (bReset)
+	{
+		ResetDirtyChunks();
+		// Save is now the last save of this world
+		OctreeContext->bHasResetSavedChunks = false;
+	}
+
+	MainOctree->LoadFromSaveQueueAndGetModifiedPositions(SaveQueue, OutModifiedPositions);
+	check(SaveQueue.Num() == 0);
+
+	EndSet(Octrees);
+}
+
+void FVoxelData::StreamFromSave(const FVoxelWorldSave& Save, bool bReset)
+{
+	check(Save.HasChunkIndex());
+
+	auto Octrees = BeginSetInternal(FIntBox::Infinite(), false);
 
 	if (bReset)
 	{
-		TArray<FValueOctree*> Leaves;
-		MainOctree->GetLeavesOverlappingBox(FIntBox::Infinite(), Leaves);
-		for (auto& Leaf : Leaves)
+		ResetDirtyChunks();
+		// Save is now the last save of this world
+		OctreeContext->bHasResetSavedChunks = false;
+	}
+
+	StreamedSave = Save;
+	StreamedChunks.Reset();
+	StreamedSave.GetChunksIndex(StreamedChunks);
+
+	EndSet(Octrees);
+}
+
+bool FVoxelData::LoadStreamedChunksAndGetModifiedPositions(const TArray<FIntBox>& Boxes, TArray<FIntVector>& OutModifiedPositions)
+{
+	auto Octrees = BeginSetInternal(FIntBox::Infinite(), false);
+
+	LoadStreamedChunks(Boxes);
+	OutModifiedPositions.Append(StreamedModifiedPositions);
+	StreamedModifiedPositions.Reset();
+	const bool bHasStreamedChunks = StreamedChunks.Num() > 0;
+
+	EndSet(Octrees);
+
+	return bHasStreamedChunks;
+}
+
+void FVoxelData::LoadStreamedChunks(const TArray<FIntBox>& Boxes)
+{
+	TArray<FVoxelChunkSaveIndex> ChunksToLoad;
+	// Keeps the order
+	StreamedChunks.RemoveAll([&](const FVoxelChunkSaveIndex& Chunk)
+	{
+		for (auto& Box : Boxes)
 		{
-			if (Leaf->LOD == 0 && Leaf->IsDirty())
+			if (Box.Intersect(Chunk.GetBounds()))
 			{
-				Leaf->SetAsNotDirty();
+				ChunksToLoad.Add(Chunk);
+				return true;
 			}
 		}
+		return false;
+	});
+
+	if (ChunksToLoad.Num() > 0)
+	{
+		TArray<FVoxelChunkSave> SaveQueue;
+		StreamedSave.GetChunks(ChunksToLoad, SaveQueue);
+		Algo::Reverse(SaveQueue);
+
+		MainOctree->LoadFromSaveQueueAndGetModifiedPositions(SaveQueue, StreamedModifiedPositions);
+		check(SaveQueue.Num() == 0);
 	}
 
-	TArray<FVoxelChunkSave> SaveQueue;
-	Save.GetChunksQueue(SaveQueue);
-	Algo::Reverse(SaveQueue);
+	if (StreamedChunks.Num() == 0)
+	{
+		// Free the save
+		StreamedSave = FVoxelWorldSave();
+		StreamedChunks.Empty();
+	}
+}
 
-	MainOctree->LoadFromSaveQueueAndGetModifiedPositions(SaveQueue, OutModifiedPositions);
-	check(SaveQueue.Num() == 0);
+void FVoxelData::ResetDirtyChunks()
+{
+	TArray<FValueOctree*> Leaves;
+	MainOctree->GetLeavesOverlappingBox(FIntBox::Infinite(), Leaves);
+	for (auto& Leaf : Leaves)
+	{
+		if (Leaf->LOD == 0 && Leaf->IsDirty())
+		{
+			Leaf->SetAsNotDirty();
+		}
+	}
+}
+
+void FVoxelData::GetChunksInBoxes(const TArray<FIntBox>& Boxes, const TArray<FIntBox>& ExcludedBoxes, TArray<FVoxelChunkSave>& OutChunks)
+{
+	// Dirty chunks are read with the write lock, to get the latest edits
+	auto Octrees = BeginSetInternal(FIntBox::Infinite(), false);
+
+	LoadStreamedChunks(Boxes);
+	MainOctree->AddDirtyChunksInBoxesToSaveQueue(Boxes, ExcludedBoxes, OutChunks);
 
 	EndSet(Octrees);
 }
 
+FIntBox FVoxelData::GetChunkBounds(uint64 Id) const
+{
+	// Id = 9^LOD + sum of 9^ChildLOD * (ChildIndex + 1), see TVoxelOctree
+	const int HalfSize = Size() / 2;
+	FIntVector Min(-HalfSize, -HalfSize, -HalfSize);
+	for (int ChildLOD = LOD - 1; ChildLOD >= 0; ChildLOD--)
+	{
+		const int ChildIndex = (Id / IntPow9(ChildLOD)) % 9 - 1;
+		check(0 <= ChildIndex && ChildIndex < 8);
+
+		const int ChildSize = DATA_CHUNK_SIZE << ChildLOD;
+		Min += FIntVector((ChildIndex & 1) ? ChildSize : 0, (ChildIndex & 2) ? ChildSize : 0, (ChildIndex & 4) ? ChildSize : 0);
+	}
+	return FIntBox(Min, Min + FIntVector(DATA_CHUNK_SIZE, DATA_CHUNK_SIZE, DATA_CHUNK_SIZE));
+}
+
 void FVoxelData::GetDiffQueues(TArray<FVoxelValueDiff>& OutValueDiffQueue, TArray<FVoxelMaterialDiff>& OutMaterialDiffQueue)
 {
-	auto Octrees = BeginGet(FIntBox::Infinite());
+	// Clears the network dirty flags
+	auto Octrees = BeginSetInternal(FIntBox::Infinite(), false);
 
 	MainOctree->AddChunksToDiffQueues(OutValueDiffQueue, OutMaterialDiffQueue);
 
-	EndGet(Octrees);
+	EndSet(Octrees);
 }
 
 void FVoxelData::LoadFromDiffQueuesAndGetModifiedPositions(TArray<FVoxelValueDiff>& ValueDiffQueue, TArray<FVoxelMaterialDiff>& MaterialDiffQueue, TArray<FIntVector>& OutModifiedPositions)
@@ -385,9 +748,11 @@ void FVoxelData::LoadFromDiffQueuesAndGetModifiedPositions(TArray<FVoxelValueDif
 
 void FVoxelData::SetWorldGenerator(TSharedRef<FVoxelWorldGeneratorInstance> NewGenerator)
 {
-	auto Octrees = BeginSet(FIntBox::Infinite());
+	auto Octrees = BeginSetInternal(FIntBox::Infinite(), false);
 
-	MainOctree->SetWorldGenerator(NewGenerator);
+	// The readers of the previous states still use the previous generation
+	const uint32 Generation = OctreeContext->GeneratorCache.NewGeneration();
+	MainOctree->SetWorldGenerator(NewGenerator, Generation);
 	WorldGenerator = NewGenerator;
 	
 	EndSet(Octrees);
@@ -401,3 +766,12 @@ void FVoxelData::DiscardValuesByPredicateF(const std::function<int(const FIntBox
 	
 	EndSet(Octrees);
 }
+
+void FVoxelData::CompressColdChunks(float MinIdleTime, float MinPagingIdleTime, int MaxChunks)
+{
+	auto Octrees = BeginSetInternal(FIntBox::Infinite(), false);
+
+	MainOctree->CompressColdChunks(FPlatformTime::Seconds(), MinIdleTime, MinPagingIdleTime, MaxChunks);
+
+	EndSet(Octrees);
+}
@@ -0,0 +1,160 @@
+// Copyright 2018 Phyronnaz
+
+#include "VoxelGeneratorCache.h"
+#include "VoxelPrivate.h"
+#include "VoxelWorldGenerator.h"
+#include "ScopeLock.h"
+
+DECLARE_CYCLE_STAT(TEXT("FVoxelGeneratorCache::GetValuesAndMaterials"), STAT_VoxelGeneratorCache_GetValuesAndMaterials, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelGeneratorCache::Generate"), STAT_VoxelGeneratorCache_Generate, STATGROUP_Voxel);
+
+DECLARE_MEMORY_STAT(TEXT("Voxel Generator Cache Memory"), STAT_VoxelGeneratorCacheMemory, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Generator Cache Hits"), STAT_VoxelGeneratorCacheHits, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Generator Cache Misses"), STAT_VoxelGeneratorCacheMisses, STATGROUP_Voxel);
+
+// Smaller queries (eg single voxels) aren't worth caching
+#define MIN_CACHED_VOXELS 512
+
+FVoxelGeneratorCache::FVoxelGeneratorCache(uint32 MaxSize)
+	: MaxSize(MaxSize)
+	, Generation(0)
+	, AllocatedSize(0)
+{
+}
+
+FVoxelGeneratorCache::~FVoxelGeneratorCache()
+{
+	Reset();
+}
+
+void FVoxelGeneratorCache::GetValuesAndMaterials(const FVoxelWorldGeneratorInstance& WorldGenerator, uint32 InGeneration, float Values[], FVoxelMaterial Materials[], const FIntVector& Start, const FIntVector& StartIndex, const int Step, const FIntVector& Size, const FIntVector& ArraySize)
+{
+	const int Num = Size.X * Size.Y * Size.Z;
+	if (MaxSize == 0 || Num < MIN_CACHED_VOXELS)
+	{
+		WorldGenerator.GetValuesAndMaterialsAndVoxelTypes(Values, Materials, nullptr, Start, StartIndex, Step, Size, ArraySize);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_VoxelGeneratorCache_GetValuesAndMaterials);
+
+	const FKey Key = { InGeneration, Start, Size, Step };
+
+	TSharedPtr<FRegion, ESPMode::ThreadSafe> Region;
+	{
+		FScopeLock Lock(&Section);
+		auto* Existing = Regions.Find(Key);
+		if (Existing && (!Values || (*Existing)->Values.Num()) && (!Materials || (*Existing)->Materials.Num()))
+		{
+			Region = *Existing;
+			// Most recently used
+			LRU.RemoveNode(Region->Node, false);
+			LRU.AddHead(Region->Node);
+		}
+	}
+
+	if (Region.IsValid())
+	{
+		INC_DWORD_STAT(STAT_VoxelGeneratorCacheHits);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_VoxelGeneratorCacheMisses);
+		SCOPE_CYCLE_COUNTER(STAT_VoxelGeneratorCache_Generate);
+
+		Region = MakeShared<FRegion, ESPMode::ThreadSafe>();
+		if (Values)
+		{
+			Region->Values.SetNumUninitialized(Num);
+		}
+		if (Materials)
+		{
+			Region->Materials.SetNumUninitialized(Num);
+		}
+		WorldGenerator.GetValuesAndMaterialsAndVoxelTypes(Values ? Region->Values.GetData() : nullptr, Materials ? Region->Materials.GetData() : nullptr, nullptr, Start, FIntVector::ZeroValue, Step, Size, Size);
+
+		FScopeLock Lock(&Section);
+		// Generator replaced since: its regions won't be queried anymore
+		if (InGeneration == Generation)
+		{
+			// Replaces the region if it was missing values or materials
+			Remove(Key);
+			Add(Key, Region);
+		}
+	}
+
+	// Regions are never modified once added
+	for (int K = 0; K < Size.Z; K++)
+	{
+		for (int J = 0; J < Size.Y; J++)
+		{
+			const int RegionIndex = Size.X * J + Size.X * Size.Y * K;
+			const int Index = StartIndex.X + ArraySize.X * (StartIndex.Y + J) + ArraySize.X * ArraySize.Y * (StartIndex.Z + K);
+			if (Values)
+			{
+				FMemory::Memcpy(&Values[Index], &Region->Values[RegionIndex], Size.X * sizeof(float));
+			}
+			if (Materials)
+			{
+				FMemory::Memcpy(&Materials[Index], &Region->Materials[RegionIndex], Size.X * sizeof(FVoxelMaterial));
+			}
+		}
+	}
+}
+
+uint32 FVoxelGeneratorCache::NewGeneration()
+{
+	FScopeLock Lock(&Section);
+
+	Reset();
+	return ++Generation;
+}
+
+void FVoxelGeneratorCache::Reset()
+{
+	FScopeLock Lock(&Section);
+
+	while (LRU.GetHead())
+	{
+		Remove(LRU.GetHead()->GetValue());
+	}
+	check(Regions.Num() == 0);
+	check(AllocatedSize == 0);
+}
+
+void FVoxelGeneratorCache::Add(const FKey& Key, const TSharedPtr<FRegion, ESPMode::ThreadSafe>& Region)
+{
+	const uint32 RegionSize = Region->GetAllocatedSize();
+	if (RegionSize > MaxSize)
+	{
+		return;
+	}
+
+	while (AllocatedSize + RegionSize > MaxSize)
+	{
+		// Least recently used
+		Remove(LRU.GetTail()->GetValue());
+	}
+
+	Region->Node = new TDoubleLinkedList<FKey>::TDoubleLinkedListNode(Key);
+	LRU.AddHead(Region->Node);
+	Regions.Add(Key, Region);
+
+	AllocatedSize += RegionSize;
+	INC_MEMORY_STAT_BY(STAT_VoxelGeneratorCacheMemory, RegionSize);
+}
+
+void FVoxelGeneratorCache::Remove(const FKey& Key)
+{
+	TSharedPtr<FRegion, ESPMode::ThreadSafe> Region;
+	if (Regions.RemoveAndCopyValue(Key, Region))
+	{
+		const uint32 RegionSize = Region->GetAllocatedSize();
+		AllocatedSize -= RegionSize;
+		DEC_MEMORY_STAT_BY(STAT_VoxelGeneratorCacheMemory, RegionSize);
+
+		// Deletes the node
+		LRU.RemoveNode(Region->Node);
+		Region->Node = nullptr;
+	}
+}
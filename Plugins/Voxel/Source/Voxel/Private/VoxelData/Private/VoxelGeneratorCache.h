@@ -0,0 +1,89 @@
+// Copyright 2018 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/List.h"
+#include "VoxelMaterial.h"
+
+class FVoxelWorldGeneratorInstance;
+
+/**
+ * LRU cache of the world generator values and materials, keyed by the queried region
+ * Render and collision chunks query the same regions each time they are rebuilt, eg when going back and forth across a chunk boundary
+ * Only the unedited regions are read from the world generator: edits never invalidate it
+ * Thread safe
+ */
+class FVoxelGeneratorCache
+{
+public:
+	/**
+	 * @param	MaxSize		Max memory used by the cache, in bytes. 0 to disable it
+	 */
+	FVoxelGeneratorCache(uint32 MaxSize);
+	~FVoxelGeneratorCache();
+
+	/**
+	 * Same as WorldGenerator.GetValuesAndMaterialsAndVoxelTypes, without the voxel types
+	 * @param	Generation		Generation of WorldGenerator, see NewGeneration. Values of previous generations aren't cached
+	 */
+	void GetValuesAndMaterials(const FVoxelWorldGeneratorInstance& WorldGenerator, uint32 Generation, float Values[], FVoxelMaterial Materials[], const FIntVector& Start, const FIntVector& StartIndex, const int Step, const FIntVector& Size, const FIntVector& ArraySize);
+
+	/**
+	 * Remove all the cached regions and start a new generation, for a new world generator
+	 * Regions are keyed by generation and not by generator address, as the address of a deleted generator can be reused
+	 * @return	The new generation
+	 */
+	uint32 NewGeneration();
+
+	/**
+	 * Remove all the cached regions
+	 */
+	void Reset();
+
+private:
+	struct FKey
+	{
+		uint32 Generation;
+		FIntVector Start;
+		FIntVector Size;
+		int Step;
+
+		FORCEINLINE bool operator==(const FKey& Other) const
+		{
+			return Generation == Other.Generation && Start == Other.Start && Size == Other.Size && Step == Other.Step;
+		}
+		friend FORCEINLINE uint32 GetTypeHash(const FKey& Key)
+		{
+			return HashCombine(HashCombine(::GetTypeHash(Key.Generation), GetTypeHash(Key.Start)), HashCombine(GetTypeHash(Key.Size), ::GetTypeHash(Key.Step)));
+		}
+	};
+
+	struct FRegion
+	{
+		// Empty if not queried
+		TArray<float> Values;
+		TArray<FVoxelMaterial> Materials;
+
+		// Node in LRU list
+		TDoubleLinkedList<FKey>::TDoubleLinkedListNode* Node = nullptr;
+
+		uint32 GetAllocatedSize() const
+		{
+			return sizeof(FRegion) + Values.GetAllocatedSize() + Materials.GetAllocatedSize();
+		}
+	};
+
+	const uint32 MaxSize;
+
+	FCriticalSection Section;
+	// Current generation. Readers of the previous states can still query the previous ones
+	uint32 Generation;
+	TMap<FKey, TSharedPtr<FRegion, ESPMode::ThreadSafe>> Regions;
+	// Most recently used first
+	TDoubleLinkedList<FKey> LRU;
+	uint32 AllocatedSize;
+
+	void Add(const FKey& Key, const TSharedPtr<FRegion, ESPMode::ThreadSafe>& Region);
+	void Remove(const FKey& Key);
+};
@@ -0,0 +1,136 @@
+// Copyright 2018 Phyronnaz
+
+#include "VoxelPageStore.h"
+#include "VoxelPrivate.h"
+#include "PlatformFilemanager.h"
+#include "GenericPlatformFile.h"
+#include "Paths.h"
+#include "ScopeLock.h"
+
+DECLARE_MEMORY_STAT(TEXT("Voxel Page Store Size"), STAT_VoxelPageStoreSize, STATGROUP_Voxel);
+
+FVoxelPageStore::FVoxelPageStore()
+	: Filename(FPaths::ProjectSavedDir() / TEXT("VoxelPages") / FGuid::NewGuid().ToString() + TEXT(".pages"))
+	, bOpenFailed(false)
+	, FileSize(0)
+{
+
+}
+
+FVoxelPageStore::~FVoxelPageStore()
+{
+	if (File.IsValid())
+	{
+		File.Reset();
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Filename);
+	}
+	DEC_MEMORY_STAT_BY(STAT_VoxelPageStoreSize, FileSize);
+}
+
+int64 FVoxelPageStore::Write(const TArray<uint8>& Data)
+{
+	FScopeLock Lock(&Section);
+
+	if (!File.IsValid() && !OpenFile())
+	{
+		return -1;
+	}
+
+	const int64 Offset = Allocate(Data.Num());
+	if (!File->Seek(Offset) || !File->Write(Data.GetData(), Data.Num()))
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to write voxel page to %s"), *Filename);
+		Free(Offset, Data.Num());
+		return -1;
+	}
+	return Offset;
+}
+
+bool FVoxelPageStore::Read(int64 Offset, int32 Size, TArray<uint8>& OutData)
+{
+	FScopeLock Lock(&Section);
+
+	check(File.IsValid() && Offset + Size <= FileSize);
+
+	OutData.SetNumUninitialized(Size);
+	return File->Seek(Offset) && File->Read(OutData.GetData(), Size);
+}
+
+void FVoxelPageStore::Free(int64 Offset, int32 Size)
+{
+	FScopeLock Lock(&Section);
+
+	// First range after the freed one
+	int Index = 0;
+	while (Index < FreeRanges.Num() && FreeRanges[Index].Offset < Offset)
+	{
+		Index++;
+	}
+	FreeRanges.Insert(FFreeRange{ Offset, Size }, Index);
+
+	// Merge with the next and previous ranges
+	if (Index + 1 < FreeRanges.Num() && FreeRanges[Index].Offset + FreeRanges[Index].Size == FreeRanges[Index + 1].Offset)
+	{
+		FreeRanges[Index].Size += FreeRanges[Index + 1].Size;
+		FreeRanges.RemoveAt(Index + 1);
+	}
+	if (Index > 0 && FreeRanges[Index - 1].Offset + FreeRanges[Index - 1].Size == FreeRanges[Index].Offset)
+	{
+		FreeRanges[Index - 1].Size += FreeRanges[Index].Size;
+		FreeRanges.RemoveAt(Index);
+		Index--;
+	}
+
+	// Shrink the used part of the file
+	if (FreeRanges[Index].Offset + FreeRanges[Index].Size == FileSize)
+	{
+		DEC_MEMORY_STAT_BY(STAT_VoxelPageStoreSize, FreeRanges[Index].Size);
+		FileSize = FreeRanges[Index].Offset;
+		FreeRanges.RemoveAt(Index);
+	}
+}
+
+bool FVoxelPageStore::OpenFile()
+{
+	if (bOpenFailed)
+	{
+		return false;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+	File.Reset(PlatformFile.OpenWrite(*Filename, false, true));
+
+	if (!File.IsValid())
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Failed to create the voxel page file %s: cold chunks stay in memory"), *Filename);
+		bOpenFailed = true;
+		return false;
+	}
+	return true;
+}
+
+int64 FVoxelPageStore::Allocate(int32 Size)
+{
+	// First fit
+	for (int Index = 0; Index < FreeRanges.Num(); Index++)
+	{
+		FFreeRange& Range = FreeRanges[Index];
+		if (Range.Size >= Size)
+		{
+			const int64 Offset = Range.Offset;
+			Range.Offset += Size;
+			Range.Size -= Size;
+			if (Range.Size == 0)
+			{
+				FreeRanges.RemoveAt(Index);
+			}
+			return Offset;
+		}
+	}
+
+	const int64 Offset = FileSize;
+	FileSize += Size;
+	INC_MEMORY_STAT_BY(STAT_VoxelPageStoreSize, Size);
+	return Offset;
+}
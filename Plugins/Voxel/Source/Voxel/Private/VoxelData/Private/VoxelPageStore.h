@@ -0,0 +1,54 @@
+// Copyright 2018 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IFileHandle;
+
+/**
+ * Temporary file holding the data of the chunks paged out of memory, see FVoxelCompactChunk
+ * The space of the freed pages is reused. The file is deleted with the store. Thread safe
+ */
+class FVoxelPageStore
+{
+public:
+	FVoxelPageStore();
+	~FVoxelPageStore();
+
+	/**
+	 * Write a page
+	 * @return	Offset of the page in the file, -1 if the write failed
+	 */
+	int64 Write(const TArray<uint8>& Data);
+	/**
+	 * Read a page written by Write
+	 * @param	OutData		Set to the page content
+	 */
+	bool Read(int64 Offset, int32 Size, TArray<uint8>& OutData);
+	/**
+	 * Free a page written by Write
+	 */
+	void Free(int64 Offset, int32 Size);
+
+private:
+	struct FFreeRange
+	{
+		int64 Offset;
+		int64 Size;
+	};
+
+	const FString Filename;
+	TUniquePtr<IFileHandle> File;
+	// Don't try to create the file again
+	bool bOpenFailed;
+	// Used part of the file
+	int64 FileSize;
+	// Sorted by offset, never adjacent
+	TArray<FFreeRange> FreeRanges;
+
+	FCriticalSection Section;
+
+	bool OpenFile();
+	int64 Allocate(int32 Size);
+};
@@ -69,6 +69,86 @@ GENERATED_GETCOMPUTENODE(BNot)
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Call ScalarOp(Lane) on each active lane
+ */
+template<typename TScalarOp>
+FORCEINLINE void ForEachLane(const FVoxelBatchLanes& Lanes, TScalarOp ScalarOp)
+{
+	if (Lanes.bDense)
+	{
+		for (int Lane = 0; Lane < Lanes.Num; Lane++)
+		{
+			ScalarOp(Lane);
+		}
+	}
+	else
+	{
+		for (int Index = 0; Index < Lanes.Num; Index++)
+		{
+			ScalarOp(Lanes.Indices[Index]);
+		}
+	}
+}
+
+/**
+ * If the lanes are dense, call VectorOp(Lane) for each group of 4 lanes and ScalarOp(Lane) for the remaining ones
+ * Else call ScalarOp(Lane) on each active lane
+ */
+template<typename TVectorOp, typename TScalarOp>
+FORCEINLINE void ForEachLaneVectorized(const FVoxelBatchLanes& Lanes, TVectorOp VectorOp, TScalarOp ScalarOp)
+{
+	if (Lanes.bDense)
+	{
+		int Lane = 0;
+		for (; Lane + 4 <= Lanes.Num; Lane += 4)
+		{
+			VectorOp(Lane);
+		}
+		for (; Lane < Lanes.Num; Lane++)
+		{
+			ScalarOp(Lane);
+		}
+	}
+	else
+	{
+		for (int Index = 0; Index < Lanes.Num; Index++)
+		{
+			ScalarOp(Lanes.Indices[Index]);
+		}
+	}
+}
+
+/**
+ * Fold the ranges of the inputs with Op: Op(Op(Inputs[0], Inputs[1]), Inputs[2])...
+ */
+template<typename TOp>
+FORCEINLINE FVoxelRange FoldRanges(const FVoxelRange Inputs[], int32 InputCount, TOp Op)
+{
+	FVoxelRange X = Inputs[0];
+	for (int i = 1; i < InputCount; i++)
+	{
+		X = Op(X, Inputs[i]);
+	}
+	return X;
+}
+
+/**
+ * Same as FoldRanges, for the generated code. Op is a FVoxelRange static function name
+ */
+FString FoldRangesCpp(const TArray<FString>& Inputs, int32 InputCount, const FString& Op)
+{
+	FString Cpp = Inputs[0];
+	for (int i = 1; i < InputCount; i++)
+	{
+		Cpp = TEXT("FVoxelRange::") + Op + TEXT("(") + Cpp + TEXT(", ") + Inputs[i] + TEXT(")");
+	}
+	return Cpp;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 void FVoxelComputeNode_MakeMaterial::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outputs[], const FVoxelContext& Context) const
 {
 	Outputs[0].M.Index1 = FMath::Clamp<int>(Inputs[0].I, 0, 255);
@@ -141,11 +221,30 @@ void FVoxelComputeNode_XF::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outpu
 	Outputs[0].F = Context.X;
 }
 
+void FVoxelComputeNode_XF::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].F = Context.X[Lane];
+	});
+}
+
+void FVoxelComputeNode_XF::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange(Bounds.Min.X, Bounds.Max.X - 1);
+}
+
 void FVoxelComputeNode_XF::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Context + TEXT(".X") + TEXT(";"));
 }
 
+void FVoxelComputeNode_XF::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + Bounds + TEXT(".Min.X, ") + Bounds + TEXT(".Max.X - 1);"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -154,11 +253,30 @@ void FVoxelComputeNode_YF::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outpu
 	Outputs[0].F = Context.Y;
 }
 
+void FVoxelComputeNode_YF::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].F = Context.Y[Lane];
+	});
+}
+
+void FVoxelComputeNode_YF::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange(Bounds.Min.Y, Bounds.Max.Y - 1);
+}
+
 void FVoxelComputeNode_YF::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Context + TEXT(".Y") + TEXT(";"));
 }
 
+void FVoxelComputeNode_YF::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + Bounds + TEXT(".Min.Y, ") + Bounds + TEXT(".Max.Y - 1);"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -167,11 +285,30 @@ void FVoxelComputeNode_ZF::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outpu
 	Outputs[0].F = Context.Z;
 }
 
+void FVoxelComputeNode_ZF::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].F = Context.Z[Lane];
+	});
+}
+
+void FVoxelComputeNode_ZF::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange(Bounds.Min.Z, Bounds.Max.Z - 1);
+}
+
 void FVoxelComputeNode_ZF::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Context + TEXT(".Z") + TEXT(";"));
 }
 
+void FVoxelComputeNode_ZF::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + Bounds + TEXT(".Min.Z, ") + Bounds + TEXT(".Max.Z - 1);"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -180,11 +317,30 @@ void FVoxelComputeNode_XI::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outpu
 	Outputs[0].I = Context.X;
 }
 
+void FVoxelComputeNode_XI::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].I = Context.X[Lane];
+	});
+}
+
+void FVoxelComputeNode_XI::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange(Bounds.Min.X, Bounds.Max.X - 1);
+}
+
 void FVoxelComputeNode_XI::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Context + TEXT(".X") + TEXT(";"));
 }
 
+void FVoxelComputeNode_XI::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + Bounds + TEXT(".Min.X, ") + Bounds + TEXT(".Max.X - 1);"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -193,11 +349,30 @@ void FVoxelComputeNode_YI::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outpu
 	Outputs[0].I = Context.Y;
 }
 
+void FVoxelComputeNode_YI::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].I = Context.Y[Lane];
+	});
+}
+
+void FVoxelComputeNode_YI::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange(Bounds.Min.Y, Bounds.Max.Y - 1);
+}
+
 void FVoxelComputeNode_YI::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Context + TEXT(".Y") + TEXT(";"));
 }
 
+void FVoxelComputeNode_YI::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + Bounds + TEXT(".Min.Y, ") + Bounds + TEXT(".Max.Y - 1);"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -206,10 +381,29 @@ void FVoxelComputeNode_ZI::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outpu
 	Outputs[0].I = Context.Z;
 }
 
+void FVoxelComputeNode_ZI::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].I = Context.Z[Lane];
+	});
+}
+
+void FVoxelComputeNode_ZI::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange(Bounds.Min.Z, Bounds.Max.Z - 1);
+}
+
 void FVoxelComputeNode_ZI::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Context + TEXT(".Z") + TEXT(";"));
 }
+
+void FVoxelComputeNode_ZI::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + Bounds + TEXT(".Min.Z, ") + Bounds + TEXT(".Max.Z - 1);"));
+}
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -218,6 +412,20 @@ void FVoxelComputeNode_FConstant::Compute(FVoxelNodeType Inputs[], FVoxelNodeTyp
 	Outputs[0].F = Value;
 }
 
+void FVoxelComputeNode_FConstant::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].F = Value;
+	});
+}
+
+void FVoxelComputeNode_FConstant::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange(Value);
+}
+
 void FVoxelComputeNode_FConstant::GetExposedVariables(TArray<FVoxelExposedVariable>& Variables) const
 {
 	if (bExposeToBP)
@@ -242,6 +450,18 @@ void FVoxelComputeNode_FConstant::GetMain(const TArray<FString>& Inputs, const T
 	}
 }
 
+void FVoxelComputeNode_FConstant::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	if (bExposeToBP)
+	{
+		OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + UniqueName + TEXT(");"));
+	}
+	else
+	{
+		OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + FString::SanitizeFloat(Value) + TEXT(");"));
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -250,6 +470,20 @@ void FVoxelComputeNode_IConstant::Compute(FVoxelNodeType Inputs[], FVoxelNodeTyp
 	Outputs[0].I = Value;
 }
 
+void FVoxelComputeNode_IConstant::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].I = Value;
+	});
+}
+
+void FVoxelComputeNode_IConstant::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange((float)Value);
+}
+
 void FVoxelComputeNode_IConstant::GetExposedVariables(TArray<FVoxelExposedVariable>& Variables) const
 {
 	if (bExposeToBP)
@@ -274,6 +508,18 @@ void FVoxelComputeNode_IConstant::GetMain(const TArray<FString>& Inputs, const T
 	}
 }
 
+void FVoxelComputeNode_IConstant::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	if (bExposeToBP)
+	{
+		OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + UniqueName + TEXT(");"));
+	}
+	else
+	{
+		OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange(") + FString::FromInt(Value) + TEXT(");"));
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -282,11 +528,30 @@ void FVoxelComputeNode_FloatOfInt::Compute(FVoxelNodeType Inputs[], FVoxelNodeTy
 	Outputs[0].F = (float)Inputs[0].I;
 }
 
+void FVoxelComputeNode_FloatOfInt::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].F = (float)Inputs[0][Lane].I;
+	});
+}
+
+void FVoxelComputeNode_FloatOfInt::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = Inputs[0];
+}
+
 void FVoxelComputeNode_FloatOfInt::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = (float)") + Inputs[0] + TEXT(";"));
 }
 
+void FVoxelComputeNode_FloatOfInt::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + Inputs[0] + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -295,11 +560,30 @@ void FVoxelComputeNode_Round::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Ou
 	Outputs[0].I = FMath::RoundToInt(Inputs[0].F);
 }
 
+void FVoxelComputeNode_Round::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].I = FMath::RoundToInt(Inputs[0][Lane].F);
+	});
+}
+
+void FVoxelComputeNode_Round::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Round(Inputs[0]);
+}
+
 void FVoxelComputeNode_Round::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = FMath::RoundToInt(") + Inputs[0] + TEXT(");"));
 }
 
+void FVoxelComputeNode_Round::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Round(") + Inputs[0] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -314,6 +598,35 @@ void FVoxelComputeNode_Max::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outp
 	Outputs[0].F = X;
 }
 
+void FVoxelComputeNode_Max::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			VectorRegister X = VectorLoad(&Inputs[0][Lane]);
+			for (int i = 1; i < InputCount; i++)
+			{
+				X = VectorMax(X, VectorLoad(&Inputs[i][Lane]));
+			}
+			VectorStore(X, &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			float X = Inputs[0][Lane].F;
+			for (int i = 1; i < InputCount; i++)
+			{
+				X = FMath::Max(X, Inputs[i][Lane].F);
+			}
+			Out[Lane].F = X;
+		});
+}
+
+void FVoxelComputeNode_Max::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FoldRanges(Inputs, InputCount, &FVoxelRange::Maximum);
+}
+
 void FVoxelComputeNode_Max::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = "));
@@ -331,6 +644,11 @@ void FVoxelComputeNode_Max::GetMain(const TArray<FString>& Inputs, const TArray<
 	OutCpp.Append(TEXT(";"));
 }
 
+void FVoxelComputeNode_Max::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + FoldRangesCpp(Inputs, InputCount, TEXT("Maximum")) + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -345,6 +663,35 @@ void FVoxelComputeNode_Min::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outp
 	Outputs[0].F = X;
 }
 
+void FVoxelComputeNode_Min::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			VectorRegister X = VectorLoad(&Inputs[0][Lane]);
+			for (int i = 1; i < InputCount; i++)
+			{
+				X = VectorMin(X, VectorLoad(&Inputs[i][Lane]));
+			}
+			VectorStore(X, &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			float X = Inputs[0][Lane].F;
+			for (int i = 1; i < InputCount; i++)
+			{
+				X = FMath::Min(X, Inputs[i][Lane].F);
+			}
+			Out[Lane].F = X;
+		});
+}
+
+void FVoxelComputeNode_Min::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FoldRanges(Inputs, InputCount, &FVoxelRange::Minimum);
+}
+
 void FVoxelComputeNode_Min::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = "));
@@ -362,6 +709,11 @@ void FVoxelComputeNode_Min::GetMain(const TArray<FString>& Inputs, const TArray<
 	OutCpp.Append(TEXT(";"));
 }
 
+void FVoxelComputeNode_Min::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + FoldRangesCpp(Inputs, InputCount, TEXT("Minimum")) + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -370,11 +722,30 @@ void FVoxelComputeNode_Less::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].B = Inputs[0].F < Inputs[1].F;
 }
 
+void FVoxelComputeNode_Less::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].B = Inputs[0][Lane].F < Inputs[1][Lane].F;
+	});
+}
+
+void FVoxelComputeNode_Less::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Less(Inputs[0], Inputs[1]);
+}
+
 void FVoxelComputeNode_Less::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Inputs[0] + TEXT(" < ") + Inputs[1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_Less::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Less(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -383,10 +754,29 @@ void FVoxelComputeNode_LessEqual::Compute(FVoxelNodeType Inputs[], FVoxelNodeTyp
 	Outputs[0].B = Inputs[0].F <= Inputs[1].F;
 }
 
+void FVoxelComputeNode_LessEqual::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].B = Inputs[0][Lane].F <= Inputs[1][Lane].F;
+	});
+}
+
+void FVoxelComputeNode_LessEqual::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::LessEqual(Inputs[0], Inputs[1]);
+}
+
 void FVoxelComputeNode_LessEqual::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Inputs[0] + TEXT(" <= ") + Inputs[1] + TEXT(";"));
 }
+
+void FVoxelComputeNode_LessEqual::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::LessEqual(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(");"));
+}
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -395,10 +785,29 @@ void FVoxelComputeNode_Greater::Compute(FVoxelNodeType Inputs[], FVoxelNodeType
 	Outputs[0].B = Inputs[0].F > Inputs[1].F;
 }
 
+void FVoxelComputeNode_Greater::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].B = Inputs[0][Lane].F > Inputs[1][Lane].F;
+	});
+}
+
+void FVoxelComputeNode_Greater::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Greater(Inputs[0], Inputs[1]);
+}
+
 void FVoxelComputeNode_Greater::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Inputs[0] + TEXT(" > ") + Inputs[1] + TEXT(";"));
 }
+
+void FVoxelComputeNode_Greater::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Greater(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(");"));
+}
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -407,10 +816,29 @@ void FVoxelComputeNode_GreaterEqual::Compute(FVoxelNodeType Inputs[], FVoxelNode
 	Outputs[0].B = Inputs[0].F >= Inputs[1].F;
 }
 
+void FVoxelComputeNode_GreaterEqual::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].B = Inputs[0][Lane].F >= Inputs[1][Lane].F;
+	});
+}
+
+void FVoxelComputeNode_GreaterEqual::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::GreaterEqual(Inputs[0], Inputs[1]);
+}
+
 void FVoxelComputeNode_GreaterEqual::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Inputs[0] + TEXT(" >= ") + Inputs[1] + TEXT(";"));
 }
+
+void FVoxelComputeNode_GreaterEqual::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::GreaterEqual(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(");"));
+}
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -419,11 +847,38 @@ void FVoxelComputeNode_Lerp::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].F = FMath::Lerp(Inputs[0].F, Inputs[1].F, Inputs[2].F);
 }
 
+void FVoxelComputeNode_Lerp::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			const VectorRegister A = VectorLoad(&Inputs[0][Lane]);
+			const VectorRegister B = VectorLoad(&Inputs[1][Lane]);
+			const VectorRegister Alpha = VectorLoad(&Inputs[2][Lane]);
+			VectorStore(VectorMultiplyAdd(Alpha, VectorSubtract(B, A), A), &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			Out[Lane].F = FMath::Lerp(Inputs[0][Lane].F, Inputs[1][Lane].F, Inputs[2][Lane].F);
+		});
+}
+
+void FVoxelComputeNode_Lerp::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Lerp(Inputs[0], Inputs[1], Inputs[2]);
+}
+
 void FVoxelComputeNode_Lerp::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + TEXT("FMath::Lerp<float>(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(", ") + Inputs[2] + TEXT(");"));
 }
 
+void FVoxelComputeNode_Lerp::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Lerp(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(", ") + Inputs[2] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -432,11 +887,35 @@ void FVoxelComputeNode_Clamp::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Ou
 	Outputs[0].F = FMath::Clamp(Inputs[0].F, Inputs[1].F, Inputs[2].F);
 }
 
+void FVoxelComputeNode_Clamp::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			VectorStore(VectorMin(VectorMax(VectorLoad(&Inputs[0][Lane]), VectorLoad(&Inputs[1][Lane])), VectorLoad(&Inputs[2][Lane])), &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			Out[Lane].F = FMath::Clamp(Inputs[0][Lane].F, Inputs[1][Lane].F, Inputs[2][Lane].F);
+		});
+}
+
+void FVoxelComputeNode_Clamp::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Clamp(Inputs[0], Inputs[1], Inputs[2]);
+}
+
 void FVoxelComputeNode_Clamp::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + TEXT("FMath::Clamp<float>(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(", ") + Inputs[2] + TEXT(");"));
 }
 
+void FVoxelComputeNode_Clamp::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Clamp(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(", ") + Inputs[2] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -451,6 +930,35 @@ void FVoxelComputeNode_FAdd::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].F = X;
 }
 
+void FVoxelComputeNode_FAdd::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			VectorRegister X = VectorLoad(&Inputs[0][Lane]);
+			for (int i = 1; i < InputCount; i++)
+			{
+				X = VectorAdd(X, VectorLoad(&Inputs[i][Lane]));
+			}
+			VectorStore(X, &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			float X = Inputs[0][Lane].F;
+			for (int i = 1; i < InputCount; i++)
+			{
+				X += Inputs[i][Lane].F;
+			}
+			Out[Lane].F = X;
+		});
+}
+
+void FVoxelComputeNode_FAdd::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FoldRanges(Inputs, InputCount, &FVoxelRange::Add);
+}
+
 void FVoxelComputeNode_FAdd::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = "));
@@ -461,6 +969,11 @@ void FVoxelComputeNode_FAdd::GetMain(const TArray<FString>& Inputs, const TArray
 	OutCpp.Append(Inputs[InputCount - 1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_FAdd::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + FoldRangesCpp(Inputs, InputCount, TEXT("Add")) + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -469,11 +982,35 @@ void FVoxelComputeNode_FSubstract::Compute(FVoxelNodeType Inputs[], FVoxelNodeTy
 	Outputs[0].F = Inputs[0].F - Inputs[1].F;
 }
 
+void FVoxelComputeNode_FSubstract::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			VectorStore(VectorSubtract(VectorLoad(&Inputs[0][Lane]), VectorLoad(&Inputs[1][Lane])), &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			Out[Lane].F = Inputs[0][Lane].F - Inputs[1][Lane].F;
+		});
+}
+
+void FVoxelComputeNode_FSubstract::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Sub(Inputs[0], Inputs[1]);
+}
+
 void FVoxelComputeNode_FSubstract::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Inputs[0] + TEXT(" - ") + Inputs[1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_FSubstract::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Sub(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -488,6 +1025,35 @@ void FVoxelComputeNode_FMultiply::Compute(FVoxelNodeType Inputs[], FVoxelNodeTyp
 	Outputs[0].F = X;
 }
 
+void FVoxelComputeNode_FMultiply::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			VectorRegister X = VectorLoad(&Inputs[0][Lane]);
+			for (int i = 1; i < InputCount; i++)
+			{
+				X = VectorMultiply(X, VectorLoad(&Inputs[i][Lane]));
+			}
+			VectorStore(X, &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			float X = Inputs[0][Lane].F;
+			for (int i = 1; i < InputCount; i++)
+			{
+				X *= Inputs[i][Lane].F;
+			}
+			Out[Lane].F = X;
+		});
+}
+
+void FVoxelComputeNode_FMultiply::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FoldRanges(Inputs, InputCount, &FVoxelRange::Mul);
+}
+
 void FVoxelComputeNode_FMultiply::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = "));
@@ -498,6 +1064,11 @@ void FVoxelComputeNode_FMultiply::GetMain(const TArray<FString>& Inputs, const T
 	OutCpp.Append(Inputs[InputCount - 1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_FMultiply::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + FoldRangesCpp(Inputs, InputCount, TEXT("Mul")) + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -506,11 +1077,30 @@ void FVoxelComputeNode_FDivide::Compute(FVoxelNodeType Inputs[], FVoxelNodeType
 	Outputs[0].F = Inputs[0].F / Inputs[1].F;
 }
 
+void FVoxelComputeNode_FDivide::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].F = Inputs[0][Lane].F / Inputs[1][Lane].F;
+	});
+}
+
+void FVoxelComputeNode_FDivide::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Div(Inputs[0], Inputs[1]);
+}
+
 void FVoxelComputeNode_FDivide::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Inputs[0] + TEXT(" / ") + Inputs[1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_FDivide::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Div(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -525,6 +1115,25 @@ void FVoxelComputeNode_IAdd::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].I = X;
 }
 
+void FVoxelComputeNode_IAdd::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		int32 X = Inputs[0][Lane].I;
+		for (int i = 1; i < InputCount; i++)
+		{
+			X += Inputs[i][Lane].I;
+		}
+		Out[Lane].I = X;
+	});
+}
+
+void FVoxelComputeNode_IAdd::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FoldRanges(Inputs, InputCount, &FVoxelRange::Add);
+}
+
 void FVoxelComputeNode_IAdd::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = "));
@@ -535,6 +1144,11 @@ void FVoxelComputeNode_IAdd::GetMain(const TArray<FString>& Inputs, const TArray
 	OutCpp.Append(Inputs[InputCount - 1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_IAdd::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + FoldRangesCpp(Inputs, InputCount, TEXT("Add")) + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -543,11 +1157,30 @@ void FVoxelComputeNode_ISubstract::Compute(FVoxelNodeType Inputs[], FVoxelNodeTy
 	Outputs[0].I = Inputs[0].I - Inputs[1].I;
 }
 
+void FVoxelComputeNode_ISubstract::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].I = Inputs[0][Lane].I - Inputs[1][Lane].I;
+	});
+}
+
+void FVoxelComputeNode_ISubstract::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Sub(Inputs[0], Inputs[1]);
+}
+
 void FVoxelComputeNode_ISubstract::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = ") + Inputs[0] + TEXT(" - ") + Inputs[1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_ISubstract::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Sub(") + Inputs[0] + TEXT(", ") + Inputs[1] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -562,6 +1195,25 @@ void FVoxelComputeNode_IMultiply::Compute(FVoxelNodeType Inputs[], FVoxelNodeTyp
 	Outputs[0].I = X;
 }
 
+void FVoxelComputeNode_IMultiply::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		int32 X = Inputs[0][Lane].I;
+		for (int i = 1; i < InputCount; i++)
+		{
+			X *= Inputs[i][Lane].I;
+		}
+		Out[Lane].I = X;
+	});
+}
+
+void FVoxelComputeNode_IMultiply::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FoldRanges(Inputs, InputCount, &FVoxelRange::Mul);
+}
+
 void FVoxelComputeNode_IMultiply::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = "));
@@ -572,6 +1224,11 @@ void FVoxelComputeNode_IMultiply::GetMain(const TArray<FString>& Inputs, const T
 	OutCpp.Append(Inputs[InputCount - 1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_IMultiply::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + FoldRangesCpp(Inputs, InputCount, TEXT("Mul")) + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -593,11 +1250,35 @@ void FVoxelComputeNode_1MinusX::Compute(FVoxelNodeType Inputs[], FVoxelNodeType
 	Outputs[0].F = 1 - Inputs[0].F;
 }
 
+void FVoxelComputeNode_1MinusX::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			VectorStore(VectorSubtract(VectorOne(), VectorLoad(&Inputs[0][Lane])), &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			Out[Lane].F = 1 - Inputs[0][Lane].F;
+		});
+}
+
+void FVoxelComputeNode_1MinusX::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::OneMinus(Inputs[0]);
+}
+
 void FVoxelComputeNode_1MinusX::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = 1 - ") + Inputs[0] + TEXT(";"));
 }
 
+void FVoxelComputeNode_1MinusX::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::OneMinus(") + Inputs[0] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -606,11 +1287,30 @@ void FVoxelComputeNode_Sqrt::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].F = FMath::Sqrt(Inputs[0].F);
 }
 
+void FVoxelComputeNode_Sqrt::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].F = FMath::Sqrt(Inputs[0][Lane].F);
+	});
+}
+
+void FVoxelComputeNode_Sqrt::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Sqrt(Inputs[0]);
+}
+
 void FVoxelComputeNode_Sqrt::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = FMath::Sqrt(") + Inputs[0] + TEXT(");"));
 }
 
+void FVoxelComputeNode_Sqrt::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Sqrt(") + Inputs[0] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -645,11 +1345,35 @@ void FVoxelComputeNode_FAbs::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].F = FMath::Abs(Inputs[0].F);
 }
 
+void FVoxelComputeNode_FAbs::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLaneVectorized(Lanes,
+		[&](int Lane)
+		{
+			VectorStore(VectorAbs(VectorLoad(&Inputs[0][Lane])), &Out[Lane]);
+		},
+		[&](int Lane)
+		{
+			Out[Lane].F = FMath::Abs(Inputs[0][Lane].F);
+		});
+}
+
+void FVoxelComputeNode_FAbs::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Abs(Inputs[0]);
+}
+
 void FVoxelComputeNode_FAbs::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = FMath::Abs(") + Inputs[0] + TEXT(");"));
 }
 
+void FVoxelComputeNode_FAbs::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Abs(") + Inputs[0] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -658,11 +1382,30 @@ void FVoxelComputeNode_IAbs::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].I = FMath::Abs(Inputs[0].I);
 }
 
+void FVoxelComputeNode_IAbs::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].I = FMath::Abs(Inputs[0][Lane].I);
+	});
+}
+
+void FVoxelComputeNode_IAbs::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Abs(Inputs[0]);
+}
+
 void FVoxelComputeNode_IAbs::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = FMath::Abs(") + Inputs[0] + TEXT(");"));
 }
 
+void FVoxelComputeNode_IAbs::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Abs(") + Inputs[0] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -761,6 +1504,25 @@ void FVoxelComputeNode_BAnd::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].B = X;
 }
 
+void FVoxelComputeNode_BAnd::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		bool X = Inputs[0][Lane].B;
+		for (int i = 1; i < InputCount; i++)
+		{
+			X = X && Inputs[i][Lane].B;
+		}
+		Out[Lane].B = X;
+	});
+}
+
+void FVoxelComputeNode_BAnd::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FoldRanges(Inputs, InputCount, &FVoxelRange::And);
+}
+
 void FVoxelComputeNode_BAnd::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = "));
@@ -771,6 +1533,11 @@ void FVoxelComputeNode_BAnd::GetMain(const TArray<FString>& Inputs, const TArray
 	OutCpp.Append(Inputs[InputCount - 1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_BAnd::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + FoldRangesCpp(Inputs, InputCount, TEXT("And")) + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -785,6 +1552,25 @@ void FVoxelComputeNode_BOr::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Outp
 	Outputs[0].B = X;
 }
 
+void FVoxelComputeNode_BOr::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		bool X = Inputs[0][Lane].B;
+		for (int i = 1; i < InputCount; i++)
+		{
+			X = X || Inputs[i][Lane].B;
+		}
+		Out[Lane].B = X;
+	});
+}
+
+void FVoxelComputeNode_BOr::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FoldRanges(Inputs, InputCount, &FVoxelRange::Or);
+}
+
 void FVoxelComputeNode_BOr::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = "));
@@ -795,6 +1581,11 @@ void FVoxelComputeNode_BOr::GetMain(const TArray<FString>& Inputs, const TArray<
 	OutCpp.Append(Inputs[InputCount - 1] + TEXT(";"));
 }
 
+void FVoxelComputeNode_BOr::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = ") + FoldRangesCpp(Inputs, InputCount, TEXT("Or")) + TEXT(";"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -803,10 +1594,29 @@ void FVoxelComputeNode_BNot::Compute(FVoxelNodeType Inputs[], FVoxelNodeType Out
 	Outputs[0].B = !Inputs[0].B;
 }
 
+void FVoxelComputeNode_BNot::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* const Out = Outputs[0];
+	ForEachLane(Lanes, [&](int Lane)
+	{
+		Out[Lane].B = !Inputs[0][Lane].B;
+	});
+}
+
+void FVoxelComputeNode_BNot::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	Outputs[0] = FVoxelRange::Not(Inputs[0]);
+}
+
 void FVoxelComputeNode_BNot::GetMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Context, FString& OutCpp) const
 {
 	OutCpp.Append(Outputs[0] + TEXT(" = !") + Inputs[0] + TEXT(";"));
 }
 
+void FVoxelComputeNode_BNot::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	OutCpp.Append(Outputs[0] + TEXT(" = FVoxelRange::Not(") + Inputs[0] + TEXT(");"));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
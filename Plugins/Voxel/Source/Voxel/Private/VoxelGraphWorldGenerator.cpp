@@ -43,6 +43,61 @@ void FVoxelComputeNodeTree::SetNodes(const TArray<TSharedPtr<FVoxelComputeNode>>
 	{
 		Nodes[i] = InNodes[i];
 	}
+
+	DefaultRegisters.Reset();
+	DefaultRegistersOffsets.Init(-1, NodesCount * MAX_PINS);
+	for (int NodeIndex = 0; NodeIndex < NodesCount; NodeIndex++)
+	{
+		auto& Node = Nodes[NodeIndex];
+		for (int InputIndex = 0; InputIndex < Node->InputCount; InputIndex++)
+		{
+			if (Node->GetInputId(InputIndex) == -1)
+			{
+				DefaultRegistersOffsets[NodeIndex * MAX_PINS + InputIndex] = DefaultRegisters.Num();
+				const FVoxelNodeType DefaultValue = Node->GetDefaultValue(InputIndex);
+				for (int Lane = 0; Lane < VOXEL_BATCH_SIZE; Lane++)
+				{
+					DefaultRegisters.Add(DefaultValue);
+				}
+			}
+		}
+	}
+
+	TMap<int32, uint8> VariablesDependencies;
+	NodesDependencies.SetNum(NodesCount);
+	for (int NodeIndex = 0; NodeIndex < NodesCount; NodeIndex++)
+	{
+		auto& Node = Nodes[NodeIndex];
+		uint8 Dependencies = Node->GetContextDependencies();
+		for (int InputIndex = 0; InputIndex < Node->InputCount; InputIndex++)
+		{
+			int32 Id = Node->GetInputId(InputIndex);
+			if (Id != -1)
+			{
+				const uint8* InputDependencies = VariablesDependencies.Find(Id);
+				Dependencies |= InputDependencies ? *InputDependencies : (uint8)EVoxelContextDependency::All;
+			}
+		}
+		for (int OutputIndex = 0; OutputIndex < Node->OutputCount; OutputIndex++)
+		{
+			VariablesDependencies.Add(Node->GetOutputId(OutputIndex), Dependencies);
+		}
+		NodesDependencies[NodeIndex] = Dependencies;
+	}
+}
+
+int32 FVoxelComputeNodeTree::GetBatchNodesCount() const
+{
+	int NodeIndex = 0;
+	for (; NodeIndex < NodesCount - (ChildsCount ? 1 : 0); NodeIndex++)
+	{
+		auto& Node = Nodes[NodeIndex];
+		if (Node->IsSetValueNode() || Node->IsSetMaterialNode() || Node->IsSetVoxelTypeNode())
+		{
+			break;
+		}
+	}
+	return NodeIndex;
 }
 
 void FVoxelComputeNodeTree::Compute(FVoxelNodeType Variables[], const FVoxelContext& Context, float& Value, FVoxelMaterial& Material, FVoxelType& VoxelType) const
@@ -130,6 +185,216 @@ void FVoxelComputeNodeTree::Compute(FVoxelNodeType Variables[], const FVoxelCont
 	}
 }
 
+void FVoxelComputeNodeTree::GetBatchInputs(int32 NodeIndex, FVoxelNodeType Registers[], FVoxelNodeType* OutInputs[]) const
+{
+	auto& Node = Nodes[NodeIndex];
+	for (int InputIndex = 0; InputIndex < Node->InputCount; InputIndex++)
+	{
+		int32 Id = Node->GetInputId(InputIndex);
+		if (Id == -1)
+		{
+			// Only read by the node, so it's safe to share it between threads
+			OutInputs[InputIndex] = const_cast<FVoxelNodeType*>(&DefaultRegisters[DefaultRegistersOffsets[NodeIndex * MAX_PINS + InputIndex]]);
+		}
+		else
+		{
+			OutInputs[InputIndex] = &Registers[Id * VOXEL_BATCH_SIZE];
+		}
+	}
+}
+
+void FVoxelComputeNodeTree::ComputeColumnsBatch(FVoxelNodeType Registers[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType* Inputs[MAX_PINS];
+	FVoxelNodeType* Outputs[MAX_PINS];
+
+	const int32 BatchNodesCount = GetBatchNodesCount();
+	for (int NodeIndex = 0; NodeIndex < BatchNodesCount; NodeIndex++)
+	{
+		if (NodesDependencies[NodeIndex] & EVoxelContextDependency::Z)
+		{
+			continue;
+		}
+
+		auto& Node = Nodes[NodeIndex];
+		GetBatchInputs(NodeIndex, Registers, Inputs);
+		for (int OutputIndex = 0; OutputIndex < Node->OutputCount; OutputIndex++)
+		{
+			Outputs[OutputIndex] = &Registers[Node->GetOutputId(OutputIndex) * VOXEL_BATCH_SIZE];
+		}
+		Node->ComputeBatch(Inputs, Outputs, Context, Lanes);
+	}
+}
+
+void FVoxelComputeNodeTree::ComputeBatch(FVoxelNodeType Registers[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes, float Values[], FVoxelMaterial Materials[], FVoxelType VoxelTypes[], bool bSkipColumnNodes) const
+{
+	FVoxelNodeType* Inputs[MAX_PINS];
+	FVoxelNodeType* Outputs[MAX_PINS];
+
+	const int32 ColumnNodesEnd = bSkipColumnNodes ? GetBatchNodesCount() : 0;
+	for (int NodeIndex = 0; NodeIndex < NodesCount; NodeIndex++)
+	{
+		if (NodeIndex < ColumnNodesEnd && !(NodesDependencies[NodeIndex] & EVoxelContextDependency::Z))
+		{
+			// Already computed by ComputeColumnsBatch
+			continue;
+		}
+
+		auto& Node = Nodes[NodeIndex];
+		GetBatchInputs(NodeIndex, Registers, Inputs);
+
+		if (Node->IsSetValueNode())
+		{
+			const FVoxelNodeType* Input = Inputs[0];
+			if (static_cast<FVoxelComputeNode_SetValue*>(Node.Get())->bDisableClamp)
+			{
+				for (int Index = 0; Index < Lanes.Num; Index++)
+				{
+					const int32 Lane = Lanes.Get(Index);
+					Values[Lane] = Input[Lane].F;
+				}
+			}
+			else
+			{
+				for (int Index = 0; Index < Lanes.Num; Index++)
+				{
+					const int32 Lane = Lanes.Get(Index);
+					Values[Lane] = FMath::Clamp(Input[Lane].F, -1.f, 1.f);
+				}
+			}
+		}
+		else if (Node->IsSetMaterialNode())
+		{
+			for (int Index = 0; Index < Lanes.Num; Index++)
+			{
+				const int32 Lane = Lanes.Get(Index);
+				Materials[Lane] = Inputs[0][Lane].M;
+			}
+		}
+		else if (Node->IsSetVoxelTypeNode())
+		{
+			for (int Index = 0; Index < Lanes.Num; Index++)
+			{
+				const int32 Lane = Lanes.Get(Index);
+				VoxelTypes[Lane] = Inputs[0][Lane].VT;
+			}
+		}
+		else if (ChildsCount && NodeIndex == NodesCount - 1)
+		{
+			// Branch node: split the lanes between the childs
+			int32 BranchIds[VOXEL_BATCH_SIZE];
+			Node->GetBranchResultBatch(Inputs, Lanes, BranchIds);
+
+			int32 ChildIndices[VOXEL_BATCH_SIZE];
+			for (int ChildIndex = 0; ChildIndex < ChildsCount; ChildIndex++)
+			{
+				int32 ChildNum = 0;
+				for (int Index = 0; Index < Lanes.Num; Index++)
+				{
+					const int32 Lane = Lanes.Get(Index);
+					check(BranchIds[Lane] >= 0);
+					if (BranchIds[Lane] == ChildIndex)
+					{
+						ChildIndices[ChildNum] = Lane;
+						ChildNum++;
+					}
+				}
+
+				if (ChildNum == Lanes.Num)
+				{
+					// All the lanes took the same branch
+					Childs[ChildIndex]->ComputeBatch(Registers, Context, Lanes, Values, Materials, VoxelTypes);
+					break;
+				}
+				else if (ChildNum > 0)
+				{
+					Childs[ChildIndex]->ComputeBatch(Registers, Context, FVoxelBatchLanes(ChildIndices, ChildNum), Values, Materials, VoxelTypes);
+				}
+			}
+			return;
+		}
+		else
+		{
+			for (int OutputIndex = 0; OutputIndex < Node->OutputCount; OutputIndex++)
+			{
+				Outputs[OutputIndex] = &Registers[Node->GetOutputId(OutputIndex) * VOXEL_BATCH_SIZE];
+			}
+			Node->ComputeBatch(Inputs, Outputs, Context, Lanes);
+		}
+	}
+
+	if (ChildsCount)
+	{
+		// Last node was a set node
+		Childs[0]->ComputeBatch(Registers, Context, Lanes, Values, Materials, VoxelTypes);
+	}
+}
+
+void FVoxelComputeNodeTree::ComputeRange(FVoxelRange Variables[], const FIntBox& Bounds, FVoxelRange& Value) const
+{
+	FVoxelRange Inputs[MAX_PINS];
+	FVoxelRange Outputs[MAX_PINS];
+
+	for (int NodeIndex = 0; NodeIndex < NodesCount; NodeIndex++)
+	{
+		auto& Node = Nodes[NodeIndex];
+		for (int InputIndex = 0; InputIndex < Node->InputCount; InputIndex++)
+		{
+			int32 Id = Node->GetInputId(InputIndex);
+			if (Id == -1)
+			{
+				Inputs[InputIndex] = Node->GetDefaultRange(InputIndex);
+			}
+			else
+			{
+				Inputs[InputIndex] = Variables[Id];
+			}
+		}
+
+		if (Node->IsSetValueNode())
+		{
+			Value = static_cast<FVoxelComputeNode_SetValue*>(Node.Get())->bDisableClamp ? Inputs[0] : FVoxelRange::Clamp(Inputs[0], -1.f, 1.f);
+		}
+		else if (Node->IsSetMaterialNode() || Node->IsSetVoxelTypeNode())
+		{
+			// Doesn't change the value
+		}
+		else if (ChildsCount && NodeIndex == NodesCount - 1)
+		{
+			bool PossibleBranches[MAX_PINS];
+			Node->GetBranchResultRange(Inputs, PossibleBranches);
+
+			const FVoxelRange ValueBeforeBranch = Value;
+			bool bAnyBranch = false;
+			for (int ChildIndex = 0; ChildIndex < ChildsCount; ChildIndex++)
+			{
+				if (PossibleBranches[ChildIndex])
+				{
+					FVoxelRange ChildValue = ValueBeforeBranch;
+					Childs[ChildIndex]->ComputeRange(Variables, Bounds, ChildValue);
+					Value = bAnyBranch ? FVoxelRange::Union(Value, ChildValue) : ChildValue;
+					bAnyBranch = true;
+				}
+			}
+			return;
+		}
+		else
+		{
+			Node->ComputeRange(Inputs, Outputs, Bounds);
+			for (int OutputIndex = 0; OutputIndex < Node->OutputCount; OutputIndex++)
+			{
+				Variables[Node->GetOutputId(OutputIndex)] = Outputs[OutputIndex];
+			}
+		}
+	}
+
+	if (ChildsCount)
+	{
+		// Last node was a set node
+		Childs[0]->ComputeRange(Variables, Bounds, Value);
+	}
+}
+
 void FVoxelComputeNodeTree::Init(const AVoxelWorld* VoxelWorld) const
 {
 	for (int i = 0; i < NodesCount; i++)
@@ -143,14 +408,14 @@ void FVoxelComputeNodeTree::Init(const AVoxelWorld* VoxelWorld) const
 	}
 }
 
-void FVoxelComputeNodeTree::GetMain(const TArray<FString>& Variables, const FString& Context, const FString& Value, const FString& Material, const FString& VoxelType, FString& OutCpp)
+void FVoxelComputeNodeTree::GetMain(const TArray<FString>& Variables, const FString& Context, const FString& Value, const FString& Material, const FString& VoxelType, FString& OutCpp, int32 StartNodeIndex)
 {
 	TArray<FString> Inputs;
 	TArray<FString> Outputs;
 	Inputs.SetNum(MAX_PINS);
 	Outputs.SetNum(MAX_PINS);
 
-	for (int NodeIndex = 0; NodeIndex < NodesCount - (ChildsCount ? 1 : 0); NodeIndex++)
+	for (int NodeIndex = StartNodeIndex; NodeIndex < NodesCount - (ChildsCount ? 1 : 0); NodeIndex++)
 	{
 		auto& Node = Nodes[NodeIndex];
 		for (int InputIndex = 0; InputIndex < Node->InputCount; InputIndex++)
@@ -261,6 +526,168 @@ void FVoxelComputeNodeTree::GetMain(const TArray<FString>& Variables, const FStr
 	}
 }
 
+int32 FVoxelComputeNodeTree::GetMainBatch(const TArray<FString>& Variables, uint8 Dependencies, const FString& Context, const FString& Lane, const FString& Count, TArray<FString>& InOutLaneVariables, TArray<bool>& InOutWrittenNodes, FString& OutCpp)
+{
+	const FString BatchSize = FString::FromInt(VOXEL_BATCH_SIZE);
+
+	TArray<FString> Inputs;
+	TArray<FString> Outputs;
+	TArray<FString> LaneInputs;
+	TArray<FString> LaneOutputs;
+	Inputs.SetNum(MAX_PINS);
+	Outputs.SetNum(MAX_PINS);
+	LaneInputs.SetNum(MAX_PINS);
+	LaneOutputs.SetNum(MAX_PINS);
+
+	const int32 BatchNodesCount = GetBatchNodesCount();
+	InOutWrittenNodes.SetNumZeroed(BatchNodesCount);
+
+	for (int NodeIndex = 0; NodeIndex < BatchNodesCount; NodeIndex++)
+	{
+		auto& Node = Nodes[NodeIndex];
+		if (InOutWrittenNodes[NodeIndex] || (NodesDependencies[NodeIndex] & ~Dependencies))
+		{
+			continue;
+		}
+		InOutWrittenNodes[NodeIndex] = true;
+
+		// Inputs written by an outer loop are scalars
+		bool bAllInputsAreArrays = true;
+		for (int InputIndex = 0; InputIndex < Node->InputCount; InputIndex++)
+		{
+			int32 Id = Node->GetInputId(InputIndex);
+			if (Id == -1)
+			{
+				Inputs[InputIndex] = Node->GetDefaultValueString(InputIndex);
+				LaneInputs[InputIndex] = Inputs[InputIndex];
+				bAllInputsAreArrays = false;
+			}
+			else
+			{
+				Inputs[InputIndex] = Variables[Id];
+				LaneInputs[InputIndex] = InOutLaneVariables[Id];
+				bAllInputsAreArrays &= InOutLaneVariables[Id] != Variables[Id];
+			}
+		}
+
+		if (Lane.IsEmpty())
+		{
+			for (int OutputIndex = 0; OutputIndex < Node->OutputCount; OutputIndex++)
+			{
+				const int32 Id = Node->GetOutputId(OutputIndex);
+				Outputs[OutputIndex] = Variables[Id];
+				OutCpp.Append(Node->GetOutputType(OutputIndex) + TEXT(" ") + Variables[Id] + TEXT(";\n"));
+			}
+			Node->GetMain(Inputs, Outputs, Context, OutCpp);
+			OutCpp.Append(TEXT("\n"));
+			continue;
+		}
+
+		for (int OutputIndex = 0; OutputIndex < Node->OutputCount; OutputIndex++)
+		{
+			const int32 Id = Node->GetOutputId(OutputIndex);
+			Outputs[OutputIndex] = Variables[Id];
+			InOutLaneVariables[Id] = Variables[Id] + TEXT("[") + Lane + TEXT("]");
+			LaneOutputs[OutputIndex] = InOutLaneVariables[Id];
+			OutCpp.Append(Node->GetOutputType(OutputIndex) + TEXT(" ") + Variables[Id] + TEXT("[") + BatchSize + TEXT("];\n"));
+		}
+
+		if (!bAllInputsAreArrays || !Node->GetMainBatch(Inputs, Outputs, Count, OutCpp))
+		{
+			OutCpp.Append(TEXT("for (int ") + Lane + TEXT(" = 0; ") + Lane + TEXT(" < ") + Count + TEXT("; ") + Lane + TEXT("++)\n"));
+			OutCpp.Append(TEXT("{\n"));
+			Node->GetMain(LaneInputs, LaneOutputs, Context + TEXT("[") + Lane + TEXT("]"), OutCpp);
+			OutCpp.Append(TEXT("\n}"));
+		}
+		OutCpp.Append(TEXT("\n"));
+	}
+
+	return BatchNodesCount;
+}
+
+void FVoxelComputeNodeTree::GetRangeMain(const TArray<FString>& Variables, const FString& Bounds, const FString& Value, FString& OutCpp, int32& UniqueId)
+{
+	TArray<FString> Inputs;
+	TArray<FString> Outputs;
+	Inputs.SetNum(MAX_PINS);
+	Outputs.SetNum(MAX_PINS);
+
+	for (int NodeIndex = 0; NodeIndex < NodesCount; NodeIndex++)
+	{
+		auto& Node = Nodes[NodeIndex];
+		for (int InputIndex = 0; InputIndex < Node->InputCount; InputIndex++)
+		{
+			int32 Id = Node->GetInputId(InputIndex);
+			if (Id == -1)
+			{
+				Inputs[InputIndex] = Node->GetDefaultRangeString(InputIndex);
+			}
+			else
+			{
+				Inputs[InputIndex] = Variables[Id];
+			}
+		}
+
+		if (Node->IsSetValueNode())
+		{
+			if (static_cast<FVoxelComputeNode_SetValue*>(Node.Get())->bDisableClamp)
+			{
+				OutCpp.Append(Value + TEXT(" = ") + Inputs[0] + TEXT(";\n"));
+			}
+			else
+			{
+				OutCpp.Append(Value + TEXT(" = FVoxelRange::Clamp(") + Inputs[0] + TEXT(", -1.f, 1.f);\n"));
+			}
+		}
+		else if (Node->IsSetMaterialNode() || Node->IsSetVoxelTypeNode())
+		{
+			// Doesn't change the value
+		}
+		else if (ChildsCount && NodeIndex == NodesCount - 1)
+		{
+			const FString Id = FString::FromInt(UniqueId++);
+			const FString ValueBeforeBranch = TEXT("___ValueBeforeBranch") + Id + TEXT("___");
+			const FString BranchesValue = TEXT("___BranchesValue") + Id + TEXT("___");
+			const FString AnyBranch = TEXT("___bAnyBranch") + Id + TEXT("___");
+
+			OutCpp.Append(TEXT("\n{\n"));
+			OutCpp.Append(TEXT("const FVoxelRange ") + ValueBeforeBranch + TEXT(" = ") + Value + TEXT(";\n"));
+			OutCpp.Append(TEXT("FVoxelRange ") + BranchesValue + TEXT(" = ") + Value + TEXT(";\n"));
+			OutCpp.Append(TEXT("bool ") + AnyBranch + TEXT(" = false;\n"));
+			for (int ChildIndex = 0; ChildIndex < ChildsCount; ChildIndex++)
+			{
+				OutCpp.Append(TEXT("if (") + Node->GetBranchResultRangeCpp(Inputs, ChildIndex) + TEXT(")\n"));
+				OutCpp.Append(TEXT("{\n"));
+				OutCpp.Append(Value + TEXT(" = ") + ValueBeforeBranch + TEXT(";\n"));
+				Childs[ChildIndex]->GetRangeMain(Variables, Bounds, Value, OutCpp, UniqueId);
+				OutCpp.Append(BranchesValue + TEXT(" = ") + AnyBranch + TEXT(" ? FVoxelRange::Union(") + BranchesValue + TEXT(", ") + Value + TEXT(") : ") + Value + TEXT(";\n"));
+				OutCpp.Append(AnyBranch + TEXT(" = true;\n"));
+				OutCpp.Append(TEXT("}\n"));
+			}
+			OutCpp.Append(Value + TEXT(" = ") + BranchesValue + TEXT(";\n"));
+			OutCpp.Append(TEXT("}\n"));
+			return;
+		}
+		else
+		{
+			for (int OutputIndex = 0; OutputIndex < Node->OutputCount; OutputIndex++)
+			{
+				FString Name = Variables[Node->GetOutputId(OutputIndex)];
+				Outputs[OutputIndex] = Name;
+				OutCpp.Append(TEXT("FVoxelRange ") + Name + TEXT(";\n"));
+			}
+
+			Node->GetRangeMain(Inputs, Outputs, Bounds, OutCpp);
+			OutCpp.Append(TEXT("\n"));
+		}
+	}
+
+	if (ChildsCount)
+	{
+		// Last node was a set node
+		Childs[0]->GetRangeMain(Variables, Bounds, Value, OutCpp, UniqueId);
+	}
+}
 
 void FVoxelComputeNodeTree::GetAdditionalHeaders(TArray<FString>& OutAdditionalHeaders) const
 {
@@ -520,6 +947,8 @@ bool UVoxelGraphGenerator::CompileToCpp(FString& OutCpp, const FString& Filename
 		Headers.Add(TEXT("\"VoxelMaterial.h\""));
 		Headers.Add(TEXT("\"VoxelWorldGenerator.h\""));
 		Headers.Add(TEXT("\"VoxelAsset.h\""));
+		Headers.Add(TEXT("\"VoxelRange.h\""));
+		Headers.Add(TEXT("\"IntBox.h\""));
 
 		TArray<FString> AdditionalHeaders;
 		Tree.GetAdditionalHeaders(AdditionalHeaders);
@@ -589,33 +1018,64 @@ bool UVoxelGraphGenerator::CompileToCpp(FString& OutCpp, const FString& Filename
 	{
 		OutCpp.Append(TEXT("	virtual void GetValuesAndMaterialsAndVoxelTypes(float Values[], FVoxelMaterial Materials[], FVoxelType VoxelTypes[], const FIntVector& Start, const FIntVector& StartIndex, const int Step, const FIntVector& Size, const FIntVector& ArraySize) const override\n"));
 		OutCpp.Append(TEXT("	{\n"));
-		OutCpp.Append(TEXT("		for (int K = 0; K < Size.Z; K++)\n"));
-		OutCpp.Append(TEXT("		{\n"));
-		OutCpp.Append(TEXT("			const int Z = Start.Z + K * Step;\n"));
-		OutCpp.Append(TEXT("			for (int J = 0; J < Size.Y; J++)\n"));
-		OutCpp.Append(TEXT("			{\n"));
-		OutCpp.Append(TEXT("				const int Y = Start.Y + J * Step;\n"));
-		OutCpp.Append(TEXT("				for (int I = 0; I < Size.X; I++)\n"));
-		OutCpp.Append(TEXT("				{\n"));
-		OutCpp.Append(TEXT("					const int X = Start.X + I * Step;\n"));
-		OutCpp.Append(TEXT("					const int Index = (StartIndex.X + I) + ArraySize.X * (StartIndex.Y + J) + ArraySize.X * ArraySize.Y * (StartIndex.Z + K);\n"));
-
 		// Main
 		{
 			const FString Value(TEXT("___Value___"));
 			const FString Material(TEXT("___Material___"));
 			const FString VoxelType(TEXT("___VoxelType___"));
+			const FString RowContext(TEXT("___RowContext___"));
 			const FString Context(TEXT("___Context___"));
+			const FString Lane(TEXT("___Lane___"));
+			const FString Count(TEXT("___Count___"));
+			const FString BatchSize = FString::FromInt(VOXEL_BATCH_SIZE);
+
+			// Each root node is written in the outermost loop fixing all the coordinates it depends on, see FVoxelComputeNodeTree::GetMainBatch
+			TArray<FString> LaneVariables = Variables;
+			TArray<bool> WrittenNodes;
+
+			OutCpp.Append(TEXT("		for (int J = 0; J < Size.Y; J++)\n"));
+			OutCpp.Append(TEXT("		{\n"));
+			OutCpp.Append(TEXT("			const int Y = Start.Y + J * Step;\n"));
+			OutCpp.Append(TEXT("FVoxelContext ") + RowContext + TEXT(";\n"));
+			OutCpp.Append(RowContext + TEXT(".X = Start.X;\n"));
+			OutCpp.Append(RowContext + TEXT(".Y = Y;\n"));
+			OutCpp.Append(RowContext + TEXT(".Z = Start.Z;\n"));
+
+			Tree.GetMainBatch(Variables, EVoxelContextDependency::Y, RowContext, FString(), FString(), LaneVariables, WrittenNodes, OutCpp);
+
+			// Blocks of up to VOXEL_BATCH_SIZE columns
+			OutCpp.Append(TEXT("			for (int IStart = 0; IStart < Size.X; IStart += ") + BatchSize + TEXT(")\n"));
+			OutCpp.Append(TEXT("			{\n"));
+			OutCpp.Append(TEXT("const int ") + Count + TEXT(" = FMath::Min(Size.X - IStart, ") + BatchSize + TEXT(");\n"));
+			OutCpp.Append(TEXT("FVoxelContext ") + Context + TEXT("[") + BatchSize + TEXT("];\n"));
+			OutCpp.Append(TEXT("for (int ") + Lane + TEXT(" = 0; ") + Lane + TEXT(" < ") + Count + TEXT("; ") + Lane + TEXT("++)\n"));
+			OutCpp.Append(TEXT("{\n"));
+			OutCpp.Append(Context + TEXT("[") + Lane + TEXT("].X = Start.X + (IStart + ") + Lane + TEXT(") * Step;\n"));
+			OutCpp.Append(Context + TEXT("[") + Lane + TEXT("].Y = Y;\n"));
+			OutCpp.Append(Context + TEXT("[") + Lane + TEXT("].Z = Start.Z;\n"));
+			OutCpp.Append(TEXT("}\n"));
+
+			Tree.GetMainBatch(Variables, (uint8)(EVoxelContextDependency::X | EVoxelContextDependency::Y), Context, Lane, Count, LaneVariables, WrittenNodes, OutCpp);
+
+			OutCpp.Append(TEXT("				for (int K = 0; K < Size.Z; K++)\n"));
+			OutCpp.Append(TEXT("				{\n"));
+			OutCpp.Append(TEXT("					const int Z = Start.Z + K * Step;\n"));
+			OutCpp.Append(TEXT("for (int ") + Lane + TEXT(" = 0; ") + Lane + TEXT(" < ") + Count + TEXT("; ") + Lane + TEXT("++)\n"));
+			OutCpp.Append(TEXT("{\n"));
+			OutCpp.Append(Context + TEXT("[") + Lane + TEXT("].Z = Z;\n"));
+			OutCpp.Append(TEXT("}\n"));
+
+			const int32 StartNodeIndex = Tree.GetMainBatch(Variables, EVoxelContextDependency::All, Context, Lane, Count, LaneVariables, WrittenNodes, OutCpp);
 
+			OutCpp.Append(TEXT("for (int ") + Lane + TEXT(" = 0; ") + Lane + TEXT(" < ") + Count + TEXT("; ") + Lane + TEXT("++)\n"));
+			OutCpp.Append(TEXT("{\n"));
+			OutCpp.Append(TEXT("					const int I = IStart + ") + Lane + TEXT(";\n"));
+			OutCpp.Append(TEXT("					const int Index = (StartIndex.X + I) + ArraySize.X * (StartIndex.Y + J) + ArraySize.X * ArraySize.Y * (StartIndex.Z + K);\n"));
 			OutCpp.Append(TEXT("float ") + Value + TEXT(" = 1;\n"));
 			OutCpp.Append(TEXT("FVoxelMaterial ") + Material + TEXT("(0, 0, 0, 0);\n"));
 			OutCpp.Append(TEXT("FVoxelType ") + VoxelType + TEXT(" = FVoxelType::UseAll();\n"));
-			OutCpp.Append(TEXT("FVoxelContext ") + Context + TEXT(";\n"));
-			OutCpp.Append(Context + TEXT(".X = X;\n"));
-			OutCpp.Append(Context + TEXT(".Y = Y;\n"));
-			OutCpp.Append(Context + TEXT(".Z = Z;\n"));
 
-			Tree.GetMain(Variables, Context, Value, Material, VoxelType, OutCpp);
+			Tree.GetMain(LaneVariables, Context + TEXT("[") + Lane + TEXT("]"), Value, Material, VoxelType, OutCpp, StartNodeIndex);
 
 			OutCpp.Append(TEXT("					if (Values)\n"));
 			OutCpp.Append(TEXT("					{\n"));
@@ -629,6 +1089,7 @@ bool UVoxelGraphGenerator::CompileToCpp(FString& OutCpp, const FString& Filename
 			OutCpp.Append(TEXT("					{\n"));
 			OutCpp.Append(TEXT("						VoxelTypes[Index] = ") + VoxelType + TEXT(";\n"));
 			OutCpp.Append(TEXT("					}\n"));
+			OutCpp.Append(TEXT("}\n"));
 		}
 		OutCpp.Append(TEXT("				}\n"));
 		OutCpp.Append(TEXT("			}\n"));
@@ -651,68 +1112,18 @@ bool UVoxelGraphGenerator::CompileToCpp(FString& OutCpp, const FString& Filename
 
 	// IsEmpty
 	{
-		const FString IsEmptySign(TEXT("__IsEmptySign__"));
+		const FString Value(TEXT("___Value___"));
+		const FString Bounds(TEXT("___Bounds___"));
+		int32 UniqueId = 0;
 
 		OutCpp.Append(TEXT("	virtual bool IsEmpty(const FIntVector& Start, const int Step, const FIntVector& Size) const override\n"));
 		OutCpp.Append(TEXT("	{\n"));
-		OutCpp.Append(TEXT("		int ") + IsEmptySign + TEXT(" = 0;\n"));
-		OutCpp.Append(TEXT("		for (int K = 0; K < Size.Z; K++)\n"));
-		OutCpp.Append(TEXT("		{\n"));
-		OutCpp.Append(TEXT("			const int Z = Start.Z + K * Step;\n"));
-		OutCpp.Append(TEXT("			for (int J = 0; J < Size.Y; J++)\n"));
-		OutCpp.Append(TEXT("			{\n"));
-		OutCpp.Append(TEXT("				const int Y = Start.Y + J * Step;\n"));
-		OutCpp.Append(TEXT("				for (int I = 0; I < Size.X; I++)\n"));
-		OutCpp.Append(TEXT("				{\n"));
-		OutCpp.Append(TEXT("					const int X = Start.X + I * Step;\n"));
-
-		// Main
-		{
-			const FString Value(TEXT("___Value___"));
-			const FString Material(TEXT("___Material___"));
-			const FString VoxelType(TEXT("___VoxelType___"));
-			const FString Context(TEXT("___Context___"));
+		OutCpp.Append(TEXT("		const FIntBox ") + Bounds + TEXT("(Start, Start + (Size - FIntVector(1, 1, 1)) * Step + FIntVector(1, 1, 1));\n"));
+		OutCpp.Append(TEXT("		FVoxelRange ") + Value + TEXT(" = 1;\n"));
 
-			OutCpp.Append(TEXT("float ") + Value + TEXT(" = 1;\n"));
-			OutCpp.Append(TEXT("FVoxelMaterial ") + Material + TEXT("(0, 0, 0, 0);\n"));
-			OutCpp.Append(TEXT("FVoxelType ") + VoxelType + TEXT(" = FVoxelType::UseAll();\n"));
-			OutCpp.Append(TEXT("FVoxelContext ") + Context + TEXT(";\n"));
-			OutCpp.Append(Context + TEXT(".X = X;\n"));
-			OutCpp.Append(Context + TEXT(".Y = Y;\n"));
-			OutCpp.Append(Context + TEXT(".Z = Z;\n"));
-
-			Tree.GetMain(Variables, Context, Value, Material, VoxelType, OutCpp);
-
-			OutCpp.Append(TEXT("					if (-1 + KINDA_SMALL_NUMBER < ") + Value + TEXT(" && ") + Value + TEXT(" < 1 - KINDA_SMALL_NUMBER)\n"));
-			OutCpp.Append(TEXT("					{\n"));
-			OutCpp.Append(TEXT("						return false;\n"));
-			OutCpp.Append(TEXT("					}\n\n"));
+		Tree.GetRangeMain(Variables, Bounds, Value, OutCpp, UniqueId);
 
-			OutCpp.Append(TEXT("					if (") + IsEmptySign + TEXT(" == 0)\n"));
-			OutCpp.Append(TEXT("					{\n"));
-			OutCpp.Append(TEXT("						") + IsEmptySign + TEXT(" = ") + Value + TEXT(" > 0 ? 1 : -1;\n"));
-			OutCpp.Append(TEXT("					}\n"));
-			OutCpp.Append(TEXT("					else if (") + IsEmptySign + TEXT(" == 1)\n"));
-			OutCpp.Append(TEXT("					{\n"));
-			OutCpp.Append(TEXT("						if (") + Value + TEXT(" < 0)\n"));
-			OutCpp.Append(TEXT("						{\n"));
-			OutCpp.Append(TEXT("							return false;\n"));
-			OutCpp.Append(TEXT("						}\n"));
-			OutCpp.Append(TEXT("					}\n"));
-			OutCpp.Append(TEXT("					else\n"));
-			OutCpp.Append(TEXT("					{\n"));
-			OutCpp.Append(TEXT("						check(") + IsEmptySign + TEXT(" == -1);\n"));
-			OutCpp.Append(TEXT("						if (") + Value + TEXT(" > 0)\n"));
-			OutCpp.Append(TEXT("						{\n"));
-			OutCpp.Append(TEXT("							return false;\n"));
-			OutCpp.Append(TEXT("						}\n"));
-			OutCpp.Append(TEXT("					}\n"));
-		}
-
-		OutCpp.Append(TEXT("				}\n"));
-		OutCpp.Append(TEXT("			}\n"));
-		OutCpp.Append(TEXT("		}\n"));
-		OutCpp.Append(TEXT("		return true;\n"));
+		OutCpp.Append(TEXT("		return ") + Value + TEXT(".Min >= 1 - KINDA_SMALL_NUMBER || ") + Value + TEXT(".Max <= -1 + KINDA_SMALL_NUMBER;\n"));
 		OutCpp.Append(TEXT("	}\n"));
 		OutCpp.Append(TEXT("	\n"));
 	}
@@ -986,47 +1397,115 @@ FVoxelGraphWorldGeneratorInstance::FVoxelGraphWorldGeneratorInstance(int32 MaxId
 
 void FVoxelGraphWorldGeneratorInstance::GetValuesAndMaterialsAndVoxelTypes(float Values[], FVoxelMaterial Materials[], FVoxelType VoxelTypes[], const FIntVector& Start, const FIntVector& StartIndex, const int Step, const FIntVector& Size, const FIntVector& ArraySize) const
 {
-	FVoxelNodeType* Variables = new FVoxelNodeType[MaxId];
-
-	for (int K = 0; K < Size.Z; K++)
+	if (Size.X * Size.Y * Size.Z == 1)
 	{
-		const int Z = Start.Z + K * Step;
-		for (int J = 0; J < Size.Y; J++)
+		// Single voxel queries (GetValue...): not worth filling batch registers
+		FVoxelNodeType* Variables = new FVoxelNodeType[MaxId];
+
+		float Value = 1;
+		FVoxelMaterial Material(0, 0, 0, 0);
+		FVoxelType VoxelType = FVoxelType::UseAll();
+		FVoxelContext Context;
+		Context.X = Start.X;
+		Context.Y = Start.Y;
+		Context.Z = Start.Z;
+
+		ComputeTree->Compute(Variables, Context, Value, Material, VoxelType);
+
+		const int Index = StartIndex.X + ArraySize.X * StartIndex.Y + ArraySize.X * ArraySize.Y * StartIndex.Z;
+		if (Values)
 		{
-			const int Y = Start.Y + J * Step;
-			for (int I = 0; I < Size.X; I++)
-			{
-				const int X = Start.X + I * Step;
+			Values[Index] = Value;
+		}
+		if (Materials)
+		{
+			Materials[Index] = Material;
+		}
+		if (VoxelTypes)
+		{
+			VoxelTypes[Index] = VoxelType;
+		}
+
+		delete[] Variables;
+		return;
+	}
+
+	FVoxelNodeType* Registers = new FVoxelNodeType[MaxId * VOXEL_BATCH_SIZE];
+
+	FVoxelBatchContext Context;
+	// Index of the voxel at K = 0 of each column
+	int32 ColumnIndices[VOXEL_BATCH_SIZE];
+	float BatchValues[VOXEL_BATCH_SIZE];
+	FVoxelMaterial BatchMaterials[VOXEL_BATCH_SIZE];
+	FVoxelType BatchVoxelTypes[VOXEL_BATCH_SIZE];
+	int32 LanesCount = 0;
+
+	// Each lane is a column: the nodes that don't depend on Z are computed once for all its voxels
+	auto Flush = [&]()
+	{
+		const FVoxelBatchLanes Lanes(LanesCount);
+		ComputeTree->ComputeColumnsBatch(Registers, Context, Lanes);
 
-				const int Index = (StartIndex.X + I) + ArraySize.X * (StartIndex.Y + J) + ArraySize.X * ArraySize.Y * (StartIndex.Z + K);
+		for (int K = 0; K < Size.Z; K++)
+		{
+			const int Z = Start.Z + K * Step;
+			const int ZOffset = ArraySize.X * ArraySize.Y * (StartIndex.Z + K);
 
-				float Value = 1;
-				FVoxelMaterial Material(0, 0, 0, 0);
-				FVoxelType VoxelType = FVoxelType::UseAll();
-				FVoxelContext Context;
-				Context.X = X;
-				Context.Y = Y;
-				Context.Z = Z;
+			for (int Lane = 0; Lane < LanesCount; Lane++)
+			{
+				Context.Z[Lane] = Z;
+				BatchValues[Lane] = 1;
+				BatchMaterials[Lane] = FVoxelMaterial(0, 0, 0, 0);
+				BatchVoxelTypes[Lane] = FVoxelType::UseAll();
+			}
 
-				ComputeTree->Compute(Variables, Context, Value, Material, VoxelType);
+			ComputeTree->ComputeBatch(Registers, Context, Lanes, BatchValues, BatchMaterials, BatchVoxelTypes, true);
 
+			for (int Lane = 0; Lane < LanesCount; Lane++)
+			{
+				const int Index = ColumnIndices[Lane] + ZOffset;
 				if (Values)
 				{
-					Values[Index] = Value;
+					Values[Index] = BatchValues[Lane];
 				}
 				if (Materials)
 				{
-					Materials[Index] = Material;
+					Materials[Index] = BatchMaterials[Lane];
 				}
 				if (VoxelTypes)
 				{
-					VoxelTypes[Index] = VoxelType;
+					VoxelTypes[Index] = BatchVoxelTypes[Lane];
 				}
 			}
 		}
+		LanesCount = 0;
+	};
+
+	for (int J = 0; J < Size.Y; J++)
+	{
+		const int Y = Start.Y + J * Step;
+		for (int I = 0; I < Size.X; I++)
+		{
+			const int X = Start.X + I * Step;
+
+			Context.X[LanesCount] = X;
+			Context.Y[LanesCount] = Y;
+			Context.Z[LanesCount] = Start.Z;
+			ColumnIndices[LanesCount] = (StartIndex.X + I) + ArraySize.X * (StartIndex.Y + J);
+			LanesCount++;
+
+			if (LanesCount == VOXEL_BATCH_SIZE)
+			{
+				Flush();
+			}
+		}
+	}
+	if (LanesCount > 0)
+	{
+		Flush();
 	}
 
-	delete[] Variables;
+	delete[] Registers;
 }
 
 void FVoxelGraphWorldGeneratorInstance::SetVoxelWorld(const AVoxelWorld* VoxelWorld)
@@ -1036,61 +1515,14 @@ void FVoxelGraphWorldGeneratorInstance::SetVoxelWorld(const AVoxelWorld* VoxelWo
 
 bool FVoxelGraphWorldGeneratorInstance::IsEmpty(const FIntVector& Start, const int Step, const FIntVector& Size) const
 {
-	int Sign = 0;
-
-	FVoxelNodeType* Variables = new FVoxelNodeType[MaxId];
-
-	for (int K = 0; K < Size.Z; K++)
-	{
-		const int Z = Start.Z + K * Step;
-		for (int J = 0; J < Size.Y; J++)
-		{
-			const int Y = Start.Y + J * Step;
-			for (int I = 0; I < Size.X; I++)
-			{
-				const int X = Start.X + I * Step;
-
-				float Value = 1;
-				FVoxelMaterial Material(0, 0, 0, 0);
-				FVoxelType VoxelType = FVoxelType::UseAll();
-				FVoxelContext Context;
-				Context.X = X;
-				Context.Y = Y;
-				Context.Z = Z;
-
-				ComputeTree->Compute(Variables, Context, Value, Material, VoxelType);
-
-				if (-1 + KINDA_SMALL_NUMBER < Value && Value < 1 - KINDA_SMALL_NUMBER)
-				{
-					delete[] Variables;
-					return false;
-				}
-
-				if (Sign == 0)
-				{
-					Sign = Value > 0 ? 1 : -1;
-				}
-				else if (Sign == 1)
-				{
-					if (Value < 0)
-					{
-						delete[] Variables;
-						return false;
-					}
-				}
-				else
-				{
-					check(Sign == -1);
-					if (Value > 0)
-					{
-						delete[] Variables;
-						return false;
-					}
-				}
-			}
-		}
-	}
+	// Every sampled voxel is in Bounds
+	const FIntBox Bounds(Start, Start + (Size - FIntVector(1, 1, 1)) * Step + FIntVector(1, 1, 1));
 
+	FVoxelRange* Variables = new FVoxelRange[MaxId];
+	FVoxelRange Value = 1;
+	ComputeTree->ComputeRange(Variables, Bounds, Value);
 	delete[] Variables;
-	return true;
+
+	// Empty if all the values are >= 1 or all the values are <= -1
+	return Value.Min >= 1 - KINDA_SMALL_NUMBER || Value.Max <= -1 + KINDA_SMALL_NUMBER;
 }
@@ -2,20 +2,246 @@
 
 #include "VoxelNetworking.h"
 #include "VoxelPrivate.h"
+#include "VoxelData.h"
+#include "VoxelUtilities.h"
 #include "Sockets.h"
+#include "SocketSubsystem.h"
 #include "TcpListener.h"
-
-#include "ArchiveSaveCompressedProxy.h"
-#include "ArchiveLoadCompressedProxy.h"
+#include "RunnableThread.h"
+#include "Event.h"
+#include "Compression.h"
+#include "MemoryReader.h"
+#include "MemoryWriter.h"
+#include "BufferArchive.h"
 #include "Engine.h"
 
 DECLARE_CYCLE_STAT(TEXT("FVoxelTcpClient::ReceiveData"), STAT_FVoxelTcpClient_ReceiveData, STATGROUP_Voxel);
 DECLARE_CYCLE_STAT(TEXT("FVoxelTcpServer::SendData"), STAT_FVoxelTcpServer_SendData, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelTcpServer::SendChunks"), STAT_FVoxelTcpServer_SendChunks, STATGROUP_Voxel);
+
+/**
+ * Diffs message: uint32 chunk count, then for each chunk:
+ *   uint64 Id, uint8 flags
+ *   If values: indices, then int16 (quantized) or float values
+ *   If materials: indices, then materials
+ * Indices are a uint8 bIsBitmask followed either by a DATA_CHUNK_TOTAL_SIZE bits mask or by uint16 runs (count, then start and length)
+ * The message is then compressed on the network thread: int32 uncompressed size, then the zlib data
+ */
+namespace EVoxelDiffChunkFlags
+{
+	enum Type : uint8
+	{
+		HasValues = 0x01,
+		QuantizedValues = 0x02,
+		HasMaterials = 0x04
+	};
+}
+
+#define DIFF_BITMASK_SIZE (DATA_CHUNK_TOTAL_SIZE / 8)
+#define MESSAGE_HEADER_SIZE 5
+// Time between two reads of the clients messages, in ms
+#define RECEIVE_POLL_TIME 10
+
+struct FVoxelDiffChunk
+{
+	uint64 Id;
+	uint8 ValuesMask[DIFF_BITMASK_SIZE];
+	uint8 MaterialsMask[DIFF_BITMASK_SIZE];
+	float Values[DATA_CHUNK_TOTAL_SIZE];
+	FVoxelMaterial Materials[DATA_CHUNK_TOTAL_SIZE];
+};
+
+inline bool IsBitSet(const uint8 Mask[DIFF_BITMASK_SIZE], int Index)
+{
+	return (Mask[Index / 8] >> (Index % 8)) & 1;
+}
+
+inline void SetBit(uint8 Mask[DIFF_BITMASK_SIZE], int Index)
+{
+	Mask[Index / 8] |= 1 << (Index % 8);
+}
+
+inline void WriteIndices(FArchive& Writer, uint8 Mask[DIFF_BITMASK_SIZE])
+{
+	TArray<uint16> Runs;
+	for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+	{
+		if (IsBitSet(Mask, Index))
+		{
+			const int Start = Index;
+			while (Index + 1 < DATA_CHUNK_TOTAL_SIZE && IsBitSet(Mask, Index + 1))
+			{
+				Index++;
+			}
+			Runs.Add(Start);
+			Runs.Add(Index - Start + 1);
+		}
+	}
+
+	uint8 bIsBitmask = sizeof(uint16) * (1 + Runs.Num()) > DIFF_BITMASK_SIZE;
+	Writer << bIsBitmask;
+	if (bIsBitmask)
+	{
+		Writer.Serialize(Mask, DIFF_BITMASK_SIZE);
+	}
+	else
+	{
+		uint16 NumRuns = Runs.Num() / 2;
+		Writer << NumRuns;
+		for (auto& Run : Runs)
+		{
+			Writer << Run;
+		}
+	}
+}
+
+inline bool ReadIndices(FArchive& Reader, TArray<uint32>& OutIndices)
+{
+	OutIndices.Reset();
+
+	uint8 bIsBitmask;
+	Reader << bIsBitmask;
+	if (bIsBitmask)
+	{
+		uint8 Mask[DIFF_BITMASK_SIZE];
+		Reader.Serialize(Mask, DIFF_BITMASK_SIZE);
+		for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+		{
+			if (IsBitSet(Mask, Index))
+			{
+				OutIndices.Add(Index);
+			}
+		}
+	}
+	else
+	{
+		uint16 NumRuns;
+		Reader << NumRuns;
+		for (int Run = 0; Run < NumRuns; Run++)
+		{
+			uint16 Start;
+			uint16 Length;
+			Reader << Start;
+			Reader << Length;
+			if (Start + Length > DATA_CHUNK_TOTAL_SIZE)
+			{
+				return false;
+			}
+			for (int Index = Start; Index < Start + Length; Index++)
+			{
+				OutIndices.Add(Index);
+			}
+		}
+	}
+	return !Reader.IsError();
+}
+
+inline void WriteDiffChunk(FArchive& Writer, FVoxelDiffChunk& Chunk, bool bHasValues, bool bHasMaterials)
+{
+	TArray<int, TFixedAllocator<DATA_CHUNK_TOTAL_SIZE>> ValuesIndices;
+	bool bQuantize = true;
+	if (bHasValues)
+	{
+		for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+		{
+			if (IsBitSet(Chunk.ValuesMask, Index))
+			{
+				ValuesIndices.Add(Index);
+				bQuantize &= FMath::Abs(Chunk.Values[Index]) <= 1;
+			}
+		}
+	}
+
+	uint8 Flags = 0;
+	Flags |= bHasValues ? EVoxelDiffChunkFlags::HasValues : 0;
+	Flags |= bHasValues && bQuantize ? EVoxelDiffChunkFlags::QuantizedValues : 0;
+	Flags |= bHasMaterials ? EVoxelDiffChunkFlags::HasMaterials : 0;
+
+	Writer << Chunk.Id;
+	Writer << Flags;
+
+	if (bHasValues)
+	{
+		WriteIndices(Writer, Chunk.ValuesMask);
+		for (int Index : ValuesIndices)
+		{
+			if (bQuantize)
+			{
+				int16 Value = FVoxelUtilities::QuantizeValue(Chunk.Values[Index]);
+				Writer << Value;
+			}
+			else
+			{
+				Writer << Chunk.Values[Index];
+			}
+		}
+	}
+	if (bHasMaterials)
+	{
+		WriteIndices(Writer, Chunk.MaterialsMask);
+		for (int Index = 0; Index < DATA_CHUNK_TOTAL_SIZE; Index++)
+		{
+			if (IsBitSet(Chunk.MaterialsMask, Index))
+			{
+				Writer << Chunk.Materials[Index];
+			}
+		}
+	}
+}
+
+inline void WriteMessageHeader(uint8 Header[MESSAGE_HEADER_SIZE], uint32 Size, uint8 Type)
+{
+	Header[0] = Size % 256;
+	Size /= 256;
+	Header[1] = Size % 256;
+	Size /= 256;
+	Header[2] = Size % 256;
+	Size /= 256;
+	Header[3] = Size % 256;
+	Header[4] = Type;
+}
+
+inline uint32 ReadMessageHeaderSize(const uint8 Header[MESSAGE_HEADER_SIZE])
+{
+	return Header[0] + 256 * (Header[1] + 256 * (Header[2] + 256 * Header[3]));
+}
+
+inline void WriteSave(const FVoxelWorldSave& Save, TArray<uint8>& OutData)
+{
+	// Needed because of <<
+	FVoxelWorldSave& NotConstSave = const_cast<FVoxelWorldSave&>(Save);
+
+	FMemoryWriter Writer(OutData);
+	Writer << NotConstSave.Version;
+	Writer << NotConstSave.LOD;
+	Writer << NotConstSave.Data;
+}
+
+inline void SerializeBoxes(FArchive& Ar, TArray<FIntBox>& Boxes)
+{
+	int32 NumBoxes = Boxes.Num();
+	Ar << NumBoxes;
+	if (Ar.IsLoading())
+	{
+		if (NumBoxes < 0 || NumBoxes * 2 * sizeof(FIntVector) > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.ArIsError = true;
+			return;
+		}
+		Boxes.SetNum(NumBoxes);
+	}
+	for (auto& Box : Boxes)
+	{
+		Ar << Box.Min;
+		Ar << Box.Max;
+	}
+}
 
 FVoxelTcpClient::FVoxelTcpClient()
 	: Socket(nullptr)
 	, ExpectedSize(0)
 	, bExpectedSizeUpToDate(false)
+	, NextMessageType(EVoxelMessageType::Diffs)
 {
 
 }
@@ -72,7 +298,7 @@ void FVoxelTcpClient::ReceiveDiffQueues(TArray<FVoxelValueDiff>& OutValueDiffs,
 {
 	SCOPE_CYCLE_COUNTER(STAT_FVoxelTcpClient_ReceiveData);
 
-	check(!bNextUpdateIsRemoteLoad);
+	check(NextMessageType == EVoxelMessageType::Diffs);
 
 	if (Socket)
 	{
@@ -90,39 +316,22 @@ void FVoxelTcpClient::ReceiveDiffQueues(TArray<FVoxelValueDiff>& OutValueDiffs,
 					Socket->Recv(ReceivedData.GetData(), ReceivedData.Num(), BytesRead);
 					check(BytesRead == ExpectedSize);
 
-					FArchiveLoadCompressedProxy Decompressor = FArchiveLoadCompressedProxy(ReceivedData, ECompressionFlags::COMPRESS_ZLIB);
-					check(!Decompressor.GetError());
-
-					//Decompress
-					FBufferArchive DecompressedDataArray;
-					Decompressor << DecompressedDataArray;
-
-					FMemoryReader DecompressedData = FMemoryReader(DecompressedDataArray);
-
-					bool bValues;
-					uint32 ItemCount;
-					DecompressedData << bValues;
-					DecompressedData << ItemCount;
-
-					check(ItemCount <= PACKET_SIZE_IN_DIFF);
+					int32 UncompressedSize = 0;
+					if (ReceivedData.Num() >= sizeof(int32))
+					{
+						FMemoryReader SizeReader(ReceivedData);
+						SizeReader << UncompressedSize;
+					}
 
-					if (bValues)
+					TArray<uint8> DecompressedData;
+					DecompressedData.SetNumUninitialized(FMath::Max(0, UncompressedSize));
+					if (UncompressedSize <= 0 || !FCompression::UncompressMemory(COMPRESS_ZLIB, DecompressedData.GetData(), UncompressedSize, ReceivedData.GetData() + sizeof(int32), ReceivedData.Num() - sizeof(int32)))
 					{
-						for (uint32 i = 0; i < ItemCount; i++)
-						{
-							FVoxelValueDiff Diff;
-							DecompressedData << Diff;
-							OutValueDiffs.Add(Diff);
-						}
+						UE_LOG(LogVoxel, Error, TEXT("Diffs message failed to decompress"));
 					}
-					else
+					else if (!ReadDiffs(DecompressedData, OutValueDiffs, OutMaterialDiffs))
 					{
-						for (uint32 i = 0; i < ItemCount; i++)
-						{
-							FVoxelMaterialDiff Diff;
-							DecompressedData << Diff;
-							OutMaterialDiffs.Add(Diff);
-						}
+						UE_LOG(LogVoxel, Error, TEXT("Corrupted diffs message"));
 					}
 
 					bExpectedSizeUpToDate = false;
@@ -137,9 +346,9 @@ void FVoxelTcpClient::ReceiveDiffQueues(TArray<FVoxelValueDiff>& OutValueDiffs,
 	}
 }
 
-void FVoxelTcpClient::ReceiveSave(FVoxelWorldSave& OutSave)
+bool FVoxelTcpClient::ReceiveSave(FVoxelWorldSave& OutSave)
 {
-	check(bNextUpdateIsRemoteLoad);
+	check(NextMessageType == EVoxelMessageType::Chunks);
 
 	if (Socket)
 	{
@@ -156,21 +365,23 @@ void FVoxelTcpClient::ReceiveSave(FVoxelWorldSave& OutSave)
 					int32 BytesRead = 0;
 					Socket->Recv(ReceivedData.GetData(), ReceivedData.Num(), BytesRead);
 					bool bSuccess = BytesRead == ExpectedSize;
-					UE_LOG(LogVoxel, Log, TEXT("Remote load: Bytes to receive: %d. Bytes received: %d. Success: %d"), ExpectedSize, BytesRead, bSuccess);
+					UE_LOG(LogVoxel, Log, TEXT("Chunks: Bytes to receive: %d. Bytes received: %d. Success: %d"), ExpectedSize, BytesRead, bSuccess);
 					if (bSuccess)
 					{
 
 						FMemoryReader Reader(ReceivedData);
+						Reader << OutSave.Version;
 						Reader << OutSave.LOD;
 						Reader << OutSave.Data;
 
-						bNextUpdateIsRemoteLoad = false;
+						NextMessageType = EVoxelMessageType::Diffs;
 						bExpectedSizeUpToDate = false;
 						UpdateExpectedSize();
+						return true;
 					}
 					else
 					{
-						UE_LOG(LogVoxel, Error, TEXT("Remote load: Fail"));
+						UE_LOG(LogVoxel, Error, TEXT("Chunks: Fail"));
 					}
 				}
 			}
@@ -180,6 +391,87 @@ void FVoxelTcpClient::ReceiveSave(FVoxelWorldSave& OutSave)
 	{
 		UE_LOG(LogVoxel, Error, TEXT("Client not connected"));
 	}
+	return false;
+}
+
+void FVoxelTcpClient::SendInterest(const TArray<FIntBox>& Boxes)
+{
+	if (!Socket || Boxes == SentInterest)
+	{
+		return;
+	}
+
+	TArray<uint8> Message;
+	Message.SetNumUninitialized(MESSAGE_HEADER_SIZE);
+	FMemoryWriter Writer(Message);
+	Writer.Seek(MESSAGE_HEADER_SIZE);
+	SerializeBoxes(Writer, const_cast<TArray<FIntBox>&>(Boxes));
+	WriteMessageHeader(Message.GetData(), Message.Num() - MESSAGE_HEADER_SIZE, EVoxelMessageType::Interest);
+
+	int32 BytesSent = 0;
+	if (Socket->Send(Message.GetData(), Message.Num(), BytesSent) && BytesSent == Message.Num())
+	{
+		SentInterest = Boxes;
+	}
+	else
+	{
+		UE_LOG(LogVoxel, Error, TEXT("Interest failed to send"));
+	}
+}
+
+bool FVoxelTcpClient::ReadDiffs(const TArray<uint8>& Data, TArray<FVoxelValueDiff>& OutValueDiffs, TArray<FVoxelMaterialDiff>& OutMaterialDiffs)
+{
+	FMemoryReader Reader(Data);
+
+	uint32 NumChunks;
+	Reader << NumChunks;
+
+	TArray<uint32> Indices;
+	for (uint32 ChunkIndex = 0; ChunkIndex < NumChunks && !Reader.IsError(); ChunkIndex++)
+	{
+		uint64 Id;
+		uint8 Flags;
+		Reader << Id;
+		Reader << Flags;
+
+		if (Flags & EVoxelDiffChunkFlags::HasValues)
+		{
+			if (!ReadIndices(Reader, Indices))
+			{
+				return false;
+			}
+			for (uint32 Index : Indices)
+			{
+				float Value;
+				if (Flags & EVoxelDiffChunkFlags::QuantizedValues)
+				{
+					int16 QuantizedValue;
+					Reader << QuantizedValue;
+					Value = QuantizedValue / (float)MAX_int16;
+				}
+				else
+				{
+					Reader << Value;
+				}
+				OutValueDiffs.Emplace(Id, Index, Value);
+			}
+		}
+		if (Flags & EVoxelDiffChunkFlags::HasMaterials)
+		{
+			if (!ReadIndices(Reader, Indices))
+			{
+				return false;
+			}
+			for (uint32 Index : Indices)
+			{
+				FVoxelMaterial Material;
+				Reader << Material;
+				OutMaterialDiffs.Emplace(Id, Index, Material);
+			}
+		}
+	}
+
+	return !Reader.IsError();
 }
 
 bool FVoxelTcpClient::IsValid() const
@@ -187,9 +479,9 @@ bool FVoxelTcpClient::IsValid() const
 	return Socket != nullptr;
 }
 
-bool FVoxelTcpClient::IsNextUpdateRemoteLoad()
+bool FVoxelTcpClient::IsNextUpdateChunks()
 {
-	return bNextUpdateIsRemoteLoad;
+	return NextMessageType == EVoxelMessageType::Chunks;
 }
 
 void FVoxelTcpClient::UpdateExpectedSize()
@@ -199,16 +491,16 @@ void FVoxelTcpClient::UpdateExpectedSize()
 		uint32 PendingDataSize = 0;
 		if (Socket->HasPendingData(PendingDataSize))
 		{
-			if (PendingDataSize >= 5)
+			if (PendingDataSize >= MESSAGE_HEADER_SIZE)
 			{
-				uint8 ReceivedData[5];
+				uint8 ReceivedData[MESSAGE_HEADER_SIZE];
 
 				int BytesRead;
-				Socket->Recv(ReceivedData, 5, BytesRead);
-				check(BytesRead == 5);
+				Socket->Recv(ReceivedData, MESSAGE_HEADER_SIZE, BytesRead);
+				check(BytesRead == MESSAGE_HEADER_SIZE);
 
-				ExpectedSize = ReceivedData[0] + 256 * (ReceivedData[1] + 256 * (ReceivedData[2] + 256 * ReceivedData[3]));
-				bNextUpdateIsRemoteLoad = ReceivedData[4];
+				ExpectedSize = ReadMessageHeaderSize(ReceivedData);
+				NextMessageType = ReceivedData[4];
 
 				bExpectedSizeUpToDate = true;
 			}
@@ -220,17 +512,27 @@ void FVoxelTcpClient::UpdateExpectedSize()
 
 FVoxelTcpServer::FVoxelTcpServer()
 	: TcpListener(nullptr)
+	, TimeToDie(0)
 {
-
+	WakeUpEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("VoxelTcpServer"), 0, TPri_BelowNormal);
+	check(Thread);
 }
 
 FVoxelTcpServer::~FVoxelTcpServer()
 {
+	// Stop accepting connections before the sockets are destroyed
+	delete TcpListener;
+
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+
 	for (auto Socket : Sockets)
 	{
 		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
 	}
-	delete TcpListener;
 }
 
 FOnVoxelTcpServerConnection& FVoxelTcpServer::OnConnection()
@@ -262,13 +564,15 @@ bool FVoxelTcpServer::Accept(FSocket* NewSocket, const FIPv4Endpoint& Endpoint)
 	OnConnectionDelegate.ExecuteIfBound();
 
 	Sockets.Add(NewSocket);
-	SocketsToSendSave.Add(NewSocket);
 
 	int BufferSize = 1000000;
 	int NewSize;
 	NewSocket->SetSendBufferSize(BufferSize, NewSize);
 	check(BufferSize == NewSize);
 
+	// The network thread resumes the partial sends
+	NewSocket->SetNonBlocking(true);
+
 	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("Connected!"));
 
 	return true;
@@ -280,116 +584,305 @@ bool FVoxelTcpServer::IsValid()
 	return Sockets.Num() > 0;
 }
 
-void FVoxelTcpServer::SendValueDiffQueue(const TArray<FVoxelValueDiff>& Diffs)
+void FVoxelTcpServer::SendChunksEnteringInterests(FVoxelData& Data)
 {
-	SendDiffs(Diffs, true);
-}
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelTcpServer_SendChunks);
 
-void FVoxelTcpServer::SendMaterialDiffQueue(const TArray<FVoxelMaterialDiff>& Diffs)
-{
-	SendDiffs(Diffs, false);
+	TMap<FSocket*, TArray<FIntBox>> Interests;
+	{
+		FScopeLock Lock(&SocketsLock);
+		Interests = ClientsInterests;
+	}
+
+	for (auto& It : Interests)
+	{
+		TArray<FIntBox>& SyncedInterest = SyncedInterests.FindOrAdd(It.Key);
+		if (SyncedInterest == It.Value)
+		{
+			continue;
+		}
+
+		// The chunks still in the region are kept up to date by the diffs
+		TArray<FVoxelChunkSave> Chunks;
+		Data.GetChunksInBoxes(It.Value, SyncedInterest, Chunks);
+		SyncedInterest = It.Value;
+
+		if (Chunks.Num() > 0)
+		{
+			FVoxelWorldSave Save;
+			Save.Init(Data.LOD, Chunks);
+
+			// Clients only read complete messages, and their receive buffer is bounded
+			TArray<FVoxelWorldSave> Saves;
+			Save.SplitRecords(MAX_DIFF_MESSAGE_SIZE, Saves);
+
+			for (auto& MessageSave : Saves)
+			{
+				// Already compressed
+				TArray<uint8> Message;
+				WriteSave(MessageSave, Message);
+				SendMessage({ It.Key }, EVoxelMessageType::Chunks, false, MoveTemp(Message));
+			}
+		}
+	}
 }
 
-void FVoxelTcpServer::SendSave(const FVoxelWorldSave& Save, bool bOnlyToNewConnections)
+void FVoxelTcpServer::SendDiffQueues(const FVoxelData& Data, const TArray<FVoxelValueDiff>& ValueDiffQueue, const TArray<FVoxelMaterialDiff>& MaterialDiffQueue)
 {
-	// Needed because of <<
-	FVoxelWorldSave& NotConstSave = const_cast<FVoxelWorldSave&>(Save);
-	
-	FBufferArchive Writer;
-	Writer << NotConstSave.LOD;
-	Writer << NotConstSave.Data;
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelTcpServer_SendData);
 
+	if (SyncedInterests.Num() == 0 || (ValueDiffQueue.Num() == 0 && MaterialDiffQueue.Num() == 0))
 	{
-		FScopeLock Lock(&SocketsLock);
-		for (auto Socket : (bOnlyToNewConnections ? SocketsToSendSave : Sockets))
+		return;
+	}
+
+	// Each chunk is encoded once, then sent to the clients interested in it
+	TArray<TArray<uint8>> EncodedChunks;
+	TArray<FIntBox> ChunksBounds;
+
+	// Big: 48kB
+	TUniquePtr<FVoxelDiffChunk> Chunk = MakeUnique<FVoxelDiffChunk>();
+
+	// Both queues are sorted by increasing Id: merge them chunk by chunk
+	int ValueIndex = 0;
+	int MaterialIndex = 0;
+	while (ValueIndex < ValueDiffQueue.Num() || MaterialIndex < MaterialDiffQueue.Num())
+	{
+		const uint64 ValueId = ValueIndex < ValueDiffQueue.Num() ? ValueDiffQueue[ValueIndex].Id : MAX_uint64;
+		const uint64 MaterialId = MaterialIndex < MaterialDiffQueue.Num() ? MaterialDiffQueue[MaterialIndex].Id : MAX_uint64;
+
+		Chunk->Id = FMath::Min(ValueId, MaterialId);
+		FMemory::Memzero(Chunk->ValuesMask);
+		FMemory::Memzero(Chunk->MaterialsMask);
+
+		const bool bHasValues = ValueId == Chunk->Id;
+		const bool bHasMaterials = MaterialId == Chunk->Id;
+		for (; ValueIndex < ValueDiffQueue.Num() && ValueDiffQueue[ValueIndex].Id == Chunk->Id; ValueIndex++)
 		{
-			// Send
-			int32 BytesSent = 0;
+			const FVoxelValueDiff& Diff = ValueDiffQueue[ValueIndex];
+			check(Diff.Index < DATA_CHUNK_TOTAL_SIZE);
+			SetBit(Chunk->ValuesMask, Diff.Index);
+			Chunk->Values[Diff.Index] = Diff.Value;
+		}
+		for (; MaterialIndex < MaterialDiffQueue.Num() && MaterialDiffQueue[MaterialIndex].Id == Chunk->Id; MaterialIndex++)
+		{
+			const FVoxelMaterialDiff& Diff = MaterialDiffQueue[MaterialIndex];
+			check(Diff.Index < DATA_CHUNK_TOTAL_SIZE);
+			SetBit(Chunk->MaterialsMask, Diff.Index);
+			Chunk->Materials[Diff.Index] = Diff.Material;
+		}
+
+		FMemoryWriter Writer(EncodedChunks[EncodedChunks.AddDefaulted()]);
+		WriteDiffChunk(Writer, *Chunk, bHasValues, bHasMaterials);
+		ChunksBounds.Add(Data.GetChunkBounds(Chunk->Id));
+	}
+
+	for (auto& It : SyncedInterests)
+	{
+		FSocket* const Socket = It.Key;
+		const TArray<FIntBox>& Interest = It.Value;
+
+		TArray<uint8> Message;
+		FMemoryWriter Writer(Message);
+		uint32 NumChunks = 0;
+		// Overwritten when the message is complete
+		Writer << NumChunks;
+
+		auto SendCurrentMessage = [&]()
+		{
+			Writer.Seek(0);
+			Writer << NumChunks;
+			SendMessage({ Socket }, EVoxelMessageType::Diffs, true, MoveTemp(Message));
+
+			Message.Reset();
+			Writer.Seek(0);
+			NumChunks = 0;
+			Writer << NumChunks;
+		};
+
+		for (int Index = 0; Index < EncodedChunks.Num(); Index++)
+		{
+			const FIntBox& Bounds = ChunksBounds[Index];
+			if (Interest.ContainsByPredicate([&](const FIntBox& Box) { return Box.Intersect(Bounds); }))
+			{
+				Writer.Serialize(EncodedChunks[Index].GetData(), EncodedChunks[Index].Num());
+				NumChunks++;
+
+				if (Message.Num() >= MAX_DIFF_MESSAGE_SIZE)
+				{
+					SendCurrentMessage();
+				}
+			}
+		}
+
+		if (NumChunks > 0)
+		{
+			SendCurrentMessage();
+		}
+	}
+}
+
+void FVoxelTcpServer::SendMessage(const TArray<FSocket*>& TargetSockets, uint8 Type, bool bCompress, TArray<uint8>&& Data)
+{
+	if (TargetSockets.Num() == 0)
+	{
+		return;
+	}
 
-			uint8 Data[5];
+	FMessage Message;
+	Message.Sockets = TargetSockets;
+	Message.Type = Type;
+	Message.bCompress = bCompress;
+	Message.Data = MoveTemp(Data);
+	Messages.Enqueue(MoveTemp(Message));
 
-			uint32 Tmp = Writer.Num();
-			Data[0] = Tmp % 256;
-			Tmp /= 256;
-			Data[1] = Tmp % 256;
-			Tmp /= 256;
-			Data[2] = Tmp % 256;
-			Tmp /= 256;
-			Data[3] = Tmp % 256;
-			Data[4] = true;
+	WakeUpEvent->Trigger();
+}
 
-			Socket->Send(Data, 5, BytesSent);
-			if (BytesSent != 5)
+uint32 FVoxelTcpServer::Run()
+{
+	while (!TimeToDie)
+	{
+		FMessage Message;
+		while (Messages.Dequeue(Message))
+		{
+			// Compressed once for all the clients
+			TSharedPtr<TArray<uint8>> Packet = MakeShareable(new TArray<uint8>());
+			if (Message.bCompress)
 			{
-				UE_LOG(LogVoxel, Error, TEXT("Header for remote load failed to send"));
+				int32 CompressedSize = FCompression::CompressMemoryBound(COMPRESS_ZLIB, Message.Data.Num());
+				Packet->SetNumUninitialized(MESSAGE_HEADER_SIZE + sizeof(int32) + CompressedSize);
+				verify(FCompression::CompressMemory(COMPRESS_ZLIB, Packet->GetData() + MESSAGE_HEADER_SIZE + sizeof(int32), CompressedSize, Message.Data.GetData(), Message.Data.Num()));
+				Packet->SetNum(MESSAGE_HEADER_SIZE + sizeof(int32) + CompressedSize, false);
+
+				const int32 UncompressedSize = Message.Data.Num();
+				FMemory::Memcpy(Packet->GetData() + MESSAGE_HEADER_SIZE, &UncompressedSize, sizeof(int32));
 			}
 			else
 			{
-				bool bSuccess = Socket->Send(Writer.GetData(), Writer.Num(), BytesSent);
-				UE_LOG(LogVoxel, Log, TEXT("Remote load: Bytes to send: %d. Bytes sent: %d. Success: %d"), Writer.Num(), BytesSent, bSuccess);
+				Packet->SetNumUninitialized(MESSAGE_HEADER_SIZE);
+				Packet->Append(Message.Data);
+			}
+			WriteMessageHeader(Packet->GetData(), Packet->Num() - MESSAGE_HEADER_SIZE, Message.Type);
+
+			for (auto Socket : Message.Sockets)
+			{
+				SendQueues.FindOrAdd(Socket).Packets.Add(Packet);
 			}
 		}
-		SocketsToSendSave.Reset();
+
+		const bool bPacketsLeft = FlushSendQueues();
+		ReceiveMessages();
+
+		// Poll the sockets that are full, else wait for new messages
+		WakeUpEvent->Wait(bPacketsLeft ? 1 : RECEIVE_POLL_TIME);
 	}
+	return 0;
 }
 
-template<typename T>
-void FVoxelTcpServer::SendDiffs(const TArray<T>& DiffList, bool bIsValues)
+void FVoxelTcpServer::Stop()
 {
-	SCOPE_CYCLE_COUNTER(STAT_FVoxelTcpServer_SendData);
+	FPlatformAtomics::InterlockedExchange(&TimeToDie, 1);
+	WakeUpEvent->Trigger();
+}
 
-	int i = 0;
-	while (i < DiffList.Num())
+bool FVoxelTcpServer::FlushSendQueues()
+{
+	bool bPacketsLeft = false;
+	for (auto& It : SendQueues)
 	{
-		uint32 SizeToSend = FMath::Min<int>(PACKET_SIZE_IN_DIFF, DiffList.Num() - i);
-
-		FBufferArchive Writer;
-		Writer << bIsValues;
-		Writer << SizeToSend;
+		FSocket* Socket = It.Key;
+		FSendQueue& Queue = It.Value;
 
-		for (uint32 k = 0; k < SizeToSend; k++)
+		while (Queue.Packets.Num() > 0)
 		{
-			Writer << const_cast<T&>(DiffList[i]);
-			i++;
+			const TArray<uint8>& Packet = *Queue.Packets[0];
+
+			int32 BytesSent = 0;
+			if (!Socket->Send(Packet.GetData() + Queue.Offset, Packet.Num() - Queue.Offset, BytesSent))
+			{
+				if (ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() != SE_EWOULDBLOCK)
+				{
+					UE_LOG(LogVoxel, Error, TEXT("Failed to send data: dropping %d messages"), Queue.Packets.Num());
+					Queue.Packets.Reset();
+					Queue.Offset = 0;
+				}
+				break;
+			}
+
+			Queue.Offset += BytesSent;
+			if (Queue.Offset < Packet.Num())
+			{
+				// Send buffer full
+				break;
+			}
+			Queue.Packets.RemoveAt(0);
+			Queue.Offset = 0;
 		}
 
-		TArray<uint8> DataToSend;
-		FArchiveSaveCompressedProxy Compressor = FArchiveSaveCompressedProxy(DataToSend, ECompressionFlags::COMPRESS_ZLIB);
-		// Send entire binary array/archive to compressor
-		Compressor << Writer;
-		// Send archive serialized data to binary array
-		Compressor.Flush();
+		bPacketsLeft |= Queue.Packets.Num() > 0;
+	}
+	return bPacketsLeft;
+}
+
+void FVoxelTcpServer::ReceiveMessages()
+{
+	TArray<FSocket*> CurrentSockets;
+	{
+		FScopeLock Lock(&SocketsLock);
+		CurrentSockets = Sockets;
+	}
+
+	for (auto Socket : CurrentSockets)
+	{
+		TArray<uint8>& Buffer = ReceiveBuffers.FindOrAdd(Socket);
+
+		uint32 PendingDataSize = 0;
+		if (Socket->HasPendingData(PendingDataSize) && PendingDataSize > 0)
+		{
+			const int32 Start = Buffer.Num();
+			Buffer.AddUninitialized(PendingDataSize);
+			int32 BytesRead = 0;
+			Socket->Recv(Buffer.GetData() + Start, PendingDataSize, BytesRead);
+			Buffer.SetNum(Start + FMath::Max(0, BytesRead), false);
+		}
 
+		while (Buffer.Num() >= MESSAGE_HEADER_SIZE)
 		{
-			FScopeLock Lock(&SocketsLock);
-			for (auto Socket : Sockets)
+			const uint32 Size = ReadMessageHeaderSize(Buffer.GetData());
+			const uint8 Type = Buffer[4];
+			if (Size > MAX_DIFF_MESSAGE_SIZE)
 			{
-				// Send
-				int32 BytesSent = 0;
-
-				uint8 Data[5];
-
-				uint32 Tmp = DataToSend.Num();
-				Data[0] = Tmp % 256;
-				Tmp /= 256;
-				Data[1] = Tmp % 256;
-				Tmp /= 256;
-				Data[2] = Tmp % 256;
-				Tmp /= 256;
-				Data[3] = Tmp % 256;
-				Data[4] = false;
-
-				Socket->Send(Data, 5, BytesSent);
-				if (BytesSent != 5)
+				UE_LOG(LogVoxel, Error, TEXT("Client message too big: %u bytes. Dropping the received data"), Size);
+				Buffer.Empty();
+				break;
+			}
+			if ((uint32)Buffer.Num() < MESSAGE_HEADER_SIZE + Size)
+			{
+				break;
+			}
+
+			if (Type == EVoxelMessageType::Interest)
+			{
+				TArray<uint8> Payload(Buffer.GetData() + MESSAGE_HEADER_SIZE, Size);
+				FMemoryReader Reader(Payload);
+				TArray<FIntBox> Interest;
+				SerializeBoxes(Reader, Interest);
+				if (Reader.IsError())
 				{
-					UE_LOG(LogVoxel, Error, TEXT("Header failed to send"));
+					UE_LOG(LogVoxel, Error, TEXT("Corrupted interest message"));
 				}
 				else
 				{
-					bool bSuccess = Socket->Send(DataToSend.GetData(), DataToSend.Num(), BytesSent);
-					UE_LOG(LogVoxel, Log, TEXT("Bytes to send: %d. Bytes sent: %d. Success: %d"), DataToSend.Num(), BytesSent, bSuccess);
+					FScopeLock Lock(&SocketsLock);
+					ClientsInterests.Add(Socket, Interest);
 				}
 			}
+			else
+			{
+				UE_LOG(LogVoxel, Error, TEXT("Unexpected message from client: %d"), Type);
+			}
+			Buffer.RemoveAt(0, MESSAGE_HEADER_SIZE + Size, false);
 		}
 	}
 }
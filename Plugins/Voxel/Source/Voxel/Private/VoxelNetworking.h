@@ -7,17 +7,38 @@
 #include "VoxelDiff.h"
 #include "VoxelSave.h"
 #include "IPv4Endpoint.h"
+#include "Runnable.h"
+#include "Queue.h"
 
-#define PACKET_SIZE_IN_DIFF 250
+// Max uncompressed size of a diffs message, in bytes. Must fit in the client receive buffer once compressed
+#define MAX_DIFF_MESSAGE_SIZE (256 * 1024)
 
 DECLARE_DELEGATE(FOnVoxelTcpServerConnection)
 
 class FSocket;
 class FTcpListener;
 class AVoxelWorld;
+class FVoxelData;
 
 /**
- * The client can only receive diffs and saves
+ * Last byte of the messages headers
+ */
+namespace EVoxelMessageType
+{
+	enum Type : uint8
+	{
+		// Server to client: diffs of a sync
+		Diffs = 0,
+		// 1 was the full world save, removed
+		// Server to client: edited chunks entering the client interest region, as a save
+		Chunks = 2,
+		// Client to server: interest region
+		Interest = 3
+	};
+}
+
+/**
+ * The client can only receive diffs and chunks
  */
 class FVoxelTcpClient
 {
@@ -33,14 +54,23 @@ public:
 	void ConnectTcpClient(const FString& Ip, int32 Port);
 
 	/**
-	 * Receive the diffs from the server. Must not be called when IsNextUpdateRemoteLoad is true
+	 * Receive the diffs from the server. Must not be called when IsNextUpdateChunks is true
+	 * @param	OutValueDiffQueue		Sorted by increasing Id
+	 * @param	OutMaterialDiffQueue	Sorted by increasing Id
 	 */
 	void ReceiveDiffQueues(TArray<FVoxelValueDiff>& OutValueDiffQueue, TArray<FVoxelMaterialDiff>& OutMaterialDiffQueue);
 
 	/**
-	 * Receive the save from the server. Must not be called when IsNextUpdateRemoteLoad is false
+	 * Receive the chunks from the server. Must not be called when IsNextUpdateChunks is false
+	 * @return	Have the chunks been received?
+	 */
+	bool ReceiveSave(FVoxelWorldSave& OutSave);
+
+	/**
+	 * Send the region the server should sync, eg around the invokers. Only sent if it changed
+	 * @param	Boxes	In voxel space
 	 */
-	void ReceiveSave(FVoxelWorldSave& OutSave);
+	void SendInterest(const TArray<FIntBox>& Boxes);
 
 	/**
 	 * Is the connection valid?
@@ -48,29 +78,39 @@ public:
 	bool IsValid() const;
 
 	/**
-	 * Is the server sending the save?
+	 * Is the server sending chunks entering the interest region? To load without reset
 	 */
-	bool IsNextUpdateRemoteLoad();
+	bool IsNextUpdateChunks();
 
 	/**
-	 * Check if headers has been received. Should be called before IsNextUpdateRemoteLoad
+	 * Check if headers has been received. Should be called before IsNextUpdateChunks
 	 */
 	void UpdateExpectedSize();
 
 private:
 	FSocket * Socket;
 
+	/**
+	 * Decode a decompressed diffs message
+	 * @return	Success
+	 */
+	static bool ReadDiffs(const TArray<uint8>& Data, TArray<FVoxelValueDiff>& OutValueDiffs, TArray<FVoxelMaterialDiff>& OutMaterialDiffs);
+
 	bool bExpectedSizeUpToDate;
 	uint32 ExpectedSize;
-	bool bNextUpdateIsRemoteLoad;
+	uint8 NextMessageType;
+
+	TArray<FIntBox> SentInterest;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 /**
  * The server can send the diffs and the saves
+ * Compression and sends are done by a network thread, with a send queue per client: a slow client doesn't block the others nor the game thread
+ * Each client only receives the chunks intersecting the interest region it sent
  */
-class FVoxelTcpServer
+class FVoxelTcpServer : public FRunnable
 {
 public:
 	FOnVoxelTcpServerConnection OnConnectionDelegate;
@@ -94,27 +134,70 @@ public:
 	bool IsValid();
 
 	/**
-	 * Send the value diffs
+	 * Send to each client the edited chunks that entered its interest region since the last call
+	 * Should be called before SendDiffQueues
 	 */
-	void SendValueDiffQueue(const TArray<FVoxelValueDiff>& ValueDiffQueue);
+	void SendChunksEnteringInterests(FVoxelData& Data);
 	/**
-	 * Send the materials diffs
+	 * Send the diffs of a sync, grouped by chunk. A client only receives the chunks in its interest region
+	 * @param	ValueDiffQueue		Sorted by increasing Id
+	 * @param	MaterialDiffQueue	Sorted by increasing Id
 	 */
-	void SendMaterialDiffQueue(const TArray<FVoxelMaterialDiff>& MaterialDiffQueue);
-	/**
-	 * Send a world save
-	 * @param	bOnlyToNewConnections	Only send save to the one that haven't synced yet
-	 */
-	void SendSave(const FVoxelWorldSave& Save, bool bOnlyToNewConnections);
+	void SendDiffQueues(const FVoxelData& Data, const TArray<FVoxelValueDiff>& ValueDiffQueue, const TArray<FVoxelMaterialDiff>& MaterialDiffQueue);
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
 
 private:
+	struct FMessage
+	{
+		TArray<FSocket*> Sockets;
+		uint8 Type;
+		bool bCompress;
+		TArray<uint8> Data;
+	};
+	struct FSendQueue
+	{
+		// Header and data of the messages
+		TArray<TSharedPtr<TArray<uint8>>> Packets;
+		// Bytes of the first packet already sent
+		int32 Offset = 0;
+	};
+
 	FTcpListener* TcpListener;
 	TArray<FSocket*> Sockets;
-	TArray<FSocket*> SocketsToSendSave;
+	// Received by the network thread. Requires SocketsLock
+	TMap<FSocket*, TArray<FIntBox>> ClientsInterests;
 	FCriticalSection SocketsLock;
 
-	template<typename T>
-	void SendDiffs(const TArray<T>& DiffList, bool bIsValues);
+	// Game thread only: interest regions of the last SendChunksEnteringInterests
+	TMap<FSocket*, TArray<FIntBox>> SyncedInterests;
+
+	FRunnableThread* Thread;
+	FEvent* WakeUpEvent;
+	volatile int32 TimeToDie;
+	// Filled by the game thread
+	TQueue<FMessage, EQueueMode::Spsc> Messages;
+	// Network thread only
+	TMap<FSocket*, FSendQueue> SendQueues;
+	// Network thread only: incomplete messages from the clients
+	TMap<FSocket*, TArray<uint8>> ReceiveBuffers;
+
+	/**
+	 * Queue a message for the network thread
+	 */
+	void SendMessage(const TArray<FSocket*>& TargetSockets, uint8 Type, bool bCompress, TArray<uint8>&& Data);
+	/**
+	 * Network thread: send as much of the queued packets as the sockets accept
+	 * @return	Are there packets left?
+	 */
+	bool FlushSendQueues();
+	/**
+	 * Network thread: read the messages of the clients
+	 */
+	void ReceiveMessages();
 
 	/**
 	 * Callback from the server
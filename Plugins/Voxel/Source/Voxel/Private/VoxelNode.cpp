@@ -300,6 +300,26 @@ FVoxelComputeNode::FVoxelComputeNode(const UVoxelNode* InNode)
 
 		DefaultValues[k] = Value;
 		DefaultValueStrings[k] = ValueString;
+
+		switch (Pin.PinCategory)
+		{
+		case EVoxelPinCategory::Boolean:
+			DefaultRanges[k] = FVoxelRange(Value.B ? 1.f : 0.f);
+			DefaultRangeStrings[k] = TEXT("FVoxelRange(") + FString(Value.B ? TEXT("1") : TEXT("0")) + TEXT(")");
+			break;
+		case EVoxelPinCategory::Int:
+			DefaultRanges[k] = FVoxelRange((float)Value.I);
+			DefaultRangeStrings[k] = TEXT("FVoxelRange(") + ValueString + TEXT(")");
+			break;
+		case EVoxelPinCategory::Float:
+			DefaultRanges[k] = FVoxelRange(Value.F);
+			DefaultRangeStrings[k] = TEXT("FVoxelRange(") + ValueString + TEXT(")");
+			break;
+		default:
+			DefaultRanges[k] = FVoxelRange::Infinite();
+			DefaultRangeStrings[k] = TEXT("FVoxelRange::Infinite()");
+		}
+
 		k++;
 	}
 	int l = 0;
@@ -309,3 +329,72 @@ FVoxelComputeNode::FVoxelComputeNode(const UVoxelNode* InNode)
 		l++;
 	}
 }
+
+void FVoxelComputeNode::ComputeBatch(FVoxelNodeType* Inputs[], FVoxelNodeType* Outputs[], const FVoxelBatchContext& Context, const FVoxelBatchLanes& Lanes) const
+{
+	FVoxelNodeType LaneInputs[MAX_PINS];
+	FVoxelNodeType LaneOutputs[MAX_PINS];
+
+	for (int Index = 0; Index < Lanes.Num; Index++)
+	{
+		const int32 Lane = Lanes.Get(Index);
+
+		for (int InputIndex = 0; InputIndex < InputCount; InputIndex++)
+		{
+			LaneInputs[InputIndex] = Inputs[InputIndex][Lane];
+		}
+
+		FVoxelContext LaneContext;
+		LaneContext.X = Context.X[Lane];
+		LaneContext.Y = Context.Y[Lane];
+		LaneContext.Z = Context.Z[Lane];
+
+		Compute(LaneInputs, LaneOutputs, LaneContext);
+
+		for (int OutputIndex = 0; OutputIndex < OutputCount; OutputIndex++)
+		{
+			Outputs[OutputIndex][Lane] = LaneOutputs[OutputIndex];
+		}
+	}
+}
+
+void FVoxelComputeNode::GetBranchResultBatch(FVoxelNodeType* Inputs[], const FVoxelBatchLanes& Lanes, int32 OutBranchIds[]) const
+{
+	FVoxelNodeType LaneInputs[MAX_PINS];
+
+	for (int Index = 0; Index < Lanes.Num; Index++)
+	{
+		const int32 Lane = Lanes.Get(Index);
+
+		for (int InputIndex = 0; InputIndex < InputCount; InputIndex++)
+		{
+			LaneInputs[InputIndex] = Inputs[InputIndex][Lane];
+		}
+
+		OutBranchIds[Lane] = GetBranchResult(LaneInputs);
+	}
+}
+
+void FVoxelComputeNode::ComputeRange(const FVoxelRange Inputs[], FVoxelRange Outputs[], const FIntBox& Bounds) const
+{
+	for (int OutputIndex = 0; OutputIndex < OutputCount; OutputIndex++)
+	{
+		Outputs[OutputIndex] = FVoxelRange::Infinite();
+	}
+}
+
+void FVoxelComputeNode::GetBranchResultRange(const FVoxelRange Inputs[], bool OutPossibleBranches[]) const
+{
+	for (int BranchIndex = 0; BranchIndex < MAX_PINS; BranchIndex++)
+	{
+		OutPossibleBranches[BranchIndex] = true;
+	}
+}
+
+void FVoxelComputeNode::GetRangeMain(const TArray<FString>& Inputs, const TArray<FString>& Outputs, const FString& Bounds, FString& OutCpp) const
+{
+	for (int OutputIndex = 0; OutputIndex < OutputCount; OutputIndex++)
+	{
+		OutCpp.Append(Outputs[OutputIndex] + TEXT(" = FVoxelRange::Infinite();"));
+	}
+}
@@ -90,6 +90,36 @@ void FVoxelComputeNode_NoiseNodeFractal::GetSetVoxelWorld(const FString& VoxelWo
 	OutCpp.Append(NoiseName + TEXT(".SetFractalType((FastNoise::FractalType)" + FString::FromInt((int)FractalType) + TEXT(");\n")));
 }
 
+float FVoxelComputeNode_NoiseNodeFractal::GetNoiseBound(float SingleBound) const
+{
+	// Same as FastNoise::CalculateFractalBounding, with the absolute value of the gain
+	float Amplitude = FMath::Abs(FractalGain);
+	float AbsoluteSum = 1;
+	float Sum = 1;
+	for (int i = 1; i < FractalOctaves; i++)
+	{
+		AbsoluteSum += Amplitude;
+		Sum += FMath::Pow(FractalGain, i);
+		Amplitude *= FMath::Abs(FractalGain);
+	}
+
+	switch (FractalType)
+	{
+	case EFractalType::FBM:
+		// Octaves are normalized by 1 / Sum
+		return Sum > KINDA_SMALL_NUMBER ? SingleBound * AbsoluteSum / Sum : MAX_flt;
+	case EFractalType::Billow:
+		// Octaves are abs(X) * 2 - 1, normalized by 1 / Sum
+		return Sum > KINDA_SMALL_NUMBER ? FMath::Max(1.f, 2 * SingleBound - 1) * AbsoluteSum / Sum : MAX_flt;
+	case EFractalType::RigidMulti:
+		// Octaves are 1 - abs(X), not normalized
+		return FMath::Max(1.f, SingleBound - 1) * AbsoluteSum;
+	default:
+		check(false);
+		return MAX_flt;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -49,7 +49,7 @@ void AVoxelPartSimpleMesh::Init(FVoxelData* Data, AVoxelWorld* World)
 				{
 					FVoxelProcMeshSection Section;
 					Section.bEnableCollision = true;
-					Thread->Chunk.InitSectionBuffers(Section.ProcVertexBuffer, Section.ProcIndexBuffer, 0);
+					Thread->Chunk.InitSectionBuffers(Section.ProcVertexBuffer, Section.ProcIndexBuffer);
 
 					TArray<FVector> Vertices;
 					Vertices.SetNumUninitialized(Section.ProcVertexBuffer.Num());
@@ -69,7 +69,7 @@ void FVoxelIntermediateChunk::Reset()
 	VertexBuffer.Reset();
 }
 
-void FVoxelIntermediateChunk::InitSectionBuffers(TArray<FVoxelProcMeshVertex>& OutVertexBuffer, TArray<int32>& OutIndexBuffer, uint8 TransitionsMask) const
+void FVoxelIntermediateChunk::InitSectionBuffers(TArray<FVoxelProcMeshVertex>& OutVertexBuffer, TArray<int32>& OutIndexBuffer) const
 {
 	OutVertexBuffer.SetNumUninitialized(VertexBuffer.Num());
 	for (int Index = 0; Index < OutVertexBuffer.Num(); Index++)
@@ -77,7 +77,7 @@ void FVoxelIntermediateChunk::InitSectionBuffers(TArray<FVoxelProcMeshVertex>& O
 		FVoxelProcMeshVertex NewVertex;
 		const FVoxelVertex& Vertex = VertexBuffer[Index];
 
-		NewVertex.Position = GetTranslated(Vertex.Position, Vertex.Normal, TransitionsMask, LOD);
+		NewVertex.Position = Vertex.Position;
 		NewVertex.Normal = Vertex.Normal;
 		NewVertex.Color = Vertex.Color;
 
@@ -527,6 +527,7 @@ bool FVoxelPolygonizer::CreateChunk(FVoxelIntermediateChunk& OutChunk)
 
 		if (LOD > 0)
 		{
+			// Readers don't lock: this only ends the get. The edges were refined with uncached reads of the values between the cached ones
 			Data->EndGet(Octrees);
 		}
 	}
@@ -689,14 +690,8 @@ void FVoxelPolygonizer::GetNormal(const FVector& Position, FVector& Result) cons
 		Position.Z < Step() ||
 		Position.Z >(CHUNK_SIZE - 1) * Step())
 	{
-		if (LOD == 0)
-		{
-			GetNormalImpl(this, Position, Step(), Result);
-		}
-		else
-		{
-			GetNormalImpl(Data, Position + (FVector)ChunkPosition, Step(), Result);
-		}
+		// Gradients of the cached values: for LOD > 0, the normals are at the chunk resolution, like the mesh
+		GetNormalImpl(this, Position / Step(), 1, Result);
 	}
 	else
 	{
@@ -724,7 +719,6 @@ void FVoxelPolygonizer::GetValueAndMaterialFromCache(int X, int Y, int Z, float&
 
 float FVoxelPolygonizer::GetValue(int X, int Y, int Z) const
 {
-	check(LOD == 0);
 	check(-1 <= X && X < CHUNK_SIZE + 2 && -1 <= Y && Y < CHUNK_SIZE + 2 && -1 <= Z && Z < CHUNK_SIZE + 2);
 
 	return CachedValues[(X + 1) + (CHUNK_SIZE + 3) * (Y + 1) + (CHUNK_SIZE + 3) * (CHUNK_SIZE + 3) * (Z + 1)];
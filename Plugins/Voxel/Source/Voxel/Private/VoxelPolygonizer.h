@@ -36,7 +36,8 @@ struct FVoxelIntermediateChunk
 
 	void Reset();
 
-	void InitSectionBuffers(TArray<FVoxelProcMeshVertex>& OutVertexBuffer, TArray<int32>& OutIndexBuffer, uint8 TransitionsMask) const;
+	// The vertices aren't translated for the transitions: the vertex factory does it, see UVoxelProceduralMeshComponent::SetTransitions
+	void InitSectionBuffers(TArray<FVoxelProcMeshVertex>& OutVertexBuffer, TArray<int32>& OutIndexBuffer) const;
 
 	static FVector GetTranslated(const FVector& Vertex, const FVector& Normal, uint8 TransitionsMask, uint8 LOD);
 };
@@ -48,7 +49,7 @@ public:
 
 	bool CreateChunk(FVoxelIntermediateChunk& OutChunk);
 	
-	// For NormalImpl
+	// For NormalImpl. In cached values coordinates: the position divided by Step
 	float GetValue(int X, int Y, int Z) const;
 
 private:
@@ -16,6 +16,8 @@ FVoxelPolygonizerForCollisions::FVoxelPolygonizerForCollisions(FVoxelData* Data,
 	: Data(Data)
 	, ChunkPosition(ChunkPosition)
 	, bEnableRender(bEnableRender)
+	, Cache(FVoxelPolygonizerForCollisionsBuffers::Get().Cache)
+	, CachedValues(FVoxelPolygonizerForCollisionsBuffers::Get().CachedValues)
 {
 }
 
@@ -2,12 +2,28 @@
 
 #include "CoreMinimal.h"
 #include "VoxelProceduralMeshComponent.h"
+#include "ThreadSingleton.h"
 
 #define CHUNKSIZE_FC 18
 
 class FVoxelData;
 struct FVoxelMaterial;
 
+/**
+ * Large caches of FVoxelPolygonizerForCollisions. Allocated once per thread and reused by all the polygonizers of this thread
+ */
+class FVoxelPolygonizerForCollisionsBuffers : public TThreadSingleton<FVoxelPolygonizerForCollisionsBuffers>
+{
+public:
+	// Cache to get index of already created vertices
+	int Cache[CHUNKSIZE_FC][CHUNKSIZE_FC][CHUNKSIZE_FC][3];
+
+	float CachedValues[(CHUNKSIZE_FC + 1) * (CHUNKSIZE_FC + 1) * (CHUNKSIZE_FC + 1)];
+};
+
+/**
+ * Must be used on the thread that created it: the caches are shared with the other polygonizers of this thread
+ */
 class FVoxelPolygonizerForCollisions
 {
 public:
@@ -25,9 +41,9 @@ private:
 	uint64 CachedSigns[216];
 
 	// Cache to get index of already created vertices
-	int Cache[CHUNKSIZE_FC][CHUNKSIZE_FC][CHUNKSIZE_FC][3];
+	int (&Cache)[CHUNKSIZE_FC][CHUNKSIZE_FC][CHUNKSIZE_FC][3];
 
-	float CachedValues[(CHUNKSIZE_FC + 1) * (CHUNKSIZE_FC + 1) * (CHUNKSIZE_FC + 1)];
+	float (&CachedValues)[(CHUNKSIZE_FC + 1) * (CHUNKSIZE_FC + 1) * (CHUNKSIZE_FC + 1)];
 
 	FORCEINLINE float GetValue(int X, int Y, int Z);
 
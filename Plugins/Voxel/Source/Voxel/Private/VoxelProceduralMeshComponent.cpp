@@ -58,7 +58,7 @@ public:
 	{
 		nv::Vertex Vertex;
 
-		const FVector& Position = VertexBuffer.Vertices[Index].Position;
+		const FVector Position = VertexBuffer.Vertices[Index].GetPosition(VertexBuffer.PositionScale);
 		Vertex.pos.x = Position.X;
 		Vertex.pos.y = Position.Y;
 		Vertex.pos.z = Position.Z;
@@ -111,14 +111,34 @@ static void BuildStaticAdjacencyIndexBuffer(const FVoxelProcMeshVertexBuffer& Po
 //////////////////////////////////////////////////////////////////////////
 
 
-static void ConvertProcMeshToDynMeshVertex(FVoxelDynamicMeshVertex& Vert, const FVoxelProcMeshVertex& ProcVert)
+static void ConvertProcMeshToDynMeshVertex(FVoxelDynamicMeshVertex& Vert, const FVoxelProcMeshVertex& ProcVert, float PositionScale)
 {
-	Vert.Position = ProcVert.Position;
+	Vert.SetPosition(ProcVert.Position, PositionScale);
+	Vert.SetNormal(ProcVert.Normal);
 	Vert.Color = ProcVert.Color;
 	Vert.TextureCoordinate = ProcVert.TextureCoordinate;
-	Vert.TangentX = ProcVert.Tangent.TangentX;
-	Vert.TangentZ = ProcVert.Normal;
-	Vert.TangentZ.Vector.W = ProcVert.Tangent.bFlipTangentY ? 0 : 255;
+}
+
+/** @return	The position scale of the vertices */
+static float ConvertProcMeshToDynMeshVertices(TArray<FVoxelDynamicMeshVertex>& OutVertices, const TArray<FVoxelProcMeshVertex>& ProcVertices)
+{
+	// Find the fixed point precision
+	float MaxAbsCoordinate = 0;
+	for (const FVoxelProcMeshVertex& ProcVert : ProcVertices)
+	{
+		MaxAbsCoordinate = FMath::Max(MaxAbsCoordinate, ProcVert.Position.GetAbsMax());
+	}
+	const float PositionScale = FVoxelProcMeshVertexBuffer::GetPositionScale(MaxAbsCoordinate);
+
+	// Allocate verts
+	OutVertices.SetNumUninitialized(ProcVertices.Num());
+	// Copy verts
+	for (int VertIdx = 0; VertIdx < ProcVertices.Num(); VertIdx++)
+	{
+		ConvertProcMeshToDynMeshVertex(OutVertices[VertIdx], ProcVertices[VertIdx], PositionScale);
+	}
+
+	return PositionScale;
 }
 
 
@@ -130,6 +150,8 @@ FVoxelProceduralMeshSceneProxy::FVoxelProceduralMeshSceneProxy(UVoxelProceduralM
 	: FPrimitiveSceneProxy(Component)
 	, BodySetup(Component->GetBodySetup())
 	, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetFeatureLevel()))
+	, TransitionsMask(Component->TransitionsMask)
+	, TransitionsLOD(Component->TransitionsLOD)
 {
 	// Copy each section
 	const int32 NumSections = Component->ProcMeshSections.Num();
@@ -146,24 +168,11 @@ FVoxelProceduralMeshSceneProxy::FVoxelProceduralMeshSceneProxy(UVoxelProceduralM
 #endif
 
 			// Copy data from vertex buffer
-			const int32 NumVerts = SrcSection.ProcVertexBuffer.Num();
-
-			// Allocate verts
-			NewSection->VertexBuffer.Vertices.SetNumUninitialized(NumVerts);
-			// Copy verts
-			for (int VertIdx = 0; VertIdx < NumVerts; VertIdx++)
-			{
-				const FVoxelProcMeshVertex& ProcVert = SrcSection.ProcVertexBuffer[VertIdx];
-				FVoxelDynamicMeshVertex& Vert = NewSection->VertexBuffer.Vertices[VertIdx];
-				ConvertProcMeshToDynMeshVertex(Vert, ProcVert);
-			}
+			NewSection->VertexBuffer.PositionScale = ConvertProcMeshToDynMeshVertices(NewSection->VertexBuffer.Vertices, SrcSection.ProcVertexBuffer);
 
 			// Copy index buffer
 			NewSection->IndexBuffer.Indices = SrcSection.ProcIndexBuffer;
 
-			// Init vertex factory
-			NewSection->VertexFactory.Init(&NewSection->VertexBuffer);
-			
 			// Grab material
 			NewSection->Material = Component->GetMaterial(SectionIdx);
 			if (NewSection->Material == NULL)
@@ -171,35 +180,10 @@ FVoxelProceduralMeshSceneProxy::FVoxelProceduralMeshSceneProxy(UVoxelProceduralM
 				NewSection->Material = UMaterial::GetDefaultMaterial(MD_Surface);
 			}
 
-			NewSection->bRequiresAdjacencyInformation = RequiresAdjacencyInformation(NewSection->Material, NewSection->VertexFactory.GetType(), GetScene().GetFeatureLevel());
-
-#if !PLATFORM_ANDROID
-			if (NewSection->bRequiresAdjacencyInformation)
-			{
-				TArray<uint32> Indices;
-				Indices.SetNum(NewSection->IndexBuffer.Indices.Num());
-				for (int i = 0; i < Indices.Num(); i++)
-				{
-					Indices[i] = NewSection->IndexBuffer.Indices[i];
-				}
-
-				BuildStaticAdjacencyIndexBuffer(
-					NewSection->VertexBuffer,
-					Indices,
-					NewSection->AdjacencyIndexBuffer.Indices
-				);
-			}
-#endif // !PLATFORM_ANDROID
-
+			NewSection->bEnableTransitions = SrcSection.bEnableTransitions;
 
 			// Enqueue initialization of render resource
-			BeginInitResource(&NewSection->VertexBuffer);
-			BeginInitResource(&NewSection->IndexBuffer);
-			BeginInitResource(&NewSection->VertexFactory);
-			if (NewSection->bRequiresAdjacencyInformation)
-			{
-				BeginInitResource(&NewSection->AdjacencyIndexBuffer);
-			}
+			InitSectionResources(*NewSection, false);
 
 			// Copy visibility info
 			NewSection->bSectionVisible = SrcSection.bSectionVisible;
@@ -216,18 +200,138 @@ FVoxelProceduralMeshSceneProxy::~FVoxelProceduralMeshSceneProxy()
 	{
 		if (Section != nullptr)
 		{
-			Section->VertexBuffer.ReleaseResource();
-			Section->IndexBuffer.ReleaseResource();
-			Section->VertexFactory.ReleaseResource();
-			if (Section->bRequiresAdjacencyInformation)
-			{
-				Section->AdjacencyIndexBuffer.ReleaseResource();
-			}
+			ReleaseSectionResources(*Section);
 			delete Section;
 		}
 	}
 }
 
+void FVoxelProceduralMeshSceneProxy::UpdateSection_RenderThread(FVoxelProcMeshSectionUpdateData* SectionData)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProcMesh_UpdateSectionRT);
+
+	check(IsInRenderingThread());
+	check(SectionData && Sections.IsValidIndex(SectionData->TargetSection));
+
+	FVoxelProcMeshProxySection*& Section = Sections[SectionData->TargetSection];
+	if (SectionData->NewIndexBuffer.Num() == 0 || SectionData->NewVertexBuffer.Num() == 0)
+	{
+		// Empty sections don't have a proxy section
+		if (Section != nullptr)
+		{
+			ReleaseSectionResources(*Section);
+			delete Section;
+			Section = nullptr;
+		}
+	}
+	else
+	{
+		if (Section == nullptr)
+		{
+#if ENGINE_MINOR_VERSION < 19
+			Section = new FVoxelProcMeshProxySection();
+#else
+			Section = new FVoxelProcMeshProxySection(GetScene().GetFeatureLevel());
+#endif
+			Section->Material = SectionData->Material;
+		}
+
+		Section->VertexBuffer.Vertices = MoveTemp(SectionData->NewVertexBuffer);
+		Section->VertexBuffer.PositionScale = SectionData->NewPositionScale;
+		Section->IndexBuffer.Indices = MoveTemp(SectionData->NewIndexBuffer);
+		Section->bSectionVisible = SectionData->bSectionVisible;
+		Section->bEnableTransitions = SectionData->bEnableTransitions;
+
+		InitSectionResources(*Section, true);
+	}
+
+	delete SectionData;
+}
+
+void FVoxelProceduralMeshSceneProxy::SetTransitions_RenderThread(uint8 NewTransitionsMask, uint8 NewTransitionsLOD)
+{
+	check(IsInRenderingThread());
+
+	TransitionsMask = NewTransitionsMask;
+	TransitionsLOD = NewTransitionsLOD;
+
+	for (FVoxelProcMeshProxySection* Section : Sections)
+	{
+		if (Section != nullptr && Section->bEnableTransitions)
+		{
+			Section->VertexFactory.SetTransitions(TransitionsMask, TransitionsLOD);
+		}
+	}
+}
+
+void FVoxelProceduralMeshSceneProxy::InitSectionResources(FVoxelProcMeshProxySection& Section, bool bRenderThread)
+{
+	// Read by the render thread only when drawing
+	Section.VertexFactory.SetTransitions(Section.bEnableTransitions ? TransitionsMask : 0, TransitionsLOD);
+
+	Section.bRequiresAdjacencyInformation = RequiresAdjacencyInformation(Section.Material, Section.VertexFactory.GetType(), GetScene().GetFeatureLevel());
+
+#if !PLATFORM_ANDROID
+	if (Section.bRequiresAdjacencyInformation)
+	{
+		TArray<uint32> Indices;
+		Indices.SetNum(Section.IndexBuffer.Indices.Num());
+		for (int i = 0; i < Indices.Num(); i++)
+		{
+			Indices[i] = Section.IndexBuffer.Indices[i];
+		}
+
+		BuildStaticAdjacencyIndexBuffer(
+			Section.VertexBuffer,
+			Indices,
+			Section.AdjacencyIndexBuffer.Indices
+		);
+	}
+#endif // !PLATFORM_ANDROID
+
+	if (bRenderThread)
+	{
+		// Reuse the existing buffers when possible
+		Section.VertexBuffer.UpdateBuffer();
+		Section.IndexBuffer.UpdateBuffer();
+		if (Section.bRequiresAdjacencyInformation)
+		{
+			Section.AdjacencyIndexBuffer.UpdateBuffer();
+		}
+		// The position scale might have changed
+		Section.VertexFactory.Init_RenderThread(&Section.VertexBuffer);
+		if (!Section.VertexFactory.IsInitialized())
+		{
+			Section.VertexFactory.InitResource();
+		}
+	}
+	else
+	{
+		// Init vertex factory
+		Section.VertexFactory.Init(&Section.VertexBuffer);
+
+		// Enqueue initialization of render resource
+		BeginInitResource(&Section.VertexBuffer);
+		BeginInitResource(&Section.IndexBuffer);
+		BeginInitResource(&Section.VertexFactory);
+		if (Section.bRequiresAdjacencyInformation)
+		{
+			BeginInitResource(&Section.AdjacencyIndexBuffer);
+		}
+	}
+}
+
+void FVoxelProceduralMeshSceneProxy::ReleaseSectionResources(FVoxelProcMeshProxySection& Section)
+{
+	Section.VertexBuffer.ReleaseResource();
+	Section.IndexBuffer.ReleaseResource();
+	Section.VertexFactory.ReleaseResource();
+	if (Section.bRequiresAdjacencyInformation)
+	{
+		Section.AdjacencyIndexBuffer.ReleaseResource();
+	}
+}
+
 void FVoxelProceduralMeshSceneProxy::GetDynamicMeshElements(const TArray<const FSceneView *>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMeshElementCollector& Collector) const
 {
 	SCOPE_CYCLE_COUNTER(STAT_ProcMesh_GetMeshElements);
@@ -329,6 +433,8 @@ uint32 FVoxelProceduralMeshSceneProxy::GetAllocatedSize(void) const
 
 UVoxelProceduralMeshComponent::UVoxelProceduralMeshComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
+	, TransitionsMask(0)
+	, TransitionsLOD(0)
 {
 	bUseComplexAsSimpleCollision = true;
 
@@ -439,8 +545,11 @@ FVoxelProcMeshSection* UVoxelProceduralMeshComponent::GetProcMeshSection(int32 S
 
 void UVoxelProceduralMeshComponent::SetProcMeshSection(int32 SectionIndex, const FVoxelProcMeshSection& Section)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ProcMesh_UpdateSectionGT);
+
 	// Ensure sections array is long enough
-	if (SectionIndex >= ProcMeshSections.Num())
+	const bool bSectionCountChanged = SectionIndex >= ProcMeshSections.Num();
+	if (bSectionCountChanged)
 	{
 		ProcMeshSections.SetNum(SectionIndex + 1, false);
 	}
@@ -449,7 +558,64 @@ void UVoxelProceduralMeshComponent::SetProcMeshSection(int32 SectionIndex, const
 
 	UpdateLocalBounds(); // Update overall bounds
 	if (GetOwner() && GetOwner()->GetWorld() && GetOwner()->GetWorld()->WorldType != EWorldType::Editor) UpdateCollision(); // Mark collision as dirty
-	MarkRenderStateDirty(); // New section requires recreating scene proxy
+	UpdateSectionRenderState(SectionIndex, bSectionCountChanged);
+}
+
+void UVoxelProceduralMeshComponent::UpdateSectionRenderState(int32 SectionIndex, bool bSectionCountChanged)
+{
+	if (bSectionCountChanged || !SceneProxy || IsRenderStateDirty())
+	{
+		// New section requires recreating scene proxy. Materials changes already mark the render state dirty
+		MarkRenderStateDirty();
+		return;
+	}
+
+	const FVoxelProcMeshSection& Section = ProcMeshSections[SectionIndex];
+
+	FVoxelProcMeshSectionUpdateData* SectionData = new FVoxelProcMeshSectionUpdateData;
+	SectionData->TargetSection = SectionIndex;
+	SectionData->NewPositionScale = ConvertProcMeshToDynMeshVertices(SectionData->NewVertexBuffer, Section.ProcVertexBuffer);
+	SectionData->NewIndexBuffer = Section.ProcIndexBuffer;
+	SectionData->Material = GetMaterial(SectionIndex);
+	if (SectionData->Material == NULL)
+	{
+		SectionData->Material = UMaterial::GetDefaultMaterial(MD_Surface);
+	}
+	SectionData->bSectionVisible = Section.bSectionVisible;
+	SectionData->bEnableTransitions = Section.bEnableTransitions;
+
+	// Only this section buffers are sent
+	ENQUEUE_UNIQUE_RENDER_COMMAND_TWOPARAMETER(
+		FVoxelProcMeshSectionUpdate,
+		FVoxelProceduralMeshSceneProxy*, ProcMeshSceneProxy, (FVoxelProceduralMeshSceneProxy*)SceneProxy,
+		FVoxelProcMeshSectionUpdateData*, SectionData, SectionData,
+		{
+			ProcMeshSceneProxy->UpdateSection_RenderThread(SectionData);
+		});
+}
+
+void UVoxelProceduralMeshComponent::SetTransitions(uint8 NewTransitionsMask, uint8 NewTransitionsLOD)
+{
+	if (TransitionsMask == NewTransitionsMask && TransitionsLOD == NewTransitionsLOD)
+	{
+		return;
+	}
+
+	TransitionsMask = NewTransitionsMask;
+	TransitionsLOD = NewTransitionsLOD;
+
+	// Else the new proxy reads them from the component
+	if (SceneProxy && !IsRenderStateDirty())
+	{
+		ENQUEUE_UNIQUE_RENDER_COMMAND_THREEPARAMETER(
+			FVoxelProcMeshTransitionsUpdate,
+			FVoxelProceduralMeshSceneProxy*, ProcMeshSceneProxy, (FVoxelProceduralMeshSceneProxy*)SceneProxy,
+			uint8, TransitionsMask, TransitionsMask,
+			uint8, TransitionsLOD, TransitionsLOD,
+			{
+				ProcMeshSceneProxy->SetTransitions_RenderThread(TransitionsMask, TransitionsLOD);
+			});
+	}
 }
 
 FBoxSphereBounds UVoxelProceduralMeshComponent::CalcBounds(const FTransform& LocalToWorld) const
@@ -610,6 +776,11 @@ void UVoxelProceduralMeshComponent::FinishPhysicsAsyncCook(UBodySetup* FinishedB
 	}
 }
 
+bool UVoxelProceduralMeshComponent::IsCollisionCookPending() const
+{
+	return AsyncBodySetupQueue.Num() > 0;
+}
+
 UBodySetup* UVoxelProceduralMeshComponent::GetBodySetup()
 {
 	CreateProcMeshBodySetup();
@@ -0,0 +1,227 @@
+// Copyright 2018 Phyronnaz
+
+#include "CollisionTileCache.h"
+#include "VoxelPrivate.h"
+#include "VoxelData.h"
+#include "VoxelWorld.h"
+#include "VoxelPolygonizerForCollisions.h"
+#include "Async.h"
+#include "VoxelCrashReporter.h"
+
+DECLARE_CYCLE_STAT(TEXT("FCollisionTileCache::StartTasksTick"), STAT_FCollisionTileCache_StartTasksTick, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FCollisionTileCache::EndTasksTick"), STAT_FCollisionTileCache_EndTasksTick, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FCollisionTileCache::UpdateInBox"), STAT_FCollisionTileCache_UpdateInBox, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FCollisionTileCache::Update"), STAT_FCollisionTileCache_Update, STATGROUP_Voxel);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Collision Tiles"), STAT_VoxelCollisionTiles, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Unused Collision Tiles"), STAT_VoxelUnusedCollisionTiles, STATGROUP_Voxel);
+
+FAsyncCollisionTask::FAsyncCollisionTask(FVoxelData* Data, FIntVector ChunkPosition, bool bEnableRender)
+	: Data(Data)
+	, ChunkPosition(ChunkPosition)
+	, bEnableRender(bEnableRender)
+{
+
+}
+
+void FAsyncCollisionTask::DoWork()
+{
+	// Small: the caches are per thread
+	FVoxelPolygonizerForCollisions Poly(Data, ChunkPosition, bEnableRender);
+	bool bSuccess = Poly.CreateSection(Section);
+	if (!bSuccess)
+	{
+		AsyncTask(ENamedThreads::GameThread, []() { FVoxelCrashReporter::ShowApproximationError(); });
+		Section.Reset();
+	}
+}
+
+inline void ClearCollisions(UVoxelProceduralMeshComponent* Component)
+{
+	if (Component->GetProcMeshSection(0) && Component->GetProcMeshSection(0)->ProcIndexBuffer.Num() > 0)
+	{
+		Component->SetProcMeshSection(0, FVoxelProcMeshSection());
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+
+
+FCollisionTileCache::FCollisionTileCache(AVoxelWorld* World, AActor* ChunksOwner, FQueuedThreadPool* Pool, int MaxUnusedTiles)
+	: World(World)
+	, ChunksOwner(ChunksOwner)
+	, Pool(Pool)
+	, MaxUnusedTiles(MaxUnusedTiles)
+{
+}
+
+FCollisionTileCache::~FCollisionTileCache()
+{
+	for (auto& It : Tiles)
+	{
+		auto& Task = It.Value.Task;
+		if (Task)
+		{
+			if (!Task->Cancel())
+			{
+				Task->EnsureCompletion();
+			}
+			delete Task;
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_VoxelCollisionTiles, Tiles.Num());
+	DEC_DWORD_STAT_BY(STAT_VoxelUnusedCollisionTiles, UnusedTiles.Num());
+}
+
+void FCollisionTileCache::AddReference(const FIntVector& Tile)
+{
+	FCollisionTile* TileData = Tiles.Find(Tile);
+	if (!TileData)
+	{
+		TileData = &Tiles.Add(Tile);
+		TileData->Front = CreateComponent(Tile);
+		TileData->Back = CreateComponent(Tile);
+		TileData->bBackCooking = false;
+		TileData->bNeedsUpdate = true;
+		TileData->Task = nullptr;
+		TileData->References = 0;
+		INC_DWORD_STAT(STAT_VoxelCollisionTiles);
+	}
+	else if (TileData->References == 0)
+	{
+		UnusedTiles.RemoveSingle(Tile);
+		DEC_DWORD_STAT(STAT_VoxelUnusedCollisionTiles);
+	}
+	TileData->References++;
+}
+
+void FCollisionTileCache::RemoveReference(const FIntVector& Tile)
+{
+	FCollisionTile& TileData = Tiles.FindChecked(Tile);
+	check(TileData.References > 0);
+	TileData.References--;
+	if (TileData.References == 0)
+	{
+		UnusedTiles.Add(Tile);
+		INC_DWORD_STAT(STAT_VoxelUnusedCollisionTiles);
+		DestroyUnusedTiles();
+	}
+}
+
+void FCollisionTileCache::StartTasksTick()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FCollisionTileCache_StartTasksTick);
+
+	for (auto& It : Tiles)
+	{
+		FCollisionTile& TileData = It.Value;
+		// Unused tiles are updated when they are referenced again
+		if (TileData.bNeedsUpdate && !TileData.Task && TileData.References > 0)
+		{
+			Update(It.Key, TileData);
+		}
+	}
+}
+
+void FCollisionTileCache::EndTasksTick()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FCollisionTileCache_EndTasksTick);
+
+	for (auto& It : Tiles)
+	{
+		FCollisionTile& TileData = It.Value;
+		if (TileData.Task && TileData.Task->IsDone())
+		{
+			TileData.Back->SetProcMeshSection(0, TileData.Task->GetTask().Section);
+			TileData.bBackCooking = true;
+			delete TileData.Task;
+			TileData.Task = nullptr;
+		}
+		if (TileData.bBackCooking && !TileData.Back->IsCollisionCookPending())
+		{
+			Swap(TileData.Front, TileData.Back);
+			TileData.bBackCooking = false;
+			ClearCollisions(TileData.Back);
+		}
+	}
+
+	// Tiles with a running task can't be destroyed without waiting for it
+	DestroyUnusedTiles();
+}
+
+void FCollisionTileCache::UpdateInBox(const FIntBox& Box)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FCollisionTileCache_UpdateInBox);
+
+	for (auto& It : Tiles)
+	{
+		if (GetTileBounds(It.Key).Intersect(Box))
+		{
+			It.Value.bNeedsUpdate = true;
+		}
+	}
+}
+
+FIntVector FCollisionTileCache::GetTilePosition(const FIntVector& Tile) const
+{
+	return Tile * CHUNKSIZE_FC;
+}
+
+FIntBox FCollisionTileCache::GetTileBounds(const FIntVector& Tile) const
+{
+	const FIntVector Position = GetTilePosition(Tile);
+	return FIntBox(Position, Position + FIntVector(CHUNKSIZE_FC + 1, CHUNKSIZE_FC + 1, CHUNKSIZE_FC + 1));
+}
+
+UVoxelProceduralMeshComponent* FCollisionTileCache::CreateComponent(const FIntVector& Tile)
+{
+	UVoxelProceduralMeshComponent* Component = NewObject<UVoxelProceduralMeshComponent>(ChunksOwner, NAME_None, RF_Transient);
+	Component->bUseAsyncCooking = true;
+	Component->SetupAttachment(World->GetRootComponent(), NAME_None);
+	Component->RegisterComponent();
+	Component->SetWorldScale3D(FVector::OneVector * World->GetVoxelSize());
+	Component->SetWorldLocation(World->LocalToGlobal(GetTilePosition(Tile)));
+	return Component;
+}
+
+void FCollisionTileCache::Update(const FIntVector& Tile, FCollisionTile& TileData)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FCollisionTileCache_Update);
+
+	check(!TileData.Task);
+	TileData.bNeedsUpdate = false;
+
+	if (World->GetBounds().Intersect(GetTileBounds(Tile)))
+	{
+		TileData.Task = new FAsyncTask<FAsyncCollisionTask>(World->GetData(), GetTilePosition(Tile), World->GetDebugCollisions());
+		TileData.Task->StartBackgroundTask(Pool);
+	}
+	else
+	{
+		ClearCollisions(TileData.Front);
+		ClearCollisions(TileData.Back);
+		TileData.bBackCooking = false;
+	}
+}
+
+void FCollisionTileCache::DestroyUnusedTiles()
+{
+	for (int Index = 0; Index < UnusedTiles.Num() && UnusedTiles.Num() > MaxUnusedTiles;)
+	{
+		const FIntVector Tile = UnusedTiles[Index];
+		FCollisionTile& TileData = Tiles.FindChecked(Tile);
+		if (TileData.Task)
+		{
+			Index++;
+			continue;
+		}
+
+		TileData.Front->DestroyComponent();
+		TileData.Back->DestroyComponent();
+		Tiles.Remove(Tile);
+		UnusedTiles.RemoveAt(Index);
+		DEC_DWORD_STAT(STAT_VoxelCollisionTiles);
+		DEC_DWORD_STAT(STAT_VoxelUnusedCollisionTiles);
+	}
+}
@@ -0,0 +1,94 @@
+// Copyright 2018 Phyronnaz
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelProceduralMeshComponent.h"
+#include "IntBox.h"
+
+class AVoxelWorld;
+class FVoxelData;
+class FQueuedThreadPool;
+
+class FAsyncCollisionTask : public FNonAbandonableTask
+{
+public:
+	// Output
+	FVoxelProcMeshSection Section;
+
+	const bool bEnableRender;
+	const FIntVector ChunkPosition;
+	FVoxelData* const Data;
+
+	FAsyncCollisionTask(FVoxelData* Data, FIntVector ChunkPosition, bool bEnableRender);
+
+	void DoWork();
+
+	FORCEINLINE TStatId GetStatId() const
+	{
+		RETURN_QUICK_DECLARE_CYCLE_STAT(FAsyncFoliageTask, STATGROUP_ThreadPoolAsyncTasks);
+	};
+};
+
+/**
+ * Collision tiles shared by all the invokers, on a grid of CHUNKSIZE_FC voxels
+ * A tile is meshed and cooked once, whatever the number of invokers referencing it
+ * Unreferenced tiles are kept to be reused, and destroyed least recently used first
+ * Never blocks the game thread: the previous collisions of a tile are used until the new ones are cooked
+ */
+class FCollisionTileCache
+{
+public:
+	AVoxelWorld* const World;
+	AActor* const ChunksOwner;
+	FQueuedThreadPool* const Pool;
+
+	/**
+	 * @param	MaxUnusedTiles	Unreferenced tiles kept to be reused
+	 */
+	FCollisionTileCache(AVoxelWorld* World, AActor* ChunksOwner, FQueuedThreadPool* Pool, int MaxUnusedTiles);
+	~FCollisionTileCache();
+
+	/**
+	 * @param	Tile	Position of the tile, in tiles
+	 */
+	void AddReference(const FIntVector& Tile);
+	void RemoveReference(const FIntVector& Tile);
+
+	/**
+	 * Start the tasks of the referenced tiles to update that don't have one running
+	 */
+	void StartTasksTick();
+	/**
+	 * Apply the finished tasks, and swap the components once their new collisions are cooked
+	 */
+	void EndTasksTick();
+
+	void UpdateInBox(const FIntBox& Box);
+
+private:
+	struct FCollisionTile
+	{
+		// Component with the collisions in use
+		UVoxelProceduralMeshComponent* Front;
+		// Component cooking the new collisions. Swapped with Front once done
+		UVoxelProceduralMeshComponent* Back;
+		bool bBackCooking;
+		bool bNeedsUpdate;
+		FAsyncTask<FAsyncCollisionTask>* Task;
+		int References;
+	};
+
+	const int MaxUnusedTiles;
+
+	TMap<FIntVector, FCollisionTile> Tiles;
+	// Least recently used first
+	TArray<FIntVector> UnusedTiles;
+
+	FORCEINLINE FIntVector GetTilePosition(const FIntVector& Tile) const;
+	FORCEINLINE FIntBox GetTileBounds(const FIntVector& Tile) const;
+
+	UVoxelProceduralMeshComponent* CreateComponent(const FIntVector& Tile);
+	void Update(const FIntVector& Tile, FCollisionTile& TileData);
+	void DestroyUnusedTiles();
+};
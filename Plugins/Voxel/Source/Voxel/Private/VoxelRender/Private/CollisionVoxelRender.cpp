@@ -4,47 +4,49 @@
 #include "VoxelPrivate.h"
 #include "QueuedThreadPool.h"
 #include "CollisionMeshHandler.h"
+#include "CollisionTileCache.h"
 #include "VoxelInvokerComponent.h"
 #include "VoxelWorld.h"
 
 DECLARE_CYCLE_STAT(TEXT("FCollisionVoxelRender::Tick"), STAT_FCollisionVoxelRender_Tick, STATGROUP_Voxel);
 
+// Collision tiles kept once no invoker uses them, eg for players going back and forth
+#define MAX_UNUSED_COLLISION_TILES 64
+
 FCollisionVoxelRender::FCollisionVoxelRender(AVoxelWorld* World, AActor* ChunksOwner)
 	: IVoxelRender(World, ChunksOwner)
 	, CollisionMeshHandlerThreadPool(FQueuedThreadPool::Allocate())
 	, TimeSinceUpdate(0)
-	, bNeedToEndCollisionsTasks(false)
 {
 	CollisionMeshHandlerThreadPool->Create(World->GetCollisionsThreadCount(), 1024 * 1024);
+	TileCache = MakeShared<FCollisionTileCache>(World, ChunksOwner, CollisionMeshHandlerThreadPool, MAX_UNUSED_COLLISION_TILES);
 }
 
 FCollisionVoxelRender::~FCollisionVoxelRender()
 {
 	CollisionComponents.Reset(0);
+	// Before the pool: waits for the running tasks
+	TileCache.Reset();
 	CollisionMeshHandlerThreadPool->Destroy();
 	delete CollisionMeshHandlerThreadPool;
 }
 
 void FCollisionVoxelRender::Tick(float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_FCollisionVoxelRender_Tick);
+
+	// Doesn't wait for the tasks: apply the finished ones every frame
+	TileCache->EndTasksTick();
+
 	TimeSinceUpdate += DeltaTime;
 	if (TimeSinceUpdate > 1 / World->GetCollisionsUpdateRate())
 	{
-		SCOPE_CYCLE_COUNTER(STAT_FCollisionVoxelRender_Tick);
-
 		TimeSinceUpdate = 0;
 		for (auto& Handler : CollisionComponents)
 		{
 			if (Handler->IsValid())
 			{
-				if (!bNeedToEndCollisionsTasks)
-				{
-					Handler->StartTasksTick();
-				}
-				else
-				{
-					Handler->EndTasksTick();
-				}
+				Handler->Tick();
 			}
 			else
 			{
@@ -52,10 +54,11 @@ void FCollisionVoxelRender::Tick(float DeltaTime)
 				Handler.Reset();
 			}
 		}
-		bNeedToEndCollisionsTasks = !bNeedToEndCollisionsTasks;
 
 		Invokers.RemoveAll([](TWeakObjectPtr<UVoxelInvokerComponent> Invoker) { return !Invoker.IsValid(); });
 		CollisionComponents.RemoveAll([](TSharedPtr<FCollisionMeshHandler> P) { return !P.IsValid(); });
+
+		TileCache->StartTasksTick();
 	}
 }
 
@@ -69,15 +72,12 @@ void FCollisionVoxelRender::AddInvoker(TWeakObjectPtr<UVoxelInvokerComponent> In
 		}
 		if (Invoker->UseForCollisions())
 		{
-			CollisionComponents.Add(MakeShared<FCollisionMeshHandler>(Invoker, World, ChunksOwner, CollisionMeshHandlerThreadPool));
+			CollisionComponents.Add(MakeShared<FCollisionMeshHandler>(Invoker, World, TileCache.Get()));
 		}
 	}
 }
 
 void FCollisionVoxelRender::UpdateBoxInternal(const FIntBox& Box)
 {
-	for (auto Handler : CollisionComponents)
-	{
-		Handler->UpdateInBox(Box);
-	}
+	TileCache->UpdateInBox(Box);
 }
@@ -7,6 +7,7 @@
 
 class FQueuedThreadPool;
 class FCollisionMeshHandler;
+class FCollisionTileCache;
 
 class FCollisionVoxelRender : public IVoxelRender
 {
@@ -22,8 +23,9 @@ public:
 private:
 	TArray<TWeakObjectPtr<UVoxelInvokerComponent>> Invokers;
 	FQueuedThreadPool* const CollisionMeshHandlerThreadPool;
+	// Shared by the handlers
+	TSharedPtr<FCollisionTileCache> TileCache;
 	TArray<TSharedPtr<FCollisionMeshHandler>> CollisionComponents;
 
 	float TimeSinceUpdate;
-	bool bNeedToEndCollisionsTasks;
 };
\ No newline at end of file
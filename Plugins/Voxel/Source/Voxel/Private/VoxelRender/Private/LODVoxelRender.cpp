@@ -22,6 +22,10 @@ DECLARE_CYCLE_STAT(TEXT("FLODVoxelRender::UpdateLOD.ChunksToCreate"), STAT_LODVo
 DECLARE_CYCLE_STAT(TEXT("FLODVoxelRender::UpdateLOD.ChunksToCreate.FindOldChunks"), STAT_LODVoxelRender_UpdateLOD_ChunksToCreate_FindOldChunks, STATGROUP_Voxel);
 DECLARE_CYCLE_STAT(TEXT("FLODVoxelRender::UpdateLOD.ChunksToCreate.UpdateChunks"), STAT_LODVoxelRender_UpdateLOD_ChunksToCreate_UpdateChunks, STATGROUP_Voxel);
 DECLARE_CYCLE_STAT(TEXT("FLODVoxelRender::UpdateLOD.UpdateTransitions"), STAT_LODVoxelRender_UpdateLOD_UpdateTransitions, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FLODVoxelRender::CommitQueuedChunks"), STAT_LODVoxelRender_CommitQueuedChunks, STATGROUP_Voxel);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Queued Mesh Commits"), STAT_VoxelQueuedMeshCommits, STATGROUP_Voxel);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Voxel Oldest Queued Mesh Commit Age (ms)"), STAT_VoxelOldestQueuedMeshCommitAge, STATGROUP_Voxel);
 
 FAsyncOctreeBuilderTask::FAsyncOctreeBuilderTask(const TArray<FIntBox>& CameraBounds, uint8 LOD, TSharedPtr<FVoxelChunkOctree> Octree)
 	: CameraBounds(CameraBounds)
@@ -33,22 +37,36 @@ FAsyncOctreeBuilderTask::FAsyncOctreeBuilderTask(const TArray<FIntBox>& CameraBo
 
 void FAsyncOctreeBuilderTask::DoWork()
 {
-	NewOctree = MakeShared<FVoxelChunkOctree>(CameraBounds, LOD);
-	OldOctree = Octree;
-
-	TSet<FIntBox> OldBounds;
-	TSet<FIntBox> NewBounds;
-
-	if (OldOctree.IsValid())
+	if (Octree.IsValid() && Octree->LOD == LOD)
 	{
-		OldOctree->GetLeavesBounds(OldBounds);
+		FVoxelChunkOctreeDiff Diff;
+		Octree->Update(CameraBounds, Diff);
+
+		ChunksToDelete = MoveTemp(Diff.ChunksToDelete);
+		ChunksToCreate = MoveTemp(Diff.ChunksToCreate);
+		TransitionsMasks = MoveTemp(Diff.TransitionsMasks);
 	}
-	NewOctree->GetLeavesBounds(NewBounds);
+	else
+	{
+		// First build, or the world LOD changed
+		TSet<FIntBox> OldBounds;
+		TSet<FIntBox> NewBounds;
 
-	ChunksToDelete = OldBounds.Difference(NewBounds);
-	ChunksToCreate = NewBounds.Difference(OldBounds);
+		if (Octree.IsValid())
+		{
+			Octree->GetLeavesBounds(OldBounds);
+		}
 
-	NewOctree->GetLeavesTransitionsMasks(TransitionsMasks);
+		Octree = MakeShared<FVoxelChunkOctree>(LOD);
+		FVoxelChunkOctreeDiff Diff;
+		Octree->Update(CameraBounds, Diff);
+		Octree->GetLeavesBounds(NewBounds);
+
+		ChunksToDelete = OldBounds.Difference(NewBounds);
+		ChunksToCreate = NewBounds.Difference(OldBounds);
+
+		Octree->GetLeavesTransitionsMasks(TransitionsMasks);
+	}
 }
 
 bool FAsyncOctreeBuilderTask::CanAbandon()
@@ -72,14 +90,14 @@ FVoxelRenderChunk::FVoxelRenderChunk(FLODVoxelRender* Render, const FIntVector&
 	, TransitionsMask(0)
 	, TransitionsDisplayedMask(0)
 	, TransitionsCurrentMask(0xFF)
+	, bTransitionsCommitQueued(false)
 {
-	IntermediateChunks.SetNum(SECTIONS_PER_CHUNK);
 	InitialUpdatingFinished.SetNum(SECTIONS_PER_CHUNK);
 	Tasks.SetNum(SECTIONS_PER_CHUNK);
+	SectionCommitQueued.SetNum(SECTIONS_PER_CHUNK);
 	SectionNeedsUpdate.SetNum(SECTIONS_PER_CHUNK);
 	OldGrassPositionsArrayPerSection.SetNum(SECTIONS_PER_CHUNK);
 	SectionsBounds.SetNumUninitialized(SECTIONS_PER_CHUNK);
-	ChunksCurrentMask.SetNumUninitialized(SECTIONS_PER_CHUNK);
 
 	for (int I = 0; I < CHUNK_MULTIPLIER; I++)
 	{
@@ -91,8 +109,6 @@ FVoxelRenderChunk::FVoxelRenderChunk(FLODVoxelRender* Render, const FIntVector&
 				FIntVector Max = Min + FIntVector(SectionSize() + 1, SectionSize() + 1, SectionSize() + 1);
 
 				SectionsBounds[I + CHUNK_MULTIPLIER * J + CHUNK_MULTIPLIER * CHUNK_MULTIPLIER * K] = FIntBox(Min, Max);
-
-				ChunksCurrentMask[I + CHUNK_MULTIPLIER * J + CHUNK_MULTIPLIER * CHUNK_MULTIPLIER * K] = 0xFF;
 			}
 		}
 	}
@@ -163,7 +179,7 @@ void FVoxelRenderChunk::UpdateTransitions()
 {
 	if (!TransitionsTask.IsValid())
 	{
-		TransitionsTask = MakeShared<FAsyncPolygonizerForTransitionsWork>(LOD, Render->World->GetData(), Position, TransitionsMask);
+		TransitionsTask = MakeShared<FAsyncPolygonizerForTransitionsWork>(LOD, Render->World->GetData(), Position, TransitionsMask, &Render->PriorityHandler);
 		Render->MeshThreadPool->AddQueuedWork(TransitionsTask.Get());
 		TransitionsCurrentMask = TransitionsMask;
 	}
@@ -176,106 +192,10 @@ void FVoxelRenderChunk::Tick()
 		auto& Task = Tasks[Index];
 		if (Task.IsValid())
 		{
-			if (Task->IsDone())
+			if (Task->IsDone() && !SectionCommitQueued[Index])
 			{
-				IntermediateChunks[Index] = Task->Chunk;
-				const FIntVector& ChunkPosition = Task->ChunkPosition;
-
-				// Mesh
-				{
-					if (!Mesh && IntermediateChunks[Index].VertexBuffer.Num() != 0)
-					{
-						Mesh = Render->GetNewMesh(Position, ComputeCollisions(), PreviousChunks.Num() > 0, LOD);
-					}
-
-					if (Mesh)
-					{
-						FVoxelProcMeshSection Section;
-						IntermediateChunks[Index].InitSectionBuffers(Section.ProcVertexBuffer, Section.ProcIndexBuffer, TransitionsDisplayedMask);
-						ChunksCurrentMask[Index] = TransitionsDisplayedMask;
-						Section.SectionLocalBox = FBox(-FVector::OneVector, (TotalSize() + 2) * FVector::OneVector);
-						Section.bEnableCollision = ComputeCollisions();
-
-						Mesh->SetProcMeshSection(Index, Section);
-					}
-				}
-				
-				// Grass
-				{
-					OldGrassPositionsArrayPerSection[Index] = Task->NewGrassPositionsArray;
-					int BufferIndex = 0;
-					for (auto& Buffer : Task->GrassBuffers)
-					{
-						BufferIndex++;
-
-						while (GrassMeshes.Num() <= BufferIndex)
-						{
-							GrassMeshes.AddZeroed();
-						}
-
-						while (GrassMeshes[BufferIndex].Num() <= Index)
-						{
-							GrassMeshes[BufferIndex].AddZeroed();
-						}
-
-						auto& NewGrass = GrassMeshes[BufferIndex][Index];
-						
-#if ENGINE_MINOR_VERSION < 19
-						if (Buffer->InstanceBuffer.NumInstances())
-#else
-						if (Buffer->InstanceBuffer.GetNumInstances())
-#endif
-						{
-							if (!NewGrass)
-							{
-								NewGrass = Render->GetNewGrass(Position);
-								FVoxelGrassUtilities::InitGrass(NewGrass, Buffer);
-							}
-
-							FVoxelGrassUtilities::SetNewPositions(NewGrass, Buffer);
-						}
-						else if (NewGrass)
-						{
-							// If all the grass has been removed
-							NewGrass->ClearInstances();
-						}
-					}
-				}
-
-				// Actors
-				if (Task->bComputeVoxelActors)
-				{
-					Render->World->NotifyActorsAreCreated(ChunkPosition);
-					for (auto& ActorInfo : Task->ActorsSpawnInfo)
-					{
-						//DrawDebugLine(Render->World->GetWorld(), ActorInfo.Position, ActorInfo.Position + FVector::UpVector * ActorInfo.Height, FColor::Red, true, 100.f, 0, 10);
-						AVoxelActor* Actor = Render->World->GetWorld()->SpawnActor<AVoxelActor>(ActorInfo.ClassToSpawn);
-						Actor->SetActorLocation(ActorInfo.Position);
-						Actor->SetActorRotation(FQuat(ActorInfo.Rotation));
-						Actor->SetActorScale3D(ActorInfo.Scale);
-						Render->World->AddActor(Actor);
-					}
-				}
-
-				Task.Reset();
-
-				if (PreviousChunks.Num() > 0 && !InitialUpdatingFinished[Index])
-				{
-					InitialUpdatingFinished[Index] = true;
-					bool bAllFinished = true;
-					for (auto& Value : InitialUpdatingFinished)
-					{
-						bAllFinished = bAllFinished && Value;
-					}
-					if (bAllFinished)
-					{
-						for (auto& PreviousChunk : PreviousChunks)
-						{
-							PreviousChunk->RemoveRef();
-						}
-						PreviousChunks.Reset();
-					}
-				}
+				SectionCommitQueued[Index] = true;
+				Render->QueueCommit(AsShared(), Index);
 			}
 		}
 		else
@@ -287,50 +207,32 @@ void FVoxelRenderChunk::Tick()
 		}
 	}
 
-	if (TransitionsTask.IsValid() && TransitionsTask->IsDone())
+	if (TransitionsTask.IsValid() && TransitionsTask->IsDone() && !bTransitionsCommitQueued)
 	{
-		if (!Mesh && TransitionsTask->VertexBuffer.Num() != 0)
-		{
-			Mesh = Render->GetNewMesh(Position, ComputeCollisions(), PreviousChunks.Num() > 0, LOD);
-		}
-
-		if (Mesh)
-		{
-			FVoxelProcMeshSection Section;
-			Section.SectionLocalBox = FBox(-FVector::OneVector, (TotalSize() + 2) * FVector::OneVector);
-			Section.ProcIndexBuffer = TransitionsTask->IndexBuffer;
-			Section.ProcVertexBuffer = TransitionsTask->VertexBuffer;
-			Mesh->SetProcMeshSection(SECTIONS_PER_CHUNK, Section);
-			TransitionsDisplayedMask = TransitionsCurrentMask;
-		}
-
-		TransitionsTask.Reset();
+		bTransitionsCommitQueued = true;
+		Render->QueueCommit(AsShared(), SECTIONS_PER_CHUNK);
 	}
 
 	if (TransitionsCurrentMask != TransitionsMask)
 	{
+		// If the task is done, a new one is started once it's committed
 		if (TransitionsTask.IsValid() && Render->MeshThreadPool->RetractQueuedWork(TransitionsTask.Get()))
 		{
 			TransitionsTask.Reset();
 		}
 		UpdateTransitions();
 	}
+}
 
-	if (Mesh)
+void FVoxelRenderChunk::Commit(int SectionIndex)
+{
+	if (SectionIndex == SECTIONS_PER_CHUNK)
 	{
-		for (int Index = 0; Index < SECTIONS_PER_CHUNK; Index++)
-		{
-			if (ChunksCurrentMask[Index] != TransitionsDisplayedMask)
-			{
-				FVoxelProcMeshSection Section;
-				IntermediateChunks[Index].InitSectionBuffers(Section.ProcVertexBuffer, Section.ProcIndexBuffer, TransitionsDisplayedMask);
-				ChunksCurrentMask[Index] = TransitionsDisplayedMask;
-				Section.SectionLocalBox = FBox(-FVector::OneVector, (TotalSize() + 2) * FVector::OneVector);
-				Section.bEnableCollision = ComputeCollisions();
-
-				Mesh->SetProcMeshSection(Index, Section);
-			}
-		}
+		CommitTransitions();
+	}
+	else
+	{
+		CommitSection(SectionIndex);
 	}
 }
 
@@ -378,7 +280,8 @@ void FVoxelRenderChunk::UpdateSection(int SectionIndex)
 		Render->World
 		,LOD == 0,
 		OldGrassPositionsArrayPerSection[SectionIndex],
-		LOD == 0 && !Render->World->HasActorsBeenCreated(ChunkPosition)
+		LOD == 0 && !Render->World->HasActorsBeenCreated(ChunkPosition),
+		&Render->PriorityHandler
 	);
 
 	Render->MeshThreadPool->AddQueuedWork(&NewTask.Get());
@@ -388,6 +291,138 @@ void FVoxelRenderChunk::UpdateSection(int SectionIndex)
 	UpdateTransitions();
 }
 
+void FVoxelRenderChunk::CommitSection(int Index)
+{
+	auto& Task = Tasks[Index];
+	check(Task.IsValid() && Task->IsDone() && SectionCommitQueued[Index]);
+	SectionCommitQueued[Index] = false;
+
+	const FIntVector& ChunkPosition = Task->ChunkPosition;
+
+	// Mesh
+	{
+		if (!Mesh && Task->Chunk.VertexBuffer.Num() != 0)
+		{
+			Mesh = Render->GetNewMesh(Position, ComputeCollisions(), PreviousChunks.Num() > 0, LOD);
+			Mesh->SetTransitions(TransitionsDisplayedMask, LOD);
+		}
+
+		if (Mesh)
+		{
+			FVoxelProcMeshSection Section;
+			Task->Chunk.InitSectionBuffers(Section.ProcVertexBuffer, Section.ProcIndexBuffer);
+			Section.SectionLocalBox = FBox(-FVector::OneVector, (TotalSize() + 2) * FVector::OneVector);
+			Section.bEnableCollision = ComputeCollisions();
+			Section.bEnableTransitions = true;
+
+			Mesh->SetProcMeshSection(Index, Section);
+		}
+	}
+
+	// Grass
+	{
+		OldGrassPositionsArrayPerSection[Index] = Task->NewGrassPositionsArray;
+		int BufferIndex = 0;
+		for (auto& Buffer : Task->GrassBuffers)
+		{
+			BufferIndex++;
+
+			while (GrassMeshes.Num() <= BufferIndex)
+			{
+				GrassMeshes.AddZeroed();
+			}
+
+			while (GrassMeshes[BufferIndex].Num() <= Index)
+			{
+				GrassMeshes[BufferIndex].AddZeroed();
+			}
+
+			auto& NewGrass = GrassMeshes[BufferIndex][Index];
+
+#if ENGINE_MINOR_VERSION < 19
+			if (Buffer->InstanceBuffer.NumInstances())
+#else
+			if (Buffer->InstanceBuffer.GetNumInstances())
+#endif
+			{
+				if (!NewGrass)
+				{
+					NewGrass = Render->GetNewGrass(Position);
+					FVoxelGrassUtilities::InitGrass(NewGrass, Buffer);
+				}
+
+				FVoxelGrassUtilities::SetNewPositions(NewGrass, Buffer);
+			}
+			else if (NewGrass)
+			{
+				// If all the grass has been removed
+				NewGrass->ClearInstances();
+			}
+		}
+	}
+
+	// Actors
+	if (Task->bComputeVoxelActors)
+	{
+		Render->World->NotifyActorsAreCreated(ChunkPosition);
+		for (auto& ActorInfo : Task->ActorsSpawnInfo)
+		{
+			//DrawDebugLine(Render->World->GetWorld(), ActorInfo.Position, ActorInfo.Position + FVector::UpVector * ActorInfo.Height, FColor::Red, true, 100.f, 0, 10);
+			AVoxelActor* Actor = Render->World->GetWorld()->SpawnActor<AVoxelActor>(ActorInfo.ClassToSpawn);
+			Actor->SetActorLocation(ActorInfo.Position);
+			Actor->SetActorRotation(FQuat(ActorInfo.Rotation));
+			Actor->SetActorScale3D(ActorInfo.Scale);
+			Render->World->AddActor(Actor);
+		}
+	}
+
+	Task.Reset();
+
+	if (PreviousChunks.Num() > 0 && !InitialUpdatingFinished[Index])
+	{
+		InitialUpdatingFinished[Index] = true;
+		bool bAllFinished = true;
+		for (auto& Value : InitialUpdatingFinished)
+		{
+			bAllFinished = bAllFinished && Value;
+		}
+		if (bAllFinished)
+		{
+			for (auto& PreviousChunk : PreviousChunks)
+			{
+				PreviousChunk->RemoveRef();
+			}
+			PreviousChunks.Reset();
+		}
+	}
+}
+
+void FVoxelRenderChunk::CommitTransitions()
+{
+	check(TransitionsTask.IsValid() && TransitionsTask->IsDone() && bTransitionsCommitQueued);
+	bTransitionsCommitQueued = false;
+
+	if (!Mesh && TransitionsTask->VertexBuffer.Num() != 0)
+	{
+		Mesh = Render->GetNewMesh(Position, ComputeCollisions(), PreviousChunks.Num() > 0, LOD);
+	}
+
+	if (Mesh)
+	{
+		FVoxelProcMeshSection Section;
+		Section.SectionLocalBox = FBox(-FVector::OneVector, (TotalSize() + 2) * FVector::OneVector);
+		Section.ProcIndexBuffer = TransitionsTask->IndexBuffer;
+		Section.ProcVertexBuffer = TransitionsTask->VertexBuffer;
+		Mesh->SetProcMeshSection(SECTIONS_PER_CHUNK, Section);
+		TransitionsDisplayedMask = TransitionsCurrentMask;
+
+		// Move the sections vertices to match the new transitions. Done in the vertex shader
+		Mesh->SetTransitions(TransitionsDisplayedMask, LOD);
+	}
+
+	TransitionsTask.Reset();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 FVoxelChunkToDelete::FVoxelChunkToDelete(const FVoxelRenderChunk& OldChunk)
@@ -465,6 +500,8 @@ void FLODVoxelRender::Tick(float DeltaTime)
 	
 	FCollisionVoxelRender::Tick(DeltaTime);
 
+	UpdatePriorities();
+
 	{
 		for (auto& Chunk : MeshToRemove)
 		{
@@ -504,6 +541,8 @@ void FLODVoxelRender::Tick(float DeltaTime)
 		Chunk->Tick();
 	}
 
+	CommitQueuedChunks();
+
 	if (OctreeBuilder.IsValid() && OctreeBuilder->IsDone())
 	{
 		UpdateLOD();
@@ -528,12 +567,87 @@ void FLODVoxelRender::Tick(float DeltaTime)
 					}
 				}
 			}
-			OctreeBuilder = MakeShared<FAsyncTask<FAsyncOctreeBuilderTask>>(CameraBounds, World->GetLOD() - CHUNK_MULTIPLIER_EXPONENT, Octree);
+			OctreeBuilder = MakeShared<FAsyncTask<FAsyncOctreeBuilderTask>>(CameraBounds, GetOctreeLOD(), Octree);
 			OctreeBuilder->StartBackgroundTask(OctreeBuilderThreadPool);
 		}
 	}
 }
 
+void FLODVoxelRender::CommitQueuedChunks()
+{
+	SCOPE_CYCLE_COUNTER(STAT_LODVoxelRender_CommitQueuedChunks);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double Budget = World->GetMeshUpdateBudget() / 1000;
+
+	// Commits of deleted chunks are dropped
+	QueuedCommits.RemoveAll([](const FVoxelChunkCommit& Commit) { return !Commit.Chunk.IsValid(); });
+
+	// Same order as the mesh tasks, and oldest first
+	for (auto& Commit : QueuedCommits)
+	{
+		Commit.Priority = PriorityHandler.GetPriority(Commit.Chunk.Pin()->Bounds);
+	}
+	QueuedCommits.Sort([](const FVoxelChunkCommit& A, const FVoxelChunkCommit& B)
+	{
+		return A.Priority != B.Priority ? A.Priority > B.Priority : A.QueueTime < B.QueueTime;
+	});
+
+	int NumCommitted = 0;
+	// Always commit at least one, so that a single slow commit can't stall the queue
+	while (NumCommitted < QueuedCommits.Num() && (NumCommitted == 0 || Budget <= 0 || FPlatformTime::Seconds() - StartTime < Budget))
+	{
+		const FVoxelChunkCommit& Commit = QueuedCommits[NumCommitted];
+		Commit.Chunk.Pin()->Commit(Commit.SectionIndex);
+		NumCommitted++;
+	}
+	QueuedCommits.RemoveAt(0, NumCommitted, false);
+
+	double OldestQueueTime = StartTime;
+	for (auto& Commit : QueuedCommits)
+	{
+		OldestQueueTime = FMath::Min(OldestQueueTime, Commit.QueueTime);
+	}
+	SET_DWORD_STAT(STAT_VoxelQueuedMeshCommits, QueuedCommits.Num());
+	SET_FLOAT_STAT(STAT_VoxelOldestQueuedMeshCommitAge, (StartTime - OldestQueueTime) * 1000);
+}
+
+void FLODVoxelRender::UpdatePriorities()
+{
+	TArray<FVoxelTaskPriorityHandler::FInvoker> PriorityInvokers;
+	for (const auto& Invoker : Invokers)
+	{
+		if (Invoker.IsValid() && Invoker->UseForRender())
+		{
+			AActor* Owner = Invoker->GetOwner();
+
+			FVoxelTaskPriorityHandler::FInvoker PriorityInvoker;
+			PriorityInvoker.Position = World->GlobalToLocalFloat(Invoker->GetPosition());
+
+			// Favor where we are going, else where we are looking
+			const FVector Velocity = Owner->GetVelocity();
+			if (Velocity.SizeSquared() > FMath::Square(World->GetVoxelSize()))
+			{
+				PriorityInvoker.Direction = Velocity.GetSafeNormal();
+			}
+			else
+			{
+				FVector EyesLocation;
+				FRotator EyesRotation;
+				Owner->GetActorEyesViewPoint(EyesLocation, EyesRotation);
+				PriorityInvoker.Direction = EyesRotation.Vector();
+			}
+
+			PriorityInvokers.Add(PriorityInvoker);
+		}
+	}
+
+	if (PriorityHandler.SetInvokers(PriorityInvokers))
+	{
+		MeshThreadPool->RecomputePriorities();
+	}
+}
+
 void FLODVoxelRender::AddInvoker(TWeakObjectPtr<UVoxelInvokerComponent> Invoker)
 {
 	FCollisionVoxelRender::AddInvoker(Invoker);
@@ -545,14 +659,46 @@ void FLODVoxelRender::UpdateBoxInternal(const FIntBox& Box)
 {
 	FCollisionVoxelRender::UpdateBoxInternal(Box);
 
-	if (Octree.IsValid())
+	if (Chunks.Num() > 0)
 	{
-		TArray<FVoxelChunkOctree*> Leaves;
-		Octree->GetLeavesOverlappingBox(Box, Leaves);
-		for (auto& Chunk : Leaves)
+		const FIntVector Min = FVoxelChunkOctree::GetAlignedBounds(Box.Min, RENDER_CHUNK_SIZE).Min;
+		const FIntVector Max = FVoxelChunkOctree::GetAlignedBounds(Box.Max - FIntVector(1, 1, 1), RENDER_CHUNK_SIZE).Max;
+		const double NumCells = (double)((Max.X - Min.X) / RENDER_CHUNK_SIZE) * ((Max.Y - Min.Y) / RENDER_CHUNK_SIZE) * ((Max.Z - Min.Z) / RENDER_CHUNK_SIZE);
+
+		if (NumCells > Chunks.Num())
+		{
+			for (auto& Chunk : ChunksArray)
+			{
+				if (Chunk->Bounds.Intersect(Box))
+				{
+					Chunk->UpdateChunk(Box);
+				}
+			}
+		}
+		else
 		{
-			check(Chunks.Contains(Chunk->GetBounds()));
-			Chunks[Chunk->GetBounds()]->UpdateChunk(Box);
+			// Chunks are aligned on their size: look up all the possible chunks at each LOD
+			for (int ChunkLOD = 0; ChunkLOD < GetOctreeLOD(); ChunkLOD++)
+			{
+				const int Size = RENDER_CHUNK_SIZE << ChunkLOD;
+				const FIntVector LODMin = FVoxelChunkOctree::GetAlignedBounds(Box.Min, Size).Min;
+				const FIntVector LODMax = FVoxelChunkOctree::GetAlignedBounds(Box.Max - FIntVector(1, 1, 1), Size).Max;
+				for (int X = LODMin.X; X < LODMax.X; X += Size)
+				{
+					for (int Y = LODMin.Y; Y < LODMax.Y; Y += Size)
+					{
+						for (int Z = LODMin.Z; Z < LODMax.Z; Z += Size)
+						{
+							const FIntVector P(X, Y, Z);
+							TSharedPtr<FVoxelRenderChunk>* Chunk = Chunks.Find(FIntBox(P, P + FIntVector(Size, Size, Size)));
+							if (Chunk)
+							{
+								(*Chunk)->UpdateChunk(Box);
+							}
+						}
+					}
+				}
+			}
 		}
 	}
 	else
@@ -563,7 +709,20 @@ void FLODVoxelRender::UpdateBoxInternal(const FIntBox& Box)
 
 uint8 FLODVoxelRender::GetLODAtPosition(const FIntVector& Position) const
 {
-	return Octree->GetLeaf(Position)->LOD;
+	for (int ChunkLOD = 0; ChunkLOD < GetOctreeLOD(); ChunkLOD++)
+	{
+		if (Chunks.Contains(FVoxelChunkOctree::GetAlignedBounds(Position, RENDER_CHUNK_SIZE << ChunkLOD)))
+		{
+			return ChunkLOD;
+		}
+	}
+	UE_LOG(LogVoxel, Error, TEXT("GetLODAtPosition: no chunk at %s"), *Position.ToString());
+	return 0;
+}
+
+uint8 FLODVoxelRender::GetOctreeLOD() const
+{
+	return World->GetLOD() - CHUNK_MULTIPLIER_EXPONENT;
 }
 
 void FLODVoxelRender::RemoveMesh(UVoxelProceduralMeshComponent* Mesh, bool bCollisions)
@@ -655,15 +814,23 @@ void FLODVoxelRender::AddTaskToDelete(const TSharedPtr<FVoxelAsyncWork>& NewTask
 	TasksToDelete.Add(NewTaskToDelete);
 }
 
+void FLODVoxelRender::QueueCommit(const TSharedRef<FVoxelRenderChunk>& Chunk, int SectionIndex)
+{
+	FVoxelChunkCommit Commit;
+	Commit.Chunk = Chunk;
+	Commit.SectionIndex = SectionIndex;
+	Commit.QueueTime = FPlatformTime::Seconds();
+	Commit.Priority = 0;
+	QueuedCommits.Add(Commit);
+}
+
 void FLODVoxelRender::UpdateLOD()
 {
 	SCOPE_CYCLE_COUNTER(STAT_LODVoxelRender_UpdateLOD);
 
 	check(OctreeBuilder.IsUnique() && OctreeBuilder->IsDone());
 
-	TSharedPtr<FVoxelChunkOctree>& OldOctree = OctreeBuilder->GetTask().OldOctree;
-	TSharedPtr<FVoxelChunkOctree>& NewOctree = OctreeBuilder->GetTask().NewOctree;
-	Octree = NewOctree;
+	Octree = OctreeBuilder->GetTask().Octree;
 
 	TSet<FIntBox>& ChunksToDelete = OctreeBuilder->GetTask().ChunksToDelete;
 	TSet<FIntBox>& ChunksToCreate = OctreeBuilder->GetTask().ChunksToCreate;
@@ -692,35 +859,55 @@ void FLODVoxelRender::UpdateLOD()
 	{
 		SCOPE_CYCLE_COUNTER(STAT_LODVoxelRender_UpdateLOD_ChunksToCreate);
 
+		TMap<FIntBox, TSharedRef<FVoxelRenderChunk>> NewChunks;
 		for (auto& NewChunkBounds : ChunksToCreate)
 		{
-			TSharedRef<FVoxelRenderChunk> NewChunk = MakeShared<FVoxelRenderChunk>(this, NewChunkBounds.Min, FMath::RoundToInt(FMath::Log2(NewChunkBounds.Size().X / RENDER_CHUNK_SIZE)), NewChunkBounds);
-
-			if (OldOctree.IsValid())
-			{
-				SCOPE_CYCLE_COUNTER(STAT_LODVoxelRender_UpdateLOD_ChunksToCreate_FindOldChunks);
+			NewChunks.Add(NewChunkBounds, MakeShared<FVoxelRenderChunk>(this, NewChunkBounds.Min, FMath::RoundToInt(FMath::Log2(NewChunkBounds.Size().X / RENDER_CHUNK_SIZE)), NewChunkBounds));
+		}
 
-				TArray<FVoxelChunkOctree*> OldChunks;
-				OldOctree->GetLeavesOverlappingBox(NewChunkBounds, OldChunks);
+		if (ChunksToDeleteMap.Num() > 0)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_LODVoxelRender_UpdateLOD_ChunksToCreate_FindOldChunks);
 
-				for (auto& OldChunk : OldChunks)
+			// Chunks are aligned on their size: an old chunk overlaps a new one iff one is an ancestor of the other
+			const int OctreeLOD = Octree->LOD;
+			for (auto& It : NewChunks)
+			{
+				// Split chunks
+				for (int ParentLOD = It.Value->LOD + 1; ParentLOD < OctreeLOD; ParentLOD++)
 				{
-					auto ChunkToDelete = ChunksToDeleteMap.Find(OldChunk->GetBounds());
+					auto ChunkToDelete = ChunksToDeleteMap.Find(FVoxelChunkOctree::GetAlignedBounds(It.Key.Min, RENDER_CHUNK_SIZE << ParentLOD));
 					if (ChunkToDelete)
 					{
-						NewChunk->AddPreviousChunk(*ChunkToDelete);
+						It.Value->AddPreviousChunk(*ChunkToDelete);
+					}
+				}
+			}
+			for (auto& It : ChunksToDeleteMap)
+			{
+				// Merged chunks
+				const int OldLOD = FMath::RoundToInt(FMath::Log2(It.Key.Size().X / RENDER_CHUNK_SIZE));
+				for (int ParentLOD = OldLOD + 1; ParentLOD < OctreeLOD; ParentLOD++)
+				{
+					auto NewChunk = NewChunks.Find(FVoxelChunkOctree::GetAlignedBounds(It.Key.Min, RENDER_CHUNK_SIZE << ParentLOD));
+					if (NewChunk)
+					{
+						(*NewChunk)->AddPreviousChunk(It.Value);
 					}
 				}
 			}
+		}
 
+		for (auto& It : NewChunks)
+		{
 			{
 				SCOPE_CYCLE_COUNTER(STAT_LODVoxelRender_UpdateLOD_ChunksToCreate_UpdateChunks);
-				NewChunk->UpdateTransitions(TransitionsMasks[NewChunk->Bounds]); // Must be done before UpdateChunk, else an invalid transition mask is used (0)
-				NewChunk->UpdateChunk(FIntBox::Infinite());
+				It.Value->UpdateTransitions(TransitionsMasks[It.Key]); // Must be done before UpdateChunk, else an invalid transition mask is used (0)
+				It.Value->UpdateChunk(FIntBox::Infinite());
 			}
 
 			//check(!Chunks.Contains(NewChunkBounds));
-			Chunks.Add(NewChunkBounds, NewChunk);
+			Chunks.Add(It.Key, It.Value);
 		}
 	}
 
@@ -730,9 +917,14 @@ void FLODVoxelRender::UpdateLOD()
 	{
 		SCOPE_CYCLE_COUNTER(STAT_LODVoxelRender_UpdateLOD_UpdateTransitions);
 
-		for (auto& Chunk : ChunksArray)
+		// Only the leaves next to a split or a merge can have a new mask
+		for (auto& It : TransitionsMasks)
 		{
-			Chunk->UpdateTransitions(TransitionsMasks[Chunk->Bounds]);
+			TSharedPtr<FVoxelRenderChunk>* Chunk = Chunks.Find(It.Key);
+			if (Chunk)
+			{
+				(*Chunk)->UpdateTransitions(It.Value);
+			}
 		}
 	}
-}
\ No newline at end of file
+}
@@ -30,9 +30,10 @@ class FAsyncOctreeBuilderTask
 public:
 	TSet<FIntBox> ChunksToDelete;
 	TSet<FIntBox> ChunksToCreate;
-	TSharedPtr<FVoxelChunkOctree> NewOctree;
-	TSharedPtr<FVoxelChunkOctree> OldOctree;
+	// Only the masks that might have changed
 	TMap<FIntBox, uint8> TransitionsMasks;
+	// Updated in place: must not be accessed by the game thread while the task is running
+	TSharedPtr<FVoxelChunkOctree> Octree;
 
 	FAsyncOctreeBuilderTask(const TArray<FIntBox>& CameraBounds, uint8 LOD, TSharedPtr<FVoxelChunkOctree> Octree);
 
@@ -47,14 +48,13 @@ public:
 	};
 
 private:
-	TSharedPtr<FVoxelChunkOctree> Octree;
 	const uint8 LOD;
 	const TArray<FIntBox> CameraBounds;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class FVoxelRenderChunk
+class FVoxelRenderChunk : public TSharedFromThis<FVoxelRenderChunk>
 {
 public:
 	FLODVoxelRender* const Render;
@@ -75,6 +75,12 @@ public:
 
 	void Tick();
 
+	/**
+	 * Apply the result of a finished task. Called by the render, within its mesh update budget
+	 * @param	SectionIndex	The section to update, or SECTIONS_PER_CHUNK for the transitions
+	 */
+	void Commit(int SectionIndex);
+
 	FORCEINLINE UVoxelProceduralMeshComponent* GetMesh() const;
 	FORCEINLINE FIntBox GetBounds() const;
 	FORCEINLINE int TotalSize() const;
@@ -88,21 +94,24 @@ private:
 	uint8 TransitionsCurrentMask;
 	uint8 TransitionsDisplayedMask;
 	uint8 TransitionsMask;
-	TArray<uint8, TFixedAllocator<SECTIONS_PER_CHUNK>> ChunksCurrentMask;
 	
 	UVoxelProceduralMeshComponent* Mesh;	
-	TArray<FVoxelIntermediateChunk,							  TFixedAllocator<SECTIONS_PER_CHUNK>> IntermediateChunks;
 	TArray<TArray<UHierarchicalInstancedStaticMeshComponent*, TFixedAllocator<SECTIONS_PER_CHUNK>>> GrassMeshes;
 
 	TArray<FIntBox,							  TFixedAllocator<SECTIONS_PER_CHUNK>> SectionsBounds;
 	TArray<bool,							  TFixedAllocator<SECTIONS_PER_CHUNK>> InitialUpdatingFinished;
 	TArray<bool,							  TFixedAllocator<SECTIONS_PER_CHUNK>> SectionNeedsUpdate;
 	TArray<TSharedPtr<FAsyncPolygonizerWork>, TFixedAllocator<SECTIONS_PER_CHUNK>> Tasks;
+	// Is the task done and waiting to be committed?
+	TArray<bool,							  TFixedAllocator<SECTIONS_PER_CHUNK>> SectionCommitQueued;
+	bool bTransitionsCommitQueued;
 	
 	TArray<TArray<TSet<FIntVector>>> OldGrassPositionsArrayPerSection;
 	TArray<TSharedRef<FVoxelChunkToDelete>> PreviousChunks;
 
 	void UpdateSection(int SectionIndex);
+	void CommitSection(int SectionIndex);
+	void CommitTransitions();
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -129,11 +138,20 @@ private:
 	bool const bCollisions;
 };
 
+struct FVoxelChunkCommit
+{
+	TWeakPtr<FVoxelRenderChunk> Chunk;
+	int SectionIndex;
+	double QueueTime;
+	int Priority;
+};
+
 class FLODVoxelRender : public FCollisionVoxelRender
 {
 
 public:
 	FVoxelQueuedThreadPool* const MeshThreadPool;
+	FVoxelTaskPriorityHandler PriorityHandler;
 
 	FLODVoxelRender(AVoxelWorld* World, AActor* ChunksOwner);
 	~FLODVoxelRender() override;
@@ -151,6 +169,11 @@ public:
 
 	void AddTaskToDelete(const TSharedPtr<FVoxelAsyncWork>& NewTaskToDelete);
 
+	/**
+	 * Queue the result of a finished task. Results are committed by priority, under the world mesh update budget
+	 */
+	void QueueCommit(const TSharedRef<FVoxelRenderChunk>& Chunk, int SectionIndex);
+
 private:
 	FQueuedThreadPool* const OctreeBuilderThreadPool;
 
@@ -162,6 +185,7 @@ private:
 	TMap<FIntBox, TSharedPtr<FVoxelRenderChunk>> Chunks;
 	TArray<TSharedPtr<FVoxelRenderChunk>> ChunksArray;
 
+	// Updated by the octree builder: the game thread only passes it to the next builder, and uses Chunks instead
 	TSharedPtr<FVoxelChunkOctree> Octree;
 	
 	TSharedPtr<FAsyncTask<FAsyncOctreeBuilderTask>> OctreeBuilder;
@@ -170,7 +194,13 @@ private:
 
 	TArray<TSharedPtr<FVoxelAsyncWork>> TasksToDelete;
 
+	TArray<FVoxelChunkCommit> QueuedCommits;
+
 	float TimeSinceUpdate;
 
 	void UpdateLOD();
+	void UpdatePriorities();
+	void CommitQueuedChunks();
+
+	uint8 GetOctreeLOD() const;
 };
\ No newline at end of file
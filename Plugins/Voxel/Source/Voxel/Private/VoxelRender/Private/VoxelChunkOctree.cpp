@@ -2,38 +2,150 @@
 
 #include "VoxelChunkOctree.h"
 
-FVoxelChunkOctree::FVoxelChunkOctree(const TArray<FIntBox>& CameraBounds, uint8 LOD)
+struct FVoxelChunkOctreeUpdateState
+{
+	const TArray<FIntBox>& OldCameraBounds;
+	const TArray<FIntBox>& NewCameraBounds;
+	FVoxelChunkOctreeDiff& Diff;
+
+	// Leaves created by a split, whose neighbors might need to be split to keep the octree balanced
+	TArray<FVoxelChunkOctree*> LeavesToBalance;
+	// Nodes that might be merged, by LOD
+	TArray<TArray<FVoxelChunkOctree*>> MergeCandidates;
+	// Created leaves. They and their neighbors need their transitions mask to be recomputed
+	TSet<FIntBox> CreatedLeaves;
+
+	FVoxelChunkOctreeUpdateState(const TArray<FIntBox>& OldCameraBounds, const TArray<FIntBox>& NewCameraBounds, FVoxelChunkOctreeDiff& Diff, uint8 RootLOD)
+		: OldCameraBounds(OldCameraBounds)
+		, NewCameraBounds(NewCameraBounds)
+		, Diff(Diff)
+	{
+		MergeCandidates.SetNum(RootLOD + 1);
+	}
+
+	void OnLeafCreated(const FIntBox& Bounds)
+	{
+		if (Diff.ChunksToDelete.Remove(Bounds) == 0)
+		{
+			Diff.ChunksToCreate.Add(Bounds);
+		}
+		CreatedLeaves.Add(Bounds);
+	}
+	void OnLeafDeleted(const FIntBox& Bounds)
+	{
+		if (Diff.ChunksToCreate.Remove(Bounds) == 0)
+		{
+			Diff.ChunksToDelete.Add(Bounds);
+		}
+		CreatedLeaves.Remove(Bounds);
+	}
+
+	static bool IntersectAny(const FIntBox& Bounds, const TArray<FIntBox>& Boxes)
+	{
+		for (auto& Box : Boxes)
+		{
+			if (Box.Intersect(Bounds))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	static bool IsContainedInAny(const FIntBox& Bounds, const TArray<FIntBox>& Boxes)
+	{
+		for (auto& Box : Boxes)
+		{
+			if (Box.Contains(Bounds))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelChunkOctree::FVoxelChunkOctree(uint8 LOD)
 	: TVoxelOctree(LOD)
 	, Root(this)
-	, CameraBounds(CameraBounds)
 {
 	check(LOD > 0);
 
+	// The root is never a leaf
 	CreateChilds();
-
-	bContinueInit = true;
-	while (bContinueInit)
-	{
-		bContinueInit = false;
-		Init();
-	}
 }
 
 FVoxelChunkOctree::FVoxelChunkOctree(FVoxelChunkOctree* Parent, uint8 ChildIndex)
 	: TVoxelOctree(Parent, ChildIndex)
 	, Root(Parent->Root)
 {
-	if (LOD > 0)
+}
+
+void FVoxelChunkOctree::Update(const TArray<FIntBox>& NewCameraBounds, FVoxelChunkOctreeDiff& OutDiff)
+{
+	check(Root == this);
+
+	FVoxelChunkOctreeUpdateState State(CameraBounds, NewCameraBounds, OutDiff, LOD);
+
+	// Split the nodes entering the camera bounds, and find the ones leaving them
+	UpdateCamera(State);
+
+	// Keep adjacent leaves within one LOD of each other
+	while (State.LeavesToBalance.Num() > 0)
 	{
-		for (const FIntBox& Bound : Root->CameraBounds)
+		FVoxelChunkOctree* Leaf = State.LeavesToBalance.Pop(false);
+		if (!Leaf->IsLeaf())
 		{
-			if (GetBounds().Intersect(Bound))
+			// Its childs have been added
+			continue;
+		}
+		for (auto Direction : { XMin, XMax, YMin, YMax, ZMin, ZMax })
+		{
+			FVoxelChunkOctree* AdjacentChunk = Leaf->GetAdjacentChunk(Direction);
+			while (AdjacentChunk && AdjacentChunk->LOD > Leaf->LOD + 1)
+			{
+				AdjacentChunk->Split(State);
+				AdjacentChunk = Leaf->GetAdjacentChunk(Direction);
+			}
+		}
+	}
+
+	// Merge the nodes that are no longer needed, from the smallest to the biggest so that merges can cascade
+	for (int CandidateLOD = 0; CandidateLOD < State.MergeCandidates.Num(); CandidateLOD++)
+	{
+		// Merges only add candidates of higher LOD
+		for (FVoxelChunkOctree* Candidate : State.MergeCandidates[CandidateLOD])
+		{
+			if (!Candidate->IsLeaf() && Candidate != Root && !State.IntersectAny(Candidate->GetBounds(), NewCameraBounds) && Candidate->CanMerge())
+			{
+				Candidate->Merge(State);
+			}
+		}
+	}
+
+	// Recompute the transitions masks of the created leaves and of their neighbors
+	for (auto& Bounds : State.CreatedLeaves)
+	{
+		FVoxelChunkOctree* Leaf = GetLeaf(Bounds.Min);
+		check(Leaf->GetBounds() == Bounds);
+
+		OutDiff.TransitionsMasks.Add(Bounds, Leaf->GetTransitionsMask());
+		for (auto Direction : { XMin, XMax, YMin, YMax, ZMin, ZMax })
+		{
+			TArray<FVoxelChunkOctree*> AdjacentLeaves;
+			GetLeavesOverlappingBox(Leaf->GetFaceBounds(Direction), AdjacentLeaves);
+			for (auto AdjacentLeaf : AdjacentLeaves)
 			{
-				CreateChilds();
-				break;
+				if (!OutDiff.TransitionsMasks.Contains(AdjacentLeaf->GetBounds()))
+				{
+					OutDiff.TransitionsMasks.Add(AdjacentLeaf->GetBounds(), AdjacentLeaf->GetTransitionsMask());
+				}
 			}
 		}
 	}
+
+	CameraBounds = NewCameraBounds;
 }
 
 void FVoxelChunkOctree::GetLeavesBounds(TSet<FIntBox>& InBounds) const
@@ -55,16 +167,7 @@ void FVoxelChunkOctree::GetLeavesTransitionsMasks(TMap<FIntBox, uint8>& Transiti
 {
 	if (IsLeaf())
 	{
-		uint8 TransitionsMask = 0;
-		for (auto Direction : { XMin, XMax, YMin, YMax, ZMin, ZMax })
-		{
-			FVoxelChunkOctree* AdjacentChunk = GetAdjacentChunk(Direction);
-			if (AdjacentChunk && AdjacentChunk->LOD < LOD)
-			{
-				TransitionsMask |= Direction;
-			}
-		}
-		TransitionsMasks.Add(GetBounds(), TransitionsMask);
+		TransitionsMasks.Add(GetBounds(), GetTransitionsMask());
 	}
 	else
 	{
@@ -75,6 +178,22 @@ void FVoxelChunkOctree::GetLeavesTransitionsMasks(TMap<FIntBox, uint8>& Transiti
 	}
 }
 
+uint8 FVoxelChunkOctree::GetTransitionsMask() const
+{
+	check(IsLeaf());
+
+	uint8 TransitionsMask = 0;
+	for (auto Direction : { XMin, XMax, YMin, YMax, ZMin, ZMax })
+	{
+		FVoxelChunkOctree* AdjacentChunk = GetAdjacentChunk(Direction);
+		if (AdjacentChunk && AdjacentChunk->LOD < LOD)
+		{
+			TransitionsMask |= Direction;
+		}
+	}
+	return TransitionsMask;
+}
+
 FVoxelChunkOctree* FVoxelChunkOctree::GetAdjacentChunk(EVoxelDirection Direction) const
 {
 	FIntVector P;
@@ -113,27 +232,170 @@ FVoxelChunkOctree* FVoxelChunkOctree::GetAdjacentChunk(EVoxelDirection Direction
 	}
 }
 
-void FVoxelChunkOctree::Init()
+FIntBox FVoxelChunkOctree::GetAlignedBounds(const FIntVector& Position, int Size)
 {
-	if (IsLeaf())
+	auto FloorToSize = [Size](int X) { return (X >= 0 ? X : X - Size + 1) / Size * Size; };
+	const FIntVector Min(FloorToSize(Position.X), FloorToSize(Position.Y), FloorToSize(Position.Z));
+	return FIntBox(Min, Min + FIntVector(Size, Size, Size));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelChunkOctree* FVoxelChunkOctree::GetNode(const FIntVector& P, uint8 MinLOD) const
+{
+	check(IsInOctree(P));
+
+	const FVoxelChunkOctree* Ptr = this;
+	while (!Ptr->IsLeaf() && Ptr->LOD > MinLOD)
+	{
+		Ptr = Ptr->GetChild(P);
+	}
+	return const_cast<FVoxelChunkOctree*>(Ptr);
+}
+
+FIntBox FVoxelChunkOctree::GetFaceBounds(EVoxelDirection Direction) const
+{
+	// One voxel thick box just outside the face
+	FIntVector Min = Bounds.Min;
+	FIntVector Max = Bounds.Max;
+	switch (Direction)
+	{
+	case XMin:
+		Max.X = Min.X--;
+		break;
+	case XMax:
+		Min.X = Max.X++;
+		break;
+	case YMin:
+		Max.Y = Min.Y--;
+		break;
+	case YMax:
+		Min.Y = Max.Y++;
+		break;
+	case ZMin:
+		Max.Z = Min.Z--;
+		break;
+	case ZMax:
+		Min.Z = Max.Z++;
+		break;
+	default:
+		check(false);
+	}
+	return FIntBox(Min, Max);
+}
+
+void FVoxelChunkOctree::UpdateCamera(FVoxelChunkOctreeUpdateState& State)
+{
+	const bool bIntersectOld = State.IntersectAny(Bounds, State.OldCameraBounds);
+	const bool bIntersectNew = State.IntersectAny(Bounds, State.NewCameraBounds);
+
+	if (!bIntersectOld && !bIntersectNew)
+	{
+		// Camera bounds don't affect this node
+		return;
+	}
+	if (bIntersectOld && bIntersectNew && State.IsContainedInAny(Bounds, State.OldCameraBounds) && State.IsContainedInAny(Bounds, State.NewCameraBounds))
 	{
+		// Already fully subdivided, and still needs to be
+		return;
+	}
+	if (LOD == 0)
+	{
+		return;
+	}
+
+	if (bIntersectNew)
+	{
+		if (IsLeaf())
+		{
+			Split(State);
+		}
+		for (auto Child : GetChilds())
+		{
+			Child->UpdateCamera(State);
+		}
+	}
+	else if (!IsLeaf())
+	{
+		for (auto Child : GetChilds())
+		{
+			Child->UpdateCamera(State);
+		}
+		State.MergeCandidates[LOD].Add(this);
+	}
+}
+
+void FVoxelChunkOctree::Split(FVoxelChunkOctreeUpdateState& State)
+{
+	State.OnLeafDeleted(Bounds);
+	CreateChilds();
+	for (auto Child : GetChilds())
+	{
+		State.OnLeafCreated(Child->GetBounds());
+		State.LeavesToBalance.Add(Child);
+	}
+}
+
+void FVoxelChunkOctree::Merge(FVoxelChunkOctreeUpdateState& State)
+{
+	for (auto Child : GetChilds())
+	{
+		State.OnLeafDeleted(Child->GetBounds());
+	}
+	DestroyChilds();
+	State.OnLeafCreated(Bounds);
+
+	if (LOD + 1 < State.MergeCandidates.Num())
+	{
+		// Our parent, and the nodes for which we were blocking a merge
+		State.MergeCandidates[LOD + 1].Add(Root->GetNode(Position, LOD + 1));
 		for (auto Direction : { XMin, XMax, YMin, YMax, ZMin, ZMax })
 		{
-			FVoxelChunkOctree* AdjacentChunk = GetAdjacentChunk(Direction);
-			while (AdjacentChunk && AdjacentChunk->LOD > LOD + 1)
+			const FIntBox FaceBounds = GetFaceBounds(Direction);
+			if (Root->IsInOctree(FaceBounds.Min))
 			{
-				AdjacentChunk->CreateChilds();
-				AdjacentChunk = GetAdjacentChunk(Direction);
-				Root->bContinueInit = true;
+				FVoxelChunkOctree* Node = Root->GetNode(FaceBounds.Min, LOD + 1);
+				if (!Node->IsLeaf() && Node->LOD == LOD + 1)
+				{
+					State.MergeCandidates[LOD + 1].Add(Node);
+				}
 			}
-			check(!GetAdjacentChunk(Direction) || GetAdjacentChunk(Direction)->LOD <= LOD + 1);
 		}
 	}
-	else
+}
+
+bool FVoxelChunkOctree::CanMerge() const
+{
+	check(!IsLeaf());
+
+	for (auto Child : GetChilds())
 	{
-		for (auto Child : GetChilds())
+		if (!Child->IsLeaf())
+		{
+			return false;
+		}
+	}
+
+	// Once merged, the leaves adjacent to us must be at most one LOD smaller
+	for (auto Direction : { XMin, XMax, YMin, YMax, ZMin, ZMax })
+	{
+		const FIntBox FaceBounds = GetFaceBounds(Direction);
+		if (!Root->IsInOctree(FaceBounds.Min))
+		{
+			continue;
+		}
+		FVoxelChunkOctree* AdjacentNode = Root->GetNode(FaceBounds.Min, LOD);
+		if (AdjacentNode->IsLeaf())
 		{
-			Child->Init();
+			continue;
+		}
+		for (auto Child : AdjacentNode->GetChilds())
+		{
+			if (!Child->IsLeaf() && Child->GetBounds().Intersect(FaceBounds))
+			{
+				return false;
+			}
 		}
 	}
+	return true;
 }
@@ -8,25 +8,57 @@
 #include "VoxelGlobals.h"
 #include "VoxelDirection.h"
 
+/**
+ * Changes of the leaves of a FVoxelChunkOctree during an update
+ */
+struct FVoxelChunkOctreeDiff
+{
+	TSet<FIntBox> ChunksToCreate;
+	TSet<FIntBox> ChunksToDelete;
+	// Transitions masks of all the leaves whose mask might have changed, including all the created ones
+	TMap<FIntBox, uint8> TransitionsMasks;
+};
+
+struct FVoxelChunkOctreeUpdateState;
+
 /**
  * Create the octree for rendering and spawning VoxelChunks
+ * Nodes intersecting the camera bounds are subdivided, and adjacent leaves differ by at most one LOD
  */
 class FVoxelChunkOctree : public TVoxelOctree<FVoxelChunkOctree, RENDER_CHUNK_SIZE>
 {
 public:
 	FVoxelChunkOctree* const Root;
-	const TArray<FIntBox> CameraBounds;
 
-	FVoxelChunkOctree(const TArray<FIntBox>& CameraBounds, uint8 LOD);
+	FVoxelChunkOctree(uint8 LOD);
 	FVoxelChunkOctree(FVoxelChunkOctree* Parent, uint8 ChildIndex);
 
+	/**
+	 * Update the octree for new camera bounds, only visiting the nodes whose intersection with the camera bounds changed
+	 * Can only be called on the root
+	 */
+	void Update(const TArray<FIntBox>& NewCameraBounds, FVoxelChunkOctreeDiff& OutDiff);
+
 	void GetLeavesBounds(TSet<FIntBox>& Bounds) const;
 	void GetLeavesTransitionsMasks(TMap<FIntBox, uint8>& TransitionsMasks) const;
 
+	uint8 GetTransitionsMask() const;
 	FVoxelChunkOctree* GetAdjacentChunk(EVoxelDirection Direction) const;
 
+	/**
+	 * Get the bounds of the node of size Size containing Position. Nodes are aligned on their size
+	 */
+	static FIntBox GetAlignedBounds(const FIntVector& Position, int Size);
+
 private:
-	bool bContinueInit;
+	// Only used on the root
+	TArray<FIntBox> CameraBounds;
+
+	FVoxelChunkOctree* GetNode(const FIntVector& P, uint8 MinLOD) const;
+	FIntBox GetFaceBounds(EVoxelDirection Direction) const;
 
-	void Init();
-};
\ No newline at end of file
+	void UpdateCamera(FVoxelChunkOctreeUpdateState& State);
+	void Split(FVoxelChunkOctreeUpdateState& State);
+	void Merge(FVoxelChunkOctreeUpdateState& State);
+	bool CanMerge() const;
+};
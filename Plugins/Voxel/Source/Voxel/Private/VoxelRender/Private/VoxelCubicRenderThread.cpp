@@ -309,6 +309,10 @@ void FAsyncCubicPolygonizerWork::DoWork()
 		const FVoxelWorldGeneratorInstance* Generator = World->GetWorldGenerator();
 		const float VoxelTriangleArea = (VoxelSize * VoxelSize) / 2;
 
+		// Spawned if nothing is above them
+		TArray<FVoxelActorSpawnInfo> SpawnCandidates;
+		TArray<FVoxelRay> SpawnClearanceRays;
+
 		int RandomIndex = 0;
 		for (const auto& GroupID : ActorSpawnerConfig.ActorConfigs)
 		{
@@ -440,12 +444,8 @@ void FAsyncCubicPolygonizerWork::DoWork()
 									if (World->GetValue(IntPosition) > 0)
 									{
 										float Height = FMath::CeilToInt(AVoxelActor::GetActorHeight(ClassToSpawn)) * Scale.Z;
-										FVector Dummy1;
-										FIntVector Dummy2;
-										if (!World->GetIntersection(IntPosition, IntPosition + FIntVector(0, 0, Height / VoxelSize), Dummy1, Dummy2))
-										{
-											ActorsSpawnInfo.Add(FVoxelActorSpawnInfo(ClassToSpawn, Height, Position, Rotation, Scale));
-										}
+										SpawnCandidates.Add(FVoxelActorSpawnInfo(ClassToSpawn, Height, Position, Rotation, Scale));
+										SpawnClearanceRays.Add(FVoxelRay(FVector(IntPosition), FVector(IntPosition + FIntVector(0, 0, Height / VoxelSize))));
 									}
 								}
 							}
@@ -454,6 +454,17 @@ void FAsyncCubicPolygonizerWork::DoWork()
 				}
 			}
 		}
+
+		// Check the clearance above the candidates at once: close rays share the regions skipped
+		TArray<FVoxelRaycastHit> Hits;
+		Data->RaycastBatch(SpawnClearanceRays, Hits);
+		for (int Index = 0; Index < SpawnCandidates.Num(); Index++)
+		{
+			if (!Hits[Index].bHit)
+			{
+				ActorsSpawnInfo.Add(SpawnCandidates[Index]);
+			}
+		}
 	}
 }
 
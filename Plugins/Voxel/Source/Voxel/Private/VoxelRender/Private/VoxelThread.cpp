@@ -2,6 +2,7 @@
 
 #include "VoxelThread.h"
 #include "VoxelPrivate.h"
+#include "VoxelGlobals.h"
 #include "VoxelData.h"
 #include "VoxelWorld.h"
 #include "VoxelWorldGenerator.h"
@@ -19,6 +20,51 @@ DECLARE_CYCLE_STAT(TEXT("FAsyncPolygonizerWork::DoWork.Actors"), STAT_FAsyncPoly
 
 DECLARE_CYCLE_STAT(TEXT("FAsyncPolygonizerWorkForTransitions::DoWork"), STAT_FAsyncPolygonizerWorkForTransitions_DoWork, STATGROUP_Voxel);
 
+bool FVoxelTaskPriorityHandler::SetInvokers(const TArray<FInvoker>& NewInvokers)
+{
+	bool bNeedsUpdate = NewInvokers.Num() != Invokers.Num();
+	for (int Index = 0; Index < NewInvokers.Num() && !bNeedsUpdate; Index++)
+	{
+		const FInvoker& Old = Invokers[Index];
+		const FInvoker& New = NewInvokers[Index];
+		// Half a chunk, or ~25 degrees
+		bNeedsUpdate = FVector::DistSquared(Old.Position, New.Position) > FMath::Square(CHUNK_SIZE / 2) || FVector::DotProduct(Old.Direction, New.Direction) < 0.9f;
+	}
+
+	if (bNeedsUpdate)
+	{
+		Invokers = NewInvokers;
+	}
+	return bNeedsUpdate;
+}
+
+int FVoxelTaskPriorityHandler::GetPriority(const FIntBox& Bounds) const
+{
+	if (Invokers.Num() == 0)
+	{
+		return 0;
+	}
+
+	const FVector Center = (FVector)(Bounds.Min + Bounds.Max) / 2;
+	const float Size = FMath::Max(1, Bounds.Size().X);
+
+	float MinDistance = MAX_flt;
+	for (auto& Invoker : Invokers)
+	{
+		const FVector ToChunk = Center - Invoker.Position;
+		const float Distance = ToChunk.Size();
+		// 1 in front, 2 on the sides, 3 behind
+		const float DirectionFactor = 2 - FVector::DotProduct(Invoker.Direction, ToChunk.GetSafeNormal());
+		MinDistance = FMath::Min(MinDistance, Distance * DirectionFactor);
+	}
+
+	// Screen coverage is about Size / Distance: use a log scale to spread it over the buckets
+	const int Rank = FMath::FloorToInt(8 * FMath::Log2(1 + MinDistance / Size));
+	return -FMath::Clamp(Rank, 0, VOXEL_THREAD_POOL_BUCKETS - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 FVoxelAsyncWork::FVoxelAsyncWork()
 {
 	DoneEvent = FPlatformProcess::GetSynchEventFromPool(true);
@@ -77,7 +123,8 @@ FAsyncPolygonizerWork::FAsyncPolygonizerWork(
 	AVoxelWorld* World
 	,bool bComputeGrass,
 	const TArray<TSet<FIntVector>>& OldGrassPositionsArray,
-	bool bComputeVoxelActors
+	bool bComputeVoxelActors,
+	const FVoxelTaskPriorityHandler* PriorityHandler
 	)
 	: LOD(LOD)
 	, Data(Data)
@@ -88,6 +135,7 @@ FAsyncPolygonizerWork::FAsyncPolygonizerWork(
 	, OldGrassPositionsArray(OldGrassPositionsArray)
 	, bComputeVoxelActors(bComputeVoxelActors)
 	, IsDoneCounter(0)
+	, PriorityHandler(PriorityHandler)
 {
 }
 
@@ -364,6 +412,10 @@ void FAsyncPolygonizerWork::DoWork()
 		const FVoxelWorldGeneratorInstance* Generator = World->GetWorldGenerator();
 		const float VoxelTriangleArea = (VoxelSize * VoxelSize) / 2;
 
+		// Spawned if nothing is above them
+		TArray<FVoxelActorSpawnInfo> SpawnCandidates;
+		TArray<FVoxelRay> SpawnClearanceRays;
+
 		int RandomIndex = 0;
 		for (const auto& GroupID : ActorSpawnerConfig.ActorConfigs)
 		{
@@ -495,12 +547,8 @@ void FAsyncPolygonizerWork::DoWork()
 									if (World->GetValue(IntPosition) > 0)
 									{
 										float Height = FMath::CeilToInt(AVoxelActor::GetActorHeight(ClassToSpawn)) * Scale.Z;
-										FVector Dummy1;
-										FIntVector Dummy2;
-										if (!World->GetIntersection(IntPosition, IntPosition + FIntVector(0, 0, Height / VoxelSize), Dummy1, Dummy2))
-										{
-											ActorsSpawnInfo.Add(FVoxelActorSpawnInfo(ClassToSpawn, Height, Position, Rotation, Scale));
-										}
+										SpawnCandidates.Add(FVoxelActorSpawnInfo(ClassToSpawn, Height, Position, Rotation, Scale));
+										SpawnClearanceRays.Add(FVoxelRay(FVector(IntPosition), FVector(IntPosition + FIntVector(0, 0, Height / VoxelSize))));
 									}
 								}
 							}
@@ -509,22 +557,41 @@ void FAsyncPolygonizerWork::DoWork()
 				}
 			}
 		}
+
+		// Check the clearance above the candidates at once: close rays share the regions skipped
+		TArray<FVoxelRaycastHit> Hits;
+		Data->RaycastBatch(SpawnClearanceRays, Hits);
+		for (int Index = 0; Index < SpawnCandidates.Num(); Index++)
+		{
+			if (!Hits[Index].bHit)
+			{
+				ActorsSpawnInfo.Add(SpawnCandidates[Index]);
+			}
+		}
 	}
 }
 
 
 int FAsyncPolygonizerWork::GetPriority() const
 {
-	return -LOD;
+	if (PriorityHandler)
+	{
+		return PriorityHandler->GetPriority(FIntBox(ChunkPosition, ChunkPosition + FIntVector(CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE) * (1 << LOD)));
+	}
+	else
+	{
+		return -LOD;
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-FAsyncPolygonizerForTransitionsWork::FAsyncPolygonizerForTransitionsWork(int LOD, FVoxelData* Data, const FIntVector& ChunkPosition, uint8 TransitionsMask)
+FAsyncPolygonizerForTransitionsWork::FAsyncPolygonizerForTransitionsWork(int LOD, FVoxelData* Data, const FIntVector& ChunkPosition, uint8 TransitionsMask, const FVoxelTaskPriorityHandler* PriorityHandler)
 	: LOD(LOD)
 	, Data(Data)
 	, ChunkPosition(ChunkPosition)
 	, TransitionsMask(TransitionsMask)
+	, PriorityHandler(PriorityHandler)
 {
 
 }
@@ -546,5 +613,12 @@ void FAsyncPolygonizerForTransitionsWork::DoWork()
 
 int FAsyncPolygonizerForTransitionsWork::GetPriority() const
 {
-	return -LOD;
+	if (PriorityHandler)
+	{
+		return PriorityHandler->GetPriority(FIntBox(ChunkPosition, ChunkPosition + FIntVector(CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE) * (CHUNK_MULTIPLIER << LOD)));
+	}
+	else
+	{
+		return -LOD;
+	}
 }
@@ -8,9 +8,11 @@
 #include "ScopeLock.h"
 
 DECLARE_DWORD_COUNTER_STAT( TEXT( "VoxelThreadPoolDummyCounter" ), STAT_VoxelThreadPoolDummyCounter, STATGROUP_ThreadPoolAsyncTasks );
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Thread Pool Queued Works"), STAT_VoxelThreadPool_QueuedWorks, STATGROUP_Voxel);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Voxel Thread Pool Steals"), STAT_VoxelThreadPool_Steals, STATGROUP_Voxel);
 DECLARE_CYCLE_STAT(TEXT("FVoxelQueuedThreadPool::AddQueuedWork"), STAT_FVoxelQueuedThreadPool_AddQueuedWork, STATGROUP_Voxel);
 DECLARE_CYCLE_STAT(TEXT("FVoxelQueuedThreadPool::RetractQueuedWork"), STAT_FVoxelQueuedThreadPool_RetractQueuedWork, STATGROUP_Voxel);
-DECLARE_CYCLE_STAT(TEXT("FVoxelQueuedThreadPool::RetractQueuedWork.EraseFromQueue"), STAT_FVoxelQueuedThreadPool_RetractQueuedWork_EraseFromQueue, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelQueuedThreadPool::RecomputePriorities"), STAT_FVoxelQueuedThreadPool_RecomputePriorities, STATGROUP_Voxel);
 
 uint32 FVoxelQueuedThread::Run()
 {
@@ -18,25 +20,18 @@ uint32 FVoxelQueuedThread::Run()
 	{
 		// This will force sending the stats packet from the previous frame.
 		SET_DWORD_STAT(STAT_VoxelThreadPoolDummyCounter, 0);
-		// We need to wait for shorter amount of time
-		bool bContinueWaiting = true;
-		while (bContinueWaiting)
+
+		IVoxelQueuedWork* LocalQueuedWork = OwningThreadPool->GetNextJob(this);
+		if (!LocalQueuedWork)
 		{
-			DECLARE_SCOPE_CYCLE_COUNTER(TEXT("FVoxelQueuedThread::Run.WaitForWork"), STAT_FQueuedThread_Run_WaitForWork, STATGROUP_Voxel);
-			// Wait for some work to do
-			bContinueWaiting = !DoWorkEvent->Wait(10);
+			LocalQueuedWork = OwningThreadPool->WaitForJob(this);
 		}
-
-		IVoxelQueuedWork* LocalQueuedWork = QueuedWork;
-		QueuedWork = nullptr;
-		FPlatformMisc::MemoryBarrier();
-		check(LocalQueuedWork || TimeToDie); // well you woke me up, where is the job or termination request?
-		while (LocalQueuedWork)
+		while (LocalQueuedWork && !TimeToDie)
 		{
 			// Tell the object to do the work
 			LocalQueuedWork->DoThreadedWork();
 			// Let the object cleanup before we remove our ref to it
-			LocalQueuedWork = OwningThreadPool->ReturnToPoolOrGetNextJob(this);
+			LocalQueuedWork = OwningThreadPool->GetNextJob(this);
 		}
 	}
 	return 0;
@@ -44,7 +39,6 @@ uint32 FVoxelQueuedThread::Run()
 
 FVoxelQueuedThread::FVoxelQueuedThread() : DoWorkEvent(nullptr)
 , TimeToDie(0)
-, QueuedWork(nullptr)
 , OwningThreadPool(nullptr)
 , Thread(nullptr)
 {
@@ -82,22 +76,15 @@ bool FVoxelQueuedThread::KillThread()
 	return bDidExitOK;
 }
 
-void FVoxelQueuedThread::DoWork(IVoxelQueuedWork* InQueuedWork)
+void FVoxelQueuedThread::WakeUp()
 {
-	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("FVoxelQueuedThread::DoWork"), STAT_FVoxelQueuedThread_DoWork, STATGROUP_ThreadPoolAsyncTasks);
-
-	check(QueuedWork == nullptr && "Can't do more than one task at a time");
-	// Tell the thread the work to be done
-	QueuedWork = InQueuedWork;
-	FPlatformMisc::MemoryBarrier();
-	// Tell the thread to wake up and do its job
 	DoWorkEvent->Trigger();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 FVoxelQueuedThreadPool::FVoxelQueuedThreadPool()
-	: SynchQueue(nullptr)
+	: NumIdleThreads(0)
 	, TimeToDie(0)
 {
 
@@ -110,14 +97,11 @@ FVoxelQueuedThreadPool::~FVoxelQueuedThreadPool()
 
 bool FVoxelQueuedThreadPool::Create(uint32 InNumQueuedThreads, uint32 StackSize /*= (32 * 1024)*/, EThreadPriority ThreadPriority /*= TPri_Normal*/)
 {
-	// Make sure we have synch objects
 	bool bWasSuccessful = true;
-	check(SynchQueue == nullptr);
-	SynchQueue = new FCriticalSection();
-	FScopeLock Lock(SynchQueue);
-	// Presize the array so there is no extra memory allocated
-	check(QueuedThreads.Num() == 0);
-	QueuedThreads.Empty(InNumQueuedThreads);
+	check(AllThreads.Num() == 0);
+	// Presize the array so there is no extra memory allocated, and so that threads can iterate it while it's being filled
+	AllThreads.Empty(InNumQueuedThreads);
+	IdleThreads.Empty(InNumQueuedThreads);
 
 	// Now create each thread and add it to the array
 	for (uint32 Count = 0; Count < InNumQueuedThreads && bWasSuccessful == true; Count++)
@@ -127,7 +111,6 @@ bool FVoxelQueuedThreadPool::Create(uint32 InNumQueuedThreads, uint32 StackSize
 		// Now create the thread and add it if ok
 		if (pThread->Create(this, StackSize, ThreadPriority) == true)
 		{
-			QueuedThreads.Add(pThread);
 			AllThreads.Add(pThread);
 		}
 		else
@@ -147,65 +130,73 @@ bool FVoxelQueuedThreadPool::Create(uint32 InNumQueuedThreads, uint32 StackSize
 
 void FVoxelQueuedThreadPool::Destroy()
 {
-	if (SynchQueue)
+	if (AllThreads.Num() == 0)
 	{
+		return;
+	}
+
+	FPlatformAtomics::InterlockedExchange(&TimeToDie, 1);
+
+	// Clean up all queued objects
+	auto AbandonAll = [&](TArray<FVoxelQueuedWorkTicketPtr>& Works)
+	{
+		for (auto& Ticket : Works)
 		{
-			FScopeLock Lock(SynchQueue);
-			TimeToDie = 1;
-			FPlatformMisc::MemoryBarrier();
-			// Clean up all queued objects
-			while (!QueuedWork.empty())
-			{
-				auto Work = QueuedWork.top().Work;
-				if (ValidQueuedWork.Contains(Work))
-				{
-					Work->Abandon();
-				}
-				QueuedWork.pop();
-			}
-			ValidQueuedWork.Reset();
-		}
-		// wait for all threads to finish up
-		while (1)
-		{
-			{
-				FScopeLock Lock(SynchQueue);
-				if (AllThreads.Num() == QueuedThreads.Num())
-				{
-					break;
-				}
-			}
-			FPlatformProcess::Sleep(0.0f);
-		}
-		// Delete all threads
-		{
-			FScopeLock Lock(SynchQueue);
-			// Now tell each thread to die and delete those
-			for (int32 Index = 0; Index < AllThreads.Num(); Index++)
+			if (Ticket->TryChangeState(FVoxelQueuedWorkTicket::Retracted))
 			{
-				AllThreads[Index]->KillThread();
-				delete AllThreads[Index];
+				NumQueuedJobs.Decrement();
+				DEC_DWORD_STAT(STAT_VoxelThreadPool_QueuedWorks);
+				Ticket->Work->Abandon();
 			}
-			QueuedThreads.Empty();
-			AllThreads.Empty();
 		}
-		delete SynchQueue;
-		SynchQueue = nullptr;
+		Works.Empty();
+	};
+	for (auto& Bucket : Buckets)
+	{
+		FScopeLock Lock(&Bucket.Section);
+		AbandonAll(Bucket.Works);
+		Bucket.Num = 0;
+	}
+	for (auto* Thread : AllThreads)
+	{
+		FScopeLock Lock(&Thread->LocalQueueSection);
+		AbandonAll(Thread->LocalQueue);
 	}
-}
 
-/*int32 FVoxelQueuedThreadPool::GetNumQueuedJobs() const
-{
-	// this is a estimate of the number of queued jobs. 
-	// no need for thread safe lock as the queuedWork array isn't moved around in memory so unless this class is being destroyed then we don't need to worry about it
-	return QueuedWork.size();
-}*/
+	// Now tell each thread to die and delete those. This waits for the works in progress
+	for (auto* Thread : AllThreads)
+	{
+		Thread->KillThread();
+	}
+	for (auto* Thread : AllThreads)
+	{
+		delete Thread;
+	}
+	AllThreads.Empty();
+	IdleThreads.Empty();
+	NumIdleThreads = 0;
+}
 
 int32 FVoxelQueuedThreadPool::GetNumThreads() const
 {
 	return AllThreads.Num();
 }
 
+int32 FVoxelQueuedThreadPool::GetNumQueuedJobs() const
+{
+	return NumQueuedJobs.GetValue();
+}
+
+int32 FVoxelQueuedThreadPool::GetNumSteals() const
+{
+	return NumSteals.GetValue();
+}
+
+double FVoxelQueuedThreadPool::GetIdleTime() const
+{
+	return IdleTimeInMicroseconds.GetValue() / 1000000.;
+}
+
 void FVoxelQueuedThreadPool::AddQueuedWork(IVoxelQueuedWork* InQueuedWork)
 {
 	SCOPE_CYCLE_COUNTER(STAT_FVoxelQueuedThreadPool_AddQueuedWork);
@@ -216,77 +207,316 @@ void FVoxelQueuedThreadPool::AddQueuedWork(IVoxelQueuedWork* InQueuedWork)
 		return;
 	}
 	check(InQueuedWork != nullptr);
-	FVoxelQueuedThread* Thread = nullptr;
-	// Check to see if a thread is available. Make sure no other threads
-	// can manipulate the thread pool while we do this.
-	check(SynchQueue);
-	FScopeLock sl(SynchQueue);
-	if (QueuedThreads.Num() > 0)
+
+	const int32 BucketIndex = GetBucketIndex(InQueuedWork->GetPriority());
+	FVoxelQueuedWorkTicketPtr Ticket = MakeShareable(new FVoxelQueuedWorkTicket(InQueuedWork, BucketIndex));
+	InQueuedWork->Ticket = Ticket;
+
+	NumQueuedJobs.Increment();
+	INC_DWORD_STAT(STAT_VoxelThreadPool_QueuedWorks);
+	{
+		FBucket& Bucket = Buckets[BucketIndex];
+		FScopeLock Lock(&Bucket.Section);
+		Bucket.Works.Add(Ticket);
+		FPlatformAtomics::InterlockedIncrement(&Bucket.Num);
+	}
+
+	WakeUpIdleThread();
+}
+
+bool FVoxelQueuedThreadPool::RetractQueuedWork(IVoxelQueuedWork* InQueuedWork)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelQueuedThreadPool_RetractQueuedWork);
+
+	if (TimeToDie)
 	{
-		// Cycle through all available threads to make sure that stats are up to date.
-		int32 Index = 0;
-		// Grab that thread to use
-		Thread = QueuedThreads[Index];
-		// Remove it from the list so no one else grabs it
-		QueuedThreads.RemoveAt(Index);
+		return false; // no special consideration for this, refuse the retraction and let shutdown proceed
 	}
-	// Was there a thread ready?
-	if (Thread != nullptr)
+	check(InQueuedWork != nullptr);
+
+	// The ticket stays in the queues: it will be skipped by the threads
+	FVoxelQueuedWorkTicketPtr Ticket = InQueuedWork->Ticket;
+	if (Ticket.IsValid() && Ticket->TryChangeState(FVoxelQueuedWorkTicket::Retracted))
 	{
-		// We have a thread, so tell it to do the work
-		Thread->DoWork(InQueuedWork);
+		NumQueuedJobs.Decrement();
+		DEC_DWORD_STAT(STAT_VoxelThreadPool_QueuedWorks);
+		return true;
 	}
 	else
 	{
-		// There were no threads available, queue the work to be done
-		// as soon as one does become available
-		QueuedWork.push(FVoxelQueuedWorkPtr(InQueuedWork, ValidQueuedWork));
-		ValidQueuedWork.Add(InQueuedWork);
+		return false;
 	}
 }
 
-bool FVoxelQueuedThreadPool::RetractQueuedWork(IVoxelQueuedWork* InQueuedWork)
+void FVoxelQueuedThreadPool::RecomputePriorities()
 {
-	SCOPE_CYCLE_COUNTER(STAT_FVoxelQueuedThreadPool_RetractQueuedWork);
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelQueuedThreadPool_RecomputePriorities);
 
 	if (TimeToDie)
 	{
-		return false; // no special consideration for this, refuse the retraction and let shutdown proceed
+		return;
 	}
-	check(InQueuedWork != nullptr);
-	check(SynchQueue);
-	FScopeLock sl(SynchQueue);
 
-	return !!ValidQueuedWork.Remove(InQueuedWork);
+	TArray<FVoxelQueuedWorkTicketPtr> NewBuckets[VOXEL_THREAD_POOL_BUCKETS];
+	for (auto& Bucket : Buckets)
+	{
+		TArray<FVoxelQueuedWorkTicketPtr> Works;
+		{
+			FScopeLock Lock(&Bucket.Section);
+			Works = MoveTemp(Bucket.Works);
+			Bucket.Works.Reset();
+			FPlatformAtomics::InterlockedExchange(&Bucket.Num, 0);
+		}
+
+		for (auto& Ticket : Works)
+		{
+			// Retracted works might be deleted
+			if (Ticket->State == FVoxelQueuedWorkTicket::Queued)
+			{
+				Ticket->BucketIndex = GetBucketIndex(Ticket->Work->GetPriority());
+				NewBuckets[Ticket->BucketIndex].Add(Ticket);
+			}
+		}
+	}
+
+	int32 NumWorks = 0;
+	for (int32 BucketIndex = 0; BucketIndex < VOXEL_THREAD_POOL_BUCKETS; BucketIndex++)
+	{
+		auto& NewWorks = NewBuckets[BucketIndex];
+		if (NewWorks.Num() > 0)
+		{
+			FBucket& Bucket = Buckets[BucketIndex];
+			FScopeLock Lock(&Bucket.Section);
+			Bucket.Works.Append(NewWorks);
+			FPlatformAtomics::InterlockedAdd(&Bucket.Num, NewWorks.Num());
+			NumWorks += NewWorks.Num();
+		}
+	}
+
+	// Threads might have gone idle while the buckets were empty
+	for (int32 Index = 0; Index < NumWorks && NumIdleThreads > 0; Index++)
+	{
+		WakeUpIdleThread();
+	}
 }
 
-IVoxelQueuedWork* FVoxelQueuedThreadPool::ReturnToPoolOrGetNextJob(FVoxelQueuedThread* InQueuedThread)
+IVoxelQueuedWork* FVoxelQueuedThreadPool::GetNextJob(FVoxelQueuedThread* InQueuedThread)
 {
 	check(InQueuedThread != nullptr);
-	IVoxelQueuedWork* Work = nullptr;
-	// Check to see if there is any work to be done
-	FScopeLock sl(SynchQueue);
+
 	if (TimeToDie)
 	{
-		check(QueuedWork.empty());  // we better not have anything if we are dying
+		return nullptr;
 	}
-	bool bWorkIsValid = false;
-	while (!QueuedWork.empty() && !bWorkIsValid)
+
+	// Own queue first, unless a work with a higher priority was added since
+	IVoxelQueuedWork* Work = nullptr;
 	{
-		Work = QueuedWork.top().Work;
-		QueuedWork.pop();
+		FScopeLock Lock(&InQueuedThread->LocalQueueSection);
+		if (InQueuedThread->LocalQueue.Num() > 0 && InQueuedThread->LocalQueue.Last()->BucketIndex >= GetHighestBucketIndex())
+		{
+			Work = PopFromLocalQueue(InQueuedThread);
+		}
+	}
+	if (!Work)
+	{
+		Work = PopFromBuckets(InQueuedThread);
+	}
+	if (!Work)
+	{
+		FScopeLock Lock(&InQueuedThread->LocalQueueSection);
+		Work = PopFromLocalQueue(InQueuedThread);
+	}
+	if (!Work)
+	{
+		Work = StealFromOtherThreads(InQueuedThread);
+	}
+	return Work;
+}
+
+IVoxelQueuedWork* FVoxelQueuedThreadPool::WaitForJob(FVoxelQueuedThread* InQueuedThread)
+{
+	{
+		FScopeLock Lock(&IdleThreadsSection);
+		IdleThreads.Add(InQueuedThread);
+		FPlatformAtomics::InterlockedIncrement(&NumIdleThreads);
+	}
 
-		bWorkIsValid = ValidQueuedWork.Contains(Work);
+	// A work might have been added before we were marked as idle
+	IVoxelQueuedWork* Work = GetNextJob(InQueuedThread);
+	if (Work)
+	{
+		FScopeLock Lock(&IdleThreadsSection);
+		if (IdleThreads.RemoveSingleSwap(InQueuedThread, false))
+		{
+			FPlatformAtomics::InterlockedDecrement(&NumIdleThreads);
+		}
+		// Else someone already woke us up: the next wait will return immediately, which is harmless
+		return Work;
 	}
-	if (bWorkIsValid)
+
 	{
-		check(Work);
-		ValidQueuedWork.Remove(Work);
+		DECLARE_SCOPE_CYCLE_COUNTER(TEXT("FVoxelQueuedThread::Run.WaitForWork"), STAT_FQueuedThread_Run_WaitForWork, STATGROUP_Voxel);
+
+		const double StartTime = FPlatformTime::Seconds();
+		InQueuedThread->DoWorkEvent->Wait();
+		IdleTimeInMicroseconds.Add((int64)((FPlatformTime::Seconds() - StartTime) * 1000000));
+	}
+	return nullptr;
+}
+
+int32 FVoxelQueuedThreadPool::GetBucketIndex(int Priority)
+{
+	return FMath::Clamp(Priority + VOXEL_THREAD_POOL_BUCKETS - 1, 0, VOXEL_THREAD_POOL_BUCKETS - 1);
+}
+
+int32 FVoxelQueuedThreadPool::GetHighestBucketIndex() const
+{
+	for (int32 BucketIndex = VOXEL_THREAD_POOL_BUCKETS - 1; BucketIndex >= 0; BucketIndex--)
+	{
+		if (Buckets[BucketIndex].Num > 0)
+		{
+			return BucketIndex;
+		}
+	}
+	return -1;
+}
+
+IVoxelQueuedWork* FVoxelQueuedThreadPool::StartWork(const FVoxelQueuedWorkTicketPtr& Ticket)
+{
+	if (Ticket->TryChangeState(FVoxelQueuedWorkTicket::Started))
+	{
+		NumQueuedJobs.Decrement();
+		DEC_DWORD_STAT(STAT_VoxelThreadPool_QueuedWorks);
+		return Ticket->Work;
 	}
 	else
 	{
-		// There was no work to be done, so add the thread to the pool
-		QueuedThreads.Add(InQueuedThread);
+		// Retracted
+		return nullptr;
+	}
+}
+
+IVoxelQueuedWork* FVoxelQueuedThreadPool::PopFromLocalQueue(FVoxelQueuedThread* InQueuedThread)
+{
+	// LocalQueueSection must be locked
+	auto& LocalQueue = InQueuedThread->LocalQueue;
+	while (LocalQueue.Num() > 0)
+	{
+		IVoxelQueuedWork* Work = StartWork(LocalQueue.Pop(false));
+		if (Work)
+		{
+			return Work;
+		}
+	}
+	return nullptr;
+}
+
+IVoxelQueuedWork* FVoxelQueuedThreadPool::PopFromBuckets(FVoxelQueuedThread* InQueuedThread)
+{
+	for (int32 BucketIndex = VOXEL_THREAD_POOL_BUCKETS - 1; BucketIndex >= 0; BucketIndex--)
+	{
+		FBucket& Bucket = Buckets[BucketIndex];
+		if (Bucket.Num == 0)
+		{
+			continue;
+		}
+
+		TArray<FVoxelQueuedWorkTicketPtr, TInlineAllocator<VOXEL_THREAD_POOL_BATCH_SIZE>> Batch;
+		IVoxelQueuedWork* Work = nullptr;
+		{
+			FScopeLock Lock(&Bucket.Section);
+			while (Bucket.Works.Num() > 0 && Batch.Num() < VOXEL_THREAD_POOL_BATCH_SIZE)
+			{
+				FVoxelQueuedWorkTicketPtr Ticket = Bucket.Works.Pop(false);
+				FPlatformAtomics::InterlockedDecrement(&Bucket.Num);
+				if (Ticket->State != FVoxelQueuedWorkTicket::Queued)
+				{
+					// Retracted: drop it
+					continue;
+				}
+				if (!Work)
+				{
+					Work = StartWork(Ticket);
+				}
+				else
+				{
+					Batch.Add(Ticket);
+				}
+			}
+		}
+
+		if (Batch.Num() > 0)
+		{
+			FScopeLock Lock(&InQueuedThread->LocalQueueSection);
+			// Keep the order: the last one is popped first
+			for (int32 Index = Batch.Num() - 1; Index >= 0; Index--)
+			{
+				InQueuedThread->LocalQueue.Add(Batch[Index]);
+			}
+		}
+		if (Work)
+		{
+			if (Batch.Num() > 0)
+			{
+				// There's work left for the others
+				WakeUpIdleThread();
+			}
+			return Work;
+		}
+	}
+	return nullptr;
+}
+
+IVoxelQueuedWork* FVoxelQueuedThreadPool::StealFromOtherThreads(FVoxelQueuedThread* InQueuedThread)
+{
+	for (auto* Thread : AllThreads)
+	{
+		if (Thread == InQueuedThread || Thread->LocalQueue.Num() == 0)
+		{
+			continue;
+		}
+
+		FScopeLock Lock(&Thread->LocalQueueSection);
+		auto& LocalQueue = Thread->LocalQueue;
+		while (LocalQueue.Num() > 0)
+		{
+			// Steal from the front: the owner pops from the back
+			FVoxelQueuedWorkTicketPtr Ticket = LocalQueue[0];
+			LocalQueue.RemoveAt(0, 1, false);
+
+			IVoxelQueuedWork* Work = StartWork(Ticket);
+			if (Work)
+			{
+				NumSteals.Increment();
+				INC_DWORD_STAT(STAT_VoxelThreadPool_Steals);
+				return Work;
+			}
+		}
+	}
+	return nullptr;
+}
+
+void FVoxelQueuedThreadPool::WakeUpIdleThread()
+{
+	// Make sure the work we just queued is visible before reading NumIdleThreads
+	FPlatformMisc::MemoryBarrier();
+	if (NumIdleThreads == 0)
+	{
+		return;
+	}
+
+	FVoxelQueuedThread* Thread = nullptr;
+	{
+		FScopeLock Lock(&IdleThreadsSection);
+		if (IdleThreads.Num() > 0)
+		{
+			Thread = IdleThreads.Pop(false);
+			FPlatformAtomics::InterlockedDecrement(&NumIdleThreads);
+		}
+	}
+	if (Thread)
+	{
+		Thread->WakeUp();
 	}
-	return bWorkIsValid ? Work : nullptr;
 }
@@ -8,6 +8,7 @@
 #include "VoxelThreadPool.h"
 #include "VoxelGrassUtilities.h"
 #include "VoxelPolygonizer.h"
+#include "IntBox.h"
 
 class AVoxelWorld;
 class FVoxelPolygonizer;
@@ -35,6 +36,37 @@ struct FVoxelActorSpawnInfo
 	}
 };
 
+/**
+ * Ranks the mesh tasks by their distance to the invokers, relative to their size (ie their screen coverage)
+ * Chunks in the direction the invokers are moving or looking at are favored
+ * Must only be used on the game thread
+ */
+class FVoxelTaskPriorityHandler
+{
+public:
+	struct FInvoker
+	{
+		// In voxel space
+		FVector Position;
+		// Normalized, or zero if unknown
+		FVector Direction;
+	};
+
+	/**
+	 * @return	True if the invokers moved enough since the last call to justify recomputing the priorities
+	 */
+	bool SetInvokers(const TArray<FInvoker>& NewInvokers);
+
+	/**
+	 * @param	Bounds	Bounds of the chunk in voxel space
+	 * @return	A priority in [-(VOXEL_THREAD_POOL_BUCKETS - 1), 0], higher is more important
+	 */
+	int GetPriority(const FIntBox& Bounds) const;
+
+private:
+	TArray<FInvoker> Invokers;
+};
+
 class FVoxelAsyncWork : public IVoxelQueuedWork
 {
 public:
@@ -87,7 +119,8 @@ public:
 		AVoxelWorld* World
 		,bool bComputeGrass = true,
 		const TArray<TSet<FIntVector>>& OldPositionsArray = TArray<TSet<FIntVector>>(),
-		bool bComputeVoxelActors = false
+		bool bComputeVoxelActors = false,
+		const FVoxelTaskPriorityHandler* PriorityHandler = nullptr
 		);
 	
 	virtual void DoWork() override;
@@ -99,6 +132,8 @@ private:
 	FCriticalSection DoneSection;
 
 	TArray<TSet<FIntVector>> OldGrassPositionsArray;
+
+	const FVoxelTaskPriorityHandler* const PriorityHandler;
 };
 
 /**
@@ -120,8 +155,12 @@ public:
 		int LOD,
 		FVoxelData* Data,
 		const FIntVector& ChunkPosition,
-		uint8 TransitionsMask);
+		uint8 TransitionsMask,
+		const FVoxelTaskPriorityHandler* PriorityHandler = nullptr);
 	
 	virtual void DoWork() override;
 	virtual int GetPriority() const override;
+
+private:
+	const FVoxelTaskPriorityHandler* const PriorityHandler;
 };
\ No newline at end of file
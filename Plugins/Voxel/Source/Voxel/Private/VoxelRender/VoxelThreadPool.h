@@ -2,11 +2,49 @@
 
 #pragma once
 
-#include <queue>
-
 #include "CoreMinimal.h"
 #include "Runnable.h"
 #include "GenericPlatformAffinity.h"
+#include "ThreadSafeCounter64.h"
+
+// Number of priority buckets of the pool. Priorities are clamped to [-(VOXEL_THREAD_POOL_BUCKETS - 1), 0]
+#define VOXEL_THREAD_POOL_BUCKETS 64
+// Max number of works a thread moves from the shared buckets to its own queue at once
+#define VOXEL_THREAD_POOL_BATCH_SIZE 4
+
+class IVoxelQueuedWork;
+
+/**
+ * Handle to a queued work, shared by the queues and the work
+ * The work is only accessed by the one that successfully changes the state from Queued
+ */
+struct FVoxelQueuedWorkTicket
+{
+	enum
+	{
+		Queued,
+		Started,
+		Retracted
+	};
+
+	IVoxelQueuedWork* const Work;
+	int32 BucketIndex;
+	volatile int32 State;
+
+	FVoxelQueuedWorkTicket(IVoxelQueuedWork* Work, int32 BucketIndex)
+		: Work(Work)
+		, BucketIndex(BucketIndex)
+		, State(Queued)
+	{
+	}
+
+	FORCEINLINE bool TryChangeState(int32 NewState)
+	{
+		return FPlatformAtomics::InterlockedCompareExchange(&State, NewState, Queued) == Queued;
+	}
+};
+
+typedef TSharedPtr<FVoxelQueuedWorkTicket, ESPMode::ThreadSafe> FVoxelQueuedWorkTicketPtr;
 
 class IVoxelQueuedWork
 {
@@ -35,40 +73,12 @@ public:
 	 * to clean up any resources they allocated.
 	 */
 	virtual ~IVoxelQueuedWork() {}
-};
-
-// Needed because of priorities queries
-struct FVoxelQueuedWorkPtr
-{
-	IVoxelQueuedWork* Work;
-	const TSet<IVoxelQueuedWork*>* ValidQueuedWork;
-
-	FVoxelQueuedWorkPtr(IVoxelQueuedWork* InWork, const TSet<IVoxelQueuedWork*>& InValidQueuedWork)
-		: Work(InWork)
-		, ValidQueuedWork(&InValidQueuedWork)
-	{
-	}
 
-	int GetPriority() const
-	{
-		if (ValidQueuedWork->Contains(Work))
-		{
-			return Work->GetPriority();
-		}
-		else
-		{
-			return MAX_int32; // Put invalid jobs on top to avoid too much memory usage
-		}
-	}
-};
+private:
+	// Set when queued. Lets RetractQueuedWork find the work without searching the queues
+	FVoxelQueuedWorkTicketPtr Ticket;
 
-class FVoxelQueuedWorkCompare
-{
-public:
-	bool operator() (const FVoxelQueuedWorkPtr& A, const FVoxelQueuedWorkPtr& B)
-	{
-		return A.GetPriority() < B.GetPriority();
-	}
+	friend class FVoxelQueuedThreadPool;
 };
 
 class FVoxelQueuedThread : public FRunnable
@@ -81,18 +91,21 @@ protected:
 	/** If true, the thread should exit. */
 	volatile int32 TimeToDie;
 
-	/** The work this thread is doing. */
-	IVoxelQueuedWork* volatile QueuedWork;
-
 	/** The pool this thread belongs to. */
 	class FVoxelQueuedThreadPool* OwningThreadPool;
 
 	/** My Thread  */
 	FRunnableThread* Thread;
 
+	/** Works taken from the shared buckets by this thread. Other threads steal from the front */
+	TArray<FVoxelQueuedWorkTicketPtr> LocalQueue;
+
+	/** Protects LocalQueue. Only contended when another thread is stealing */
+	FCriticalSection LocalQueueSection;
+
 	/**
-	 * The real thread entry point. It waits for work events to be queued. Once
-	 * an event is queued, it executes it and goes back to waiting.
+	 * The real thread entry point. It takes works from the pool until there is none left,
+	 * and then waits to be woken up.
 	 */
 	virtual uint32 Run() override;
 
@@ -123,34 +136,50 @@ public:
 	bool KillThread();
 
 	/**
-	 * Tells the thread there is work to be done. Upon completion, the thread
-	 * is responsible for adding itself back into the available pool.
-	 *
-	 * @param InQueuedWork The queued work to perform
+	 * Wakes up the thread if it is waiting for work
 	 */
-	void DoWork(IVoxelQueuedWork* InQueuedWork);
+	void WakeUp();
 
+	friend class FVoxelQueuedThreadPool;
 };
 
+/**
+ * Priority-bucketed work-stealing thread pool
+ * New works go in a shared bucket per priority, each with its own lock
+ * Threads move small batches from the highest bucket to their own queue, and steal from other threads queues when out of work
+ */
 class FVoxelQueuedThreadPool
 {
 protected:
 
-	/** The work queue to pull from. */
-	std::priority_queue<FVoxelQueuedWorkPtr, std::vector<FVoxelQueuedWorkPtr>, FVoxelQueuedWorkCompare> QueuedWork;
-	TSet<IVoxelQueuedWork*> ValidQueuedWork;
+	struct FBucket
+	{
+		FCriticalSection Section;
+		TArray<FVoxelQueuedWorkTicketPtr> Works;
+		/** Works.Num(), readable without locking */
+		volatile int32 Num = 0;
+	};
 
-	/** The thread pool to dole work out to. */
-	TArray<FVoxelQueuedThread*> QueuedThreads;
+	/** The shared work queues, sorted by increasing priority. */
+	FBucket Buckets[VOXEL_THREAD_POOL_BUCKETS];
 
 	/** All threads in the pool. */
 	TArray<FVoxelQueuedThread*> AllThreads;
 
-	/** The synchronization object used to protect access to the queued work. */
-	FCriticalSection* SynchQueue;
+	/** Threads waiting for work. */
+	TArray<FVoxelQueuedThread*> IdleThreads;
+	volatile int32 NumIdleThreads;
+
+	/** The synchronization object used to protect access to the idle threads. */
+	FCriticalSection IdleThreadsSection;
 
 	/** If true, indicates the destruction process has taken place. */
-	bool TimeToDie;
+	volatile int32 TimeToDie;
+
+	/** Stats */
+	FThreadSafeCounter NumQueuedJobs;
+	FThreadSafeCounter NumSteals;
+	FThreadSafeCounter64 IdleTimeInMicroseconds;
 
 public:
 
@@ -164,13 +193,47 @@ public:
 
 	void Destroy();
 
-	//int32 GetNumQueuedJobs() const;
 	int32 GetNumThreads() const;
 
+	/** Number of works queued and not started yet */
+	int32 GetNumQueuedJobs() const;
+	/** Number of works a thread took from another thread queue */
+	int32 GetNumSteals() const;
+	/** Total time spent by the threads waiting for work, in seconds */
+	double GetIdleTime() const;
+
 	void AddQueuedWork(IVoxelQueuedWork* InQueuedWork);
 
+	/**
+	 * Remove a work from the queue if it hasn't been started yet
+	 * @return	True if the work was retracted and will never be started
+	 */
 	bool RetractQueuedWork(IVoxelQueuedWork* InQueuedWork);
 
-	IVoxelQueuedWork* ReturnToPoolOrGetNextJob(FVoxelQueuedThread* InQueuedThread);
-};
+	/**
+	 * Call GetPriority again on all the queued works and move them to their new bucket
+	 * Works already moved to a thread queue are not affected
+	 * Must be called from the thread deleting the works, as GetPriority is called on them
+	 */
+	void RecomputePriorities();
+
+	/**
+	 * Get the next work to do, or nullptr if there is none
+	 */
+	IVoxelQueuedWork* GetNextJob(FVoxelQueuedThread* InQueuedThread);
+
+	/**
+	 * Called by threads with nothing to do: returns the next work, or nullptr after having waited
+	 */
+	IVoxelQueuedWork* WaitForJob(FVoxelQueuedThread* InQueuedThread);
+
+private:
+	static int32 GetBucketIndex(int Priority);
 
+	int32 GetHighestBucketIndex() const;
+	IVoxelQueuedWork* StartWork(const FVoxelQueuedWorkTicketPtr& Ticket);
+	IVoxelQueuedWork* PopFromLocalQueue(FVoxelQueuedThread* InQueuedThread);
+	IVoxelQueuedWork* PopFromBuckets(FVoxelQueuedThread* InQueuedThread);
+	IVoxelQueuedWork* StealFromOtherThreads(FVoxelQueuedThread* InQueuedThread);
+	void WakeUpIdleThread();
+};
@@ -1,21 +1,32 @@
 // Copyright 2018 Phyronnaz
 
 #include "VoxelSave.h"
+#include "VoxelPrivate.h"
 #include "BufferArchive.h"
-#include "ArchiveSaveCompressedProxy.h"
 #include "ArchiveLoadCompressedProxy.h"
 #include "MemoryReader.h"
+#include "MemoryWriter.h"
+#include "Compression.h"
+#include "ParallelFor.h"
 
+DECLARE_CYCLE_STAT(TEXT("FVoxelWorldSave::CompressChunks"), STAT_FVoxelWorldSave_CompressChunks, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelWorldSave::GetChunksIndex"), STAT_FVoxelWorldSave_GetChunksIndex, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("FVoxelWorldSave::GetChunks"), STAT_FVoxelWorldSave_GetChunks, STATGROUP_Voxel);
 
+// Id, Position, compressed size
+#define CHUNK_RECORD_HEADER_SIZE (sizeof(uint64) + sizeof(FIntVector) + sizeof(int32))
+#define CHUNK_UNCOMPRESSED_SIZE (DATA_CHUNK_TOTAL_SIZE * (sizeof(float) + sizeof(FVoxelMaterial)))
 
 FVoxelChunkSave::FVoxelChunkSave()
 	: Id(-1)
+	, Position(FIntVector::ZeroValue)
 {
 
 }
 
 FVoxelChunkSave::FVoxelChunkSave(uint64 Id, FIntVector Position, float InValues[DATA_CHUNK_TOTAL_SIZE], FVoxelMaterial InMaterials[DATA_CHUNK_TOTAL_SIZE])
 	: Id(Id)
+	, Position(Position)
 {
 	Values.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
 	Materials.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
@@ -27,36 +38,81 @@ FVoxelChunkSave::FVoxelChunkSave(uint64 Id, FIntVector Position, float InValues[
 	}
 }
 
+inline void AppendChunkRecords(const TArray<FVoxelChunkSave>& ChunksList, TArray<uint8>& Data)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelWorldSave_CompressChunks);
+
+	TArray<TArray<uint8>> Records;
+	Records.SetNum(ChunksList.Num());
+
+	ParallelFor(ChunksList.Num(), [&](int32 Index)
+	{
+		const FVoxelChunkSave& Chunk = ChunksList[Index];
+		check(Chunk.Values.Num() == DATA_CHUNK_TOTAL_SIZE && Chunk.Materials.Num() == DATA_CHUNK_TOTAL_SIZE);
+
+		TArray<uint8> Uncompressed;
+		Uncompressed.SetNumUninitialized(CHUNK_UNCOMPRESSED_SIZE);
+		FMemory::Memcpy(Uncompressed.GetData(), Chunk.Values.GetData(), DATA_CHUNK_TOTAL_SIZE * sizeof(float));
+		FMemory::Memcpy(Uncompressed.GetData() + DATA_CHUNK_TOTAL_SIZE * sizeof(float), Chunk.Materials.GetData(), DATA_CHUNK_TOTAL_SIZE * sizeof(FVoxelMaterial));
+
+		TArray<uint8>& Record = Records[Index];
+		int32 CompressedSize = FCompression::CompressMemoryBound(COMPRESS_ZLIB, Uncompressed.Num());
+		Record.SetNumUninitialized(CHUNK_RECORD_HEADER_SIZE + CompressedSize);
+		verify(FCompression::CompressMemory(COMPRESS_ZLIB, Record.GetData() + CHUNK_RECORD_HEADER_SIZE, CompressedSize, Uncompressed.GetData(), Uncompressed.Num()));
+		Record.SetNum(CHUNK_RECORD_HEADER_SIZE + CompressedSize, false);
+
+		// Overwrites the header
+		FMemoryWriter Writer(Record);
+		uint64 Id = Chunk.Id;
+		FIntVector Position = Chunk.Position;
+		Writer << Id;
+		Writer << Position;
+		Writer << CompressedSize;
+		check(Writer.Tell() == CHUNK_RECORD_HEADER_SIZE);
+	});
+
+	// Order matters
+	for (auto& Record : Records)
+	{
+		Data.Append(Record);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 FVoxelWorldSave::FVoxelWorldSave()
-	: LOD(-1)
+	: Version(EVoxelSaveVersion::BeforeChunkIndex)
+	, LOD(-1)
 {
 
 }
 
 void FVoxelWorldSave::Init(int NewLOD, const TArray<FVoxelChunkSave>& ChunksList)
 {
+	Version = EVoxelSaveVersion::LatestVersion;
 	LOD = NewLOD;
 
-	FBufferArchive ToBinary;
-
-	// Order matters
-	for (auto Chunk : ChunksList)
-	{
-		ToBinary << Chunk;
-	}
-
 	Data.Empty();
-	FArchiveSaveCompressedProxy Compressor = FArchiveSaveCompressedProxy(Data, ECompressionFlags::COMPRESS_ZLIB);
+	AppendChunkRecords(ChunksList, Data);
+}
 
-	// Send entire binary array/archive to compressor
-	Compressor << ToBinary;
+void FVoxelWorldSave::Append(const TArray<FVoxelChunkSave>& ChunksList)
+{
+	check(Version == EVoxelSaveVersion::LatestVersion);
 
-	// Send archive serialized data to binary array
-	Compressor.Flush();
+	AppendChunkRecords(ChunksList, Data);
 }
 
 void FVoxelWorldSave::GetChunksQueue(TArray<FVoxelChunkSave>& SaveQueue) const
 {
+	if (HasChunkIndex())
+	{
+		TArray<FVoxelChunkSaveIndex> Index;
+		GetChunksIndex(Index);
+		GetChunks(Index, SaveQueue);
+		return;
+	}
+
 	FArchiveLoadCompressedProxy Decompressor = FArchiveLoadCompressedProxy(Data, ECompressionFlags::COMPRESS_ZLIB);
 
 	check(!Decompressor.GetError());
@@ -76,3 +132,119 @@ void FVoxelWorldSave::GetChunksQueue(TArray<FVoxelChunkSave>& SaveQueue) const
 		SaveQueue.Add(Chunk);
 	}
 }
+
+void FVoxelWorldSave::GetChunksIndex(TArray<FVoxelChunkSaveIndex>& OutIndex) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelWorldSave_GetChunksIndex);
+
+	check(HasChunkIndex());
+
+	// Last record of each chunk
+	TMap<uint64, FVoxelChunkSaveIndex> Chunks;
+
+	FMemoryReader Reader(Data);
+	while (!Reader.AtEnd())
+	{
+		FVoxelChunkSaveIndex Chunk;
+		Reader << Chunk.Id;
+		Reader << Chunk.Position;
+		Reader << Chunk.Size;
+		Chunk.Offset = Reader.Tell();
+
+		if (Reader.IsError() || Chunk.Size < 0 || Chunk.Offset + Chunk.Size > Data.Num())
+		{
+			UE_LOG(LogVoxel, Error, TEXT("Corrupted voxel save: ignoring the chunks after byte %d"), Chunk.Offset);
+			break;
+		}
+
+		Chunks.Add(Chunk.Id, Chunk);
+		Reader.Seek(Chunk.Offset + Chunk.Size);
+	}
+
+	Chunks.GenerateValueArray(OutIndex);
+	OutIndex.Sort([](const FVoxelChunkSaveIndex& A, const FVoxelChunkSaveIndex& B) { return A.Id < B.Id; });
+}
+
+void FVoxelWorldSave::GetChunks(const TArray<FVoxelChunkSaveIndex>& Index, TArray<FVoxelChunkSave>& OutChunks) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_FVoxelWorldSave_GetChunks);
+
+	check(HasChunkIndex());
+
+	const int32 Start = OutChunks.Num();
+	OutChunks.SetNum(Start + Index.Num());
+
+	TArray<bool> Corrupted;
+	Corrupted.SetNumZeroed(Index.Num());
+
+	ParallelFor(Index.Num(), [&](int32 ChunkIndex)
+	{
+		const FVoxelChunkSaveIndex& Entry = Index[ChunkIndex];
+		FVoxelChunkSave& Chunk = OutChunks[Start + ChunkIndex];
+
+		TArray<uint8> Uncompressed;
+		Uncompressed.SetNumUninitialized(CHUNK_UNCOMPRESSED_SIZE);
+		if (!FCompression::UncompressMemory(COMPRESS_ZLIB, Uncompressed.GetData(), Uncompressed.Num(), Data.GetData() + Entry.Offset, Entry.Size))
+		{
+			Corrupted[ChunkIndex] = true;
+			return;
+		}
+
+		Chunk.Id = Entry.Id;
+		Chunk.Position = Entry.Position;
+		Chunk.Values.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+		Chunk.Materials.SetNumUninitialized(DATA_CHUNK_TOTAL_SIZE);
+		FMemory::Memcpy(Chunk.Values.GetData(), Uncompressed.GetData(), DATA_CHUNK_TOTAL_SIZE * sizeof(float));
+		FMemory::Memcpy(Chunk.Materials.GetData(), Uncompressed.GetData() + DATA_CHUNK_TOTAL_SIZE * sizeof(float), DATA_CHUNK_TOTAL_SIZE * sizeof(FVoxelMaterial));
+	});
+
+	// Backward, to keep the order
+	for (int ChunkIndex = Index.Num() - 1; ChunkIndex >= 0; ChunkIndex--)
+	{
+		if (Corrupted[ChunkIndex])
+		{
+			UE_LOG(LogVoxel, Error, TEXT("Corrupted voxel save: ignoring the chunk at byte %d"), Index[ChunkIndex].Offset);
+			OutChunks.RemoveAt(Start + ChunkIndex, 1, false);
+		}
+	}
+}
+
+void FVoxelWorldSave::SplitRecords(int32 MaxDataSize, TArray<FVoxelWorldSave>& OutSaves) const
+{
+	check(HasChunkIndex());
+
+	int32 RecordsStart = 0;
+	int32 Offset = 0;
+	while (Offset < Data.Num())
+	{
+		FMemoryReader Reader(Data);
+		Reader.Seek(Offset + sizeof(uint64) + sizeof(FIntVector));
+		int32 CompressedSize;
+		Reader << CompressedSize;
+
+		const int32 RecordSize = CHUNK_RECORD_HEADER_SIZE + CompressedSize;
+		if (Reader.IsError() || CompressedSize < 0 || Offset + RecordSize > Data.Num())
+		{
+			UE_LOG(LogVoxel, Error, TEXT("Corrupted voxel save: ignoring the chunks after byte %d"), Offset);
+			break;
+		}
+
+		if (Offset > RecordsStart && Offset + RecordSize - RecordsStart > MaxDataSize)
+		{
+			FVoxelWorldSave& Save = OutSaves[OutSaves.AddDefaulted()];
+			Save.Version = Version;
+			Save.LOD = LOD;
+			Save.Data.Append(Data.GetData() + RecordsStart, Offset - RecordsStart);
+			RecordsStart = Offset;
+		}
+		Offset += RecordSize;
+	}
+
+	if (Offset > RecordsStart)
+	{
+		FVoxelWorldSave& Save = OutSaves[OutSaves.AddDefaulted()];
+		Save.Version = Version;
+		Save.LOD = LOD;
+		Save.Data.Append(Data.GetData() + RecordsStart, Offset - RecordsStart);
+	}
+}
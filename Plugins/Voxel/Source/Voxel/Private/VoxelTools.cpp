@@ -1364,7 +1364,7 @@ void UVoxelTools::CreateMeshFromVoxels(const FIntVector& Size, const TArray<floa
 				{
 					FVoxelProcMeshSection Section;
 					Section.bEnableCollision = true;
-					Thread->Chunk.InitSectionBuffers(Section.ProcVertexBuffer, Section.ProcIndexBuffer, 0);
+					Thread->Chunk.InitSectionBuffers(Section.ProcVertexBuffer, Section.ProcIndexBuffer);
 
 					TArray<FVector> Vertices;
 					Vertices.SetNumUninitialized(Section.ProcVertexBuffer.Num());
@@ -2,52 +2,105 @@
 
 #include "VoxelVertexFactory.h"
 #include "MeshBatch.h"
+#include "ShaderParameterUtils.h"
+#include "VoxelGlobals.h"
+#include "VoxelDirection.h"
 
 
-FVoxelDynamicMeshVertex::FVoxelDynamicMeshVertex(const FVector& InPosition) :
-	Position(InPosition),
-	TextureCoordinate(FVector2D::ZeroVector),
-	TangentX(FVector(1, 0, 0)),
-	TangentZ(FVector(0, 0, 1)),
-	Color(FColor(255, 255, 255))
+FVoxelDynamicMeshVertex::FVoxelDynamicMeshVertex(const FVector& InPosition, const FVector& InNormal, const FVector2D& InTexCoord, const FColor& InColor, float PositionScale)
+	: Color(InColor)
+	, TextureCoordinate(InTexCoord)
 {
-	// basis determinant default to +1.0
-	TangentZ.Vector.W = 255;
+	SetPosition(InPosition, PositionScale);
+	SetNormal(InNormal);
 }
 
-FVoxelDynamicMeshVertex::FVoxelDynamicMeshVertex(const FVector& InPosition, const FVector& InTangentX, const FVector& InTangentZ, const FVector2D& InTexCoord1,const FVector2D& InTexCoord2,const FVector2D& InTexCoord3, const FColor& InColor) :
-	Position(InPosition),
-	TextureCoordinate(InTexCoord1),
-	TangentX(InTangentX),
-	TangentZ(InTangentZ),
-	Color(InColor)
+void FVoxelDynamicMeshVertex::SetPosition(const FVector& InPosition, float PositionScale)
 {
-	// basis determinant default to +1.0
-	TangentZ.Vector.W = 255;
+	for (int Axis = 0; Axis < 3; Axis++)
+	{
+		Position[Axis] = FMath::Clamp<int32>(FMath::RoundToInt(InPosition[Axis] / PositionScale), MIN_int16, MAX_int16);
+	}
 }
 
-void FVoxelDynamicMeshVertex::SetTangents(const FVector& InTangentX, const FVector& InTangentY, const FVector& InTangentZ)
+FVector FVoxelDynamicMeshVertex::GetPosition(float PositionScale) const
 {
-	TangentX = InTangentX;
-	TangentZ = InTangentZ;
-	// store determinant of basis in w component of normal vector
-	TangentZ.Vector.W = GetBasisDeterminantSign(InTangentX, InTangentY, InTangentZ) < 0.0f ? 0 : 255;
+	return FVector(Position[0], Position[1], Position[2]) * PositionScale;
 }
 
-FVector FVoxelDynamicMeshVertex::GetTangentY()
+void FVoxelDynamicMeshVertex::SetNormal(const FVector& InNormal)
 {
-	FVector TanX = TangentX;
-	FVector TanZ = TangentZ;
+	// Project on the octahedron, and fold the lower half over the upper one
+	const float Norm = FMath::Abs(InNormal.X) + FMath::Abs(InNormal.Y) + FMath::Abs(InNormal.Z);
+	FVector2D Octahedral = Norm > 0 ? FVector2D(InNormal.X, InNormal.Y) / Norm : FVector2D::ZeroVector;
+	if (InNormal.Z < 0)
+	{
+		Octahedral = FVector2D(
+			(1 - FMath::Abs(Octahedral.Y)) * (Octahedral.X >= 0 ? 1 : -1),
+			(1 - FMath::Abs(Octahedral.X)) * (Octahedral.Y >= 0 ? 1 : -1));
+	}
 
-	return (TanZ ^ TanX) * ((float)TangentZ.Vector.W / 127.5f - 1.0f);
+	const uint16 X = FMath::Clamp(FMath::RoundToInt((Octahedral.X * 0.5f + 0.5f) * 255), 0, 255);
+	const uint16 Y = FMath::Clamp(FMath::RoundToInt((Octahedral.Y * 0.5f + 0.5f) * 255), 0, 255);
+	PackedNormal = X | (Y << 8);
+}
+
+FVector FVoxelDynamicMeshVertex::GetNormal() const
+{
+	// Same as VoxelGetNormal in VoxelVertexFactory.ush
+	const FVector2D Octahedral = FVector2D(PackedNormal & 0xFF, PackedNormal >> 8) / 255 * 2 - 1;
+
+	FVector Normal(Octahedral.X, Octahedral.Y, 1 - FMath::Abs(Octahedral.X) - FMath::Abs(Octahedral.Y));
+	const float T = FMath::Clamp(-Normal.Z, 0.f, 1.f);
+	Normal.X += Normal.X >= 0 ? -T : T;
+	Normal.Y += Normal.Y >= 0 ? -T : T;
+	return Normal.GetSafeNormal();
 }
 
 ///////////////////////////////////////////////////////////////////////////
 
 
+float FVoxelProcMeshVertexBuffer::GetPositionScale(float MaxAbsCoordinate)
+{
+	float Scale = 1;
+	while (Scale * MAX_int16 < MaxAbsCoordinate)
+	{
+		Scale *= 2;
+	}
+	// Don't go below 1/65536, there's no point in being more precise than floats
+	while (Scale / 2 * MAX_int16 >= MaxAbsCoordinate && Scale > 1.f / 65536)
+	{
+		Scale /= 2;
+	}
+	return Scale;
+}
+
+void FVoxelProcMeshVertexBuffer::UpdateBuffer()
+{
+	check(IsInRenderingThread());
+
+	const uint32 SizeInBytes = Vertices.Num() * sizeof(FVoxelDynamicMeshVertex);
+	if (!IsInitialized())
+	{
+		InitResource();
+	}
+	else if (SizeInBytes > AllocatedSize || SizeInBytes < AllocatedSize / 4)
+	{
+		// Too small, or wasting too much memory
+		UpdateRHI();
+	}
+	else
+	{
+		void* Buffer = RHILockVertexBuffer(VertexBufferRHI, 0, SizeInBytes, RLM_WriteOnly);
+		FMemory::Memcpy(Buffer, Vertices.GetData(), SizeInBytes);
+		RHIUnlockVertexBuffer(VertexBufferRHI);
+	}
+}
+
 void FVoxelProcMeshVertexBuffer::InitRHI()
 {
 	const uint32 SizeInBytes = Vertices.Num() * sizeof(FVoxelDynamicMeshVertex);
+	AllocatedSize = SizeInBytes;
 
 	FVoxelProcMeshVertexResourceArray ResourceArray(Vertices.GetData(), SizeInBytes);
 	FRHIResourceCreateInfo CreateInfo(&ResourceArray);
@@ -58,8 +111,32 @@ void FVoxelProcMeshVertexBuffer::InitRHI()
 //////////////////////////////////////////////////////////////////////////
 
 
+void FVoxelProcMeshIndexBuffer::UpdateBuffer()
+{
+	check(IsInRenderingThread());
+
+	const uint32 SizeInBytes = Indices.Num() * sizeof(int32);
+	if (!IsInitialized())
+	{
+		InitResource();
+	}
+	else if (SizeInBytes > AllocatedSize || SizeInBytes < AllocatedSize / 4)
+	{
+		// Too small, or wasting too much memory
+		UpdateRHI();
+	}
+	else
+	{
+		void* Buffer = RHILockIndexBuffer(IndexBufferRHI, 0, SizeInBytes, RLM_WriteOnly);
+		FMemory::Memcpy(Buffer, Indices.GetData(), SizeInBytes);
+		RHIUnlockIndexBuffer(IndexBufferRHI);
+	}
+}
+
 void FVoxelProcMeshIndexBuffer::InitRHI()
 {
+	AllocatedSize = Indices.Num() * sizeof(int32);
+
 	FRHIResourceCreateInfo CreateInfo;
 	void* Buffer = nullptr;
 	IndexBufferRHI = RHICreateAndLockIndexBuffer(sizeof(int32), Indices.Num() * sizeof(int32), BUF_Static, CreateInfo, Buffer);
@@ -73,8 +150,33 @@ void FVoxelProcMeshIndexBuffer::InitRHI()
 //////////////////////////////////////////////////////////////////////////
 
 
+void FVoxelVertexFactoryShaderParameters::Bind(const FShaderParameterMap& ParameterMap)
+{
+	PositionScaleParameter.Bind(ParameterMap, TEXT("VoxelPositionScale"));
+	TransitionsMinParameter.Bind(ParameterMap, TEXT("VoxelTransitionsMin"));
+	TransitionsMaxParameter.Bind(ParameterMap, TEXT("VoxelTransitionsMax"));
+	TransitionsStepParameter.Bind(ParameterMap, TEXT("VoxelTransitionsStep"));
+}
+
+void FVoxelVertexFactoryShaderParameters::Serialize(FArchive& Ar)
+{
+	Ar << PositionScaleParameter;
+	Ar << TransitionsMinParameter;
+	Ar << TransitionsMaxParameter;
+	Ar << TransitionsStepParameter;
+}
+
 void FVoxelVertexFactoryShaderParameters::SetMesh(FRHICommandList& RHICmdList, FShader* Shader, const FVertexFactory* VertexFactory, const FSceneView& View, const FMeshBatchElement& BatchElement, uint32 DataFlags) const
 {
+	const FVoxelVertexFactory* VoxelVertexFactory = static_cast<const FVoxelVertexFactory*>(VertexFactory);
+	const uint8 TransitionsMask = VoxelVertexFactory->GetTransitionsMask();
+
+	SetShaderValue(RHICmdList, Shader->GetVertexShader(), PositionScaleParameter, VoxelVertexFactory->GetPositionScale());
+	// 1 if there's a transition on this side
+	SetShaderValue(RHICmdList, Shader->GetVertexShader(), TransitionsMinParameter, FVector(!!(TransitionsMask & XMin), !!(TransitionsMask & YMin), !!(TransitionsMask & ZMin)));
+	SetShaderValue(RHICmdList, Shader->GetVertexShader(), TransitionsMaxParameter, FVector(!!(TransitionsMask & XMax), !!(TransitionsMask & YMax), !!(TransitionsMask & ZMax)));
+	SetShaderValue(RHICmdList, Shader->GetVertexShader(), TransitionsStepParameter, (float)(1 << VoxelVertexFactory->GetTransitionsLOD()));
+
 	if (BatchElement.bUserDataIsColorVertexBuffer)
 	{
 		FColorVertexBuffer* OverrideColorVertexBuffer = (FColorVertexBuffer*)BatchElement.UserData;
@@ -90,11 +192,17 @@ void FVoxelVertexFactoryShaderParameters::SetMesh(FRHICommandList& RHICmdList, F
 #if ENGINE_MINOR_VERSION < 19
 FVoxelVertexFactory::FVoxelVertexFactory()
 	: ColorStreamIndex(-1)
+	, PositionScale(1)
+	, TransitionsMask(0)
+	, TransitionsLOD(0)
 {
 }
 #else
 FVoxelVertexFactory::FVoxelVertexFactory(ERHIFeatureLevel::Type InFeatureLevel)
 	: ColorStreamIndex(-1)
+	, PositionScale(1)
+	, TransitionsMask(0)
+	, TransitionsLOD(0)
 	, FVertexFactory(InFeatureLevel)
 {
 }
@@ -102,31 +210,13 @@ FVoxelVertexFactory::FVoxelVertexFactory(ERHIFeatureLevel::Type InFeatureLevel)
 
 void FVoxelVertexFactory::InitRHI()
 {
-	// If the vertex buffer containing position is not the same vertex buffer containing the rest of the data,
-	// then initialize PositionStream and PositionDeclaration.
-	if (Data.PositionComponent.VertexBuffer != Data.TangentBasisComponents[0].VertexBuffer)
-	{
-		FVertexDeclarationElementList PositionOnlyStreamElements;
-		PositionOnlyStreamElements.Add(AccessPositionStreamComponent(Data.PositionComponent, 0));
-		InitPositionDeclaration(PositionOnlyStreamElements);
-	}
-
 	FVertexDeclarationElementList Elements;
 	if (Data.PositionComponent.VertexBuffer != NULL)
 	{
+		// The normal is packed with the position. The tangents are derived from it in the shader
 		Elements.Add(AccessStreamComponent(Data.PositionComponent, 0));
 	}
 
-	// only tangent,normal are used by the stream. the binormal is derived in the shader
-	uint8 TangentBasisAttributes[2] = { 1, 2 };
-	for (int32 AxisIndex = 0; AxisIndex < 2; AxisIndex++)
-	{
-		if (Data.TangentBasisComponents[AxisIndex].VertexBuffer != NULL)
-		{
-			Elements.Add(AccessStreamComponent(Data.TangentBasisComponents[AxisIndex], TangentBasisAttributes[AxisIndex]));
-		}
-	}
-
 	if (Data.ColorComponent.VertexBuffer)
 	{
 		Elements.Add(AccessStreamComponent(Data.ColorComponent, 3));
@@ -182,11 +272,11 @@ void FVoxelVertexFactory::Init_RenderThread(const FVoxelProcMeshVertexBuffer* Ve
 
 	// Initialize the vertex factory's stream components.
 	FDataType NewData;
-	NewData.PositionComponent = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FVoxelDynamicMeshVertex, Position, VET_Float3);
-	NewData.TextureCoordinates.Add(FVertexStreamComponent(VertexBuffer, STRUCT_OFFSET(FVoxelDynamicMeshVertex, TextureCoordinate), sizeof(FVoxelDynamicMeshVertex), VET_Float2));
-	NewData.TangentBasisComponents[0] = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FVoxelDynamicMeshVertex, TangentX, VET_PackedNormal);
-	NewData.TangentBasisComponents[1] = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FVoxelDynamicMeshVertex, TangentZ, VET_PackedNormal);
+	// Position and PackedNormal
+	NewData.PositionComponent = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FVoxelDynamicMeshVertex, Position, VET_Short4);
+	NewData.TextureCoordinates.Add(FVertexStreamComponent(VertexBuffer, STRUCT_OFFSET(FVoxelDynamicMeshVertex, TextureCoordinate), sizeof(FVoxelDynamicMeshVertex), VET_Half2));
 	NewData.ColorComponent = STRUCTMEMBER_VERTEXSTREAMCOMPONENT(VertexBuffer, FVoxelDynamicMeshVertex, Color, VET_Color);
+	PositionScale = VertexBuffer->PositionScale;
 	SetData(NewData);
 }
 
@@ -234,7 +324,8 @@ bool FVoxelVertexFactory::ShouldCompilePermutation(EShaderPlatform Platform, con
 
 void FVoxelVertexFactory::ModifyCompilationEnvironment(EShaderPlatform Platform, const FMaterial* Material, FShaderCompilerEnvironment& OutEnvironment)
 {
-
+	// For the transitions
+	OutEnvironment.SetDefine(TEXT("VOXEL_CHUNK_SIZE"), CHUNK_SIZE);
 }
 
 bool FVoxelVertexFactory::SupportsTessellationShaders()
@@ -3,6 +3,7 @@
 #include "VoxelWorld.h"
 #include "VoxelPrivate.h"
 #include "VoxelData.h"
+#include "VoxelGlobals.h"
 #include "IVoxelRender.h"
 #include "Components/CapsuleComponent.h"
 #include "VoxelWorldGenerators/FlatWorldGenerator.h"
@@ -28,6 +29,8 @@ DECLARE_CYCLE_STAT(TEXT("AVoxelWorld::Tick"), STAT_VoxelWorld_Tick, STATGROUP_Vo
 DECLARE_CYCLE_STAT(TEXT("AVoxelWorld::ReceiveData"), STAT_VoxelWorld_ReceiveData, STATGROUP_Voxel);
 DECLARE_CYCLE_STAT(TEXT("AVoxelWorld::SendData"), STAT_VoxelWorld_SendData, STATGROUP_Voxel);
 DECLARE_CYCLE_STAT(TEXT("AVoxelWorld::GetIntersection"), STAT_VoxelWorld_GetIntersection, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("AVoxelWorld::Raycast"), STAT_VoxelWorld_Raycast, STATGROUP_Voxel);
+DECLARE_CYCLE_STAT(TEXT("AVoxelWorld::FlushChunksUpdates"), STAT_VoxelWorld_FlushChunksUpdates, STATGROUP_Voxel);
 
 AVoxelWorld::AVoxelWorld()
 	: VoxelWorldEditorClass(nullptr)
@@ -36,14 +39,22 @@ AVoxelWorld::AVoxelWorld()
 	, VoxelSize(100)
 	, Seed(100)
 	, MeshThreadCount(2)
+	, MeshUpdateBudget(5)
 	, CollisionsThreadCount(2)
 	, bMultiplayer(false)
 	, MultiplayerSyncRate(15)
+	, MultiplayerInterestDistance(10000)
 	, CollisionsUpdateRate(30)
 	, LODUpdateRate(15)
 	, VoxelWorldEditor(nullptr)
 	, TimeSinceSync(0)
 	, TimeSinceActorOctreeUpdate(0)
+	, TimeSinceColdChunksCompression(0)
+	, bIsStreamingSave(false)
+	, SaveStreamingDistance(0)
+	, ColdChunksCompressionDelay(60)
+	, ColdChunksPagingDelay(0)
+	, GeneratorCacheSize(64)
 	, MaxVoxelActorsRenderDistance(100000)
 	, bCreateWorldAutomatically(true)
 	, ChunksFadeDuration(1)
@@ -202,6 +213,8 @@ void AVoxelWorld::Tick(float DeltaTime)
 
 	if (IsCreated())
 	{
+		FlushChunksUpdates();
+
 		Render->Tick(DeltaTime);
 
 		if (GetWorld()->WorldType == EWorldType::Editor)
@@ -225,6 +238,19 @@ void AVoxelWorld::Tick(float DeltaTime)
 				}
 			}
 			ActorOctree->UpdateVisibility(CameraVoxelPositions);
+
+			if (bIsStreamingSave)
+			{
+				LoadStreamedChunks();
+			}
+		}
+
+		TimeSinceColdChunksCompression += DeltaTime;
+		if (ColdChunksCompressionDelay > 0 && TimeSinceColdChunksCompression > 1)
+		{
+			TimeSinceColdChunksCompression = 0;
+			// Limit the number of chunks to not lock the data for too long
+			Data->CompressColdChunks(ColdChunksCompressionDelay, ColdChunksPagingDelay, 64);
 		}
 	}
 	
@@ -233,6 +259,13 @@ void AVoxelWorld::Tick(float DeltaTime)
 		if (TcpClient.IsValid())
 		{
 			ReceiveData();
+
+			TimeSinceSync += DeltaTime;
+			if (TimeSinceSync > 1.f / MultiplayerSyncRate)
+			{
+				TimeSinceSync = 0;
+				SendInterest();
+			}
 		}
 		else if (TcpServer.IsValid())
 		{
@@ -245,12 +278,7 @@ void AVoxelWorld::Tick(float DeltaTime)
 				if (OnClientConnectionTrigger.GetValue() > 0)
 				{
 					OnClientConnectionTrigger.Reset();
-
-					UE_LOG(LogVoxel, Log, TEXT("Sending world to clients"));
-					FVoxelWorldSave Save;
-					GetSave(Save);
-					TcpServer->SendSave(Save, true);
-
+					// The new clients receive the edited chunks once they send their interest region, see SendData
 					OnClientConnection.Broadcast();
 				}
 			}
@@ -358,7 +386,7 @@ void AVoxelWorld::AddAsset(UVoxelAsset* Asset, FIntVector Position)
 	Data->AddAsset(NewAsset);
 
 	FIntBox Bounds = NewAsset->GetWorldBounds();
-	Render->UpdateBox(Bounds);
+	UpdateChunksOverlappingBox(Bounds);
 }
 
 bool AVoxelWorld::IsInside(const FVector& Position)
@@ -378,10 +406,17 @@ void AVoxelWorld::GetSave(FVoxelWorldSave& OutSave) const
 	Data->GetSave(OutSave);
 }
 
+void AVoxelWorld::AppendToSave(FVoxelWorldSave& Save) const
+{
+	Data->AppendToSave(Save);
+}
+
 void AVoxelWorld::LoadFromSave(const FVoxelWorldSave& Save, bool bReset)
 {
 	if (Save.LOD == LOD)
 	{
+		bIsStreamingSave = false;
+
 		TArray<FIntVector> ModifiedPositions;
 		Data->LoadFromSaveAndGetModifiedPositions(Save, ModifiedPositions, bReset);
 		for (auto Position : ModifiedPositions)
@@ -398,6 +433,48 @@ void AVoxelWorld::LoadFromSave(const FVoxelWorldSave& Save, bool bReset)
 	}
 }
 
+void AVoxelWorld::StreamFromSave(const FVoxelWorldSave& Save, float Distance, bool bReset)
+{
+	if (!Save.HasChunkIndex())
+	{
+		LoadFromSave(Save, bReset);
+	}
+	else if (Save.LOD == LOD)
+	{
+		Data->StreamFromSave(Save, bReset);
+		bIsStreamingSave = true;
+		SaveStreamingDistance = Distance;
+		LoadStreamedChunks();
+	}
+	else
+	{
+		UE_LOG(LogVoxel, Error, TEXT("StreamFromSave: Current Depth is %d while Save one is %d"), LOD, Save.LOD);
+	}
+}
+
+void AVoxelWorld::LoadStreamedChunks()
+{
+	const int Distance = FMath::CeilToInt(SaveStreamingDistance / GetVoxelSize());
+
+	TArray<FIntBox> Boxes;
+	Invokers.RemoveAll([](auto Ptr) { return !Ptr.IsValid(); });
+	for (auto& Invoker : Invokers)
+	{
+		const FIntVector Position = GlobalToLocal(Invoker->GetPosition());
+		Boxes.Add(FIntBox(Position - FIntVector(Distance, Distance, Distance), Position + FIntVector(Distance, Distance, Distance)));
+	}
+
+	TArray<FIntVector> ModifiedPositions;
+	bIsStreamingSave = Data->LoadStreamedChunksAndGetModifiedPositions(Boxes, ModifiedPositions);
+	for (auto Position : ModifiedPositions)
+	{
+		if (IsInWorld(Position))
+		{
+			UpdateChunksAtPosition(Position);
+		}
+	}
+}
+
 void AVoxelWorld::StartServer(const FString& Ip, const int32 Port)
 {
 	if(!bMultiplayer) 
@@ -442,11 +519,14 @@ void AVoxelWorld::ReceiveData()
 	if (TcpClient.IsValid())
 	{
 		TcpClient->UpdateExpectedSize();
-		if (TcpClient->IsNextUpdateRemoteLoad())
+		if (TcpClient->IsNextUpdateChunks())
 		{
+			// Chunks entering the interest region replace the local ones
 			FVoxelWorldSave Save;
-			TcpClient->ReceiveSave(Save);
-			LoadFromSave(Save, true);
+			if (TcpClient->ReceiveSave(Save))
+			{
+				LoadFromSave(Save, false);
+			}
 		}
 		else
 		{
@@ -480,9 +560,31 @@ void AVoxelWorld::SendData()
 		TArray<FVoxelMaterialDiff> MaterialDiffQueue;
 		Data->GetDiffQueues(ValueDiffQueue, MaterialDiffQueue);
 
-		TcpServer->SendValueDiffQueue(ValueDiffQueue);
-		TcpServer->SendMaterialDiffQueue(MaterialDiffQueue);
+		// The chunks sent already have the diffs
+		TcpServer->SendChunksEnteringInterests(*Data);
+		TcpServer->SendDiffQueues(*Data, ValueDiffQueue, MaterialDiffQueue);
+	}
+}
+
+void AVoxelWorld::SendInterest()
+{
+	const int Distance = FMath::CeilToInt(MultiplayerInterestDistance / GetVoxelSize());
+
+	// Snapped to the data chunks, so that it only changes when an invoker enters a new chunk
+	auto SnapDown = [](int X) { return X & ~(DATA_CHUNK_SIZE - 1); };
+	auto SnapUp = [](int X) { return (X + DATA_CHUNK_SIZE - 1) & ~(DATA_CHUNK_SIZE - 1); };
+
+	TArray<FIntBox> Boxes;
+	Invokers.RemoveAll([](auto Ptr) { return !Ptr.IsValid(); });
+	for (auto& Invoker : Invokers)
+	{
+		const FIntVector Position = GlobalToLocal(Invoker->GetPosition());
+		const FIntVector Min = Position - FIntVector(Distance, Distance, Distance);
+		const FIntVector Max = Position + FIntVector(Distance, Distance, Distance);
+		Boxes.Add(FIntBox(FIntVector(SnapDown(Min.X), SnapDown(Min.Y), SnapDown(Min.Z)), FIntVector(SnapUp(Max.X), SnapUp(Max.Y), SnapUp(Max.Z))));
 	}
+
+	TcpClient->SendInterest(Boxes);
 }
 
 AVoxelWorldEditorInterface* AVoxelWorld::GetVoxelWorldEditor() const
@@ -702,6 +804,11 @@ int AVoxelWorld::GetMeshThreadCount() const
 	return MeshThreadCount;
 }
 
+float AVoxelWorld::GetMeshUpdateBudget() const
+{
+	return MeshUpdateBudget;
+}
+
 FQueuedThreadPool* AVoxelWorld::GetAsyncTasksThreadPool() const
 {
 	return AsyncTasksThreadPool;
@@ -750,17 +857,68 @@ TArray<FIntVector> AVoxelWorld::GetNeighboringPositions(const FVector& GlobalPos
 
 void AVoxelWorld::UpdateChunksAtPosition(const FIntVector& Position)
 {
-	Render->UpdateBox(FIntBox(Position));
+	UpdateChunksOverlappingBox(FIntBox(Position));
 }
 
 void AVoxelWorld::UpdateChunksOverlappingBox(const FIntBox& Box)
 {
-	Render->UpdateBox(Box);
+	if (Box.Size().GetMax() <= DATA_CHUNK_SIZE)
+	{
+		// Tools update voxel per voxel: merge the updates in the same data chunk
+		const FIntVector Chunk(Box.Min.X & ~(DATA_CHUNK_SIZE - 1), Box.Min.Y & ~(DATA_CHUNK_SIZE - 1), Box.Min.Z & ~(DATA_CHUNK_SIZE - 1));
+		FIntBox* QueuedBox = QueuedChunksUpdates.Find(Chunk);
+		if (QueuedBox)
+		{
+			*QueuedBox = QueuedBox->Union(Box);
+		}
+		else
+		{
+			QueuedChunksUpdates.Add(Chunk, Box);
+		}
+	}
+	else
+	{
+		for (auto& QueuedBox : QueuedBoxesUpdates)
+		{
+			if (QueuedBox.Contains(Box))
+			{
+				return;
+			}
+		}
+		QueuedBoxesUpdates.RemoveAllSwap([&](const FIntBox& QueuedBox) { return Box.Contains(QueuedBox); });
+		QueuedBoxesUpdates.Add(Box);
+	}
 }
 
 void AVoxelWorld::UpdateAll()
 {
-	Render->UpdateBox(FIntBox::Infinite());
+	QueuedChunksUpdates.Reset();
+	QueuedBoxesUpdates.Reset();
+	QueuedBoxesUpdates.Add(FIntBox::Infinite());
+}
+
+void AVoxelWorld::FlushChunksUpdates()
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelWorld_FlushChunksUpdates);
+
+	if (IsCreated())
+	{
+		for (auto& Box : QueuedBoxesUpdates)
+		{
+			Render->UpdateBox(Box);
+		}
+		for (auto& It : QueuedChunksUpdates)
+		{
+			const FIntBox& Box = It.Value;
+			if (!QueuedBoxesUpdates.ContainsByPredicate([&](const FIntBox& QueuedBox) { return QueuedBox.Contains(Box); }))
+			{
+				Render->UpdateBox(Box);
+			}
+		}
+	}
+
+	QueuedChunksUpdates.Reset();
+	QueuedBoxesUpdates.Reset();
 }
 
 void AVoxelWorld::AddInvoker(TWeakObjectPtr<UVoxelInvokerComponent> Invoker)
@@ -794,7 +952,7 @@ void AVoxelWorld::CreateWorldInternal(AActor* InChunksOwner)
 	InstancedWorldGenerator->SetVoxelWorld(this);
 
 	// Create Data
-	Data = MakeShareable(new FVoxelData(LOD, InstancedWorldGenerator.ToSharedRef(), bMultiplayer));
+	Data = MakeShareable(new FVoxelData(LOD, InstancedWorldGenerator.ToSharedRef(), bMultiplayer, (uint32)GeneratorCacheSize << 20));
 
 #if DO_CHECK
 	FVoxelUtilities::TestRLE();
@@ -846,6 +1004,10 @@ void AVoxelWorld::DestroyWorldInternal()
 	Data.Reset(); // Data must be deleted AFTER Render
 	ActorOctree.Reset();
 
+	QueuedChunksUpdates.Reset();
+	QueuedBoxesUpdates.Reset();
+
+	bIsStreamingSave = false;
 	bIsCreated = false;
 }
 
@@ -962,86 +1124,35 @@ bool AVoxelWorld::GetIntersection(const FIntVector& Start, const FIntVector& End
 {
 	SCOPE_CYCLE_COUNTER(STAT_VoxelWorld_GetIntersection);
 
-	FIntVector Diff = End - Start;
-	if (Diff.X != 0)
+	FVoxelRaycastHit Hit;
+	if (!Data->Raycast(FVoxelRay(FVector(Start), FVector(End)), Hit))
 	{
-		if (Diff.Y != 0 || Diff.Z != 0)
-		{
-			UE_LOG(LogVoxel, Error, TEXT("GetIntersection: Start and end should have 2 common coordinates"));
-			return false;
-		}
-	}
-	else if (Diff.Y != 0)
-	{
-		if (Diff.X != 0 || Diff.Z != 0)
-		{
-			UE_LOG(LogVoxel, Error, TEXT("GetIntersection: Start and end should have 2 common coordinates"));
-			return false;
-		}
-	}
-	else if (Diff.Z != 0)
-	{
-		if (Diff.X != 0 || Diff.Y != 0)
-		{
-			UE_LOG(LogVoxel, Error, TEXT("GetIntersection: Start and end should have 2 common coordinates"));
-			return false;
-		}
+		return false;
 	}
 
-	FIntVector RealStart(FMath::Min(Start.X, End.X), FMath::Min(Start.Y, End.Y), FMath::Min(Start.Z, End.Z));
-	FIntVector RealEnd(FMath::Max(Start.X, End.X) + 1, FMath::Max(Start.Y, End.Y) + 1, FMath::Max(Start.Z, End.Z) + 1);
-
-	bool bFound = false;
-	auto Octrees = Data->BeginGet(FIntBox(RealStart, RealEnd));
-	float OldValue = Data->GetValue(RealStart.X, RealStart.Y, RealStart.Z);
-	FIntVector OldPosition = RealStart;
-	for (int X = RealStart.X; X < RealEnd.X; X++)
-	{
-		for (int Y = RealStart.Y; Y < RealEnd.Y; Y++)
-		{
-			for (int Z = RealStart.Z; Z < RealEnd.Z; Z++)
-			{
-				if (UNLIKELY(!Data->IsInWorld(X, Y, Z))) 
-				{
-					UE_LOG(LogVoxel, Error, TEXT("GetIntersection: Out of world!"));
-					return false;
-				}
-
-				float Value = Data->GetValue(X, Y, Z);
-				FIntVector Position(X, Y, Z);
-
-				if (!FVoxelUtilities::HaveSameSign(OldValue, Value))
-				{
-					check(OldValue - Value != 0);
-					const float t = OldValue / (OldValue - Value);
+	OutGlobalPosition = LocalToGlobalFloat(Hit.Position);
+	OutVoxelPosition = FIntVector(FMath::RoundToInt(Hit.Position.X), FMath::RoundToInt(Hit.Position.Y), FMath::RoundToInt(Hit.Position.Z));
+	return true;
+}
 
-					FVector Q = t * static_cast<FVector>(Position) + (1 - t) * static_cast<FVector>(OldPosition);
-					OutGlobalPosition = LocalToGlobalFloat(Q);
-					OutVoxelPosition = Position;
-					bFound = true;
-				}
+bool AVoxelWorld::RaycastBP(const FVector& Start, const FVector& End, FVector& HitPosition, FVector& HitNormal)
+{
+	return Raycast(Start, End, HitPosition, HitNormal);
+}
 
-				OldValue = Value;
-				OldPosition = Position;
+bool AVoxelWorld::Raycast(const FVector& Start, const FVector& End, FVector& OutHitPosition, FVector& OutHitNormal) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_VoxelWorld_Raycast);
 
-				if (bFound)
-				{
-					break;
-				}
-			}
-			if (bFound)
-			{
-				break;
-			}
-		}
-		if (bFound)
-		{
-			break;
-		}
+	FVoxelRaycastHit Hit;
+	if (!Data->Raycast(FVoxelRay(GlobalToLocalFloat(Start), GlobalToLocalFloat(End)), Hit))
+	{
+		return false;
 	}
-	Data->EndGet(Octrees);
 
-	return bFound;
+	OutHitPosition = LocalToGlobalFloat(Hit.Position);
+	OutHitNormal = GetTransform().TransformVectorNoScale(Hit.Normal);
+	return true;
 }
 
 FVector AVoxelWorld::GetNormal(const FIntVector& Position) const